@@ -0,0 +1,60 @@
+#include "builtin_patterns.h"
+#include "patterns.h"
+#include "detection/oui_matcher.h"
+#include "detection/pattern_matcher.h"
+#include "detection/uuid_matcher.h"
+
+// Compiled-in tables described in patterns.h
+
+const char* const wifi_ssid_patterns[] = {
+    "flock",            // Standard Flock Safety naming
+    "Flock",            // Capitalized variant
+    "FLOCK",            // All caps variant
+    "FS Ext Battery",   // Flock Safety Extended Battery devices
+    "Penguin",          // Penguin surveillance devices
+    "Pigvision"         // Pigvision surveillance systems
+};
+
+const char* const mac_prefixes[] = {
+    // FS Ext Battery devices
+    "58:8e:81", "cc:cc:cc", "ec:1b:bd", "90:35:ea", "04:0d:84", 
+    "f0:82:c0", "1c:34:f1", "38:5b:44", "94:34:69", "b4:e3:f9",
+    
+    // Flock WiFi devices
+    "70:c9:4e", "3c:91:80", "d8:f3:bc", "80:30:49", "14:5a:fc",
+    "74:4c:a1", "08:3a:88", "9c:2f:9d", "94:08:53", "e4:aa:ea"
+};
+
+const char* const device_name_patterns[] = {
+    "FS Ext Battery",   // Flock Safety Extended Battery
+    "Penguin",          // Penguin surveillance devices
+    "Flock",            // Standard Flock Safety devices
+    "Pigvision"         // Pigvision surveillance systems
+};
+
+const char* const raven_service_uuids[RAVEN_SVC_COUNT] = {
+    RAVEN_DEVICE_INFO_SERVICE,      // Device info (all versions)
+    RAVEN_GPS_SERVICE,              // GPS data (1.2.0+)
+    RAVEN_POWER_SERVICE,            // Battery/Solar (1.2.0+)
+    RAVEN_NETWORK_SERVICE,          // LTE/WiFi status (1.2.0+)
+    RAVEN_UPLOAD_SERVICE,           // Upload stats (1.2.0+)
+    RAVEN_ERROR_SERVICE,            // Error tracking (1.2.0+)
+    RAVEN_OLD_HEALTH_SERVICE,       // Old health service (1.1.7)
+    RAVEN_OLD_LOCATION_SERVICE      // Old location service (1.1.7)
+};
+
+void loadBuiltinPatterns() {
+    for (size_t i = 0; i < sizeof(mac_prefixes)/sizeof(mac_prefixes[0]); i++) {
+        ouiMatcher.addPrefix(mac_prefixes[i]);
+    }
+    for (size_t i = 0; i < sizeof(wifi_ssid_patterns)/sizeof(wifi_ssid_patterns[0]); i++) {
+        ssidMatcher.addPattern(wifi_ssid_patterns[i]);
+    }
+    for (size_t i = 0; i < sizeof(device_name_patterns)/sizeof(device_name_patterns[0]); i++) {
+        nameMatcher.addPattern(device_name_patterns[i]);
+    }
+    // Index in the matcher == RavenService bit
+    for (size_t i = 0; i < sizeof(raven_service_uuids)/sizeof(raven_service_uuids[0]); i++) {
+        ravenUuidMatcher.addUuid(raven_service_uuids[i]);
+    }
+}
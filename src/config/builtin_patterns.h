@@ -0,0 +1,9 @@
+#ifndef BUILTIN_PATTERNS_H
+#define BUILTIN_PATTERNS_H
+
+// Add the compiled-in tables from patterns.h to the detection matchers.
+// The caller clears the matchers beforehand and builds them afterwards.
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+void loadBuiltinPatterns();
+
+#endif // BUILTIN_PATTERNS_H
@@ -0,0 +1,95 @@
+#include "pattern_loader.h"
+#include "builtin_patterns.h"
+#include "detection/oui_matcher.h"
+#include "detection/pattern_matcher.h"
+#include "detection/uuid_matcher.h"
+#include <SD.h>
+
+PatternLoader patternLoader;
+
+enum PatternSection {
+    SECTION_NONE,
+    SECTION_MAC,
+    SECTION_SSID,
+    SECTION_NAME
+};
+
+void PatternLoader::begin(bool sdAvailable) {
+    ouiMatcher.clear();
+    ssidMatcher.clear();
+    nameMatcher.clear();
+    ravenUuidMatcher.clear();
+    
+    loadBuiltinPatterns();
+    uint32_t added = sdAvailable ? loadFromSD() : 0;
+    
+    ouiMatcher.build();
+    ssidMatcher.build();
+    nameMatcher.build();
+    
+    printf("Detection patterns: %u MAC prefixes, %u SSID, %u device name (%u from SD)\n",
+           (unsigned)ouiMatcher.size(), (unsigned)ssidMatcher.size(),
+           (unsigned)nameMatcher.size(), (unsigned)added);
+}
+
+uint32_t PatternLoader::loadFromSD() {
+    if (!SD.exists(PATTERN_FILE)) {
+        return 0;
+    }
+    
+    File file = SD.open(PATTERN_FILE, FILE_READ);
+    if (!file) {
+        printf("Failed to open %s\n", PATTERN_FILE);
+        return 0;
+    }
+    
+    PatternSection section = SECTION_NONE;
+    uint32_t added = 0;
+    uint32_t rejected = 0;
+    
+    while (file.available()) {
+        String line = file.readStringUntil('\n');
+        int hash = line.indexOf('#');
+        if (hash >= 0) line = line.substring(0, hash);
+        line.trim();
+        
+        if (line.length() == 0) continue;
+        
+        if (line.startsWith("[")) {
+            if (line == "[mac]") {
+                section = SECTION_MAC;
+            } else if (line == "[ssid]") {
+                section = SECTION_SSID;
+            } else if (line == "[name]") {
+                section = SECTION_NAME;
+            } else {
+                section = SECTION_NONE;
+            }
+            continue;
+        }
+        
+        switch (section) {
+            case SECTION_MAC:
+                if (ouiMatcher.addPrefix(line.c_str())) {
+                    added++;
+                } else {
+                    rejected++;
+                }
+                break;
+            case SECTION_SSID:
+                if (ssidMatcher.addPattern(line.c_str()) >= 0) added++;
+                break;
+            case SECTION_NAME:
+                if (nameMatcher.addPattern(line.c_str()) >= 0) added++;
+                break;
+            case SECTION_NONE:
+                break;
+        }
+    }
+    file.close();
+    
+    if (rejected > 0) {
+        printf("%s: ignored %u malformed entries\n", PATTERN_FILE, (unsigned)rejected);
+    }
+    return added;
+}
@@ -0,0 +1,28 @@
+#ifndef PATTERN_LOADER_H
+#define PATTERN_LOADER_H
+
+#include <Arduino.h>
+
+// Builds the runtime detection matchers from the built-in tables in
+// patterns.h plus an optional community pattern file on the SD card.
+//
+// /patterns.txt format (one entry per line, '#' starts a comment):
+//   [mac]           MAC prefixes
+//   58:8e:81
+//   [ssid]          WiFi SSID substrings (case-insensitive)
+//   Flock
+//   [name]          BLE device name substrings (case-insensitive)
+//   Penguin
+class PatternLoader {
+public:
+    void begin(bool sdAvailable);
+
+private:
+    const char* PATTERN_FILE = "/patterns.txt";
+    
+    uint32_t loadFromSD();
+};
+
+extern PatternLoader patternLoader;
+
+#endif // PATTERN_LOADER_H
@@ -4,35 +4,17 @@
 // ============================================================================
 // DETECTION PATTERNS (Extracted from Real Flock Safety Device Databases)
 // ============================================================================
+//
+// The tables are defined once, in builtin_patterns.cpp.
 
 // WiFi SSID patterns to detect (case-insensitive)
-static const char* wifi_ssid_patterns[] = {
-    "flock",            // Standard Flock Safety naming
-    "Flock",            // Capitalized variant
-    "FLOCK",            // All caps variant
-    "FS Ext Battery",   // Flock Safety Extended Battery devices
-    "Penguin",          // Penguin surveillance devices
-    "Pigvision"         // Pigvision surveillance systems
-};
+extern const char* const wifi_ssid_patterns[];
 
 // Known Flock Safety MAC address prefixes (from real device databases)
-static const char* mac_prefixes[] = {
-    // FS Ext Battery devices
-    "58:8e:81", "cc:cc:cc", "ec:1b:bd", "90:35:ea", "04:0d:84", 
-    "f0:82:c0", "1c:34:f1", "38:5b:44", "94:34:69", "b4:e3:f9",
-    
-    // Flock WiFi devices
-    "70:c9:4e", "3c:91:80", "d8:f3:bc", "80:30:49", "14:5a:fc",
-    "74:4c:a1", "08:3a:88", "9c:2f:9d", "94:08:53", "e4:aa:ea"
-};
+extern const char* const mac_prefixes[];
 
 // Device name patterns for BLE advertisement detection
-static const char* device_name_patterns[] = {
-    "FS Ext Battery",   // Flock Safety Extended Battery
-    "Penguin",          // Penguin surveillance devices
-    "Flock",            // Standard Flock Safety devices
-    "Pigvision"         // Pigvision surveillance systems
-};
+extern const char* const device_name_patterns[];
 
 // ============================================================================
 // RAVEN SURVEILLANCE DEVICE UUID PATTERNS
@@ -62,16 +44,20 @@ static const char* device_name_patterns[] = {
 // Location and Navigation Service (firmware 1.1.7)
 #define RAVEN_OLD_LOCATION_SERVICE      "00001819-0000-1000-8000-00805f9b34fb"
 
-// Known Raven service UUIDs for detection
-static const char* raven_service_uuids[] = {
-    RAVEN_DEVICE_INFO_SERVICE,      // Device info (all versions)
-    RAVEN_GPS_SERVICE,              // GPS data (1.2.0+)
-    RAVEN_POWER_SERVICE,            // Battery/Solar (1.2.0+)
-    RAVEN_NETWORK_SERVICE,          // LTE/WiFi status (1.2.0+)
-    RAVEN_UPLOAD_SERVICE,           // Upload stats (1.2.0+)
-    RAVEN_ERROR_SERVICE,            // Error tracking (1.2.0+)
-    RAVEN_OLD_HEALTH_SERVICE,       // Old health service (1.1.7)
-    RAVEN_OLD_LOCATION_SERVICE      // Old location service (1.1.7)
+// Bit positions in the Raven service mask - must follow raven_service_uuids order
+enum RavenService {
+    RAVEN_SVC_DEVICE_INFO = 0,
+    RAVEN_SVC_GPS = 1,
+    RAVEN_SVC_POWER = 2,
+    RAVEN_SVC_NETWORK = 3,
+    RAVEN_SVC_UPLOAD = 4,
+    RAVEN_SVC_ERROR = 5,
+    RAVEN_SVC_OLD_HEALTH = 6,
+    RAVEN_SVC_OLD_LOCATION = 7,
+    RAVEN_SVC_COUNT = 8
 };
 
+// Known Raven service UUIDs for detection
+extern const char* const raven_service_uuids[RAVEN_SVC_COUNT];
+
 #endif // PATTERNS_H
@@ -25,6 +25,8 @@
 #define SD_MOSI         13      // SD Card MOSI (HSPI)
 #define SD_MISO         12      // SD Card MISO (HSPI)
 #define SD_SCK          14      // SD Card Clock (HSPI)
+#define SD_SPI_FREQUENCY    4000000 // One mount shared by settings, logs, database, capture
+#define SD_MAX_OPEN_FILES   8       // Log, 2 capture, journal, snapshot, camera index, export, config
 
 // ============================================================================
 // HARDWARE CONFIGURATION
@@ -35,18 +37,26 @@
 #define SCREEN_HEIGHT   64
 #define OLED_RESET      -1
 #define OLED_ADDRESS    0x3C
+#define OLED_I2C_CLOCK      800000  // Above the SSD1306's 400 kHz rating, fine on common modules; 400000 if it glitches
+#define OLED_I2C_CLOCK_RTC  400000  // DS3231 on the same bus is rated for 400 kHz
+#define OLED_I2C_CHUNK      127     // Bytes per Wire transaction (128-byte buffer minus control byte)
 
 // Audio Timing (for active buzzer)
 #define BOOT_BEEP_DURATION      300
 #define DETECT_BEEP_DURATION    150
 #define HEARTBEAT_DURATION      100
+#define LED_FRAME_INTERVAL      20      // LED render task period (ms) - 50 fps
+#define LED_TASK_STACK_SIZE     2048    // LED render task stack (bytes)
 
 // WiFi Configuration
 #define MAX_CHANNEL             13
-#define CHANNEL_HOP_INTERVAL    200     // milliseconds - faster hopping for better coverage
-
-// BLE Configuration
-#define BLE_SCAN_DURATION       5       // Seconds - longer scans catch more devices
-#define BLE_SCAN_INTERVAL       100     // Milliseconds between scans - near-continuous scanning
+#define CHANNEL_DWELL_MIN       80      // Shortest dwell on a channel (ms)
+#define CHANNEL_DWELL_MAX       800     // Longest dwell on a channel (ms)
+#define CHANNEL_LOCK_TIME       1500    // Stay on a channel after a detection (ms)
+#define CHANNEL_MAX_REVISIT     6000    // Every channel is visited at least this often (ms)
+#define WIFI_FRAME_RING_SIZE    128     // Sniffed frames buffered between callback and processing task
+#define WIFI_TASK_STACK_SIZE    8192    // Processing task stack (bytes)
+#define CHANNEL_HOP_TICK        10      // Hop task period (ms), well under CHANNEL_DWELL_MIN
+#define WIFI_HOP_TASK_STACK_SIZE 3072   // Hop task stack (bytes)
 
 #endif // PINS_H
@@ -39,6 +39,8 @@ bool SettingsManager::loadFromSD() {
     JsonObject hw = doc["hardware"];
     if (!hw.isNull()) {
         settings.hardware.enable_gps = hw["enable_gps"] | true;
+        settings.hardware.gps_ubx = hw["gps_ubx"] | false;
+        settings.hardware.gps_rate = hw["gps_rate"] | 5;
         settings.hardware.enable_rtc = hw["enable_rtc"] | false;
         settings.hardware.enable_leds = hw["enable_leds"] | true;
         settings.hardware.enable_buzzer = hw["enable_buzzer"] | true;
@@ -59,10 +61,10 @@ bool SettingsManager::loadFromSD() {
     JsonObject scan = doc["scan"];
     if (!scan.isNull()) {
         settings.scan.channel_hop_interval = scan["channel_hop_interval"] | 200;
-        settings.scan.ble_scan_duration = scan["ble_scan_duration"] | 5;
-        settings.scan.ble_scan_interval = scan["ble_scan_interval"] | 100;
         settings.scan.rssi_threshold = scan["rssi_threshold"] | -85;
         settings.scan.detection_cooldown = scan["detection_cooldown"] | 2000;
+        settings.scan.ble_filter_reset = scan["ble_filter_reset"] | 10000;
+        settings.scan.camera_alert_distance = scan["camera_alert_distance"] | 300;
     }
     
     // Load audio config
@@ -89,6 +91,10 @@ bool SettingsManager::loadFromSD() {
         settings.log.verbose_logging = log["verbose_logging"] | false;
         settings.log.flush_interval = log["flush_interval"] | 30000;
         settings.log.auto_export = log["auto_export"] | false;
+        settings.log.max_devices = log["max_devices"] | 500;
+        settings.log.binary_events = log["binary_events"] | false;
+        settings.log.capture_packets = log["capture_packets"] | false;
+        settings.log.stats_interval = log["stats_interval"] | 0;
     }
     
     printf("Settings loaded successfully\n");
@@ -101,6 +107,8 @@ bool SettingsManager::saveToSD() {
     // Hardware
     JsonObject hw = doc.createNestedObject("hardware");
     hw["enable_gps"] = settings.hardware.enable_gps;
+    hw["gps_ubx"] = settings.hardware.gps_ubx;
+    hw["gps_rate"] = settings.hardware.gps_rate;
     hw["enable_rtc"] = settings.hardware.enable_rtc;
     hw["enable_leds"] = settings.hardware.enable_leds;
     hw["enable_buzzer"] = settings.hardware.enable_buzzer;
@@ -119,10 +127,10 @@ bool SettingsManager::saveToSD() {
     // Scan
     JsonObject scan = doc.createNestedObject("scan");
     scan["channel_hop_interval"] = settings.scan.channel_hop_interval;
-    scan["ble_scan_duration"] = settings.scan.ble_scan_duration;
-    scan["ble_scan_interval"] = settings.scan.ble_scan_interval;
     scan["rssi_threshold"] = settings.scan.rssi_threshold;
     scan["detection_cooldown"] = settings.scan.detection_cooldown;
+    scan["ble_filter_reset"] = settings.scan.ble_filter_reset;
+    scan["camera_alert_distance"] = settings.scan.camera_alert_distance;
     
     // Audio
     JsonObject audio = doc.createNestedObject("audio");
@@ -143,6 +151,10 @@ bool SettingsManager::saveToSD() {
     log["verbose_logging"] = settings.log.verbose_logging;
     log["flush_interval"] = settings.log.flush_interval;
     log["auto_export"] = settings.log.auto_export;
+    log["max_devices"] = settings.log.max_devices;
+    log["binary_events"] = settings.log.binary_events;
+    log["capture_packets"] = settings.log.capture_packets;
+    log["stats_interval"] = settings.log.stats_interval;
     
     File file = SD.open(CONFIG_FILE, FILE_WRITE);
     if (!file) {
@@ -159,7 +171,8 @@ bool SettingsManager::saveToSD() {
 
 void SettingsManager::printSettings() {
     printf("\n=== Hardware Configuration ===\n");
-    printf("GPS:     %s\n", settings.hardware.enable_gps ? "ENABLED" : "DISABLED");
+    printf("GPS:     %s%s\n", settings.hardware.enable_gps ? "ENABLED" : "DISABLED",
+           settings.hardware.enable_gps && settings.hardware.gps_ubx ? " (UBX)" : "");
     printf("RTC:     %s\n", settings.hardware.enable_rtc ? "ENABLED" : "DISABLED");
     printf("LEDs:    %s\n", settings.hardware.enable_leds ? "ENABLED" : "DISABLED");
     printf("Buzzer:  %s\n", settings.hardware.enable_buzzer ? "ENABLED" : "DISABLED");
@@ -168,9 +181,9 @@ void SettingsManager::printSettings() {
     
     printf("\n=== Scan Configuration ===\n");
     printf("WiFi Channel Hop: %d ms\n", settings.scan.channel_hop_interval);
-    printf("BLE Scan Duration: %d s\n", settings.scan.ble_scan_duration);
-    printf("BLE Scan Interval: %d ms\n", settings.scan.ble_scan_interval);
+    printf("BLE Filter Reset: %d ms\n", settings.scan.ble_filter_reset);
     printf("RSSI Threshold: %d dBm\n", settings.scan.rssi_threshold);
+    printf("Camera Alert Distance: %d m\n", settings.scan.camera_alert_distance);
     
     printf("\n=== Audio Configuration ===\n");
     printf("Audio Enabled: %s\n", settings.audio.enable_audio ? "YES" : "NO");
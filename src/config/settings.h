@@ -28,6 +28,8 @@ enum LEDFunction {
 // Hardware enable/disable flags
 struct HardwareConfig {
     bool enable_gps = true;
+    bool gps_ubx = false;                   // u-blox: binary NAV-PVT at 115200 baud instead of NMEA
+    uint8_t gps_rate = 5;                   // Hz, UBX mode only
     bool enable_rtc = false;                // DS3231 RTC for accurate timestamps
     bool enable_leds = true;
     bool enable_buzzer = true;
@@ -47,10 +49,10 @@ struct HardwareConfig {
 // Scanning and detection parameters
 struct ScanConfig {
     uint16_t channel_hop_interval = 200;    // ms
-    uint8_t ble_scan_duration = 5;          // seconds
-    uint16_t ble_scan_interval = 100;       // ms
     int8_t rssi_threshold = -85;            // dBm
     uint16_t detection_cooldown = 2000;     // ms
+    uint16_t ble_filter_reset = 10000;      // ms between BLE duplicate filter resets (0 = no filter)
+    uint16_t camera_alert_distance = 300;   // m; alert for known cameras in /cameras.idx (0 = off)
 };
 
 // Audio feedback settings
@@ -74,6 +76,10 @@ struct LogConfig {
     bool verbose_logging = false;
     uint32_t flush_interval = 30000;        // ms
     bool auto_export = false;
+    uint16_t max_devices = 500;             // Device table capacity (lowest-count device evicted when full)
+    bool binary_events = false;             // Framed binary detection events on serial instead of JSON lines
+    bool capture_packets = false;           // Record raw WiFi/BLE packets to pcap files on the SD card
+    uint32_t stats_interval = 0;            // ms between stats lines on serial (0 = only on "stats" command)
 };
 
 // Complete system settings
@@ -1,113 +1,50 @@
 #include "ble_detector.h"
-#include "raven_detector.h"
-#include "detection_state.h"
-#include "hardware/led_controller.h"
-#include "hardware/buzzer.h"
-#include "hardware/gps_manager.h"
-#include "hardware/sd_logger.h"
-#include "hardware/data_manager.h"
+#include "detection_pipeline.h"
+#include "frame_parser.h"
+#include "hardware/packet_capture.h"
 #include "config/settings.h"
-#include <ArduinoJson.h>
 #include <string.h>
+#include "system/metrics.h"
 
 BLEDetector bleDetector;
 
-void outputBLEDetectionJSON(const char* mac, const char* name, int rssi, const char* detectionMethod);
+static MetricHistogram callbackLatency("ble.callback");   // Whole onResult
+static MetricHistogram pipelineLatency("ble.pipeline");   // processBle only
+static MetricCounter adverts("ble.adverts");
+static MetricCounter duplicates("ble.duplicates");        // Address seen since the last filter reset
+static MetricCounter filterResets("ble.filter_resets");
 
 class AdvertisedDeviceCallbacks : public NimBLEAdvertisedDeviceCallbacks {
     void onResult(NimBLEAdvertisedDevice* advertisedDevice) {
-        NimBLEAddress addr = advertisedDevice->getAddress();
-        std::string addrStr = addr.toString();
-        uint8_t mac[6];
-        sscanf(addrStr.c_str(), "%02x:%02x:%02x:%02x:%02x:%02x",
-               &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]);
+        uint32_t start = halCycles();
+        bleDetector.setHostTask();
         
-        int rssi = advertisedDevice->getRSSI();
-        std::string name = "";
-        if (advertisedDevice->haveName()) {
-            name = advertisedDevice->getName();
+        // NimBLE keeps the address little-endian; flip to display order
+        NimBLEAddress address = advertisedDevice->getAddress();
+        const uint8_t* native = address.getNative();
+        uint8_t mac[6];
+        for (int i = 0; i < 6; i++) {
+            mac[i] = native[5 - i];
         }
+        int8_t rssi = advertisedDevice->getRSSI();
         
-        // Check for Raven first (highest priority)
-        if (RavenDetector::checkServiceUUID(advertisedDevice)) {
-            RavenDetector::outputDetectionJSON(advertisedDevice, addrStr.c_str(), name.c_str(), rssi);
-            
-            HardwareConfig& hw = settingsManager.getHardware();
-            
-            // Record in database
-            double lat = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.latitude() : 0.0;
-            double lon = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.longitude() : 0.0;
-            bool isKnown = false;
-            
-            if (hw.enable_sd_card) {
-                isKnown = dataManager.recordDetection(addrStr.c_str(), "Raven", rssi, lat, lon);
-            }
-            
-            if (!detectionState.triggered) {
-                if (isKnown) {
-                    if (hw.enable_leds) LED.knownDeviceAlert();
-                    if (hw.enable_buzzer) buzzer.knownDeviceBeep();
-                } else {
-                    if (hw.enable_buzzer || hw.enable_leds) buzzer.detectionAlert();
-                }
-            }
-            detectionState.recordDetection(false);
-            return;
-        }
+        // Advertisement and scan response data, parsed in place
+        const uint8_t* payload = advertisedDevice->getPayload();
+        size_t payloadLen = advertisedDevice->getPayloadLength();
         
-        // Check MAC prefix
-        if (BLEDetector::checkMacPrefix(mac)) {
-            outputBLEDetectionJSON(addrStr.c_str(), name.c_str(), rssi, "mac_prefix");
-            
-            HardwareConfig& hw = settingsManager.getHardware();
-            
-            // Record in database
-            double lat = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.latitude() : 0.0;
-            double lon = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.longitude() : 0.0;
-            bool isKnown = false;
-            
-            if (hw.enable_sd_card) {
-                isKnown = dataManager.recordDetection(addrStr.c_str(), "BLE", rssi, lat, lon);
-            }
-            
-            if (!detectionState.triggered) {
-                if (isKnown) {
-                    if (hw.enable_leds) LED.knownDeviceAlert();
-                    if (hw.enable_buzzer) buzzer.knownDeviceBeep();
-                } else {
-                    if (hw.enable_buzzer || hw.enable_leds) buzzer.detectionAlert();
-                }
-            }
-            detectionState.recordDetection(false);
-            return;
-        }
+        packetCapture.captureBle(mac, address.getType() != BLE_ADDR_PUBLIC,
+                                 advertisedDevice->getAdvType(), payload, payloadLen, rssi);
         
-        // Check device name
-        if (!name.empty() && BLEDetector::checkDeviceNamePattern(name.c_str())) {
-            outputBLEDetectionJSON(addrStr.c_str(), name.c_str(), rssi, "device_name");
-            
-            HardwareConfig& hw = settingsManager.getHardware();
-            
-            // Record in database
-            double lat = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.latitude() : 0.0;
-            double lon = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.longitude() : 0.0;
-            bool isKnown = false;
-            
-            if (hw.enable_sd_card) {
-                isKnown = dataManager.recordDetection(addrStr.c_str(), "BLE", rssi, lat, lon);
-            }
-            
-            if (!detectionState.triggered) {
-                if (isKnown) {
-                    if (hw.enable_leds) LED.knownDeviceAlert();
-                    if (hw.enable_buzzer) buzzer.knownDeviceBeep();
-                } else {
-                    if (hw.enable_buzzer || hw.enable_leds) buzzer.detectionAlert();
-                }
-            }
-            detectionState.recordDetection(false);
-            return;
-        }
+        BleAdvert advert;
+        parseBleAdvert(mac, rssi, payload, payloadLen, millis(), &advert);
+        
+        uint32_t pipelineStart = halCycles();
+        detectionPipeline.processBle(advert);
+        uint32_t end = halCycles();
+        
+        pipelineLatency.record(end - pipelineStart);
+        callbackLatency.record(end - start);
+        bleDetector.recordAdvert(advert.mac);
     }
 };
 
@@ -115,79 +52,57 @@ void BLEDetector::begin() {
     printf("Initializing BLE scanner...\n");
     NimBLEDevice::init("");
     pBLEScan = NimBLEDevice::getScan();
-    pBLEScan->setAdvertisedDeviceCallbacks(new AdvertisedDeviceCallbacks());
+    
+    // Controller drops repeat adverts until the filter is reset; results are
+    // handled in the callback and never stored
+    uint16_t filterReset = settingsManager.getSettings().scan.ble_filter_reset;
+    pBLEScan->setAdvertisedDeviceCallbacks(new AdvertisedDeviceCallbacks(), false);
+    pBLEScan->setDuplicateFilter(filterReset > 0);
+    pBLEScan->setMaxResults(0);
     pBLEScan->setActiveScan(true);
     // Optimized scan parameters for faster detection
     pBLEScan->setInterval(50);  // Faster interval (50ms)
     pBLEScan->setWindow(49);    // Maximize window time
-    printf("BLE scanner initialized (optimized timing)\n");
-}
-
-void BLEDetector::update() {
-    if (millis() - lastBleScan >= BLE_SCAN_INTERVAL && !pBLEScan->isScanning()) {
-        printf("[BLE] scan...\n");
-        pBLEScan->start(BLE_SCAN_DURATION, false);
-        lastBleScan = millis();
-    }
     
-    if (pBLEScan->isScanning() == false && millis() - lastBleScan > BLE_SCAN_DURATION * 1000) {
-        pBLEScan->clearResults();
-    }
+    startScan();
+    printf("BLE scanner initialized (continuous, duplicate filter reset %u ms)\n", (unsigned)filterReset);
 }
 
-bool BLEDetector::checkMacPrefix(const uint8_t* mac) {
-    char mac_str[9];
-    snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x", mac[0], mac[1], mac[2]);
+void BLEDetector::startScan() {
+    // Duration 0 = scan until stopped
+    pBLEScan->start(0, nullptr, false);
+    lastFilterReset = millis();
     
-    for (int i = 0; i < sizeof(mac_prefixes)/sizeof(mac_prefixes[0]); i++) {
-        if (strncasecmp(mac_str, mac_prefixes[i], 8) == 0) {
-            return true;
-        }
-    }
-    return false;
+    // Duplicate tracking restarts with the controller's filter
+    memset(recentAdverts, 0, sizeof(recentAdverts));
 }
 
-bool BLEDetector::checkDeviceNamePattern(const char* name) {
-    if (!name) return false;
+void BLEDetector::update() {
+    uint16_t filterReset = settingsManager.getSettings().scan.ble_filter_reset;
     
-    for (int i = 0; i < sizeof(device_name_patterns)/sizeof(device_name_patterns[0]); i++) {
-        if (strcasestr(name, device_name_patterns[i])) {
-            return true;
-        }
+    if (!pBLEScan->isScanning()) {
+        // Stopped by the stack (e.g. controller error) - resume
+        startScan();
+    } else if (filterReset > 0 && millis() - lastFilterReset >= filterReset) {
+        // Restarting the scan clears the controller's duplicate filter so
+        // devices still in range are reported again
+        pBLEScan->stop();
+        startScan();
+        filterResets.add();
     }
-    return false;
 }
 
-void outputBLEDetectionJSON(const char* mac, const char* name, int rssi, const char* detectionMethod) {
-    DynamicJsonDocument doc(2048);
-    
-    doc["timestamp"] = millis();
-    doc["detection_time"] = String(millis() / 1000.0, 3) + "s";
-    doc["protocol"] = "bluetooth_le";
-    doc["detection_method"] = detectionMethod;
-    doc["alert_level"] = "HIGH";
-    doc["device_category"] = "FLOCK_SAFETY";
-    doc["mac_address"] = mac;
-    doc["rssi"] = rssi;
+void BLEDetector::recordAdvert(const uint8_t* mac) {
+    adverts.add();
     
-    if (name && strlen(name) > 0) {
-        doc["device_name"] = name;
-    }
-    
-    if (gpsManager.isValid()) {
-        doc["gps_latitude"] = gpsManager.latitude();
-        doc["gps_longitude"] = gpsManager.longitude();
-        doc["gps_altitude"] = gpsManager.altitude();
-        doc["gps_satellites"] = gpsManager.satellites();
+    // Small direct-mapped set of addresses seen since the last filter reset
+    uint32_t key = ((uint32_t)mac[2] << 24 | (uint32_t)mac[3] << 16 | (uint32_t)mac[4] << 8 | mac[5]) ^
+                   ((uint32_t)mac[0] << 8 | mac[1]);
+    if (key == 0) key = 1;
+    uint32_t slot = (key * 2654435761u) >> 26;  // 64 slots
+    if (recentAdverts[slot] == key) {
+        duplicates.add();
     } else {
-        doc["gps_status"] = gpsManager.getStatus().c_str();
+        recentAdverts[slot] = key;
     }
-    
-    serializeJson(doc, Serial);
-    Serial.println();
-    
-    sdLogger.logDetection("ble", detectionMethod, mac, rssi, nullptr, name,
-                         gpsManager.isValid(), gpsManager.latitude(), gpsManager.longitude());
-    
-    LED.flash(LEDController::COLOR_PURPLE, 1, 200);
 }
@@ -7,19 +7,28 @@
 #include <NimBLEAdvertisedDevice.h>
 #include "config/pins.h"
 #include "config/patterns.h"
+#include "hal/hal.h"
 
 class BLEDetector {
 public:
     void begin();
-    void update();
+    void update();  // Keeps the continuous scan running and resets the duplicate filter
     
-    // Detection helpers
-    static bool checkMacPrefix(const uint8_t* mac);
-    static bool checkDeviceNamePattern(const char* name);
+    // Scan statistics for the stats report: ble.adverts/duplicates/filter_resets
+    // (callback runs in the NimBLE host task)
+    void recordAdvert(const uint8_t* mac);
+    
+    // NimBLE host task, noted from the first callback for stack reporting
+    void setHostTask() { if (!hostTask) hostTask = xTaskGetCurrentTaskHandle(); }
+    TaskHandle_t getHostTask() { return hostTask; }
 
 private:
     NimBLEScan* pBLEScan = nullptr;
-    unsigned long lastBleScan = 0;
+    TaskHandle_t hostTask = nullptr;
+    unsigned long lastFilterReset = 0;
+    uint32_t recentAdverts[64] = {0};   // Addresses seen since the last filter reset
+    
+    void startScan();
 };
 
 extern BLEDetector bleDetector;
@@ -0,0 +1,147 @@
+#include "channel_scheduler.h"
+#include <math.h>
+
+void ChannelScheduler::begin(const ChannelSchedulerConfig& config, uint32_t now) {
+    cfg = config;
+    if (cfg.channels < 1) cfg.channels = 1;
+    if (cfg.channels > CHANNEL_SCHEDULER_MAX_CHANNELS) cfg.channels = CHANNEL_SCHEDULER_MAX_CHANNELS;
+    if (cfg.min_dwell < 1) cfg.min_dwell = 1;
+    if (cfg.max_dwell < cfg.min_dwell) cfg.max_dwell = cfg.min_dwell;
+
+    for (int i = 0; i < CHANNEL_SCHEDULER_MAX_CHANNELS; i++) {
+        frameRate[i] = 0;
+        matchScore[i] = 0;
+        lastVisit[i] = now;
+    }
+    lockChannel = 0;
+    lockEnd = now;
+    lastDecay = now;
+
+    nextRoundRobin = (cfg.channels > 1) ? 2 : 1;
+    visit(1, cfg.base_dwell, now);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void ChannelScheduler::decayMatches(uint32_t now) {
+    uint32_t elapsed = now - lastDecay;
+    if (elapsed == 0 || cfg.match_half_life == 0) return;
+
+    float factor = powf(0.5f, (float)elapsed / cfg.match_half_life);
+    for (int i = 0; i < cfg.channels; i++) {
+        matchScore[i] *= factor;
+    }
+    lastDecay = now;
+}
+
+float ChannelScheduler::getWeight(uint8_t channel) const {
+    if (channel < 1 || channel > cfg.channels) return 0;
+
+    float meanRate = 0;
+    for (int i = 0; i < cfg.channels; i++) {
+        meanRate += frameRate[i];
+    }
+    meanRate /= cfg.channels;
+
+    int i = channel - 1;
+    return 1.0f + cfg.frame_weight * frameRate[i] / (meanRate + 1.0f) +
+           cfg.match_weight * matchScore[i];
+}
+
+float ChannelScheduler::getFrameRate(uint8_t channel) const {
+    return (channel >= 1 && channel <= cfg.channels) ? frameRate[channel - 1] : 0;
+}
+
+float ChannelScheduler::getMatchScore(uint8_t channel) const {
+    return (channel >= 1 && channel <= cfg.channels) ? matchScore[channel - 1] : 0;
+}
+
+uint16_t ChannelScheduler::dwellFor(uint8_t channel) const {
+    // Share of one round-robin cycle proportional to weight; with equal
+    // weights every channel gets base_dwell
+    float total = 0;
+    for (uint8_t ch = 1; ch <= cfg.channels; ch++) {
+        total += getWeight(ch);
+    }
+    float dwell = (float)cfg.base_dwell * cfg.channels * getWeight(channel) / total;
+
+    if (dwell < cfg.min_dwell) return cfg.min_dwell;
+    if (dwell > cfg.max_dwell) return cfg.max_dwell;
+    return (uint16_t)dwell;
+}
+
+// ============================================================================
+// SCHEDULING
+// ============================================================================
+
+void ChannelScheduler::recordMatch(uint8_t channel, uint32_t now) {
+    if (channel < 1 || channel > cfg.channels) return;
+
+    decayMatches(now);
+    matchScore[channel - 1] += 1.0f;
+    lockChannel = channel;
+    lockEnd = now + cfg.lock_time;
+
+    // Hold the current dwell, but never past max_dwell so overdue channels
+    // are still checked
+    if (channel == currentChannel) {
+        uint32_t limit = dwellStart + cfg.max_dwell;
+        uint32_t wanted = ((int32_t)(lockEnd - limit) > 0) ? limit : lockEnd;
+        if ((int32_t)(wanted - dwellEnd) > 0) dwellEnd = wanted;
+    }
+}
+
+ChannelHop ChannelScheduler::visit(uint8_t channel, uint16_t dwellMs, uint32_t now) {
+    currentChannel = channel;
+    dwellStart = now;
+    dwellEnd = now + dwellMs;
+
+    ChannelHop hop = {channel, dwellMs, false, false};
+    return hop;
+}
+
+ChannelHop ChannelScheduler::next(uint32_t frames, uint32_t now) {
+    // Fold the dwell that just ended into the channel's frame rate
+    int cur = currentChannel - 1;
+    uint32_t elapsed = now - dwellStart;
+    if (elapsed > 0) {
+        float observed = frames * 1000.0f / elapsed;
+        frameRate[cur] += cfg.frame_alpha * (observed - frameRate[cur]);
+    }
+    lastVisit[cur] = now;
+    decayMatches(now);
+
+    // 1. Minimum visit rate: the most overdue channel goes first
+    uint8_t overdue = 0;
+    uint32_t longest = 0;
+    for (uint8_t ch = 1; ch <= cfg.channels; ch++) {
+        uint32_t away = now - lastVisit[ch - 1];
+        if (away >= cfg.max_revisit && away > longest) {
+            overdue = ch;
+            longest = away;
+        }
+    }
+    if (overdue) {
+        ChannelHop hop = visit(overdue, cfg.min_dwell, now);
+        hop.overdue = true;
+        return hop;
+    }
+
+    // 2. Recent match: stay on its channel until the lock runs out
+    if (lockChannel && (int32_t)(lockEnd - now) > 0) {
+        uint32_t remaining = lockEnd - now;
+        uint16_t dwell = remaining < cfg.min_dwell ? cfg.min_dwell :
+                         remaining > cfg.max_dwell ? cfg.max_dwell : (uint16_t)remaining;
+        ChannelHop hop = visit(lockChannel, dwell, now);
+        hop.locked = true;
+        return hop;
+    }
+    lockChannel = 0;
+
+    // 3. Round-robin with weighted dwell
+    uint8_t channel = nextRoundRobin;
+    nextRoundRobin = (channel % cfg.channels) + 1;
+    return visit(channel, dwellFor(channel), now);
+}
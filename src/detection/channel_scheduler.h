@@ -0,0 +1,87 @@
+#ifndef CHANNEL_SCHEDULER_H
+#define CHANNEL_SCHEDULER_H
+
+#include <stdint.h>
+
+// ============================================================================
+// CHANNEL SCHEDULER
+// ============================================================================
+//
+// Decides which WiFi channel to listen on next and for how long. Channels are
+// visited round-robin, but each dwell is scaled by the channel's weight:
+//
+//   weight = 1 + frame_weight * frame_rate / mean_frame_rate
+//              + match_weight * decayed_matches
+//
+// so busy channels and channels that recently produced detections get more
+// listening time. Dwell is clamped to [min_dwell, max_dwell], which bounds a
+// full cycle and guarantees every channel is visited at least once per
+// `max_revisit` ms. A match locks the scheduler onto that channel for
+// `lock_time` ms (unless another channel is overdue).
+//
+// Deterministic: time is passed in and nothing touches the radio, so recorded
+// channel traces can be replayed through it on a host.
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define CHANNEL_SCHEDULER_MAX_CHANNELS 14
+
+struct ChannelSchedulerConfig {
+    uint8_t channels = 13;            // Channels 1..channels
+    uint16_t base_dwell = 200;        // Dwell when all channels weigh the same (ms)
+    uint16_t min_dwell = 80;          // ms
+    uint16_t max_dwell = 800;         // ms
+    uint16_t lock_time = 1500;        // Stay on a channel after a match (ms)
+    uint32_t max_revisit = 6000;      // Longest any channel may go unvisited (ms)
+    uint32_t match_half_life = 60000; // Match score decay (ms)
+    float frame_weight = 0.5f;
+    float match_weight = 4.0f;
+    float frame_alpha = 0.25f;        // EWMA factor for per-channel frame rate
+};
+
+// Decision returned for the next dwell
+struct ChannelHop {
+    uint8_t channel;
+    uint16_t dwellMs;
+    bool locked;     // Held on a channel after a match
+    bool overdue;    // Forced visit to satisfy max_revisit
+};
+
+class ChannelScheduler {
+public:
+    void begin(const ChannelSchedulerConfig& config, uint32_t now);
+
+    // A detection was made on `channel` (may be a past channel - frames are
+    // processed asynchronously). A match on the current channel extends the
+    // current dwell, up to max_dwell.
+    void recordMatch(uint8_t channel, uint32_t now);
+
+    // True once the current dwell has ended
+    bool due(uint32_t now) const { return (int32_t)(now - dwellEnd) >= 0; }
+
+    // End the current dwell, which saw `frames` frames, and pick the next one
+    ChannelHop next(uint32_t frames, uint32_t now);
+
+    uint8_t current() const { return currentChannel; }
+    float getWeight(uint8_t channel) const;
+    float getFrameRate(uint8_t channel) const;
+    float getMatchScore(uint8_t channel) const;
+
+private:
+    ChannelSchedulerConfig cfg;
+    float frameRate[CHANNEL_SCHEDULER_MAX_CHANNELS] = {0};     // Frames/s while listening
+    float matchScore[CHANNEL_SCHEDULER_MAX_CHANNELS] = {0};    // Decayed match count
+    uint32_t lastVisit[CHANNEL_SCHEDULER_MAX_CHANNELS] = {0};
+    uint8_t currentChannel = 1;
+    uint8_t nextRoundRobin = 2;
+    uint32_t dwellStart = 0;
+    uint32_t dwellEnd = 0;
+    uint32_t lastDecay = 0;
+    uint8_t lockChannel = 0;        // 0 = no lock
+    uint32_t lockEnd = 0;
+
+    void decayMatches(uint32_t now);
+    uint16_t dwellFor(uint8_t channel) const;
+    ChannelHop visit(uint8_t channel, uint16_t dwellMs, uint32_t now);
+};
+
+#endif // CHANNEL_SCHEDULER_H
@@ -0,0 +1,106 @@
+#include "detection_cache.h"
+
+uint64_t DetectionCache::makeKey(const uint8_t* mac, const char* method) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        key = (key << 8) | mac[i];
+    }
+
+    // 16-bit FNV-1a fold of the method name
+    uint32_t h = 2166136261u;
+    for (const char* p = method; p && *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    h = (h >> 16) ^ (h & 0xFFFF);
+    if (h == 0) h = 1;  // Keep key non-zero (0 marks an empty slot)
+
+    return (key << 16) | h;
+}
+
+uint32_t DetectionCache::slotFor(uint64_t key) {
+    // Full fmix64: the low bits must depend on every MAC byte (devices from
+    // one vendor differ only in the last ones)
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (uint32_t)key & (DETECTION_CACHE_SLOTS - 1);
+}
+
+void DetectionCache::openWindow(Entry& e, uint64_t key, int8_t rssi, uint32_t now) {
+    e.key = key;
+    e.windowStart = now;
+    e.lastSeen = now;
+    e.sightings = 1;
+    e.rssiMin = rssi;
+    e.rssiMax = rssi;
+    e.rssiLast = rssi;
+}
+
+bool DetectionCache::shouldEmit(const uint8_t* mac, const char* method, int8_t rssi,
+                                uint32_t now, uint32_t cooldown,
+                                DetectionSummary* summaryOut, bool* hasSummary) {
+    if (hasSummary) *hasSummary = false;
+    if (cooldown == 0) {
+        emitted++;
+        return true;
+    }
+
+    uint64_t key = makeKey(mac, method);
+    uint32_t home = slotFor(key);
+
+    Entry* reuse = nullptr;     // First empty or expired slot in the probe run
+    Entry* oldest = nullptr;
+
+    for (uint32_t p = 0; p < DETECTION_CACHE_PROBES; p++) {
+        Entry& e = entries[(home + p) & (DETECTION_CACHE_SLOTS - 1)];
+
+        if (e.key == key) {
+            if (now - e.windowStart < cooldown) {
+                // Inside the window - fold in and suppress
+                if (e.sightings < 0xFFFF) e.sightings++;
+                if (rssi < e.rssiMin) e.rssiMin = rssi;
+                if (rssi > e.rssiMax) e.rssiMax = rssi;
+                e.rssiLast = rssi;
+                e.lastSeen = now;
+                suppressed++;
+                return false;
+            }
+
+            // Window closed - report it and open a new one
+            if (e.sightings > 1 && summaryOut) {
+                summaryOut->sightings = e.sightings;
+                summaryOut->rssiMin = e.rssiMin;
+                summaryOut->rssiMax = e.rssiMax;
+                summaryOut->rssiLast = e.rssiLast;
+                summaryOut->windowMs = e.lastSeen - e.windowStart;
+                if (hasSummary) *hasSummary = true;
+            }
+            openWindow(e, key, rssi, now);
+            emitted++;
+            return true;
+        }
+
+        if (!reuse && (e.key == 0 || now - e.windowStart >= cooldown)) {
+            reuse = &e;
+        }
+        if (!oldest || e.lastSeen - oldest->lastSeen > 0x80000000u) {
+            oldest = &e;
+        }
+    }
+
+    if (!reuse) {
+        reuse = oldest;
+        replaced++;
+    }
+    openWindow(*reuse, key, rssi, now);
+    emitted++;
+    return true;
+}
+
+void DetectionCache::clear() {
+    for (uint32_t i = 0; i < DETECTION_CACHE_SLOTS; i++) {
+        entries[i].key = 0;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef DETECTION_CACHE_H
+#define DETECTION_CACHE_H
+
+#include <stdint.h>
+
+// ============================================================================
+// DETECTION CACHE
+// ============================================================================
+//
+// Per-(MAC, detection method) cooldown. The first sighting of a device opens
+// a window of `cooldown` ms and is emitted; later sightings inside the window
+// are suppressed but folded into the window's statistics (count, RSSI
+// min/max/last). The next sighting after the window closes is emitted again
+// together with a summary of what was suppressed.
+//
+// Fixed table of DETECTION_CACHE_SLOTS entries with a short probe sequence.
+// Entries whose window has closed are reused first; if every probed entry is
+// live the oldest is replaced (that device just gets emitted early).
+//
+// Not thread-safe - each detector task owns its own cache.
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define DETECTION_CACHE_SLOTS 128
+#define DETECTION_CACHE_PROBES 8
+
+// Sightings folded into the window that just closed
+struct DetectionSummary {
+    uint16_t sightings;    // Total sightings in the window, including the emitted one
+    int8_t rssiMin;
+    int8_t rssiMax;
+    int8_t rssiLast;
+    uint32_t windowMs;     // Time from the emitted sighting to the last one
+};
+
+class DetectionCache {
+public:
+    // Returns true if this sighting should be emitted. When it is emitted and
+    // the previous window folded in more than one sighting, *summaryOut gets
+    // that window's statistics and *hasSummary is set.
+    bool shouldEmit(const uint8_t* mac, const char* method, int8_t rssi,
+                    uint32_t now, uint32_t cooldown,
+                    DetectionSummary* summaryOut = nullptr, bool* hasSummary = nullptr);
+
+    void clear();
+
+    // Stats
+    uint32_t getEmitted() const { return emitted; }
+    uint32_t getSuppressed() const { return suppressed; }
+    uint32_t getReplaced() const { return replaced; }
+
+    static uint64_t makeKey(const uint8_t* mac, const char* method);
+
+private:
+    struct Entry {
+        uint64_t key;          // MAC << 16 | method hash, 0 = empty
+        uint32_t windowStart;  // millis() of the emitted sighting
+        uint32_t lastSeen;
+        uint16_t sightings;
+        int8_t rssiMin;
+        int8_t rssiMax;
+        int8_t rssiLast;
+    };
+
+    Entry entries[DETECTION_CACHE_SLOTS] = {};
+
+    uint32_t emitted = 0;
+    uint32_t suppressed = 0;
+    uint32_t replaced = 0;
+
+    static uint32_t slotFor(uint64_t key);
+    static void openWindow(Entry& e, uint64_t key, int8_t rssi, uint32_t now);
+};
+
+#endif // DETECTION_CACHE_H
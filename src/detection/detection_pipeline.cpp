@@ -0,0 +1,286 @@
+#include "detection_pipeline.h"
+#include "detection_state.h"
+#include "raven_detector.h"
+#include "oui_matcher.h"
+#include "pattern_matcher.h"
+#include "config/patterns.h"
+#include "system/metrics.h"
+#include <stdio.h>
+#include <string.h>
+
+DetectionPipeline detectionPipeline;
+
+static MetricHistogram emitLatency("event.emit");          // Serialize + write to the sink
+static MetricHistogram storeLatency("pipeline.store");     // CSV log + database
+static MetricHistogram alertLatency("pipeline.alerts");    // LEDs + buzzer
+static MetricCounter deferred("pipeline.deferred");        // Stored once the next fix arrived
+
+static void formatMacString(const uint8_t* mac, char* out) {
+    snprintf(out, 18, "%02x:%02x:%02x:%02x:%02x:%02x",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+void DetectionPipeline::begin(const HalContext& context, const PipelineConfig& cfg) {
+    hal = context;
+    config = cfg;
+}
+
+// ============================================================================
+// SHARED STEPS
+// ============================================================================
+
+// Returns false if this sighting falls inside the device's cooldown window
+bool DetectionPipeline::passCooldown(DetectionCache& cache, PipelineStats& stats, const uint8_t* mac,
+                                     const char* method, int8_t rssi, uint32_t now,
+                                     DetectionSummary* summary, bool* hasSummary) {
+    stats.matches++;
+    if (cache.shouldEmit(mac, method, rssi, now, config.cooldown, summary, hasSummary)) {
+        stats.emitted++;
+        return true;
+    }
+    stats.suppressed++;
+    detectionState.touch();
+    return false;
+}
+
+// Position at the capture time; returns true when final
+bool DetectionPipeline::locate(uint32_t time, GpsFix* fix) {
+    if (!hal.location) return true;
+    return hal.location->getFixAt(time, fix);
+}
+
+bool DetectionPipeline::emitEvent(DetectionEvent& event, const GpsFix& fix) {
+    event.gpsValid = fix.valid;
+    if (fix.valid) {
+        event.latitude = fix.latitude;
+        event.longitude = fix.longitude;
+        event.altitude = fix.altitude;
+        event.satellites = fix.satellites;
+    } else {
+        event.gpsStatus = fix.status;
+    }
+
+    MetricTimer timer(emitLatency);
+    uint8_t buffer[EVENT_BUFFER_SIZE];
+    bool binary = config.binaryEvents;
+
+    size_t len = writeDetectionEvent(event, binary ? EVENT_ENCODING_BINARY : EVENT_ENCODING_JSON,
+                                     buffer, binary ? sizeof(buffer) : sizeof(buffer) - 2);
+    if (len == 0) {
+        eventOverflows++;
+        printf("[Event] Detection event too large (%u dropped)\n", (unsigned)eventOverflows);
+        return false;
+    }
+
+    if (!binary) {
+        // Line ending as written by Serial.println()
+        buffer[len++] = '\r';
+        buffer[len++] = '\n';
+    }
+    if (hal.events) hal.events->write(buffer, len);
+    return true;
+}
+
+// Queues the record for resolvePending(); false if the ring is full
+bool DetectionPipeline::defer(const DetectionRecord& rec, bool isWiFi) {
+    PendingDetection item;
+    item.time = rec.time;
+    memcpy(item.mac, rec.mac, sizeof(item.mac));
+    memcpy(item.macStr, rec.macStr, sizeof(item.macStr));
+    item.type = rec.type;
+    item.protocol = rec.protocol;
+    item.method = rec.method;
+    item.rssi = rec.rssi;
+    snprintf(item.ssid, sizeof(item.ssid), "%s", rec.ssid ? rec.ssid : "");
+    snprintf(item.name, sizeof(item.name), "%s", rec.name ? rec.name : "");
+    return isWiFi ? wifiPending.push(item) : blePending.push(item);
+}
+
+void DetectionPipeline::finish(const DetectionRecord& rec, bool isWiFi, bool final) {
+    bool isKnown = false;
+    if (hal.store) {
+        if (!final && defer(rec, isWiFi)) {
+            isKnown = hal.store->isKnown(rec.mac);
+        } else {
+            // Final, or no room to wait: store the provisional position
+            MetricTimer timer(storeLatency);
+            isKnown = hal.store->record(rec);
+        }
+    }
+
+    if (hal.alerts) {
+        MetricTimer timer(alertLatency);
+        hal.alerts->detected(rec.type);
+        if (!detectionState.triggered) {
+            // Known device - less urgent alert; new device - full alert
+            hal.alerts->firstDetection(isKnown);
+        }
+    }
+    detectionState.recordDetection(isWiFi);
+}
+
+void DetectionPipeline::resolvePending() {
+    PendingDetection item;
+    while (waitingCount < PIPELINE_WAITING_SIZE && (wifiPending.pop(item) || blePending.pop(item))) {
+        waiting[waitingCount++] = item;
+    }
+
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < waitingCount; i++) {
+        const PendingDetection& p = waiting[i];
+        GpsFix fix;
+        if (!locate(p.time, &fix)) {
+            waiting[kept++] = p;        // Next fix still due
+            continue;
+        }
+
+        DetectionRecord rec = {p.mac, p.macStr, p.type, p.protocol, p.method, p.rssi,
+                               p.ssid[0] ? p.ssid : nullptr, p.name[0] ? p.name : nullptr,
+                               &fix, p.time};
+        if (hal.store) {
+            MetricTimer timer(storeLatency);
+            hal.store->record(rec);
+        }
+        deferred.add();
+    }
+    waitingCount = kept;
+}
+
+// ============================================================================
+// WIFI
+// ============================================================================
+
+bool DetectionPipeline::processWiFi(const WiFiFrame& frame) {
+    wifiStats.packets++;
+
+    // SSID match first, then MAC prefix
+    const char* method;
+    const char* pattern = nullptr;
+    int idx = (frame.ssid_len > 0) ? ssidMatcher.match(frame.ssid) : -1;
+    if (idx >= 0) {
+        method = (frame.frame_type == 0x20) ? "probe_request" : "beacon";
+        pattern = ssidMatcher.getPattern(idx);
+    } else if (ouiMatcher.contains(frame.mac)) {
+        method = (frame.frame_type == 0x20) ? "probe_request_mac" : "beacon_mac";
+    } else {
+        return false;
+    }
+
+    // Repeat sightings inside the cooldown only update the cache
+    DetectionSummary summary;
+    bool hasSummary = false;
+    if (!passCooldown(wifiDedup, wifiStats, frame.mac, method, frame.rssi, frame.timestamp,
+                      &summary, &hasSummary)) {
+        return false;
+    }
+
+    char mac_str[18];
+    formatMacString(frame.mac, mac_str);
+    const char* ssid = frame.ssid[0] ? frame.ssid : "hidden";
+
+    GpsFix fix;
+    bool final = locate(frame.timestamp, &fix);
+
+    DetectionEvent event;
+    event.kind = EVENT_WIFI;
+    event.timestamp = frame.timestamp;
+    event.method = method;
+    event.mac = mac_str;
+    event.rssi = frame.rssi;
+    event.ssid = ssid;
+    event.channel = frame.channel;
+    event.matchedPattern = pattern;
+    event.summary = hasSummary ? &summary : nullptr;
+    emitEvent(event, fix);
+
+    DetectionRecord rec = {frame.mac, mac_str, DEVICE_WIFI, "wifi", method, frame.rssi,
+                           ssid, nullptr, &fix, frame.timestamp};
+    finish(rec, true, final);
+    return true;
+}
+
+// ============================================================================
+// BLE
+// ============================================================================
+
+bool DetectionPipeline::processBle(const BleAdvert& advert) {
+    bleStats.packets++;
+
+    DetectionSummary summary;
+    bool hasSummary = false;
+    char mac_str[18];
+    GpsFix fix;
+
+    // Check for Raven first (highest priority)
+    RavenFingerprint raven;
+    if (RavenDetector::fingerprint(advert, &raven)) {
+        if (!passCooldown(bleDedup, bleStats, advert.mac, "raven_service_uuid", advert.rssi,
+                          advert.timestamp, &summary, &hasSummary)) {
+            return false;
+        }
+        formatMacString(advert.mac, mac_str);
+        bool final = locate(advert.timestamp, &fix);
+
+        DetectionEvent event;
+        event.kind = EVENT_RAVEN;
+        event.timestamp = advert.timestamp;
+        event.method = "raven_service_uuid";
+        event.mac = mac_str;
+        event.rssi = advert.rssi;
+        event.name = advert.name;
+        event.summary = hasSummary ? &summary : nullptr;
+
+        event.ravenServiceUuid = raven.primary >= 0 ? raven_service_uuids[raven.primary] : "";
+        event.ravenServiceDescription = RavenDetector::getServiceDescription(raven.primary);
+        event.ravenFirmwareVersion = RavenDetector::estimateFirmwareVersion(raven.services);
+
+        // Matched Raven services, in table order
+        event.hasServiceUuids = true;
+        for (int i = 0; i < RAVEN_SVC_COUNT && event.serviceUuidCount < EVENT_MAX_SERVICE_UUIDS; i++) {
+            if (raven.services & (1u << i)) {
+                event.serviceUuids[event.serviceUuidCount++] = raven_service_uuids[i];
+            }
+        }
+        emitEvent(event, fix);
+
+        DetectionRecord rec = {advert.mac, mac_str, DEVICE_RAVEN, "ble", "raven_service_uuid",
+                               advert.rssi, nullptr, advert.name, &fix, advert.timestamp};
+        finish(rec, false, final);
+        return true;
+    }
+
+    // MAC prefix, then device name
+    const char* method;
+    const char* pattern = nullptr;
+    if (ouiMatcher.contains(advert.mac)) {
+        method = "mac_prefix";
+    } else {
+        int idx = advert.name[0] ? nameMatcher.match(advert.name) : -1;
+        if (idx < 0) return false;
+        method = "device_name";
+        pattern = nameMatcher.getPattern(idx);
+    }
+
+    if (!passCooldown(bleDedup, bleStats, advert.mac, method, advert.rssi, advert.timestamp,
+                      &summary, &hasSummary)) {
+        return false;
+    }
+    formatMacString(advert.mac, mac_str);
+    bool final = locate(advert.timestamp, &fix);
+
+    DetectionEvent event;
+    event.kind = EVENT_BLE;
+    event.timestamp = advert.timestamp;
+    event.method = method;
+    event.mac = mac_str;
+    event.rssi = advert.rssi;
+    event.name = advert.name;
+    event.matchedPattern = pattern;
+    event.summary = hasSummary ? &summary : nullptr;
+    emitEvent(event, fix);
+
+    DetectionRecord rec = {advert.mac, mac_str, DEVICE_BLE, "ble", method, advert.rssi,
+                           nullptr, advert.name, &fix, advert.timestamp};
+    finish(rec, false, final);
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef DETECTION_PIPELINE_H
+#define DETECTION_PIPELINE_H
+
+#include "hal/hal.h"
+#include "detection_cache.h"
+#include "event_writer.h"
+#include "frame_ring.h"
+
+// ============================================================================
+// DETECTION PIPELINE
+// ============================================================================
+//
+// Everything that happens to a sniffed WiFi frame or BLE advertisement after
+// the radio hands it over: pattern matching, the per-device cooldown, event
+// serialization, persistence and alerts. Board access goes through the
+// HalContext given to begin(), so the same code runs on the ESP32 and on a
+// host.
+//
+// processWiFi() and processBle() may run on different tasks; each side has
+// its own cooldown cache and counters.
+//
+// Positions are taken at the packet's capture time. The event goes out at
+// once; if its position is still extrapolated (the next GPS fix has not
+// arrived), the CSV row and database update wait in a per-side ring until
+// resolvePending() finds the interpolated position final.
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+struct PipelineConfig {
+    uint16_t cooldown = 2000;      // scan.detection_cooldown (ms)
+    bool binaryEvents = false;     // log.binary_events
+};
+
+#define PIPELINE_PENDING_SIZE 8        // Per side, waiting for the next fix
+#define PIPELINE_WAITING_SIZE 16
+
+// A deferred DetectionRecord; owns its strings
+struct PendingDetection {
+    uint32_t time;
+    uint8_t mac[6];
+    char macStr[18];
+    DeviceType type;
+    const char* protocol;          // String literals
+    const char* method;
+    int8_t rssi;
+    char ssid[33];                 // Empty if none
+    char name[32];
+};
+
+struct PipelineStats {
+    uint32_t packets = 0;          // Frames/adverts processed
+    uint32_t matches = 0;          // Matched a pattern
+    uint32_t emitted = 0;          // Passed the cooldown
+    uint32_t suppressed = 0;       // Folded into a cooldown window
+};
+
+class DetectionPipeline {
+public:
+    void begin(const HalContext& hal, const PipelineConfig& config);
+
+    // Returns true if the packet was emitted as a detection
+    bool processWiFi(const WiFiFrame& frame);
+    bool processBle(const BleAdvert& advert);
+
+    // Stores deferred detections whose position is now final; call from the main loop
+    void resolvePending();
+    uint8_t getPendingCount() const { return waitingCount; }
+
+    const PipelineStats& getWiFiStats() const { return wifiStats; }
+    const PipelineStats& getBleStats() const { return bleStats; }
+    uint32_t getEventOverflows() const { return eventOverflows; }
+    DetectionCache& getWiFiDedup() { return wifiDedup; }
+    DetectionCache& getBleDedup() { return bleDedup; }
+
+private:
+    HalContext hal = {};
+    PipelineConfig config;
+    DetectionCache wifiDedup;   // WiFi processing task only
+    DetectionCache bleDedup;    // NimBLE host task only
+    PipelineStats wifiStats;
+    PipelineStats bleStats;
+    volatile uint32_t eventOverflows = 0;
+    FrameRing<PendingDetection, PIPELINE_PENDING_SIZE> wifiPending;   // WiFi task -> loop
+    FrameRing<PendingDetection, PIPELINE_PENDING_SIZE> blePending;    // BLE task -> loop
+    PendingDetection waiting[PIPELINE_WAITING_SIZE];                  // Main loop only
+    uint8_t waitingCount = 0;
+
+    bool passCooldown(DetectionCache& cache, PipelineStats& stats, const uint8_t* mac,
+                      const char* method, int8_t rssi, uint32_t now,
+                      DetectionSummary* summary, bool* hasSummary);
+    bool locate(uint32_t time, GpsFix* fix);
+    bool emitEvent(DetectionEvent& event, const GpsFix& fix);
+    bool defer(const DetectionRecord& rec, bool isWiFi);
+    void finish(const DetectionRecord& rec, bool isWiFi, bool final);
+};
+
+extern DetectionPipeline detectionPipeline;
+
+#endif // DETECTION_PIPELINE_H
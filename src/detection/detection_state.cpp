@@ -1,4 +1,5 @@
 #include "detection_state.h"
+#include "hal/hal.h"
 
 DetectionState detectionState;
 
@@ -11,23 +12,30 @@ void DetectionState::recordDetection(bool isWiFi) {
     totalDetectionCount++;
     
     deviceInRange = true;
-    lastDetectionTime = millis();
+    lastDetectionTime = halMillis();
     if (!triggered) {
         triggered = true;
-        lastHeartbeat = millis();
+        lastHeartbeat = halMillis();
+    }
+}
+
+void DetectionState::touch() {
+    if (triggered) {
+        deviceInRange = true;
+        lastDetectionTime = halMillis();
     }
 }
 
 void DetectionState::updateHeartbeat() {
-    lastHeartbeat = millis();
+    lastHeartbeat = halMillis();
 }
 
 bool DetectionState::shouldHeartbeat() {
-    return deviceInRange && (millis() - lastHeartbeat >= 10000);
+    return deviceInRange && (halMillis() - lastHeartbeat >= 10000);
 }
 
 bool DetectionState::isDeviceOutOfRange() {
-    return deviceInRange && (millis() - lastDetectionTime >= 30000);
+    return deviceInRange && (halMillis() - lastDetectionTime >= 30000);
 }
 
 void DetectionState::resetOutOfRange() {
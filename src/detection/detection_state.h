@@ -1,7 +1,7 @@
 #ifndef DETECTION_STATE_H
 #define DETECTION_STATE_H
 
-#include <Arduino.h>
+#include <stdint.h>
 
 class DetectionState {
 public:
@@ -17,6 +17,7 @@ public:
     int totalDetectionCount = 0;
     
     void recordDetection(bool isWiFi);
+    void touch();  // Sighting suppressed by the cooldown - device still in range
     void updateHeartbeat();
     bool shouldHeartbeat();
     bool isDeviceOutOfRange();
@@ -0,0 +1,375 @@
+#include "event_writer.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// SCHEMA
+// ============================================================================
+
+enum EventField : uint8_t {
+    F_END = 0,
+    F_TIMESTAMP,
+    F_DETECTION_TIME,
+    F_PROTOCOL,
+    F_METHOD,
+    F_ALERT_LEVEL,
+    F_DEVICE_CATEGORY,
+    F_DEVICE_TYPE,
+    F_MANUFACTURER,
+    F_SSID,
+    F_MAC,
+    F_RSSI,
+    F_CHANNEL,
+    F_DEVICE_NAME,
+    F_MATCHED_PATTERN,
+    F_COOLDOWN,          // Object
+    F_GPS,               // Location fields or gps_status (flattened)
+    F_RAVEN_UUID,
+    F_RAVEN_DESCRIPTION,
+    F_RAVEN_FIRMWARE,
+    F_THREAT_LEVEL,
+    F_THREAT_SCORE,
+    F_SERVICE_UUIDS,     // Array
+    // Members of the groups above (binary ids only)
+    F_GPS_LATITUDE,
+    F_GPS_LONGITUDE,
+    F_GPS_ALTITUDE,
+    F_GPS_SATELLITES,
+    F_GPS_STATUS,
+    F_COOLDOWN_SIGHTINGS,
+    F_COOLDOWN_RSSI_MIN,
+    F_COOLDOWN_RSSI_MAX,
+    F_COOLDOWN_RSSI_LAST,
+    F_COOLDOWN_DURATION
+};
+
+static const uint8_t WIFI_SCHEMA[] = {
+    F_TIMESTAMP, F_DETECTION_TIME, F_PROTOCOL, F_METHOD, F_ALERT_LEVEL, F_DEVICE_CATEGORY,
+    F_SSID, F_RSSI, F_CHANNEL, F_MATCHED_PATTERN, F_COOLDOWN, F_MAC, F_GPS, F_END
+};
+
+static const uint8_t BLE_SCHEMA[] = {
+    F_TIMESTAMP, F_DETECTION_TIME, F_PROTOCOL, F_METHOD, F_ALERT_LEVEL, F_DEVICE_CATEGORY,
+    F_MAC, F_RSSI, F_DEVICE_NAME, F_MATCHED_PATTERN, F_COOLDOWN, F_GPS, F_END
+};
+
+static const uint8_t RAVEN_SCHEMA[] = {
+    F_TIMESTAMP, F_DETECTION_TIME, F_PROTOCOL, F_METHOD, F_DEVICE_TYPE, F_MANUFACTURER,
+    F_MAC, F_RSSI, F_DEVICE_NAME, F_GPS, F_RAVEN_UUID, F_RAVEN_DESCRIPTION, F_RAVEN_FIRMWARE,
+    F_THREAT_LEVEL, F_THREAT_SCORE, F_COOLDOWN, F_SERVICE_UUIDS, F_END
+};
+
+// ============================================================================
+// BUFFERS
+// ============================================================================
+
+class EventBuffer {
+public:
+    EventBuffer(uint8_t* buffer, size_t capacity) : buf(buffer), cap(capacity) {}
+    virtual ~EventBuffer() {}
+
+    virtual void str(uint8_t id, const char* key, const char* value) = 0;
+    virtual void i32(uint8_t id, const char* key, int32_t value) = 0;
+    virtual void u32(uint8_t id, const char* key, uint32_t value) = 0;
+    virtual void fix6(uint8_t id, const char* key, double value) = 0;
+    virtual void seconds(uint8_t id, const char* key, uint32_t millis) = 0;
+    virtual void openObject(uint8_t id, const char* key) = 0;
+    virtual void openArray(uint8_t id, const char* key) = 0;
+    virtual void element(uint8_t id, const char* value) = 0;
+    virtual void close(bool array) = 0;
+
+    size_t length() const { return overflow ? 0 : len; }
+
+protected:
+    uint8_t* buf;
+    size_t cap;
+    size_t len = 0;
+    bool overflow = false;
+
+    void put(uint8_t c) {
+        if (len < cap) buf[len++] = c;
+        else overflow = true;
+    }
+    void put(const void* data, size_t n) {
+        if (len + n <= cap) {
+            memcpy(buf + len, data, n);
+            len += n;
+        } else {
+            overflow = true;
+        }
+    }
+};
+
+class JsonEventBuffer : public EventBuffer {
+public:
+    JsonEventBuffer(uint8_t* buffer, size_t capacity) : EventBuffer(buffer, capacity) { put('{'); }
+    void finish() { put('}'); }
+
+    void str(uint8_t, const char* key, const char* value) override {
+        name(key);
+        quoted(value);
+    }
+    void i32(uint8_t, const char* key, int32_t value) override {
+        name(key);
+        char tmp[12];
+        put(tmp, snprintf(tmp, sizeof(tmp), "%ld", (long)value));
+    }
+    void u32(uint8_t, const char* key, uint32_t value) override {
+        name(key);
+        char tmp[12];
+        put(tmp, snprintf(tmp, sizeof(tmp), "%lu", (unsigned long)value));
+    }
+    void fix6(uint8_t, const char* key, double value) override {
+        name(key);
+        // Six decimals, trailing zeros trimmed (40.712800 -> 40.7128)
+        char tmp[24];
+        int n = snprintf(tmp, sizeof(tmp), "%.6f", value);
+        while (n > 1 && tmp[n - 1] == '0') n--;
+        if (n > 1 && tmp[n - 1] == '.') n--;
+        put(tmp, n);
+    }
+    void seconds(uint8_t, const char* key, uint32_t millis) override {
+        // Same text as String(millis / 1000.0, 3) + "s"
+        name(key);
+        char tmp[20];
+        put(tmp, snprintf(tmp, sizeof(tmp), "\"%lu.%03lus\"",
+                          (unsigned long)(millis / 1000), (unsigned long)(millis % 1000)));
+    }
+    void openObject(uint8_t, const char* key) override {
+        name(key);
+        put('{');
+        first = true;
+    }
+    void openArray(uint8_t, const char* key) override {
+        name(key);
+        put('[');
+        first = true;
+    }
+    void element(uint8_t, const char* value) override {
+        if (!first) put(',');
+        first = false;
+        quoted(value);
+    }
+    void close(bool array) override {
+        put(array ? ']' : '}');
+        first = false;
+    }
+
+private:
+    bool first = true;
+
+    void name(const char* key) {
+        if (!first) put(',');
+        first = false;
+        quoted(key);
+        put(':');
+    }
+
+    void quoted(const char* s) {
+        put('"');
+        for (const char* p = s ? s : ""; *p; p++) {
+            uint8_t c = (uint8_t)*p;
+            switch (c) {
+                case '"':  put('\\'); put('"'); break;
+                case '\\': put('\\'); put('\\'); break;
+                case '\b': put('\\'); put('b'); break;
+                case '\f': put('\\'); put('f'); break;
+                case '\n': put('\\'); put('n'); break;
+                case '\r': put('\\'); put('r'); break;
+                case '\t': put('\\'); put('t'); break;
+                default:
+                    if (c < 0x20) {
+                        char tmp[8];
+                        put(tmp, snprintf(tmp, sizeof(tmp), "\\u%04x", c));
+                    } else {
+                        put(c);
+                    }
+            }
+        }
+        put('"');
+    }
+};
+
+class BinaryEventBuffer : public EventBuffer {
+public:
+    enum Type : uint8_t { T_STR = 1, T_I32 = 2, T_U32 = 3, T_FIX6 = 4, T_OBJ = 5, T_ARR = 6, T_END = 7 };
+
+    BinaryEventBuffer(uint8_t* buffer, size_t capacity, EventKind kind) : EventBuffer(buffer, capacity) {
+        put(0xF1);
+        put(0x0C);
+        put(kind);
+        put(0);  // Length, patched in finish()
+        put(0);
+    }
+
+    void finish() {
+        if (overflow) return;
+        size_t payload = len - 5;
+        if (payload > 0xFFFF) {
+            overflow = true;
+            return;
+        }
+        buf[3] = payload & 0xFF;
+        buf[4] = payload >> 8;
+        uint16_t crc = crc16(buf + 2, len - 2);
+        put(crc & 0xFF);
+        put(crc >> 8);
+    }
+
+    void str(uint8_t id, const char*, const char* value) override {
+        put(id);
+        put(T_STR);
+        string(value);
+    }
+    void i32(uint8_t id, const char*, int32_t value) override {
+        put(id);
+        put(T_I32);
+        word((uint32_t)value);
+    }
+    void u32(uint8_t id, const char*, uint32_t value) override {
+        put(id);
+        put(T_U32);
+        word(value);
+    }
+    void fix6(uint8_t id, const char*, double value) override {
+        put(id);
+        put(T_FIX6);
+        word((uint32_t)(int32_t)lround(value * 1000000.0));
+    }
+    void seconds(uint8_t id, const char* key, uint32_t millis) override {
+        u32(id, key, millis);
+    }
+    void openObject(uint8_t id, const char*) override {
+        put(id);
+        put(T_OBJ);
+    }
+    void openArray(uint8_t id, const char*) override {
+        put(id);
+        put(T_ARR);
+    }
+    void element(uint8_t id, const char* value) override {
+        str(id, nullptr, value);
+    }
+    void close(bool) override {
+        put(F_END);
+        put(T_END);
+    }
+
+private:
+    void word(uint32_t v) {
+        put(v & 0xFF);
+        put((v >> 8) & 0xFF);
+        put((v >> 16) & 0xFF);
+        put((v >> 24) & 0xFF);
+    }
+    void string(const char* s) {
+        size_t n = s ? strlen(s) : 0;
+        if (n > 255) n = 255;
+        put((uint8_t)n);
+        put(s, n);
+    }
+    static uint16_t crc16(const uint8_t* data, size_t n) {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < n; i++) {
+            crc ^= (uint16_t)data[i] << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+            }
+        }
+        return crc;
+    }
+};
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+static void writeField(EventBuffer& out, uint8_t field, const DetectionEvent& e) {
+    bool ble = e.kind != EVENT_WIFI;
+
+    switch (field) {
+        case F_TIMESTAMP:       out.u32(field, "timestamp", e.timestamp); break;
+        case F_DETECTION_TIME:  out.seconds(field, "detection_time", e.timestamp); break;
+        case F_PROTOCOL:        out.str(field, "protocol", ble ? "bluetooth_le" : "wifi"); break;
+        case F_METHOD:          out.str(field, "detection_method", e.method); break;
+        case F_ALERT_LEVEL:     out.str(field, "alert_level", "HIGH"); break;
+        case F_DEVICE_CATEGORY: out.str(field, "device_category", "FLOCK_SAFETY"); break;
+        case F_DEVICE_TYPE:     out.str(field, "device_type", "RAVEN_GUNSHOT_DETECTOR"); break;
+        case F_MANUFACTURER:    out.str(field, "manufacturer", "SoundThinking/ShotSpotter"); break;
+        case F_SSID:            out.str(field, "ssid", e.ssid); break;
+        case F_MAC:             out.str(field, "mac_address", e.mac); break;
+        case F_RSSI:            out.i32(field, "rssi", e.rssi); break;
+        case F_CHANNEL:         out.u32(field, "channel", e.channel); break;
+
+        case F_DEVICE_NAME:
+            if (e.name && e.name[0]) out.str(field, "device_name", e.name);
+            break;
+        case F_MATCHED_PATTERN:
+            if (e.matchedPattern) out.str(field, "matched_pattern", e.matchedPattern);
+            break;
+
+        case F_COOLDOWN:
+            if (e.summary) {
+                // Sightings folded into the previous cooldown window
+                out.openObject(field, "cooldown_summary");
+                out.u32(F_COOLDOWN_SIGHTINGS, "sightings", e.summary->sightings);
+                out.i32(F_COOLDOWN_RSSI_MIN, "rssi_min", e.summary->rssiMin);
+                out.i32(F_COOLDOWN_RSSI_MAX, "rssi_max", e.summary->rssiMax);
+                out.i32(F_COOLDOWN_RSSI_LAST, "rssi_last", e.summary->rssiLast);
+                out.u32(F_COOLDOWN_DURATION, "duration_ms", e.summary->windowMs);
+                out.close(false);
+            }
+            break;
+
+        case F_GPS:
+            if (e.gpsValid) {
+                out.fix6(F_GPS_LATITUDE, "gps_latitude", e.latitude);
+                out.fix6(F_GPS_LONGITUDE, "gps_longitude", e.longitude);
+                out.fix6(F_GPS_ALTITUDE, "gps_altitude", e.altitude);
+                out.i32(F_GPS_SATELLITES, "gps_satellites", e.satellites);
+            } else {
+                out.str(F_GPS_STATUS, "gps_status", e.gpsStatus);
+            }
+            break;
+
+        case F_RAVEN_UUID:        out.str(field, "raven_service_uuid", e.ravenServiceUuid); break;
+        case F_RAVEN_DESCRIPTION: out.str(field, "raven_service_description", e.ravenServiceDescription); break;
+        case F_RAVEN_FIRMWARE:    out.str(field, "raven_firmware_version", e.ravenFirmwareVersion); break;
+        case F_THREAT_LEVEL:      out.str(field, "threat_level", "CRITICAL"); break;
+        case F_THREAT_SCORE:      out.i32(field, "threat_score", 100); break;
+
+        case F_SERVICE_UUIDS:
+            if (e.hasServiceUuids) {
+                out.openArray(field, "service_uuids");
+                for (uint8_t i = 0; i < e.serviceUuidCount; i++) {
+                    out.element(field, e.serviceUuids[i]);
+                }
+                out.close(true);
+            }
+            break;
+    }
+}
+
+size_t writeDetectionEvent(const DetectionEvent& event, EventEncoding encoding,
+                           uint8_t* buffer, size_t capacity) {
+    const uint8_t* schema = WIFI_SCHEMA;
+    if (event.kind == EVENT_BLE) schema = BLE_SCHEMA;
+    else if (event.kind == EVENT_RAVEN) schema = RAVEN_SCHEMA;
+
+    if (encoding == EVENT_ENCODING_BINARY) {
+        BinaryEventBuffer out(buffer, capacity, event.kind);
+        for (const uint8_t* f = schema; *f != F_END; f++) {
+            writeField(out, *f, event);
+        }
+        out.finish();
+        return out.length();
+    }
+
+    JsonEventBuffer out(buffer, capacity);
+    for (const uint8_t* f = schema; *f != F_END; f++) {
+        writeField(out, *f, event);
+    }
+    out.finish();
+    return out.length();
+}
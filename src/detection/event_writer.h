@@ -0,0 +1,80 @@
+#ifndef EVENT_WRITER_H
+#define EVENT_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "detection_cache.h"
+
+// ============================================================================
+// DETECTION EVENT WRITER
+// ============================================================================
+//
+// Serializes a detection into a caller-supplied buffer without touching the
+// heap. The field order of each event kind is fixed at compile time (see
+// the schema tables in event_writer.cpp) and matches the JSON lines the
+// detectors have always printed, which api/flockyou.py parses.
+//
+// Two encodings share the schema:
+//   JSON   - one line, compact, same keys and order as before
+//   Binary - framed TLV for low-bandwidth links:
+//              0xF1 0x0C  sync
+//              u8         event kind
+//              u16 LE     payload length
+//              payload    repeated { u8 field id, u8 type, value }
+//              u16 LE     CRC-16/CCITT-FALSE of kind..payload
+//            value: STR u8 length + bytes, I32/U32 4 bytes LE,
+//            FIX6 int32 LE in millionths; objects/arrays open with
+//            OBJ/ARR and close with END.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define EVENT_BUFFER_SIZE 768
+
+enum EventKind : uint8_t {
+    EVENT_WIFI = 1,
+    EVENT_BLE = 2,
+    EVENT_RAVEN = 3
+};
+
+enum EventEncoding : uint8_t {
+    EVENT_ENCODING_JSON = 0,
+    EVENT_ENCODING_BINARY = 1
+};
+
+#define EVENT_MAX_SERVICE_UUIDS 8
+
+struct DetectionEvent {
+    EventKind kind;
+    uint32_t timestamp;              // millis()
+    const char* method;
+    const char* mac;
+    int rssi;
+
+    const char* ssid = nullptr;      // WiFi
+    uint8_t channel = 0;             // WiFi
+    const char* name = nullptr;      // BLE/Raven (omitted if empty)
+    const char* matchedPattern = nullptr;
+    const DetectionSummary* summary = nullptr;
+
+    bool gpsValid = false;
+    double latitude = 0;
+    double longitude = 0;
+    double altitude = 0;
+    int satellites = 0;
+    const char* gpsStatus = "NO_GPS";  // Used when !gpsValid
+
+    // Raven
+    const char* ravenServiceUuid = nullptr;
+    const char* ravenServiceDescription = nullptr;
+    const char* ravenFirmwareVersion = nullptr;
+    const char* serviceUuids[EVENT_MAX_SERVICE_UUIDS];
+    uint8_t serviceUuidCount = 0;
+    bool hasServiceUuids = false;    // Emit the array (possibly empty)
+};
+
+// Returns the number of bytes written (JSON: without newline or NUL),
+// or 0 if the event did not fit.
+size_t writeDetectionEvent(const DetectionEvent& event, EventEncoding encoding,
+                           uint8_t* buffer, size_t capacity);
+
+#endif // EVENT_WRITER_H
@@ -0,0 +1,100 @@
+#include "frame_parser.h"
+#include <string.h>
+#include "uuid_matcher.h"
+
+// Management frame subtypes (frame control byte 0)
+static const uint8_t FRAME_PROBE_REQUEST = 0x40;
+static const uint8_t FRAME_BEACON = 0x80;
+
+static const size_t MAC_HEADER_SIZE = 24;
+static const size_t BEACON_FIXED_SIZE = 12;  // Timestamp, interval, capabilities
+
+bool parseWiFiFrame(const uint8_t* data, size_t len, int8_t rssi, uint8_t channel,
+                    uint32_t timestamp, WiFiFrame* out) {
+    if (rssi < WIFI_RSSI_THRESHOLD) return false;
+    if (len < MAC_HEADER_SIZE) return false;
+
+    // WiFiFrame::frame_type codes: 0x20 = probe request, 0x80 = beacon. The
+    // sniffer used to compute (frame_ctrl & 0xFF) >> 2, which turns a beacon
+    // into 0x20 and a probe request into 0x10: every beacon was reported as
+    // "probe_request" and real probe requests were dropped. Compare the whole
+    // first frame control byte (type and subtype, protocol version 0) instead.
+    uint8_t frame_type;
+    if (data[0] == FRAME_PROBE_REQUEST) {
+        frame_type = 0x20;
+    } else if (data[0] == FRAME_BEACON) {
+        frame_type = 0x80;
+    } else {
+        return false;
+    }
+
+    memcpy(out->mac, data + 10, 6);   // addr2 = transmitter
+    out->frame_type = frame_type;
+    out->channel = channel;
+    out->rssi = rssi;
+    out->ssid_len = 0;
+    out->ssid[0] = '\0';
+    out->timestamp = timestamp;
+
+    const uint8_t* payload = data + MAC_HEADER_SIZE;
+    if (frame_type == 0x80) {
+        payload += BEACON_FIXED_SIZE;
+    }
+
+    // SSID element must lie inside the received frame
+    const uint8_t* end = data + len;
+    if (payload + 2 <= end && payload[0] == 0 && payload[1] <= 32 &&
+        payload + 2 + payload[1] <= end) {
+        memcpy(out->ssid, &payload[2], payload[1]);
+        out->ssid[payload[1]] = '\0';
+        out->ssid_len = strlen(out->ssid);
+    }
+    return true;
+}
+
+// AD types
+static const uint8_t AD_UUID16_INCOMPLETE = 0x02;
+static const uint8_t AD_UUID16_COMPLETE = 0x03;
+static const uint8_t AD_UUID32_INCOMPLETE = 0x04;
+static const uint8_t AD_UUID32_COMPLETE = 0x05;
+static const uint8_t AD_UUID128_INCOMPLETE = 0x06;
+static const uint8_t AD_UUID128_COMPLETE = 0x07;
+static const uint8_t AD_NAME_SHORT = 0x08;
+static const uint8_t AD_NAME_COMPLETE = 0x09;
+
+void parseBleAdvert(const uint8_t* mac, int8_t rssi, const uint8_t* payload, size_t len,
+                    uint32_t timestamp, BleAdvert* out) {
+    memcpy(out->mac, mac, 6);
+    out->rssi = rssi;
+    out->uuid_count = 0;
+    out->name[0] = '\0';
+    out->timestamp = timestamp;
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t fieldLen = payload[i];
+        if (fieldLen == 0 || i + 1 + fieldLen > len) break;   // Padding or truncated
+        uint8_t type = payload[i + 1];
+        const uint8_t* value = payload + i + 2;
+        size_t valueLen = fieldLen - 1;
+
+        if (type == AD_NAME_COMPLETE || (type == AD_NAME_SHORT && out->name[0] == '\0')) {
+            size_t n = valueLen < sizeof(out->name) - 1 ? valueLen : sizeof(out->name) - 1;
+            memcpy(out->name, value, n);
+            out->name[n] = '\0';
+        } else if (type == AD_UUID128_INCOMPLETE || type == AD_UUID128_COMPLETE) {
+            for (size_t off = 0; off + 16 <= valueLen && out->uuid_count < BLE_ADVERT_MAX_UUIDS; off += 16) {
+                memcpy(out->uuids[out->uuid_count++], value + off, 16);
+            }
+        } else if (type >= AD_UUID16_INCOMPLETE && type <= AD_UUID32_COMPLETE) {
+            // Short forms, little-endian, widened onto the Bluetooth base UUID
+            size_t width = type <= AD_UUID16_COMPLETE ? 2 : 4;
+            for (size_t off = 0; off + width <= valueLen && out->uuid_count < BLE_ADVERT_MAX_UUIDS; off += width) {
+                uint32_t shortUuid = value[off] | (value[off + 1] << 8);
+                if (width == 4) shortUuid |= ((uint32_t)value[off + 2] << 16) | ((uint32_t)value[off + 3] << 24);
+                UUIDMatcher::widen(shortUuid, out->uuids[out->uuid_count++]);
+            }
+        }
+        i += 1 + fieldLen;
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef FRAME_PARSER_H
+#define FRAME_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hal/hal.h"
+
+// ============================================================================
+// FRAME PARSER
+// ============================================================================
+//
+// Turns raw radio payloads into the WiFiFrame / BleAdvert structs the
+// detection pipeline consumes. The sniffer and NimBLE callbacks use these on
+// the device and the host replay driver uses them on captured packets, so a
+// capture replays through exactly the same code.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define WIFI_RSSI_THRESHOLD -85   // Weaker frames are likely too far or noise
+
+// 802.11 management frame (header + body, FCS optional). Returns false for
+// frames the detectors ignore: weak, not a probe request/beacon, or truncated.
+bool parseWiFiFrame(const uint8_t* data, size_t len, int8_t rssi, uint8_t channel,
+                    uint32_t timestamp, WiFiFrame* out);
+
+// BLE advertising data (AD structures, advertisement and scan response
+// concatenated). Picks out the local name and the service UUIDs; 16- and
+// 32-bit UUIDs are stored widened onto the Bluetooth base UUID.
+void parseBleAdvert(const uint8_t* mac, int8_t rssi, const uint8_t* payload, size_t len,
+                    uint32_t timestamp, BleAdvert* out);
+
+#endif // FRAME_PARSER_H
@@ -0,0 +1,78 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ============================================================================
+// LOCK-FREE SINGLE-PRODUCER / SINGLE-CONSUMER RING
+// ============================================================================
+//
+// Fixed-size ring used to hand compact records from a driver callback
+// (producer) to a processing task (consumer) without locks or allocation.
+// Exactly one context may call push() and exactly one may call pop().
+// When the ring is full, push() drops the new record and counts it.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+template <typename T, size_t N>
+class FrameRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "FrameRing size must be a power of two");
+
+public:
+    // Producer side - returns false (and counts a drop) if the ring is full
+    bool push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        uint32_t tail = tail_.load(std::memory_order_acquire);
+        uint32_t used = head - tail;
+
+        if (used >= N) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots_[head & (N - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+
+        used++;
+        if (used > highWater_.load(std::memory_order_relaxed)) {
+            highWater_.store(used, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side - returns false if the ring is empty
+    bool pop(T& out) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        uint32_t head = head_.load(std::memory_order_acquire);
+
+        if (head == tail) return false;
+
+        out = slots_[tail & (N - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+    // Statistics
+    uint32_t pushedCount() const { return pushed_.load(std::memory_order_relaxed); }
+    uint32_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+    uint32_t highWaterMark() const { return highWater_.load(std::memory_order_relaxed); }
+
+private:
+    T slots_[N];
+    std::atomic<uint32_t> head_{0};       // Next slot to write (producer owned)
+    std::atomic<uint32_t> tail_{0};       // Next slot to read (consumer owned)
+    std::atomic<uint32_t> pushed_{0};
+    std::atomic<uint32_t> dropped_{0};
+    std::atomic<uint32_t> highWater_{0};
+};
+
+#endif // FRAME_RING_H
@@ -0,0 +1,83 @@
+#include "oui_matcher.h"
+#include <algorithm>
+#include <ctype.h>
+
+OUIMatcher ouiMatcher;
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool OUIMatcher::parse(const char* text, uint32_t* ouiOut) {
+    if (!text) return false;
+
+    uint32_t oui = 0;
+    int digits = 0;
+
+    for (const char* p = text; *p && digits < 6; p++) {
+        if (*p == ':' || *p == '-' || *p == '.') {
+            continue;
+        }
+        int v = hexValue(*p);
+        if (v < 0) return false;
+        oui = (oui << 4) | (uint32_t)v;
+        digits++;
+    }
+
+    if (digits != 6) return false;
+    *ouiOut = oui;
+    return true;
+}
+
+bool OUIMatcher::addPrefix(const char* text) {
+    uint32_t oui;
+    if (!parse(text, &oui)) return false;
+    addPrefix(oui);
+    return true;
+}
+
+void OUIMatcher::addPrefix(uint32_t oui) {
+    table.push_back(oui & 0xFFFFFF);
+}
+
+void OUIMatcher::build() {
+    std::sort(table.begin(), table.end());
+    table.erase(std::unique(table.begin(), table.end()), table.end());
+    table.shrink_to_fit();
+
+    for (int i = 0; i < 8; i++) firstOctet[i] = 0;
+    for (uint32_t oui : table) {
+        uint8_t b = oui >> 16;
+        firstOctet[b >> 5] |= 1u << (b & 31);
+    }
+}
+
+void OUIMatcher::clear() {
+    table.clear();
+    for (int i = 0; i < 8; i++) firstOctet[i] = 0;
+}
+
+bool OUIMatcher::contains(const uint8_t* mac) const {
+    if (!(firstOctet[mac[0] >> 5] & (1u << (mac[0] & 31)))) {
+        return false;
+    }
+    return contains(toKey(mac));
+}
+
+bool OUIMatcher::contains(uint32_t oui) const {
+    size_t n = table.size();
+    if (n == 0) return false;
+
+    // Lower-bound search without a data-dependent early exit; the compiler
+    // turns the select into a conditional move
+    const uint32_t* base = table.data();
+    while (n > 1) {
+        size_t half = n / 2;
+        base = (base[half] <= oui) ? base + half : base;
+        n -= half;
+    }
+    return *base == oui;
+}
@@ -0,0 +1,49 @@
+#ifndef OUI_MATCHER_H
+#define OUI_MATCHER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// ============================================================================
+// OUI PREFIX MATCHER
+// ============================================================================
+//
+// MAC prefixes ("58:8e:81") are compiled once at load time into a sorted
+// table of 24-bit integers. Lookups work on the raw address bytes: a 256-bit
+// first-octet bitmap rejects most addresses immediately, the rest go through
+// a branch-light binary search, so cost stays O(log n) for thousands of
+// prefixes loaded from SD.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+class OUIMatcher {
+public:
+    // Parse and add a prefix ("aa:bb:cc", "aa-bb-cc" or "aabbcc").
+    // Returns false if the text is not a valid prefix.
+    bool addPrefix(const char* text);
+    void addPrefix(uint32_t oui);
+
+    // Sort and de-duplicate; must be called after adding and before matching
+    void build();
+    void clear();
+
+    // Match the first three bytes of a raw 6-byte address
+    bool contains(const uint8_t* mac) const;
+    bool contains(uint32_t oui) const;
+
+    size_t size() const { return table.size(); }
+
+    static uint32_t toKey(const uint8_t* mac) {
+        return ((uint32_t)mac[0] << 16) | ((uint32_t)mac[1] << 8) | mac[2];
+    }
+    static bool parse(const char* text, uint32_t* ouiOut);
+
+private:
+    std::vector<uint32_t> table;
+    uint32_t firstOctet[8] = {0};  // Bitmap of first address bytes present in table
+};
+
+extern OUIMatcher ouiMatcher;
+
+#endif // OUI_MATCHER_H
@@ -0,0 +1,166 @@
+#include "pattern_matcher.h"
+#include <string.h>
+#include <algorithm>
+
+PatternMatcher ssidMatcher;
+PatternMatcher nameMatcher;
+
+static const uint16_t NO_STATE = 0xFFFF;
+static const size_t MAX_STATES = 0xFFFE;
+
+static inline uint8_t foldCase(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c + ('a' - 'A')) : c;
+}
+
+int PatternMatcher::addPattern(const char* pattern) {
+    if (!pattern || !pattern[0]) return -1;
+
+    std::string lower(pattern);
+    for (char& c : lower) c = (char)foldCase((uint8_t)c);
+
+    for (size_t i = 0; i < folded.size(); i++) {
+        if (folded[i] == lower) return (int)i;
+    }
+
+    patterns.push_back(pattern);
+    folded.push_back(lower);
+    return (int)patterns.size() - 1;
+}
+
+void PatternMatcher::clear() {
+    patterns.clear();
+    folded.clear();
+    nodes.clear();
+    edges.clear();
+}
+
+void PatternMatcher::build() {
+    // 1. Build the trie with temporary per-node child lists
+    std::vector<std::vector<std::pair<uint8_t, uint16_t>>> children(1);
+    std::vector<int16_t> terminal(1, -1);
+
+    for (size_t p = 0; p < folded.size(); p++) {
+        const std::string& pat = folded[p];
+        if (children.size() + pat.size() > MAX_STATES) {
+            break;  // Automaton full - remaining patterns are ignored
+        }
+
+        uint16_t state = 0;
+        for (char ch : pat) {
+            uint8_t c = (uint8_t)ch;
+            uint16_t next = NO_STATE;
+            for (auto& edge : children[state]) {
+                if (edge.first == c) {
+                    next = edge.second;
+                    break;
+                }
+            }
+            if (next == NO_STATE) {
+                next = (uint16_t)children.size();
+                children[state].push_back({c, next});
+                children.emplace_back();
+                terminal.push_back(-1);
+            }
+            state = next;
+        }
+        if (terminal[state] < 0) {
+            terminal[state] = (int16_t)p;
+        }
+    }
+
+    // 2. Flatten to sorted edge arrays
+    nodes.assign(children.size(), Node{0, 0, 0, -1});
+    edges.clear();
+    for (size_t n = 0; n < children.size(); n++) {
+        auto& list = children[n];
+        std::sort(list.begin(), list.end());
+        nodes[n].firstEdge = (uint32_t)edges.size();
+        nodes[n].edgeCount = (uint16_t)list.size();
+        for (auto& edge : list) {
+            edges.push_back({edge.first, edge.second});
+        }
+    }
+    edges.shrink_to_fit();
+
+    for (int c = 0; c < 256; c++) rootNext[c] = 0;
+    for (auto& edge : children[0]) rootNext[edge.first] = edge.second;
+
+    // 3. Breadth-first pass for failure links and outputs
+    std::vector<uint16_t> queue;
+    queue.reserve(nodes.size());
+    nodes[0].output = terminal[0];
+    for (auto& edge : children[0]) {
+        nodes[edge.second].fail = 0;
+        nodes[edge.second].output = terminal[edge.second];
+        queue.push_back(edge.second);
+    }
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint16_t u = queue[head];
+        for (auto& edge : children[u]) {
+            uint16_t v = edge.second;
+            uint16_t f = nodes[u].fail;
+            uint16_t target = NO_STATE;
+            while (true) {
+                target = (f == 0) ? (rootNext[edge.first] ? rootNext[edge.first] : NO_STATE)
+                                  : findEdge(f, edge.first);
+                if (target != NO_STATE || f == 0) break;
+                f = nodes[f].fail;
+            }
+            nodes[v].fail = (target == NO_STATE) ? 0 : target;
+            nodes[v].output = (terminal[v] >= 0) ? terminal[v] : nodes[nodes[v].fail].output;
+            queue.push_back(v);
+        }
+    }
+    nodes.shrink_to_fit();
+}
+
+uint16_t PatternMatcher::findEdge(uint16_t state, uint8_t c) const {
+    const Node& node = nodes[state];
+    const Edge* first = &edges[node.firstEdge];
+    uint16_t count = node.edgeCount;
+
+    if (count <= 8) {
+        for (uint16_t i = 0; i < count; i++) {
+            if (first[i].c == c) return first[i].target;
+        }
+        return NO_STATE;
+    }
+
+    const Edge* last = first + count;
+    const Edge* it = std::lower_bound(first, last, c,
+        [](const Edge& e, uint8_t value) { return e.c < value; });
+    return (it != last && it->c == c) ? it->target : NO_STATE;
+}
+
+uint16_t PatternMatcher::step(uint16_t state, uint8_t c) const {
+    while (state != 0) {
+        uint16_t next = findEdge(state, c);
+        if (next != NO_STATE) return next;
+        state = nodes[state].fail;
+    }
+    return rootNext[c];
+}
+
+int PatternMatcher::match(const char* text) const {
+    if (!text) return -1;
+    return match(text, strlen(text));
+}
+
+int PatternMatcher::match(const char* text, size_t length) const {
+    if (!text || nodes.empty()) return -1;
+
+    uint16_t state = 0;
+    for (size_t i = 0; i < length; i++) {
+        state = step(state, foldCase((uint8_t)text[i]));
+        if (nodes[state].output >= 0) {
+            return nodes[state].output;
+        }
+    }
+    return -1;
+}
+
+const char* PatternMatcher::getPattern(int index) const {
+    if (index < 0 || (size_t)index >= patterns.size()) return nullptr;
+    return patterns[index].c_str();
+}
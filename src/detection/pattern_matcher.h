@@ -0,0 +1,65 @@
+#ifndef PATTERN_MATCHER_H
+#define PATTERN_MATCHER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// MULTI-PATTERN SUBSTRING MATCHER
+// ============================================================================
+//
+// Case-insensitive Aho-Corasick automaton. All patterns are compiled once
+// into a single automaton, so an SSID or device name is scanned in one pass
+// no matter how many patterns are loaded. The root node uses a direct
+// 256-entry transition table (most bytes land there); other nodes keep
+// sorted edge lists to stay small on the WROOM.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+class PatternMatcher {
+public:
+    // Add a pattern (case-insensitive). Returns its index, or the index of an
+    // existing equivalent pattern; -1 if the pattern is empty.
+    int addPattern(const char* pattern);
+
+    // Compile the automaton; must be called after adding and before matching
+    void build();
+    void clear();
+
+    // Returns the index of the first pattern found in text, or -1.
+    // "First" means the match that ends earliest in the text.
+    int match(const char* text) const;
+    int match(const char* text, size_t length) const;
+
+    const char* getPattern(int index) const;
+    size_t size() const { return patterns.size(); }
+    size_t stateCount() const { return nodes.size(); }
+
+private:
+    struct Node {
+        uint32_t firstEdge;   // Index into edges[]
+        uint16_t edgeCount;
+        uint16_t fail;        // Longest proper suffix that is also a trie node
+        int16_t output;       // Pattern ending here (or at a suffix), -1 if none
+    };
+    struct Edge {
+        uint8_t c;
+        uint16_t target;
+    };
+
+    std::vector<std::string> patterns;  // Original spelling, for reporting
+    std::vector<std::string> folded;    // Lower-cased, used to build the trie
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    uint16_t rootNext[256];
+
+    uint16_t step(uint16_t state, uint8_t c) const;
+    uint16_t findEdge(uint16_t state, uint8_t c) const;
+};
+
+extern PatternMatcher ssidMatcher;    // WiFi SSID patterns
+extern PatternMatcher nameMatcher;    // BLE device name patterns
+
+#endif // PATTERN_MATCHER_H
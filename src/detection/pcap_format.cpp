@@ -0,0 +1,195 @@
+#include "pcap_format.h"
+#include <string.h>
+
+static const uint32_t PCAP_MAGIC = 0xa1b2c3d4;
+static const uint32_t BLE_ADV_ACCESS_ADDRESS = 0x8E89BED6;
+
+// Radiotap fields written: Flags, Channel, dBm antenna signal
+static const uint32_t RADIOTAP_PRESENT = (1u << 1) | (1u << 3) | (1u << 5);
+static const uint8_t RADIOTAP_FLAG_FCS = 0x10;
+static const uint16_t RADIOTAP_CHAN_2GHZ = 0x0080;
+static const size_t RADIOTAP_LEN = 15;
+
+// LE pseudo-header flags: de-whitened, signal power valid
+static const uint16_t BLE_PHDR_FLAGS = 0x0001 | 0x0002;
+static const size_t BLE_PHDR_LEN = 10;
+
+// ============================================================================
+// LITTLE-ENDIAN HELPERS
+// ============================================================================
+
+static void putU16(uint8_t* out, uint16_t v) {
+    out[0] = v & 0xFF;
+    out[1] = v >> 8;
+}
+
+static void putU32(uint8_t* out, uint32_t v) {
+    out[0] = v & 0xFF;
+    out[1] = (v >> 8) & 0xFF;
+    out[2] = (v >> 16) & 0xFF;
+    out[3] = (v >> 24) & 0xFF;
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static void putRecordHeader(uint8_t* out, uint64_t micros, uint32_t capturedLen, uint32_t originalLen) {
+    putU32(out, (uint32_t)(micros / 1000000));
+    putU32(out + 4, (uint32_t)(micros % 1000000));
+    putU32(out + 8, capturedLen);
+    putU32(out + 12, originalLen);
+}
+
+static uint16_t channelToFrequency(uint8_t channel) {
+    if (channel == 14) return 2484;
+    return 2407 + 5 * channel;
+}
+
+static uint8_t frequencyToChannel(uint16_t freq) {
+    if (freq == 2484) return 14;
+    if (freq >= 2412 && freq <= 2472) return (freq - 2407) / 5;
+    return 0;
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+size_t pcapFileHeader(uint8_t* out, uint32_t linktype) {
+    putU32(out, PCAP_MAGIC);
+    putU16(out + 4, 2);        // Version 2.4
+    putU16(out + 6, 4);
+    putU32(out + 8, 0);        // Timezone
+    putU32(out + 12, 0);       // Sigfigs
+    putU32(out + 16, PCAP_SNAPLEN);
+    putU32(out + 20, linktype);
+    return PCAP_FILE_HEADER_SIZE;
+}
+
+size_t pcapEncodeWiFi(uint8_t* out, uint64_t micros, const uint8_t* frame, size_t len,
+                      int8_t rssi, uint8_t channel) {
+    size_t original = RADIOTAP_LEN + len;
+    size_t captured = original > PCAP_SNAPLEN ? PCAP_SNAPLEN : original;
+    putRecordHeader(out, micros, captured, original);
+
+    uint8_t* rt = out + PCAP_RECORD_HEADER_SIZE;
+    rt[0] = 0;                         // Version
+    rt[1] = 0;                         // Pad
+    putU16(rt + 2, RADIOTAP_LEN);
+    putU32(rt + 4, RADIOTAP_PRESENT);
+    rt[8] = RADIOTAP_FLAG_FCS;         // ESP32 frames include the FCS
+    rt[9] = 0;                         // Align channel to 2
+    putU16(rt + 10, channelToFrequency(channel));
+    putU16(rt + 12, RADIOTAP_CHAN_2GHZ);
+    rt[14] = (uint8_t)rssi;
+
+    memcpy(rt + RADIOTAP_LEN, frame, captured - RADIOTAP_LEN);
+    return PCAP_RECORD_HEADER_SIZE + captured;
+}
+
+size_t pcapEncodeBle(uint8_t* out, uint64_t micros, const uint8_t* mac, bool randomAddress,
+                     BlePduType pduType, const uint8_t* advData, size_t len, int8_t rssi) {
+    // PHDR + access address + PDU header + AdvA + data + CRC
+    size_t overhead = BLE_PHDR_LEN + 4 + 2 + 6 + 3;
+    if (len > PCAP_SNAPLEN - overhead) len = PCAP_SNAPLEN - overhead;
+    size_t captured = overhead + len;
+    putRecordHeader(out, micros, captured, captured);
+
+    uint8_t* p = out + PCAP_RECORD_HEADER_SIZE;
+    p[0] = 0;                          // RF channel unknown
+    p[1] = (uint8_t)rssi;
+    p[2] = 0;                          // Noise
+    p[3] = 0;                          // Access address offenses
+    putU32(p + 4, 0);                  // Reference access address
+    putU16(p + 8, BLE_PHDR_FLAGS);
+    p += BLE_PHDR_LEN;
+
+    putU32(p, BLE_ADV_ACCESS_ADDRESS);
+    p[4] = (pduType & 0x0F) | (randomAddress ? 0x40 : 0);
+    p[5] = (uint8_t)(6 + len);
+    for (int i = 0; i < 6; i++) {
+        p[6 + i] = mac[5 - i];         // AdvA is little-endian on air
+    }
+    memcpy(p + 12, advData, len);
+    memset(p + 12 + len, 0, 3);        // CRC
+    return PCAP_RECORD_HEADER_SIZE + captured;
+}
+
+// ============================================================================
+// DECODING
+// ============================================================================
+
+bool pcapParseFileHeader(const uint8_t* in, uint32_t* linktype) {
+    if (getU32(in) != PCAP_MAGIC) return false;
+    *linktype = getU32(in + 20);
+    return true;
+}
+
+bool pcapParseRecordHeader(const uint8_t* in, uint64_t* micros, uint32_t* capturedLen) {
+    uint32_t usec = getU32(in + 4);
+    if (usec >= 1000000) return false;
+    *micros = (uint64_t)getU32(in) * 1000000 + usec;
+    *capturedLen = getU32(in + 8);
+    return *capturedLen <= 0x40000;
+}
+
+bool pcapDecodeWiFi(const uint8_t* in, size_t len, const uint8_t** frame, size_t* frameLen,
+                    int8_t* rssi, uint8_t* channel) {
+    if (len < 8 || in[0] != 0) return false;
+    size_t rtLen = getU16(in + 2);
+    if (rtLen < 8 || rtLen > len) return false;
+
+    *rssi = 0;
+    *channel = 0;
+
+    // Skip extended presence bitmaps; fields start after the last one
+    uint32_t present = getU32(in + 4);
+    size_t off = 8;
+    for (uint32_t word = present; (word & 0x80000000u) && off + 4 <= rtLen; off += 4) {
+        word = getU32(in + off);
+    }
+
+    // (alignment, size) of radiotap fields 0-5
+    static const uint8_t FIELDS[6][2] = {{8, 8}, {1, 1}, {1, 1}, {2, 4}, {1, 2}, {1, 1}};
+    for (int bit = 0; bit < 6; bit++) {
+        if (!(present & (1u << bit))) continue;
+        size_t align = FIELDS[bit][0];
+        off = (off + align - 1) & ~(align - 1);
+        if (off + FIELDS[bit][1] > rtLen) return false;
+        if (bit == 3) *channel = frequencyToChannel(getU16(in + off));
+        if (bit == 5) *rssi = (int8_t)in[off];
+        off += FIELDS[bit][1];
+    }
+
+    *frame = in + rtLen;
+    *frameLen = len - rtLen;
+    return true;
+}
+
+bool pcapDecodeBle(const uint8_t* in, size_t len, uint8_t* mac, const uint8_t** advData,
+                   size_t* advLen, int8_t* rssi) {
+    if (len < BLE_PHDR_LEN + 4 + 2 + 6) return false;
+    *rssi = (int8_t)in[1];
+
+    const uint8_t* ll = in + BLE_PHDR_LEN;
+    if (getU32(ll) != BLE_ADV_ACCESS_ADDRESS) return false;
+
+    size_t pduLen = ll[5];
+    if (pduLen < 6) return false;
+    for (int i = 0; i < 6; i++) {
+        mac[i] = ll[6 + 5 - i];
+    }
+
+    // Clamp to what was captured (snaplen may have cut the CRC or data)
+    size_t available = len - (BLE_PHDR_LEN + 4 + 2 + 6);
+    size_t dataLen = pduLen - 6;
+    *advData = ll + 12;
+    *advLen = dataLen < available ? dataLen : available;
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef PCAP_FORMAT_H
+#define PCAP_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// PCAP FORMAT
+// ============================================================================
+//
+// Encoder/decoder for the two capture files written by PacketCapture:
+//
+//   WiFi  LINKTYPE_IEEE802_11_RADIOTAP (127)
+//         radiotap header with channel (freq + flags) and dBm signal,
+//         followed by the 802.11 frame as received
+//   BLE   LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR (256)
+//         10-byte pseudo-header (RF channel, signal) followed by a link-layer
+//         advertising packet: access address, PDU header, AdvA, AdvData and
+//         a zeroed CRC (the controller does not hand it over)
+//
+// Classic pcap (microsecond timestamps, little-endian). Both open in
+// Wireshark.
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define PCAP_FILE_HEADER_SIZE 24
+#define PCAP_RECORD_HEADER_SIZE 16
+#define PCAP_LINKTYPE_RADIOTAP 127
+#define PCAP_LINKTYPE_BLE_LL_PHDR 256
+#define PCAP_SNAPLEN 256
+
+// Largest record either encoder produces
+#define PCAP_MAX_RECORD (PCAP_RECORD_HEADER_SIZE + PCAP_SNAPLEN)
+
+// BLE PDU types (legacy advertising)
+enum BlePduType : uint8_t {
+    BLE_PDU_ADV_IND = 0,
+    BLE_PDU_ADV_DIRECT_IND = 1,
+    BLE_PDU_ADV_NONCONN_IND = 2,
+    BLE_PDU_SCAN_RSP = 4,
+    BLE_PDU_ADV_SCAN_IND = 6
+};
+
+size_t pcapFileHeader(uint8_t* out, uint32_t linktype);
+
+// Each returns the record size written to out (>= PCAP_MAX_RECORD bytes),
+// truncating the packet to PCAP_SNAPLEN
+size_t pcapEncodeWiFi(uint8_t* out, uint64_t micros, const uint8_t* frame, size_t len,
+                      int8_t rssi, uint8_t channel);
+size_t pcapEncodeBle(uint8_t* out, uint64_t micros, const uint8_t* mac, bool randomAddress,
+                     BlePduType pduType, const uint8_t* advData, size_t len, int8_t rssi);
+
+// Decoding. The caller reads the file header and record headers; these
+// unwrap one record's captured bytes.
+bool pcapParseFileHeader(const uint8_t* in, uint32_t* linktype);
+bool pcapParseRecordHeader(const uint8_t* in, uint64_t* micros, uint32_t* capturedLen);
+
+// Radiotap: returns the 802.11 frame and the channel/signal fields if present
+bool pcapDecodeWiFi(const uint8_t* in, size_t len, const uint8_t** frame, size_t* frameLen,
+                    int8_t* rssi, uint8_t* channel);
+
+// BLE: mac in display order, advData without the CRC
+bool pcapDecodeBle(const uint8_t* in, size_t len, uint8_t* mac, const uint8_t** advData,
+                   size_t* advLen, int8_t* rssi);
+
+#endif // PCAP_FORMAT_H
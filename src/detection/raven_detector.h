@@ -1,17 +1,21 @@
 #ifndef RAVEN_DETECTOR_H
 #define RAVEN_DETECTOR_H
 
-#include <Arduino.h>
-#include <NimBLEAdvertisedDevice.h>
+#include <stdint.h>
+#include "hal/hal.h"
 #include "config/patterns.h"
 
+// Raven services found in one pass over an advertisement
+struct RavenFingerprint {
+    uint32_t services = 0;   // Bit RavenService set for each matched service
+    int primary = -1;        // First matched service in advertisement order
+};
+
 class RavenDetector {
 public:
-    static bool checkServiceUUID(NimBLEAdvertisedDevice* device, char* detectedServiceOut = nullptr);
-    static const char* getServiceDescription(const char* uuid);
-    static const char* estimateFirmwareVersion(NimBLEAdvertisedDevice* device);
-    static void outputDetectionJSON(NimBLEAdvertisedDevice* device, const char* mac, 
-                                   const char* name, int rssi);
+    static bool fingerprint(const BleAdvert& advert, RavenFingerprint* out);
+    static const char* getServiceDescription(int service);
+    static const char* estimateFirmwareVersion(uint32_t services);
 };
 
 #endif // RAVEN_DETECTOR_H
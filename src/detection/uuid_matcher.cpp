@@ -0,0 +1,73 @@
+#include "uuid_matcher.h"
+#include <string.h>
+#include <stdio.h>
+
+UUIDMatcher ravenUuidMatcher;
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static uint32_t readShort(const uint8_t* uuid128) {
+    return (uint32_t)uuid128[12] | ((uint32_t)uuid128[13] << 8) |
+           ((uint32_t)uuid128[14] << 16) | ((uint32_t)uuid128[15] << 24);
+}
+
+bool UUIDMatcher::parse(const char* text, uint8_t* uuid128Out) {
+    if (!text) return false;
+
+    // Text is big-endian; binary is stored little-endian
+    int digits = 0;
+    uint8_t be[16];
+    for (const char* p = text; *p; p++) {
+        if (*p == '-') continue;
+        int v = hexValue(*p);
+        if (v < 0 || digits >= 32) return false;
+        if (digits % 2 == 0) be[digits / 2] = v << 4;
+        else be[digits / 2] |= v;
+        digits++;
+    }
+    if (digits != 32) return false;
+
+    for (int i = 0; i < 16; i++) {
+        uuid128Out[i] = be[15 - i];
+    }
+    return true;
+}
+
+void UUIDMatcher::format(const uint8_t* uuid128, char* out) {
+    const uint8_t* u = uuid128;
+    snprintf(out, 37, "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+             u[15], u[14], u[13], u[12], u[11], u[10], u[9], u[8],
+             u[7], u[6], u[5], u[4], u[3], u[2], u[1], u[0]);
+}
+
+void UUIDMatcher::widen(uint32_t shortUuid, uint8_t* uuid128Out) {
+    // 00000000-0000-1000-8000-00805f9b34fb, little-endian
+    static const uint8_t BASE[12] = {0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00};
+    memcpy(uuid128Out, BASE, sizeof(BASE));
+    uuid128Out[12] = shortUuid & 0xFF;
+    uuid128Out[13] = (shortUuid >> 8) & 0xFF;
+    uuid128Out[14] = (shortUuid >> 16) & 0xFF;
+    uuid128Out[15] = (shortUuid >> 24) & 0xFF;
+}
+
+int UUIDMatcher::addUuid(const char* text) {
+    if (count >= UUID_MATCHER_MAX) return -1;
+    if (!parse(text, uuids[count])) return -1;
+    shortForm[count] = readShort(uuids[count]);
+    return (int)count++;
+}
+
+int UUIDMatcher::match(const uint8_t* uuid128) const {
+    uint32_t s = readShort(uuid128);
+    for (size_t i = 0; i < count; i++) {
+        if (shortForm[i] == s && memcmp(uuids[i], uuid128, 12) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
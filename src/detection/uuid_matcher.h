@@ -0,0 +1,53 @@
+#ifndef UUID_MATCHER_H
+#define UUID_MATCHER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// SERVICE UUID MATCHER
+// ============================================================================
+//
+// Up to 32 service UUIDs compiled from their text form into 128-bit binary
+// (little-endian, as carried over the air and in NimBLE's ble_uuid128_t).
+// Callers make a single pass over an advertisement's UUIDs and collect a
+// bitmask of matched entries (bit i = i-th UUID added), then derive
+// everything else from the mask without formatting UUIDs as strings.
+//
+// 16- and 32-bit advertised UUIDs are widened onto the Bluetooth base UUID
+// (0000xxxx-0000-1000-8000-00805f9b34fb) before matching, so a device that
+// advertises 0x180a matches the same entry as one advertising the full
+// 128-bit form. Entries are indexed by their 32-bit short form (bytes 12-15)
+// with the remaining 96 bits checked once per candidate.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define UUID_MATCHER_MAX 32
+
+class UUIDMatcher {
+public:
+    // Parse "0000180a-0000-1000-8000-00805f9b34fb" (dashes optional).
+    // Returns the entry index, or -1 if the text is invalid or the table is full.
+    int addUuid(const char* text);
+    void clear() { count = 0; }
+
+    // Index of a 128-bit UUID (little-endian bytes), or -1
+    int match(const uint8_t* uuid128) const;
+
+    size_t size() const { return count; }
+
+    static bool parse(const char* text, uint8_t* uuid128Out);
+    static void format(const uint8_t* uuid128, char* out);  // out must hold 37 bytes
+
+    // 16- or 32-bit UUID on the Bluetooth base UUID, as 128-bit little-endian
+    static void widen(uint32_t shortUuid, uint8_t* uuid128Out);
+
+private:
+    uint8_t uuids[UUID_MATCHER_MAX][16];
+    uint32_t shortForm[UUID_MATCHER_MAX];
+    size_t count = 0;
+};
+
+extern UUIDMatcher ravenUuidMatcher;
+
+#endif // UUID_MATCHER_H
@@ -1,242 +1,169 @@
 #include "wifi_detector.h"
-#include "detection_state.h"
-#include "hardware/led_controller.h"
-#include "hardware/buzzer.h"
-#include "hardware/gps_manager.h"
-#include "hardware/sd_logger.h"
-#include "hardware/data_manager.h"
+#include "detection_pipeline.h"
+#include "frame_parser.h"
+#include "hardware/packet_capture.h"
 #include "config/settings.h"
-#include <ArduinoJson.h>
+#include "system/metrics.h"
 #include <string.h>
 
 WiFiDetector wifiDetector;
 
-// Priority channels (non-overlapping 2.4GHz channels)
-const uint8_t WiFiDetector::PRIORITY_CHANNELS[3] = {1, 6, 11};
-
-// WiFi frame structures
-typedef struct {
-    unsigned frame_ctrl:16;
-    unsigned duration_id:16;
-    uint8_t addr1[6];
-    uint8_t addr2[6];
-    uint8_t addr3[6];
-    unsigned sequence_ctrl:16;
-    uint8_t addr4[6];
-} wifi_ieee80211_mac_hdr_t;
-
-typedef struct {
-    wifi_ieee80211_mac_hdr_t hdr;
-    uint8_t payload[0];
-} wifi_ieee80211_packet_t;
-
-void outputWiFiDetectionJSON(const char* ssid, const uint8_t* mac, int rssi, 
-                            const char* detectionType, uint8_t channel);
+static MetricHistogram sniffLatency("wifi.sniff");        // Promiscuous callback
+static MetricHistogram processLatency("wifi.process");    // Pipeline, per queued frame
+static MetricCounter mgmtFrames("wifi.mgmt_frames");
+static MetricCounter channelHops("wifi.channel_hops");
+static MetricGauge channelGauge("wifi.channel");
 
 void WiFiDetector::begin() {
     WiFi.mode(WIFI_STA);
     WiFi.disconnect();
-    delay(100);
+    
+    // Frame processing runs on Core 1, off the WiFi driver task
+    xTaskCreatePinnedToCore(
+        processTaskEntry,
+        "WiFi_Process",
+        WIFI_TASK_STACK_SIZE,
+        this,
+        2,
+        &processTask,
+        1
+    );
     
     esp_wifi_set_promiscuous(true);
     esp_wifi_set_promiscuous_rx_cb(&wifi_sniffer_packet_handler);
+    ChannelSchedulerConfig schedule;
+    schedule.channels = MAX_CHANNEL;
+    schedule.base_dwell = settingsManager.getSettings().scan.channel_hop_interval;
+    schedule.min_dwell = CHANNEL_DWELL_MIN;
+    schedule.max_dwell = CHANNEL_DWELL_MAX;
+    schedule.lock_time = CHANNEL_LOCK_TIME;
+    schedule.max_revisit = CHANNEL_MAX_REVISIT;
+    scheduler.begin(schedule, millis());
+    currentChannel = scheduler.current();
+    
     esp_wifi_set_channel(currentChannel, WIFI_SECOND_CHAN_NONE);
     
+    // Dwells are 80-800 ms: hopping on its own tick keeps them off the main
+    // loop's period, which would round every dwell up to its 100 ms steps
+    xTaskCreatePinnedToCore(
+        hopTaskEntry,
+        "WiFi_Hop",
+        WIFI_HOP_TASK_STACK_SIZE,
+        this,
+        2,
+        &hopTask,
+        1
+    );
+    
     printf("WiFi promiscuous mode enabled on channel %d\n", currentChannel);
 }
 
+void WiFiDetector::hopTaskEntry(void* parameter) {
+    WiFiDetector* detector = static_cast<WiFiDetector*>(parameter);
+    TickType_t lastWake = xTaskGetTickCount();
+    while (1) {
+        detector->hopChannel();
+        vTaskDelayUntil(&lastWake, CHANNEL_HOP_TICK / portTICK_PERIOD_MS);
+    }
+}
+
 void WiFiDetector::hopChannel() {
-    unsigned long now = millis();
-    if (now - lastChannelHop > CHANNEL_HOP_INTERVAL) {
-        // Always do sequential scanning to ensure we hit all channels
-        currentChannel++;
-        if (currentChannel > MAX_CHANNEL) {
-            currentChannel = 1;
-            channelCycleCount++;
+    uint32_t now = millis();
+    
+    // Matches found by the processing task since the last call
+    uint16_t matches[CHANNEL_SCHEDULER_MAX_CHANNELS + 1];
+    portENTER_CRITICAL(&matchLock);
+    memcpy(matches, pendingMatches, sizeof(matches));
+    memset(pendingMatches, 0, sizeof(pendingMatches));
+    portEXIT_CRITICAL(&matchLock);
+    
+    for (uint8_t ch = 1; ch <= CHANNEL_SCHEDULER_MAX_CHANNELS; ch++) {
+        for (uint16_t n = 0; n < matches[ch]; n++) {
+            scheduler.recordMatch(ch, now);
         }
-        
-        // When idle (no recent detections), spend extra time on priority channels
-        // by revisiting them after each full cycle
-        if (now - lastDetection > 10000 && channelCycleCount > 0) {
-            // Every other hop, use a priority channel for extra coverage
-            static bool usePriority = false;
-            if (usePriority) {
-                currentChannel = PRIORITY_CHANNELS[priorityChannelIdx];
-                priorityChannelIdx = (priorityChannelIdx + 1) % 3;
-            }
-            usePriority = !usePriority;
-        }
-        
+    }
+    
+    if (!scheduler.due(now)) return;
+    
+    // Taken and zeroed in one step so frames counted in between are not lost
+    uint32_t frames = dwellFrames.exchange(0, std::memory_order_relaxed);
+    ChannelHop hop = scheduler.next(frames, now);
+    
+    if (hop.channel != currentChannel) {
+        currentChannel = hop.channel;
         esp_wifi_set_channel(currentChannel, WIFI_SECOND_CHAN_NONE);
-        lastChannelHop = now;
-        printf("[WiFi] Hopped to channel %d\n", currentChannel);
+        channelHops.add();
+        channelGauge.set(currentChannel);
     }
+    printf("[WiFi] Channel %d for %d ms%s\n", currentChannel, hop.dwellMs,
+           hop.locked ? " (locked)" : hop.overdue ? " (overdue)" : "");
 }
 
-void WiFiDetector::recordDetection() {
-    lastDetection = millis();
+void WiFiDetector::recordDetection(uint8_t channel) {
+    if (channel > CHANNEL_SCHEDULER_MAX_CHANNELS) return;
+    portENTER_CRITICAL(&matchLock);
+    pendingMatches[channel]++;
+    portEXIT_CRITICAL(&matchLock);
 }
 
-bool WiFiDetector::checkMacPrefix(const uint8_t* mac) {
-    char mac_str[9];
-    snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x", mac[0], mac[1], mac[2]);
-    
-    for (int i = 0; i < sizeof(mac_prefixes)/sizeof(mac_prefixes[0]); i++) {
-        if (strncasecmp(mac_str, mac_prefixes[i], 8) == 0) {
-            return true;
-        }
+bool WiFiDetector::queueFrame(const WiFiFrame& frame) {
+    if (!frameRing.push(frame)) {
+        return false;
+    }
+    if (processTask) {
+        xTaskNotifyGive(processTask);
     }
-    return false;
+    return true;
 }
 
-bool WiFiDetector::checkSsidPattern(const char* ssid) {
-    if (!ssid) return false;
-    
-    for (int i = 0; i < sizeof(wifi_ssid_patterns)/sizeof(wifi_ssid_patterns[0]); i++) {
-        if (strcasestr(ssid, wifi_ssid_patterns[i])) {
-            return true;
-        }
+void WiFiDetector::processTaskEntry(void* parameter) {
+    WiFiDetector* detector = static_cast<WiFiDetector*>(parameter);
+    while (1) {
+        // Sleep until the sniffer queues a frame (timeout keeps drop reports flowing)
+        ulTaskNotifyTake(pdTRUE, 1000 / portTICK_PERIOD_MS);
+        detector->processQueuedFrames();
+        detector->reportDrops();
     }
-    return false;
 }
 
-void wifi_sniffer_packet_handler(void* buff, wifi_promiscuous_pkt_type_t type) {
-    const wifi_promiscuous_pkt_t *ppkt = (wifi_promiscuous_pkt_t *)buff;
-    const wifi_ieee80211_packet_t *ipkt = (wifi_ieee80211_packet_t *)ppkt->payload;
-    const wifi_ieee80211_mac_hdr_t *hdr = &ipkt->hdr;
-    
-    // Filter out weak signals (likely too far or noise)
-    const int RSSI_THRESHOLD = -85;
-    if (ppkt->rx_ctrl.rssi < RSSI_THRESHOLD) {
-        return;
-    }
-    
-    uint8_t frame_type = (hdr->frame_ctrl & 0xFF) >> 2;
-    if (frame_type != 0x20 && frame_type != 0x80) {
-        return;
-    }
-    
-    char ssid[33] = {0};
-    uint8_t *payload = (uint8_t *)ipkt + 24;
-    
-    if (frame_type == 0x20) {
-        payload += 0;
-    } else {
-        payload += 12;
-    }
-    
-    if (payload[0] == 0 && payload[1] <= 32) {
-        memcpy(ssid, &payload[2], payload[1]);
-        ssid[payload[1]] = '\0';
-    }
-    
-    // Check SSID match
-    if (strlen(ssid) > 0 && WiFiDetector::checkSsidPattern(ssid)) {
-        const char* detection_type = (frame_type == 0x20) ? "probe_request" : "beacon";
-        outputWiFiDetectionJSON(ssid, hdr->addr2, ppkt->rx_ctrl.rssi, detection_type, wifiDetector.getCurrentChannel());
-        
-        wifiDetector.recordDetection();  // Track detection for adaptive hopping
-        
-        // Record in database and check if known device
-        char mac_str[18];
-        snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
-                 hdr->addr2[0], hdr->addr2[1], hdr->addr2[2], 
-                 hdr->addr2[3], hdr->addr2[4], hdr->addr2[5]);
-        
-        HardwareConfig& hw = settingsManager.getHardware();
-        
-        double lat = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.latitude() : 0.0;
-        double lon = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.longitude() : 0.0;
-        bool isKnown = false;
-        
-        if (hw.enable_sd_card) {
-            isKnown = dataManager.recordDetection(mac_str, "WiFi", ppkt->rx_ctrl.rssi, lat, lon);
+void WiFiDetector::processQueuedFrames() {
+    WiFiFrame frame;
+    while (frameRing.pop(frame)) {
+        MetricTimer timer(processLatency);
+        if (detectionPipeline.processWiFi(frame)) {
+            recordDetection(frame.channel);  // Weight this channel in the hop schedule
         }
-        
-        if (!detectionState.triggered) {
-            if (isKnown) {
-                // Known device - less urgent alert
-                if (hw.enable_leds) LED.knownDeviceAlert();
-                if (hw.enable_buzzer) buzzer.knownDeviceBeep();
-            } else {
-                // New device - full alert
-                if (hw.enable_buzzer || hw.enable_leds) buzzer.detectionAlert();
-            }
-        }
-        detectionState.recordDetection(true);
-        return;
     }
-    
-    // Check MAC match
-    if (WiFiDetector::checkMacPrefix(hdr->addr2)) {
-        const char* detection_type = (frame_type == 0x20) ? "probe_request_mac" : "beacon_mac";
-        outputWiFiDetectionJSON(ssid[0] ? ssid : "hidden", hdr->addr2, ppkt->rx_ctrl.rssi, 
-                               detection_type, wifiDetector.getCurrentChannel());
-        
-        wifiDetector.recordDetection();  // Track detection for adaptive hopping
-        
-        // Record in database and check if known device
-        char mac_str[18];
-        snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
-                 hdr->addr2[0], hdr->addr2[1], hdr->addr2[2], 
-                 hdr->addr2[3], hdr->addr2[4], hdr->addr2[5]);
-        
-        HardwareConfig& hw = settingsManager.getHardware();
-        
-        double lat = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.latitude() : 0.0;
-        double lon = (hw.enable_gps && gpsManager.isValid()) ? gpsManager.longitude() : 0.0;
-        bool isKnown = false;
-        
-        if (hw.enable_sd_card) {
-            isKnown = dataManager.recordDetection(mac_str, "WiFi", ppkt->rx_ctrl.rssi, lat, lon);
-        }
-        
-        if (!detectionState.triggered) {
-            if (isKnown) {
-                if (hw.enable_leds) LED.knownDeviceAlert();
-                if (hw.enable_buzzer) buzzer.knownDeviceBeep();
-            } else {
-                if (hw.enable_buzzer || hw.enable_leds) buzzer.detectionAlert();
-            }
-        }
-        detectionState.recordDetection(true);
-        return;
+}
+
+void WiFiDetector::reportDrops() {
+    uint32_t dropped = frameRing.droppedCount();
+    if (dropped != lastReportedDrops && millis() - lastDropReport > 10000) {
+        printf("[WiFi] Frame queue overflow: %u dropped (%u total), high water %u/%u\n",
+               (unsigned)(dropped - lastReportedDrops), (unsigned)dropped,
+               (unsigned)frameRing.highWaterMark(), (unsigned)frameRing.capacity());
+        lastReportedDrops = dropped;
+        lastDropReport = millis();
     }
 }
 
-void outputWiFiDetectionJSON(const char* ssid, const uint8_t* mac, int rssi,
-                            const char* detectionType, uint8_t channel) {
-    DynamicJsonDocument doc(2048);
+// Runs in the WiFi driver task - only copies what the processing task needs
+void wifi_sniffer_packet_handler(void* buff, wifi_promiscuous_pkt_type_t type) {
+    if (type != WIFI_PKT_MGMT) return;
+    MetricTimer timer(sniffLatency);
+    mgmtFrames.add();
     
-    doc["timestamp"] = millis();
-    doc["detection_time"] = String(millis() / 1000.0, 3) + "s";
-    doc["protocol"] = "wifi";
-    doc["detection_method"] = detectionType;
-    doc["alert_level"] = "HIGH";
-    doc["device_category"] = "FLOCK_SAFETY";
-    doc["ssid"] = ssid;
-    doc["rssi"] = rssi;
-    doc["channel"] = channel;
+    const wifi_promiscuous_pkt_t *ppkt = (wifi_promiscuous_pkt_t *)buff;
+    int8_t rssi = ppkt->rx_ctrl.rssi;
+    uint8_t channel = ppkt->rx_ctrl.channel;
     
-    char mac_str[18];
-    snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
-             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-    doc["mac_address"] = mac_str;
+    // Record everything the radio hands over, before filtering
+    packetCapture.captureWiFi(ppkt->payload, ppkt->rx_ctrl.sig_len, rssi, channel);
     
-    if (gpsManager.isValid()) {
-        doc["gps_latitude"] = gpsManager.latitude();
-        doc["gps_longitude"] = gpsManager.longitude();
-        doc["gps_altitude"] = gpsManager.altitude();
-        doc["gps_satellites"] = gpsManager.satellites();
-    } else {
-        doc["gps_status"] = gpsManager.getStatus().c_str();
+    WiFiFrame frame;
+    if (!parseWiFiFrame(ppkt->payload, ppkt->rx_ctrl.sig_len, rssi, channel, millis(), &frame)) {
+        return;
     }
-    
-    serializeJson(doc, Serial);
-    Serial.println();
-    
-    sdLogger.logDetection("wifi", detectionType, mac_str, rssi, ssid, nullptr,
-                         gpsManager.isValid(), gpsManager.latitude(), gpsManager.longitude());
-    
-    LED.flash(LEDController::COLOR_BLUE, 1, 200);
+    wifiDetector.countFrame();
+    wifiDetector.queueFrame(frame);
 }
@@ -3,29 +3,52 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <atomic>
 #include "esp_wifi.h"
 #include "esp_wifi_types.h"
 #include "config/pins.h"
 #include "config/patterns.h"
+#include "frame_ring.h"
+#include "hal/hal.h"
+#include "channel_scheduler.h"
 
 class WiFiDetector {
 public:
     void begin();
-    void hopChannel();
-    void recordDetection();
+    void hopChannel();  // Hop task, every CHANNEL_HOP_TICK
+    void recordDetection(uint8_t channel);  // Processing task - feeds the channel scheduler
+    void countFrame() { dwellFrames.fetch_add(1, std::memory_order_relaxed); }  // Sniffer callback
     uint8_t getCurrentChannel() { return currentChannel; }
-    
-    // Detection helpers
-    static bool checkMacPrefix(const uint8_t* mac);
-    static bool checkSsidPattern(const char* ssid);
+    ChannelScheduler& getScheduler() { return scheduler; }
+
+    // Frame queue (producer: sniffer callback, consumer: processing task)
+    bool queueFrame(const WiFiFrame& frame);
+    void processQueuedFrames();
+
+    // Queue statistics
+    uint32_t getFramesQueued() { return frameRing.pushedCount(); }
+    uint32_t getFramesDropped() { return frameRing.droppedCount(); }
+    uint32_t getQueueHighWater() { return frameRing.highWaterMark(); }
+    uint32_t getQueueCapacity() { return frameRing.capacity(); }
+    TaskHandle_t getProcessTask() { return processTask; }
+    TaskHandle_t getHopTask() { return hopTask; }
 
 private:
     uint8_t currentChannel = 1;
-    unsigned long lastChannelHop = 0;
-    uint8_t priorityChannelIdx = 0;
-    unsigned long lastDetection = 0;
-    uint8_t channelCycleCount = 0;  // Track full channel scans
-    static const uint8_t PRIORITY_CHANNELS[3];
+    ChannelScheduler scheduler;  // Hop task only
+    std::atomic<uint32_t> dwellFrames{0};  // Sniffer callback counts, hop task takes
+    uint16_t pendingMatches[CHANNEL_SCHEDULER_MAX_CHANNELS + 1] = {0};  // Per channel, guarded by matchLock
+    portMUX_TYPE matchLock = portMUX_INITIALIZER_UNLOCKED;
+
+    FrameRing<WiFiFrame, WIFI_FRAME_RING_SIZE> frameRing;
+    TaskHandle_t processTask = nullptr;
+    TaskHandle_t hopTask = nullptr;
+    uint32_t lastReportedDrops = 0;
+    unsigned long lastDropReport = 0;
+
+    void reportDrops();
+    static void processTaskEntry(void* parameter);
+    static void hopTaskEntry(void* parameter);
 };
 
 extern WiFiDetector wifiDetector;
@@ -0,0 +1,155 @@
+#include "esp32_hal.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config/settings.h"
+#include "hardware/gps_manager.h"
+#include "hardware/data_manager.h"
+#include "hardware/sd_logger.h"
+#include "hardware/led_controller.h"
+#include "hardware/buzzer.h"
+
+uint32_t halMillis() {
+    return millis();
+}
+
+int64_t halMicros() {
+    return esp_timer_get_time();
+}
+
+uint32_t halCycles() {
+    return ESP.getCycleCount();
+}
+
+uint32_t halCyclesPerMicro() {
+    return ESP.getCpuFreqMHz();
+}
+
+// ============================================================================
+// IMPLEMENTATIONS
+// ============================================================================
+
+class GpsLocation : public LocationSource {
+public:
+    void getFix(GpsFix* out) override {
+        if (settingsManager.getHardware().enable_gps) {
+            gpsManager.getFix(out);     // Lock-free copy of the GPS task's latest fix
+        } else {
+            *out = GpsFix();
+        }
+    }
+
+    bool getFixAt(uint32_t time, GpsFix* out) override {
+        if (settingsManager.getHardware().enable_gps) {
+            return gpsManager.getFixAt(time, out);
+        }
+        *out = GpsFix();
+        return true;
+    }
+};
+
+class SdDetectionStore : public DetectionStore {
+public:
+    bool record(const DetectionRecord& rec) override {
+        double lat = rec.fix->valid ? rec.fix->latitude : 0.0;
+        double lon = rec.fix->valid ? rec.fix->longitude : 0.0;
+        
+        sdLogger.logDetection(rec.time, rec.protocol, rec.method, rec.macStr, rec.rssi, rec.ssid, rec.name,
+                              rec.fix->valid, lat, lon);
+        
+        if (!settingsManager.getHardware().enable_sd_card) return false;
+        return dataManager.recordDetection(rec.mac, rec.type, rec.rssi, lat, lon, rec.time);
+    }
+
+    bool isKnown(const uint8_t* mac) override {
+        if (!settingsManager.getHardware().enable_sd_card) return false;
+        return dataManager.isKnownDevice(mac);
+    }
+};
+
+class BoardAlerts : public AlertOutput {
+public:
+    void detected(DeviceType type) override {
+        switch (type) {
+            case DEVICE_RAVEN: LED.ravenDetectionStrobe(); break;
+            case DEVICE_BLE:   LED.flash(LEDController::COLOR_PURPLE, 1, 200); break;
+            default:           LED.flash(LEDController::COLOR_BLUE, 1, 200); break;
+        }
+    }
+    
+    void firstDetection(bool known) override {
+        HardwareConfig& hw = settingsManager.getHardware();
+        if (known) {
+            if (hw.enable_leds) LED.knownDeviceAlert();
+            if (hw.enable_buzzer) buzzer.knownDeviceBeep();
+        } else {
+            if (hw.enable_buzzer || hw.enable_leds) buzzer.detectionAlert();
+        }
+    }
+};
+
+class SerialEventSink : public EventSink {
+public:
+    void write(const uint8_t* data, size_t len) override {
+        Serial.write(data, len);
+    }
+};
+
+static GpsLocation gpsLocation;
+static SdDetectionStore sdStore;
+static BoardAlerts boardAlerts;
+static SerialEventSink serialEvents;
+
+HalContext esp32HalContext() {
+    HalContext hal = {&gpsLocation, &sdStore, &boardAlerts, &serialEvents};
+    return hal;
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+bool SdFileReader::open(const char* path) {
+    if (!sdLogger.isInitialized()) return false;
+    xSemaphoreTake(sdLogger.getLock(), portMAX_DELAY);
+    if (SD.exists(path)) file = SD.open(path, FILE_READ);
+    bool ok = (bool)file;
+    fileSize = ok ? file.size() : 0;
+    xSemaphoreGive(sdLogger.getLock());
+    return ok;
+}
+
+bool SdFileReader::readAt(uint32_t offset, uint8_t* out, size_t len) {
+    if (offset + len > fileSize) return false;
+    xSemaphoreTake(sdLogger.getLock(), portMAX_DELAY);
+    bool ok = file.seek(offset) && file.read(out, len) == len;
+    xSemaphoreGive(sdLogger.getLock());
+    return ok;
+}
+
+class SdFileHandle : public FileHandle {
+public:
+    explicit SdFileHandle(File opened) : file(opened) {}
+    ~SdFileHandle() override { file.close(); }
+
+    size_t read(uint8_t* out, size_t len) override { return file.read(out, len); }
+    size_t write(const uint8_t* data, size_t len) override { return file.write(data, len); }
+    bool seek(uint32_t offset) override { return file.seek(offset); }
+    uint32_t size() override { return file.size(); }
+    bool flush() override {
+        file.flush();
+        return true;
+    }
+
+private:
+    File file;
+};
+
+SdFileSystem sdFileSystem;
+
+FileHandle* SdFileSystem::open(const char* path, FileMode mode) {
+    const char* how = mode == FILE_MODE_APPEND ? FILE_APPEND :
+                      mode == FILE_MODE_WRITE ? FILE_WRITE : FILE_READ;
+    File file = SD.open(path, how);
+    if (!file) return nullptr;
+    return new SdFileHandle(file);
+}
@@ -0,0 +1,34 @@
+#ifndef ESP32_HAL_H
+#define ESP32_HAL_H
+
+#include <SD.h>
+#include "hal.h"
+
+// HAL backed by the board singletons (gpsManager, dataManager, sdLogger, LED,
+// buzzer, Serial). Hardware enable flags from settings are honoured here.
+HalContext esp32HalContext();
+
+// A file on the SD card, read under sdLogger's lock
+class SdFileReader : public FileReader {
+public:
+    bool open(const char* path);
+    bool readAt(uint32_t offset, uint8_t* out, size_t len) override;
+    uint32_t size() { return fileSize; }
+
+private:
+    File file;
+    uint32_t fileSize = 0;
+};
+
+// Files on the SD card through the Arduino SD library
+class SdFileSystem : public FileSystem {
+public:
+    FileHandle* open(const char* path, FileMode mode) override;
+    bool exists(const char* path) override { return SD.exists(path); }
+    bool remove(const char* path) override { return SD.remove(path); }
+    bool rename(const char* from, const char* to) override { return SD.rename(from, to); }
+};
+
+extern SdFileSystem sdFileSystem;
+
+#endif // ESP32_HAL_H
@@ -0,0 +1,205 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hardware/device_table.h"
+
+// ============================================================================
+// HARDWARE ABSTRACTION
+// ============================================================================
+//
+// Thin interfaces between the detection pipeline and the board. The ESP32
+// implementations (esp32_hal.cpp) forward to the existing hardware singletons;
+// the native ones (native_hal.cpp) let the same pipeline run on a Linux host
+// for tests, trace replay and benchmarks. Exactly one of the two is linked,
+// chosen by build_src_filter in platformio.ini.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+uint32_t halMillis();
+int64_t halMicros();
+
+// Free-running cycle counter for short latency measurements (wraps; take
+// differences only). On the ESP32 it is the per-core CCOUNT register.
+uint32_t halCycles();
+uint32_t halCyclesPerMicro();
+
+// ============================================================================
+// RADIO INPUT
+// ============================================================================
+
+// Compact copy of a sniffed management frame, queued by the promiscuous
+// callback and consumed by the WiFi processing task
+struct WiFiFrame {
+    uint8_t mac[6];         // Transmitter address (addr2)
+    uint8_t frame_type;     // 0x20 = probe request, 0x80 = beacon
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t ssid_len;
+    char ssid[33];          // NUL-terminated, empty if hidden
+    uint32_t timestamp;     // millis() at capture
+};
+
+#define BLE_ADVERT_MAX_UUIDS 8    // Every Raven service; 16-bit forms fit 14 in one advert
+
+// The parts of a BLE advertisement the detectors look at
+struct BleAdvert {
+    uint8_t mac[6];         // Display order (most significant byte first)
+    int8_t rssi;
+    uint8_t uuid_count;     // Service UUIDs below (short forms widened)
+    char name[32];          // NUL-terminated, empty if not advertised
+    uint8_t uuids[BLE_ADVERT_MAX_UUIDS][16];  // 128-bit little-endian
+    uint32_t timestamp;     // millis() at capture
+};
+
+enum RadioPacketKind : uint8_t {
+    RADIO_WIFI = 0,
+    RADIO_BLE = 1
+};
+
+struct RadioPacket {
+    RadioPacketKind kind;
+    int64_t micros;         // Capture time
+    WiFiFrame wifi;
+    BleAdvert ble;
+};
+
+// Pull-style packet source for host drivers (trace replay, generators). On
+// the device the sniffer and NimBLE callbacks push packets instead.
+class RadioSource {
+public:
+    virtual ~RadioSource() {}
+    virtual bool next(RadioPacket* out) = 0;  // false when exhausted
+};
+
+// ============================================================================
+// GPS
+// ============================================================================
+
+struct GpsFix {
+    bool valid = false;
+    double latitude = 0;
+    double longitude = 0;
+    double altitude = 0;
+    int satellites = 0;
+    const char* status = "NO_GPS";  // Reported when not valid
+    bool hasCourse = false;         // Course and speed from the same fix
+    float course = 0;               // Degrees, 0 = north
+    float speedKmh = 0;
+    bool hasTime = false;           // UTC date and time below
+    uint16_t year = 0;
+    uint8_t month = 0;
+    uint8_t day = 0;
+    uint8_t hour = 0;
+    uint8_t minute = 0;
+    uint8_t second = 0;
+    uint32_t timestamp = 0;         // halMillis() when the fix started arriving
+};
+
+class LocationSource {
+public:
+    virtual ~LocationSource() {}
+    virtual void getFix(GpsFix* out) = 0;
+
+    // Fix placed at a past halMillis() time (a packet's capture time) from
+    // the track of recent fixes. Returns true when final; false while the
+    // fix after that time has not arrived yet and out is extrapolated.
+    virtual bool getFixAt(uint32_t time, GpsFix* out) = 0;
+};
+
+// ============================================================================
+// STORAGE
+// ============================================================================
+
+// One emitted detection, as persisted to the database and CSV log
+struct DetectionRecord {
+    const uint8_t* mac;
+    const char* macStr;
+    DeviceType type;
+    const char* protocol;    // "wifi" or "ble"
+    const char* method;
+    int rssi;
+    const char* ssid;        // WiFi only, may be null
+    const char* name;        // BLE only, may be null
+    const GpsFix* fix;
+    uint32_t time;           // halMillis() at capture
+};
+
+class DetectionStore {
+public:
+    virtual ~DetectionStore() {}
+    // Returns true if the device was already known
+    virtual bool record(const DetectionRecord& rec) = 0;
+    virtual bool isKnown(const uint8_t* mac) = 0;
+};
+
+// Read-only random access to a file (SD card on the device, stdio on a host)
+class FileReader {
+public:
+    virtual ~FileReader() {}
+    virtual bool readAt(uint32_t offset, uint8_t* out, size_t len) = 0;
+};
+
+enum FileMode : uint8_t {
+    FILE_MODE_READ = 0,
+    FILE_MODE_WRITE = 1,    // Created or truncated
+    FILE_MODE_APPEND = 2    // Created if missing, writes go to the end
+};
+
+// An open file; deleting the handle closes it (and flushes what was written)
+class FileHandle {
+public:
+    virtual ~FileHandle() {}
+    virtual size_t read(uint8_t* out, size_t len) = 0;
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+    virtual bool seek(uint32_t offset) = 0;
+    virtual uint32_t size() = 0;
+    virtual bool flush() = 0;   // Written data survives a power cut once this returns true
+};
+
+// Files by path (SD card on the device, memory on a host). Removing and
+// renaming are taken to be atomic.
+class FileSystem {
+public:
+    virtual ~FileSystem() {}
+    virtual FileHandle* open(const char* path, FileMode mode) = 0;  // nullptr on failure
+    virtual bool exists(const char* path) = 0;
+    virtual bool remove(const char* path) = 0;
+    virtual bool rename(const char* from, const char* to) = 0;
+};
+
+// ============================================================================
+// LEDS AND BUZZER
+// ============================================================================
+
+class AlertOutput {
+public:
+    virtual ~AlertOutput() {}
+    virtual void detected(DeviceType type) = 0;   // Every emitted detection
+    virtual void firstDetection(bool known) = 0;  // First detection of a burst
+};
+
+// ============================================================================
+// EVENT OUTPUT
+// ============================================================================
+
+class EventSink {
+public:
+    virtual ~EventSink() {}
+    virtual void write(const uint8_t* data, size_t len) = 0;
+};
+
+// Everything the pipeline talks to
+struct HalContext {
+    LocationSource* location;
+    DetectionStore* store;
+    AlertOutput* alerts;
+    EventSink* events;
+};
+
+#endif // HAL_H
@@ -0,0 +1,265 @@
+#include "native_hal.h"
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "location/geo.h"
+
+static bool simulatedClock = false;
+static int64_t simulatedMicros = 0;
+
+static int64_t realMicros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void nativeSetTime(int64_t micros) {
+    simulatedClock = true;
+    simulatedMicros = micros;
+}
+
+void nativeUseRealTime() {
+    simulatedClock = false;
+}
+
+uint32_t halMillis() {
+    return (uint32_t)(halMicros() / 1000);
+}
+
+int64_t halMicros() {
+    return simulatedClock ? simulatedMicros : realMicros();
+}
+
+// Nanoseconds of real time (the simulated clock does not apply)
+uint32_t halCycles() {
+    static const auto start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t halCyclesPerMicro() {
+    return 1000;
+}
+
+// ============================================================================
+// IMPLEMENTATIONS
+// ============================================================================
+
+void FixedLocation::set(double latitude, double longitude) {
+    fix.valid = true;
+    fix.latitude = latitude;
+    fix.longitude = longitude;
+    fix.satellites = 8;
+}
+
+void FixedLocation::clear() {
+    fix = GpsFix();
+}
+
+void FixedLocation::getFix(GpsFix* out) {
+    *out = fix;
+}
+
+bool FixedLocation::getFixAt(uint32_t, GpsFix* out) {
+    *out = fix;
+    return true;
+}
+
+void TrackLocation::addFix(uint32_t time, double latitude, double longitude) {
+    latest.valid = true;
+    latest.latitude = latitude;
+    latest.longitude = longitude;
+    latest.satellites = 8;
+    latest.status = "FIX";
+    latest.timestamp = time;
+    track.add(time, toMicrodegrees(latitude), toMicrodegrees(longitude));
+}
+
+void TrackLocation::getFix(GpsFix* out) {
+    *out = latest;
+}
+
+bool TrackLocation::getFixAt(uint32_t time, GpsFix* out) {
+    return trackFixAt(track, latest, time, halMillis(), out);
+}
+
+bool MemoryDetectionStore::begin(uint32_t capacity) {
+    records = 0;
+    return devices.init(capacity);
+}
+
+bool MemoryDetectionStore::record(const DetectionRecord& rec) {
+    records++;
+    uint64_t key = macToKey(rec.mac);
+    uint32_t now = halMillis();
+
+    DeviceRecord* dev = devices.find(key);
+    bool known = dev != nullptr;
+    if (!dev) {
+        dev = devices.insert(key);
+        if (!dev) return false;
+        dev->first_seen = now;
+        dev->type = rec.type;
+    }
+    dev->last_seen = now;
+    dev->detection_count++;
+    dev->rssi = rec.rssi;
+    return known;
+}
+
+bool MemoryDetectionStore::isKnown(const uint8_t* mac) {
+    return devices.find(macToKey(mac)) != nullptr;
+}
+
+void CountingAlerts::detected(DeviceType) {
+    detectedCount++;
+}
+
+void CountingAlerts::firstDetection(bool) {
+    firstCount++;
+}
+
+void StreamEventSink::write(const uint8_t* data, size_t len) {
+    events++;
+    bytes += len;
+    if (out) fwrite(data, 1, len, out);
+}
+
+StdioFileReader::~StdioFileReader() {
+    if (file) fclose(file);
+}
+
+bool StdioFileReader::open(const char* path) {
+    if (file) fclose(file);
+    file = fopen(path, "rb");
+    return file != nullptr;
+}
+
+bool StdioFileReader::readAt(uint32_t offset, uint8_t* out, size_t len) {
+    reads++;
+    return file && fseek(file, offset, SEEK_SET) == 0 && fread(out, 1, len, file) == len;
+}
+
+class MemoryFileHandle : public FileHandle {
+public:
+    MemoryFileHandle(MemoryFileSystem* owner, std::shared_ptr<MemoryFileSystem::File> opened, bool append)
+        : fs(owner), file(opened), appending(append), epoch(owner->epoch) {}
+
+    ~MemoryFileHandle() override {
+        if (alive()) file->durable = file->data.size();
+    }
+
+    size_t read(uint8_t* out, size_t len) override {
+        if (!alive() || position >= file->data.size()) return 0;
+        size_t n = std::min(len, file->data.size() - position);
+        memcpy(out, file->data.data() + position, n);
+        position += n;
+        return n;
+    }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        if (!alive() || !fs->spend()) return 0;
+        if (appending) position = file->data.size();
+        if (file->data.size() < position + len) file->data.resize(position + len);
+        memcpy(file->data.data() + position, data, len);
+        position += len;
+        fs->writes++;
+        return len;
+    }
+
+    bool seek(uint32_t offset) override {
+        if (!alive() || offset > file->data.size()) return false;
+        position = offset;
+        return true;
+    }
+
+    uint32_t size() override {
+        return alive() ? file->data.size() : 0;
+    }
+
+    bool flush() override {
+        if (!alive() || !fs->spend()) return false;
+        file->durable = file->data.size();
+        fs->flushes++;
+        return true;
+    }
+
+private:
+    MemoryFileSystem* fs;
+    std::shared_ptr<MemoryFileSystem::File> file;
+    bool appending;
+    uint32_t epoch;
+    size_t position = 0;
+
+    bool alive() { return !fs->failed && epoch == fs->epoch; }
+};
+
+bool MemoryFileSystem::spend() {
+    if (failed) return false;
+    if (budget == 0) {
+        failed = true;
+        return false;
+    }
+    if (budget > 0) budget--;
+    return true;
+}
+
+FileHandle* MemoryFileSystem::open(const char* path, FileMode mode) {
+    if (failed) return nullptr;
+    auto it = files.find(path);
+    if (mode == FILE_MODE_READ) {
+        if (it == files.end()) return nullptr;
+        return new MemoryFileHandle(this, it->second, false);
+    }
+
+    if (!spend()) return nullptr;
+    if (it == files.end()) {
+        it = files.emplace(path, std::make_shared<File>()).first;
+    } else if (mode == FILE_MODE_WRITE) {
+        // Replaced by a new, empty file
+        it->second = std::make_shared<File>();
+    }
+    return new MemoryFileHandle(this, it->second, mode == FILE_MODE_APPEND);
+}
+
+bool MemoryFileSystem::exists(const char* path) {
+    return !failed && files.count(path) > 0;
+}
+
+bool MemoryFileSystem::remove(const char* path) {
+    if (!spend()) return false;
+    return files.erase(path) > 0;
+}
+
+bool MemoryFileSystem::rename(const char* from, const char* to) {
+    auto it = files.find(from);
+    if (it == files.end() || !spend()) return false;
+    files[to] = it->second;
+    files.erase(from);
+    return true;
+}
+
+void MemoryFileSystem::failAfter(uint32_t operations) {
+    budget = operations;
+}
+
+void MemoryFileSystem::powerCut(uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (auto& entry : files) {
+        File& file = *entry.second;
+        size_t unflushed = file.data.size() - file.durable;
+        size_t keep = file.durable + (unflushed ? rng() % (unflushed + 1) : 0);
+        file.data.resize(keep);
+        if (keep > file.durable && rng() % 2) file.data[keep - 1] ^= 0x5A;
+        file.durable = keep;
+    }
+    epoch++;
+    failed = false;
+    budget = -1;
+}
+
+const std::vector<uint8_t>* MemoryFileSystem::contents(const char* path) {
+    auto it = files.find(path);
+    return it == files.end() ? nullptr : &it->second->data;
+}
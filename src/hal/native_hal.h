@@ -0,0 +1,146 @@
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <stdio.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "hal.h"
+#include "location/gps_track.h"
+
+// ============================================================================
+// NATIVE HAL
+// ============================================================================
+//
+// Host implementations of the HAL for the [env:native] build. The clock runs
+// in real time until nativeSetTime() is called, after which it only moves
+// when the driver sets it (trace replay, simulations).
+
+void nativeSetTime(int64_t micros);
+void nativeUseRealTime();
+
+// Fixed position (or no fix)
+class FixedLocation : public LocationSource {
+public:
+    void set(double latitude, double longitude);
+    void clear();
+    void getFix(GpsFix* out) override;
+    bool getFixAt(uint32_t time, GpsFix* out) override;
+
+private:
+    GpsFix fix;
+};
+
+// Fixes fed by the driver (synthetic or recorded tracks), looked up the
+// same way as on the device
+class TrackLocation : public LocationSource {
+public:
+    void addFix(uint32_t time, double latitude, double longitude);
+    void getFix(GpsFix* out) override;
+    bool getFixAt(uint32_t time, GpsFix* out) override;
+
+    GpsTrack& getTrack() { return track; }
+
+private:
+    GpsTrack track;
+    GpsFix latest;
+};
+
+// Devices kept in memory; a device is "known" from its second detection
+class MemoryDetectionStore : public DetectionStore {
+public:
+    bool begin(uint32_t capacity);
+    bool record(const DetectionRecord& rec) override;
+    bool isKnown(const uint8_t* mac) override;
+
+    uint32_t getDevices() { return devices.size(); }
+    uint32_t getRecords() { return records; }
+
+private:
+    DeviceTable devices;
+    uint32_t records = 0;
+};
+
+// Counts alerts instead of driving LEDs and a buzzer
+class CountingAlerts : public AlertOutput {
+public:
+    void detected(DeviceType type) override;
+    void firstDetection(bool known) override;
+
+    uint32_t getDetected() { return detectedCount; }
+    uint32_t getFirstDetections() { return firstCount; }
+
+private:
+    uint32_t detectedCount = 0;
+    uint32_t firstCount = 0;
+};
+
+// Writes events to a stdio stream (nullptr = count only)
+class StreamEventSink : public EventSink {
+public:
+    explicit StreamEventSink(FILE* stream = nullptr) : out(stream) {}
+    void write(const uint8_t* data, size_t len) override;
+
+    uint32_t getEvents() { return events; }
+    uint64_t getBytes() { return bytes; }
+
+private:
+    FILE* out;
+    uint32_t events = 0;
+    uint64_t bytes = 0;
+};
+
+// A file read with stdio
+class StdioFileReader : public FileReader {
+public:
+    ~StdioFileReader();
+    bool open(const char* path);
+    bool readAt(uint32_t offset, uint8_t* out, size_t len) override;
+
+    uint32_t getReads() { return reads; }
+
+private:
+    FILE* file = nullptr;
+    uint32_t reads = 0;
+};
+
+// Files kept in memory. What was written to a file since its last flush (or
+// close) is what a power cut can lose: failAfter() makes every call fail from
+// the Nth write, flush, open for writing, remove or rename on, and powerCut()
+// then keeps a random part of each file's unflushed tail (the last byte kept
+// possibly garbled) and lets the filesystem work again. Handles opened before
+// the cut stay dead.
+class MemoryFileSystem : public FileSystem {
+public:
+    struct File {
+        std::vector<uint8_t> data;
+        size_t durable = 0;             // Bytes that survive a power cut
+    };
+
+    FileHandle* open(const char* path, FileMode mode) override;
+    bool exists(const char* path) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+
+    void failAfter(uint32_t operations);
+    bool hasFailed() { return failed; }
+    void powerCut(uint32_t seed);
+
+    const std::vector<uint8_t>* contents(const char* path);  // nullptr if missing
+    uint32_t getWrites() { return writes; }
+    uint32_t getFlushes() { return flushes; }
+
+private:
+    friend class MemoryFileHandle;
+    std::map<std::string, std::shared_ptr<File>> files;
+    int64_t budget = -1;                // Operations before failing, -1 = never
+    bool failed = false;
+    uint32_t epoch = 0;                 // Power cuts so far
+    uint32_t writes = 0;
+    uint32_t flushes = 0;
+
+    bool spend();                       // false once power is lost
+};
+
+#endif // NATIVE_HAL_H
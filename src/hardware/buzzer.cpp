@@ -13,69 +13,102 @@ void Buzzer::begin() {
         ledcAttachPin(BUZZER_PIN, pwmChannel);
         ledcWrite(pwmChannel, 0);  // Start silent
     }
+    
+    if (!stepTimer) {
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = stepTimerCallback;
+        timerArgs.arg = this;
+        timerArgs.name = "buzzer_step";
+        esp_timer_create(&timerArgs, &stepTimer);
+    }
 }
 
 void Buzzer::setType(BuzzerType type) {
     buzzerType = type;
 }
 
-void Buzzer::playToneActive(int duration) {
-    digitalWrite(BUZZER_PIN, HIGH);
-    delay(duration);
-    digitalWrite(BUZZER_PIN, LOW);
-}
+// ============================================================================
+// SEQUENCER
+// ============================================================================
 
-void Buzzer::playTonePassive(uint16_t frequency, uint16_t duration) {
-    ledcWriteTone(pwmChannel, frequency);
-    ledcWrite(pwmChannel, 128);  // 50% duty cycle
-    delay(duration);
-    ledcWrite(pwmChannel, 0);    // Stop tone
+void Buzzer::stepTimerCallback(void* arg) {
+    static_cast<Buzzer*>(arg)->advance();
 }
 
-void Buzzer::playMelody(const uint16_t* notes, const uint16_t* durations, uint8_t length) {
-    for (uint8_t i = 0; i < length; i++) {
-        if (notes[i] == 0) {
-            delay(durations[i]);  // Rest
+void Buzzer::output(uint16_t frequency) {
+    if (buzzerType == BUZZER_PASSIVE) {
+        if (frequency > 0) {
+            ledcWriteTone(pwmChannel, frequency);
+            ledcWrite(pwmChannel, 128);  // 50% duty cycle
         } else {
-            if (buzzerType == BUZZER_PASSIVE) {
-                playTonePassive(notes[i], durations[i]);
-            } else {
-                playToneActive(durations[i]);
-            }
+            ledcWrite(pwmChannel, 0);    // Stop tone
         }
-        delay(50);  // Small gap between notes
+    } else {
+        digitalWrite(BUZZER_PIN, frequency > 0 ? HIGH : LOW);
     }
 }
 
+void Buzzer::advance() {
+    ToneStep step;
+    
+    portENTER_CRITICAL(&mux);
+    bool more = sequencer.next(millis(), &step);
+    if (!more) timerRunning = false;
+    portEXIT_CRITICAL(&mux);
+    
+    if (!more) {
+        output(0);
+        return;
+    }
+    
+    output(step.frequency);
+    uint32_t duration = step.duration > 0 ? step.duration : 1;
+    esp_timer_start_once(stepTimer, (uint64_t)duration * 1000);
+}
+
+void Buzzer::play(const ToneSequence& sequence) {
+    if (!stepTimer) return;  // begin() not called (buzzer disabled)
+    
+    portENTER_CRITICAL(&mux);
+    bool start = sequencer.post(sequence, millis()) && !timerRunning;
+    if (start) timerRunning = true;
+    portEXIT_CRITICAL(&mux);
+    
+    // Idle - play the first step now, the timer takes it from there
+    if (start) advance();
+}
+
 void Buzzer::beep(int count, int duration, int gap) {
+    ToneSequence seq;
+    seq.sound = SOUND_BEEP;
     for (int i = 0; i < count; i++) {
-        if (buzzerType == BUZZER_PASSIVE) {
-            playTonePassive(2000, duration);  // 2kHz tone
-        } else {
-            playToneActive(duration);
-        }
-        if (i < count - 1) delay(gap);
+        seq.tone(2000, duration);  // 2kHz tone
+        if (i < count - 1) seq.rest(gap);
     }
+    play(seq);
 }
 
 void Buzzer::bootSequence() {
     printf("Initializing audio system...\n");
     printf("Playing boot sequence\n");
     
-    // Blue LED fade-in animation
+    // Blue LED fade-in animation (plays alongside the melody)
     LED.fadeIn(LEDController::COLOR_BLUE, 500);
-    delay(200);
-    LED.setAllLEDs(LEDController::COLOR_OFF);
     
+    ToneSequence seq;
+    seq.sound = SOUND_BOOT;
     if (buzzerType == BUZZER_PASSIVE) {
-        // Ascending musical scale
-        uint16_t notes[] = {NOTE_C4, NOTE_E4, NOTE_G4, NOTE_C5};
-        uint16_t durations[] = {100, 100, 100, 200};
-        playMelody(notes, durations, 4);
+        // Ascending musical scale (50ms gap between notes)
+        seq.tone(NOTE_C4, 100).rest(50)
+           .tone(NOTE_E4, 100).rest(50)
+           .tone(NOTE_G4, 100).rest(50)
+           .tone(NOTE_C5, 200);
     } else {
         // Two beeps for active buzzer
-        beep(2, BOOT_BEEP_DURATION, 100);
+        seq.tone(2000, BOOT_BEEP_DURATION).rest(100)
+           .tone(2000, BOOT_BEEP_DURATION);
     }
+    play(seq);
     
     printf("Audio and LED system ready\n");
     printf("Buzzer type: %s\n\n", buzzerType == BUZZER_PASSIVE ? "PASSIVE (PWM)" : "ACTIVE");
@@ -88,16 +121,15 @@ void Buzzer::detectionAlert() {
     // Red LED flash
     LED.flash(LEDController::COLOR_RED, 3, DETECT_BEEP_DURATION);
     
-    if (buzzerType == BUZZER_PASSIVE) {
-        // Urgent high-pitched beeps
-        for (int i = 0; i < 3; i++) {
-            playTonePassive(2500, DETECT_BEEP_DURATION);
-            if (i < 2) delay(50);
-        }
-    } else {
-        // Three fast beeps
-        beep(3, DETECT_BEEP_DURATION, 50);
+    // Three fast beeps (urgent high pitch on passive buzzer)
+    ToneSequence seq;
+    seq.sound = SOUND_DETECTION;
+    uint16_t frequency = buzzerType == BUZZER_PASSIVE ? 2500 : 2000;
+    for (int i = 0; i < 3; i++) {
+        seq.tone(frequency, DETECT_BEEP_DURATION);
+        if (i < 2) seq.rest(50);
     }
+    play(seq);
     
     printf("Detection complete - device identified!\n\n");
 }
@@ -106,27 +138,42 @@ void Buzzer::heartbeat() {
     printf("Heartbeat: Device still in range\n");
     
     // Orange LED pulse
-    LED.pulse(LEDController::COLOR_ORANGE, 400);
+    LED.pulse(LEDController::COLOR_ORANGE, 400, LED_PRIORITY_INFO);
+    
+    // Two beeps
+    ToneSequence seq;
+    seq.sound = SOUND_HEARTBEAT;
+    uint16_t frequency = buzzerType == BUZZER_PASSIVE ? 1800 : 2000;
+    seq.tone(frequency, HEARTBEAT_DURATION).rest(100)
+       .tone(frequency, HEARTBEAT_DURATION);
+    play(seq);
+}
+
+void Buzzer::cameraAheadAlert() {
+    // White LED flash, distinct from RF detections
+    LED.flash(LEDController::COLOR_WHITE, 2, 150);
     
+    // Long-short (falling pitch on passive buzzer)
+    ToneSequence seq;
+    seq.sound = SOUND_CAMERA_AHEAD;
     if (buzzerType == BUZZER_PASSIVE) {
-        // Two-tone heartbeat
-        playTonePassive(1800, HEARTBEAT_DURATION);
-        delay(100);
-        playTonePassive(1800, HEARTBEAT_DURATION);
+        seq.tone(NOTE_A5, 300).rest(80).tone(NOTE_E5, 120);
     } else {
-        // Two beeps
-        beep(2, HEARTBEAT_DURATION, 100);
+        seq.tone(2000, 300).rest(80).tone(2000, 120);
     }
+    play(seq);
 }
 
 void Buzzer::knownDeviceBeep() {
     // Single short beep for known device re-detection
     printf("Known device re-detected\n");
     
+    ToneSequence seq;
+    seq.sound = SOUND_KNOWN;
     if (buzzerType == BUZZER_PASSIVE) {
-        // Lower pitch for known device
-        playTonePassive(1500, 200);
+        seq.tone(1500, 200);  // Lower pitch for known device
     } else {
-        beep(1, 50, 0);  // Quick single beep
+        seq.tone(2000, 50);   // Quick single beep
     }
+    play(seq);
 }
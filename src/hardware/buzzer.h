@@ -3,12 +3,25 @@
 
 #include <Arduino.h>
 #include "config/pins.h"
+#include "tone_sequencer.h"
 
 enum BuzzerType {
     BUZZER_ACTIVE,   // 2-pin active buzzer (simple on/off)
     BUZZER_PASSIVE   // 3-pin passive buzzer (requires PWM/tones)
 };
 
+// Sound ids - repeats of the same sound within the coalesce window are dropped
+enum BuzzerSound : uint8_t {
+    SOUND_BEEP = 0,
+    SOUND_BOOT = 1,
+    SOUND_DETECTION = 2,
+    SOUND_KNOWN = 3,
+    SOUND_HEARTBEAT = 4,
+    SOUND_CAMERA_AHEAD = 5
+};
+
+// Sounds are queued and played step by step from an esp_timer callback;
+// every call returns immediately.
 class Buzzer {
 public:
     void begin();
@@ -20,14 +33,23 @@ public:
     void detectionAlert();
     void knownDeviceBeep();  // Short beep for known devices
     void heartbeat();
+    void cameraAheadAlert();  // Known camera from the SD index, before RF contact
+    
+    ToneSequencer& getSequencer() { return sequencer; }
 
 private:
     BuzzerType buzzerType = BUZZER_ACTIVE;
     uint8_t pwmChannel = 0;  // PWM channel for passive buzzer
     
-    void playToneActive(int duration);
-    void playTonePassive(uint16_t frequency, uint16_t duration);
-    void playMelody(const uint16_t* notes, const uint16_t* durations, uint8_t length);
+    ToneSequencer sequencer;
+    esp_timer_handle_t stepTimer = nullptr;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;  // Callers vs. timer task
+    bool timerRunning = false;
+    
+    void play(const ToneSequence& sequence);
+    void advance();
+    void output(uint16_t frequency);
+    static void stepTimerCallback(void* arg);
 };
 
 extern Buzzer buzzer;
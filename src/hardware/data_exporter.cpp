@@ -0,0 +1,215 @@
+#include "data_exporter.h"
+#include <stdarg.h>
+#include "../location/geo.h"
+#include "../system/metrics.h"
+
+DataExporter dataExporter;
+
+static MetricHistogram exportLatency("db.export");   // Whole export, both files
+
+bool DataExporter::start(bool changedOnly) {
+    if (state == EXPORT_RUNNING) return false;
+
+    this->changedOnly = changedOnly;
+    count = 0;
+    done = 0;
+    state = EXPORT_RUNNING;
+
+    // Idle priority on Core 1: runs whenever loop() and the WiFi processing task sleep
+    if (xTaskCreatePinnedToCore(taskEntry, "Export", EXPORT_TASK_STACK_SIZE, this,
+                                tskIDLE_PRIORITY, &task, 1) != pdPASS) {
+        printf("[Export] Failed to create task\n");
+        state = EXPORT_FAILED;
+        return false;
+    }
+    return true;
+}
+
+uint8_t DataExporter::getProgress() {
+    if (state != EXPORT_RUNNING) return state == EXPORT_DONE ? 100 : 0;
+    uint32_t total = count * 2;
+    return total ? (uint8_t)(done * 100 / total) : 0;
+}
+
+void DataExporter::taskEntry(void* parameter) {
+    static_cast<DataExporter*>(parameter)->run();
+    vTaskDelete(NULL);
+}
+
+void DataExporter::run() {
+    MetricTimer timer(exportLatency);
+    unsigned long started = millis();
+    printf("[Export] %s export started\n", changedOnly ? "Changes-only" : "Full");
+
+    dataManager.flush();  // Database on the card matches what is exported
+
+    uint32_t wanted = dataManager.countForExport(changedOnly);
+    if (wanted == 0 && changedOnly) {
+        printf("[Export] No devices changed since the last export\n");
+        mapFile[0] = csvFile[0] = '\0';
+        state = EXPORT_DONE;
+        return;
+    }
+
+    // Devices added between counting and copying wait for the next export
+    records = (ExportRecord*)malloc((wanted ? wanted : 1) * sizeof(ExportRecord));
+    if (!records) {
+        printf("[Export] Not enough memory to copy %u devices\n", (unsigned)wanted);
+        state = EXPORT_FAILED;
+        return;
+    }
+    count = dataManager.snapshotForExport(records, wanted, changedOnly);
+
+    chooseFiles();
+    bool ok = writeGeoJSON() && writeCSV();
+    if (!ok) {
+        dataManager.requeueExport(records, count);  // Still changed for the next export
+    }
+    free(records);
+    records = nullptr;
+
+    if (ok) {
+        printf("[Export] %u devices -> %s, %s (%lu ms)\n", (unsigned)count, mapFile, csvFile,
+               millis() - started);
+    } else {
+        printf("[Export] Write failed\n");
+    }
+    state = ok ? EXPORT_DONE : EXPORT_FAILED;
+}
+
+void DataExporter::chooseFiles() {
+    if (!changedOnly) {
+        snprintf(mapFile, sizeof(mapFile), "/export_map.geojson");
+        snprintf(csvFile, sizeof(csvFile), "/export_data.csv");
+        return;
+    }
+
+    // Next free number, so earlier change sets are kept
+    for (uint16_t n = 1; n < 10000; n++) {
+        snprintf(mapFile, sizeof(mapFile), "/export_map_%04u.geojson", n);
+        if (!SD.exists(mapFile)) {
+            snprintf(csvFile, sizeof(csvFile), "/export_data_%04u.csv", n);
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// BUFFERED OUTPUT
+// ============================================================================
+
+bool DataExporter::openFile(const char* path) {
+    file = SD.open(path, FILE_WRITE);
+    buffered = 0;
+    writeFailed = !file;
+    return !writeFailed;
+}
+
+// Whole buffers are written as they fill, so the card sees sector-aligned writes
+void DataExporter::append(const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n <= 0 || writeFailed) return;
+    if (n >= (int)sizeof(line)) n = sizeof(line) - 1;
+
+    for (int i = 0; i < n; ) {
+        size_t chunk = EXPORT_BUFFER_SIZE - buffered;
+        if (chunk > (size_t)(n - i)) chunk = n - i;
+        memcpy(buffer + buffered, line + i, chunk);
+        buffered += chunk;
+        i += chunk;
+
+        if (buffered == EXPORT_BUFFER_SIZE) {
+            if (file.write(buffer, buffered) != buffered) writeFailed = true;
+            buffered = 0;
+        }
+    }
+}
+
+bool DataExporter::closeFile() {
+    if (buffered > 0 && !writeFailed) {
+        if (file.write(buffer, buffered) != buffered) writeFailed = true;
+    }
+    buffered = 0;
+    file.close();
+    return !writeFailed;
+}
+
+// ============================================================================
+// FORMATS
+// ============================================================================
+
+bool DataExporter::writeGeoJSON() {
+    if (!openFile(mapFile)) return false;
+
+    append("{\n  \"type\": \"FeatureCollection\",\n  \"features\": [\n");
+
+    // One point per device, at its estimated position
+    bool first = true;
+    char mac[18];
+    for (uint32_t i = 0; i < count && !writeFailed; i++) {
+        const ExportRecord& rec = records[i];
+        done++;
+        if (!rec.located) continue;
+        formatMac(rec.device.mac, mac);
+
+        append("%s    {\n"
+               "      \"type\": \"Feature\",\n"
+               "      \"geometry\": {\n"
+               "        \"type\": \"Point\",\n"
+               "        \"coordinates\": [%.6f, %.6f]\n"
+               "      },\n",
+               first ? "" : ",\n",
+               fromMicrodegrees(rec.estimate.lon), fromMicrodegrees(rec.estimate.lat));
+        append("      \"properties\": {\n"
+               "        \"mac\": \"%s\",\n"
+               "        \"type\": \"%s\",\n"
+               "        \"rssi\": %d,\n"
+               "        \"detections\": %u,\n"
+               "        \"radius_m\": %.0f\n"
+               "      }\n"
+               "    }",
+               mac, deviceTypeName(rec.device.type), rec.device.rssi,
+               (unsigned)rec.device.detection_count, rec.radius);
+        first = false;
+    }
+
+    append("\n  ]\n}\n");
+    return closeFile();
+}
+
+bool DataExporter::writeCSV() {
+    if (!openFile(csvFile)) return false;
+
+    append("MAC,Type,RSSI,FirstSeen,LastSeen,DetectionCount,Latitude,Longitude,RadiusM,Locations\n");
+
+    char mac[18];
+    for (uint32_t i = 0; i < count && !writeFailed; i++) {
+        const ExportRecord& rec = records[i];
+        formatMac(rec.device.mac, mac);
+        append("%s,%s,%d,%u,%u,%u,", mac, deviceTypeName(rec.device.type), rec.device.rssi,
+               (unsigned)rec.device.first_seen, (unsigned)rec.device.last_seen,
+               (unsigned)rec.device.detection_count);
+
+        // Estimated position; empty without a fix
+        if (rec.located) {
+            append("%.6f,%.6f,%.0f,\"", fromMicrodegrees(rec.estimate.lat),
+                   fromMicrodegrees(rec.estimate.lon), rec.radius);
+        } else {
+            append(",,,\"");
+        }
+
+        // Stored drive-by points, "lat,lon;lat,lon", oldest first
+        for (uint8_t j = 0; j < rec.location_count; j++) {
+            append("%s%.6f,%.6f", j ? ";" : "", fromMicrodegrees(rec.locations[j].lat),
+                   fromMicrodegrees(rec.locations[j].lon));
+        }
+        append("\"\n");
+        done++;
+    }
+
+    return closeFile();
+}
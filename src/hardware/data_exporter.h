@@ -0,0 +1,68 @@
+#ifndef DATA_EXPORTER_H
+#define DATA_EXPORTER_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include "data_manager.h"
+
+// Exports run in a low-priority task so detection keeps running: flush the
+// database, copy the devices to export in one pass under the DataManager
+// lock, then format GeoJSON and CSV from that copy through a sector-sized
+// buffer. The loop polls getProgress() for the OLED and LEDs.
+//
+// The map has one point per device at its estimated position (with the
+// uncertainty radius); the CSV adds the stored drive-by points.
+//
+// A full export rewrites /export_map.geojson and /export_data.csv. A
+// changes-only export writes the devices detected since the previous export
+// (this boot) to the next free /export_map_NNNN.geojson / export_data_NNNN.csv.
+#define EXPORT_BUFFER_SIZE (8 * 512)
+#define EXPORT_TASK_STACK_SIZE 6144
+
+enum ExportState : uint8_t {
+    EXPORT_IDLE = 0,
+    EXPORT_RUNNING = 1,
+    EXPORT_DONE = 2,
+    EXPORT_FAILED = 3
+};
+
+class DataExporter {
+public:
+    bool start(bool changedOnly);  // false if an export is already running
+
+    ExportState getState() { return state; }
+    bool isRunning() { return state == EXPORT_RUNNING; }
+    uint8_t getProgress();         // 0-100
+    uint32_t getDevices() { return count; }
+    const char* getMapFile() { return mapFile; }
+    const char* getCsvFile() { return csvFile; }
+
+private:
+    volatile ExportState state = EXPORT_IDLE;
+    bool changedOnly = false;
+    TaskHandle_t task = nullptr;
+
+    ExportRecord* records = nullptr;
+    uint32_t count = 0;
+    volatile uint32_t done = 0;    // Records written, both files
+
+    File file;
+    alignas(4) uint8_t buffer[EXPORT_BUFFER_SIZE];
+    size_t buffered = 0;
+    bool writeFailed = false;
+    char mapFile[32] = "";
+    char csvFile[32] = "";
+
+    static void taskEntry(void* parameter);
+    void run();
+    void chooseFiles();
+    bool openFile(const char* path);
+    void append(const char* format, ...);
+    bool closeFile();
+    bool writeGeoJSON();
+    bool writeCSV();
+};
+
+extern DataExporter dataExporter;
+
+#endif // DATA_EXPORTER_H
@@ -1,29 +1,306 @@
 #include "data_manager.h"
 #include "rtc_manager.h"
 #include "../config/settings.h"
+#include "../system/metrics.h"
+#include "../location/geo.h"
+#include "../system/boot_profiler.h"
+#include "../hal/esp32_hal.h"
 #include <ArduinoJson.h>
+#include <string.h>
 
 DataManager dataManager;
 
+static MetricHistogram recordLatency("db.record");   // Including lock wait
+static MetricHistogram flushLatency("db.flush");     // Journal append + sync
+static MetricHistogram compactLatency("db.compact");
+static MetricCounter evictions("db.evictions");
+static MetricGauge deviceCount("db.devices");
+static MetricCounter earlyDetections("db.early");    // Recorded while the database loaded or compacted
+static MetricCounter pendingDropped("db.pending_dropped");  // Journal deltas lost to a failing card
+
+// Estimate floats travel in the journal's uint32 fields
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
 void DataManager::init() {
     printf("Initializing data manager...\n");
     
-    // Load existing database into memory cache
-    loadDatabase();
+    uint32_t capacity = settingsManager.getSettings().log.max_devices;
+    if (!allocate(capacity)) {
+        printf("[DataMgr] Failed to allocate table for %u devices\n", (unsigned)capacity);
+        return;
+    }
+    
+    if (!lock) {
+        lock = xSemaphoreCreateMutex();
+    }
+    
+    // Begun here so the boot report waits for the load task
+    load_phase = bootProfiler.begin("db_load");
+    xTaskCreatePinnedToCore(
+        loadTaskEntry,
+        "DB_Load",
+        DATA_LOAD_TASK_STACK_SIZE,
+        this,
+        1,
+        nullptr,
+        1
+    );
+}
+
+void DataManager::loadTaskEntry(void* parameter) {
+    DataManager* self = static_cast<DataManager*>(parameter);
+    unsigned long start = millis();
+    
+    xSemaphoreTake(self->lock, portMAX_DELAY);
+    self->loadDatabase();
+    self->last_flush = millis();
+    bootProfiler.end(self->load_phase);
+    
+    uint32_t reconciled;
+    {
+        BootPhase phase("db_reconcile");
+        reconciled = self->reconcileEarly();
+    }
+    xSemaphoreGive(self->lock);
+    
+    printf("Data manager loaded %u known devices in %lu ms (capacity %u), %u early detections applied",
+           (unsigned)self->devices.size(), millis() - start, (unsigned)self->devices.capacity(),
+           (unsigned)reconciled);
+    if (self->early_dropped) printf(", %u dropped", (unsigned)self->early_dropped);
+    printf("\n");
+    
+    vTaskDelete(NULL);
+}
+
+// Compaction walks the whole table, so it runs on its own task while
+// detections are buffered as during the load: the detection tasks never wait
+// for it
+void DataManager::startCompaction() {
+    portENTER_CRITICAL(&earlyLock);
+    bool idle = !buffering;
+    if (idle) buffering = true;
+    portEXIT_CRITICAL(&earlyLock);
+    if (!idle) return;
+    
+    last_compact = millis();
+    if (xTaskCreatePinnedToCore(compactTaskEntry, "DB_Compact", DATA_LOAD_TASK_STACK_SIZE,
+                                this, 1, nullptr, 1) != pdPASS) {
+        printf("[DataMgr] Failed to start compaction task\n");
+        xSemaphoreTake(lock, portMAX_DELAY);
+        reconcileEarly();
+        xSemaphoreGive(lock);
+    }
+}
+
+void DataManager::compactTaskEntry(void* parameter) {
+    DataManager* self = static_cast<DataManager*>(parameter);
+    
+    xSemaphoreTake(self->lock, portMAX_DELAY);
+    self->flushLocked();
+    self->compactLocked();
+    uint32_t reconciled = self->reconcileEarly();
+    xSemaphoreGive(self->lock);
+    
+    if (reconciled) printf("[DataMgr] %u detections applied after compaction\n", (unsigned)reconciled);
+    vTaskDelete(NULL);
+}
+
+// Applies the buffered detections with the lock held. New ones may arrive
+// meanwhile; buffering is cleared under the spinlock only once the buffer is
+// empty, so every later detection waits for the lock and lands after them.
+uint32_t DataManager::reconcileEarly() {
+    uint32_t applied = 0;
+    EarlyDetection batch[8];
+    
+    while (true) {
+        uint32_t n = 0;
+        portENTER_CRITICAL(&earlyLock);
+        while (n < 8 && early_count > 0) {
+            batch[n++] = early[early_head];
+            early_head = (early_head + 1) % DATA_EARLY_CAPACITY;
+            early_count--;
+        }
+        if (n == 0) {
+            buffering = false;
+            loaded = true;
+        }
+        portEXIT_CRITICAL(&earlyLock);
+        if (n == 0) break;
+        
+        for (uint32_t i = 0; i < n; i++) {
+            const EarlyDetection& d = batch[i];
+            recordLocked(d.mac, d.type, d.rssi, d.lat, d.lon, d.time);
+        }
+        applied += n;
+    }
+    return applied;
+}
+
+bool DataManager::allocate(uint32_t capacity) {
+    if (capacity == 0) capacity = 1;
+    if (capacity > LOCATION_NONE) capacity = LOCATION_NONE;
+    
+    // Every device fits once; stale entries of evicted devices can still overflow it
+    free(dirty_macs);
+    dirty_macs = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+    dirty_capacity = dirty_macs ? capacity : 0;
+    clearDirtyQueue();
+    
+    return dirty_macs && devices.init(capacity) && locations.init(capacity);
+}
+
+// Queues a device for the next flush the first time it changes after one
+void DataManager::markDirty(DeviceRecord* rec) {
+    if (rec->dirty) return;
+    rec->dirty = true;
+    if (dirty_count < dirty_capacity) {
+        dirty_macs[dirty_count++] = rec->mac;
+    } else {
+        dirty_overflow = true;
+    }
+}
+
+void DataManager::clearDirtyQueue() {
+    dirty_count = 0;
+    dirty_overflow = false;
+}
+
+void DataManager::releaseLocations(DeviceRecord& rec) {
+    locations.release(rec.location_id);
+    rec.location_id = LOCATION_NONE;
+}
+
+DeviceRecord* DataManager::insertDevice(uint64_t mac) {
+    DeviceRecord victim;
+    bool evicted = false;
+    DeviceRecord* rec = devices.insert(mac, &victim, &evicted);
+    if (!rec) return nullptr;
+    
+    if (evicted) {
+        evictions.add();
+        releaseLocations(victim);
+        evicted_devices++;
+        
+        if (!replaying) {
+            JournalEntry removal = {};
+            removal.kind = JOURNAL_REMOVE;
+            removal.mac = victim.mac;
+            queuePending(removal);
+            
+            char mac_str[18];
+            formatMac(victim.mac, mac_str);
+            printf("[DataMgr] Table full - evicted %s (seen %u times)\n",
+                   mac_str, (unsigned)victim.detection_count);
+        }
+    }
+    
+    rec->location_id = LOCATION_NONE;
+    return rec;
+}
+
+void DataManager::queuePending(const JournalEntry& entry) {
+    if (pending_count >= PENDING_CAPACITY) {
+        flushLocked();
+    }
+    if (pending_count >= PENDING_CAPACITY) {
+        // The journal takes nothing; the next snapshot holds the change instead
+        pending_dropped++;
+        pendingDropped.add();
+        compact_due = true;
+        return;
+    }
+    pending[pending_count++] = entry;
+}
+
+void DataManager::applyJournalEntry(const JournalEntry& entry, void* context) {
+    DataManager* self = static_cast<DataManager*>(context);
     
-    printf("Data manager initialized with %d known devices\n", device_cache.size());
+    switch (entry.kind) {
+        case JOURNAL_DEVICE: {
+            DeviceRecord* rec = self->devices.find(entry.mac);
+            if (!rec) rec = self->insertDevice(entry.mac);
+            if (!rec) return;
+            rec->type = (DeviceType)entry.type;
+            rec->rssi = entry.rssi;
+            rec->first_seen = entry.a;
+            rec->last_seen = entry.b;
+            rec->detection_count = entry.c;
+            rec->is_new = false;  // Existing device
+            rec->dirty = false;
+            break;
+        }
+        case JOURNAL_LOCATION: {
+            DeviceRecord* rec = self->devices.find(entry.mac);
+            if (rec) {
+                self->addLocation(rec, (int32_t)entry.a, (int32_t)entry.b);
+            }
+            break;
+        }
+        case JOURNAL_ESTIMATE: {
+            DeviceRecord* rec = self->devices.find(entry.mac);
+            if (rec && self->locations.acquire(&rec->location_id)) {
+                self->locations.estimate(rec->location_id)->restore(
+                    (int32_t)entry.a, (int32_t)entry.b, bitsFloat(entry.c), bitsFloat(entry.d));
+            }
+            break;
+        }
+        case JOURNAL_REMOVE: {
+            DeviceRecord* rec = self->devices.find(entry.mac);
+            if (rec) {
+                self->releaseLocations(*rec);
+                self->devices.remove(entry.mac);
+            }
+            break;
+        }
+        case JOURNAL_END:
+            break;
+    }
 }
 
 void DataManager::loadDatabase() {
+    journal.begin(sdFileSystem);
+    
+    replaying = true;
+    JournalReplayStats stats = journal.replay(applyJournalEntry, this);
+    bool imported = importLegacyDatabase();
+    seedEstimates();
+    replaying = false;
+    
+    printf("Loaded %u devices (%u snapshot + %u journal records)\n",
+           (unsigned)devices.size(), (unsigned)stats.snapshotRecords,
+           (unsigned)stats.journalRecords);
+    
+    // Rewrite the snapshot if the journal tail was torn or text data was merged
+    if (stats.needsCompaction || imported) {
+        compactLocked();
+    }
+    
+    if (imported) {
+        SD.rename(DB_FILE, "/detections.db.imported");
+        if (SD.exists(LOCATIONS_FILE)) SD.rename(LOCATIONS_FILE, "/locations.db.imported");
+        if (SD.exists(INDEX_FILE)) SD.remove(INDEX_FILE);
+    }
+}
+
+bool DataManager::importLegacyDatabase() {
     if (!SD.exists(DB_FILE)) {
-        printf("No existing database found, starting fresh\n");
-        return;
+        return false;
     }
     
     File db = SD.open(DB_FILE, FILE_READ);
     if (!db) {
         printf("Failed to open database file\n");
-        return;
+        return false;
     }
     
     uint32_t loaded = 0;
@@ -40,17 +317,17 @@ void DataManager::loadDatabase() {
         int idx4 = line.indexOf(',', idx3 + 1);
         int idx5 = line.indexOf(',', idx4 + 1);
         
-        if (idx1 > 0 && idx2 > 0 && idx3 > 0 && idx4 > 0 && idx5 > 0) {
-            DeviceRecord record;
-            record.mac = line.substring(0, idx1);
-            record.type = line.substring(idx1 + 1, idx2);
-            record.rssi = line.substring(idx2 + 1, idx3).toInt();
-            record.first_seen = line.substring(idx3 + 1, idx4).toInt();
-            record.last_seen = line.substring(idx4 + 1, idx5).toInt();
-            record.detection_count = line.substring(idx5 + 1).toInt();
-            record.is_new = false;  // Existing device
-            
-            device_cache[record.mac] = record;
+        uint64_t mac;
+        if (idx1 > 0 && idx2 > 0 && idx3 > 0 && idx4 > 0 && idx5 > 0 &&
+            parseMac(line.substring(0, idx1).c_str(), &mac) && !devices.find(mac)) {
+            DeviceRecord* record = insertDevice(mac);
+            if (!record) break;
+            record->type = deviceTypeFromName(line.substring(idx1 + 1, idx2).c_str());
+            record->rssi = line.substring(idx2 + 1, idx3).toInt();
+            record->first_seen = line.substring(idx3 + 1, idx4).toInt();
+            record->last_seen = line.substring(idx4 + 1, idx5).toInt();
+            record->detection_count = line.substring(idx5 + 1).toInt();
+            record->is_new = false;  // Existing device
             loaded++;
         }
     }
@@ -65,17 +342,50 @@ void DataManager::loadDatabase() {
                 line.trim();
                 
                 int idx = line.indexOf(',');
-                if (idx > 0) {
-                    String mac = line.substring(0, idx);
-                    String locations = line.substring(idx + 1);
-                    device_locations[mac] = locations;
+                uint64_t mac;
+                if (idx > 0 && parseMac(line.substring(0, idx).c_str(), &mac)) {
+                    DeviceRecord* rec = devices.find(mac);
+                    if (rec && rec->location_id == LOCATION_NONE) {
+                        importLegacyLocations(rec, line.c_str() + idx + 1);
+                    }
                 }
             }
             loc.close();
         }
     }
     
-    printf("Loaded %d devices from database\n", loaded);
+    printf("Imported %u devices from legacy text database\n", (unsigned)loaded);
+    return true;
+}
+
+// Databases from before the estimate (and the legacy import) only have
+// points: start from their plain centroid
+void DataManager::seedEstimates() {
+    for (uint32_t i = 0; i < devices.slotCount(); i++) {
+        DeviceRecord* rec = devices.slotAt(i);
+        EmitterEstimate* estimate = rec ? locations.estimate(rec->location_id) : nullptr;
+        if (!estimate || estimate->weight > 0) continue;
+        
+        uint8_t points = locations.count(rec->location_id);
+        for (uint8_t j = 0; j < points; j++) {
+            GeoPoint point = locations.at(rec->location_id, j);
+            estimate->add(point.lat, point.lon, EMITTER_RSSI_REF);
+        }
+    }
+}
+
+// Legacy "lat1,lon1;lat2,lon2" list; the most recent points win if it is longer than a ring
+void DataManager::importLegacyLocations(DeviceRecord* rec, const char* text) {
+    const char* p = text;
+    while (*p) {
+        char* end;
+        double lat = strtod(p, &end);
+        if (*end != ',') break;
+        double lon = strtod(end + 1, &end);
+        addLocation(rec, toMicrodegrees(lat), toMicrodegrees(lon));
+        if (*end != ';') break;
+        p = end + 1;
+    }
 }
 
 // Helper to get timestamp - uses RTC if available, else millis()
@@ -87,265 +397,335 @@ String DataManager::getTimestamp() {
     return String(millis() / 1000.0, 3) + "s";
 }
 
-bool DataManager::recordDetection(const char* mac, const char* type, int rssi,
-                                  double lat, double lon) {
-    String mac_str = String(mac);
-    unsigned long now = millis();
-    bool is_known = device_cache.find(mac_str) != device_cache.end();
+bool DataManager::recordDetection(const uint8_t* mac, DeviceType type, int rssi,
+                                  double lat, double lon, uint32_t time) {
+    if (!lock) return false;
+    MetricTimer timer(recordLatency);
+    
+    uint64_t key = macToKey(mac);
+    int32_t lat_e6 = (lat != 0.0 && lon != 0.0) ? toMicrodegrees(lat) : 0;
+    int32_t lon_e6 = (lat != 0.0 && lon != 0.0) ? toMicrodegrees(lon) : 0;
+    
+    // Still loading or compacting - buffer it rather than wait for that task
+    if (buffering) {
+        bool buffered = false;
+        portENTER_CRITICAL(&earlyLock);
+        if (buffering) {
+            if (early_count < DATA_EARLY_CAPACITY) {
+                EarlyDetection& d = early[(early_head + early_count++) % DATA_EARLY_CAPACITY];
+                d.mac = key;
+                d.time = time;
+                d.lat = lat_e6;
+                d.lon = lon_e6;
+                d.rssi = rssi;
+                d.type = type;
+            } else {
+                early_dropped++;
+            }
+            buffered = true;
+        }
+        portEXIT_CRITICAL(&earlyLock);
+        if (buffered) {
+            earlyDetections.add();
+            return false;
+        }
+    }
+    
+    xSemaphoreTake(lock, portMAX_DELAY);
+    bool is_known = recordLocked(key, type, rssi, lat_e6, lon_e6, time);
+    xSemaphoreGive(lock);
+    return is_known;  // Return true if this was a known device
+}
+
+// lat_e6/lon_e6 are 0 without a fix; now is when the detection was made
+bool DataManager::recordLocked(uint64_t key, DeviceType type, int rssi, int32_t lat_e6, int32_t lon_e6,
+                               unsigned long now) {
+    char mac_str[18];
+    formatMac(key, mac_str);
+    
+    DeviceRecord* record = devices.find(key);
+    bool is_known = record != nullptr;
     
     if (!is_known) {
         // New device - create record
-        DeviceRecord record;
-        record.mac = mac_str;
-        record.type = String(type);
-        record.rssi = rssi;
-        record.first_seen = now;
-        record.last_seen = now;
-        record.detection_count = 1;
-        record.is_new = true;
+        record = insertDevice(key);
+        if (!record) {
+            return false;
+        }
+        record->type = type;
+        record->rssi = rssi;
+        record->first_seen = now;
+        record->last_seen = now;
+        record->detection_count = 1;
+        record->is_new = true;
         
-        device_cache[mac_str] = record;
         new_devices_this_session++;
         
-        printf("[DataMgr] NEW DEVICE: %s (%s)\n", mac, type);
+        printf("[DataMgr] NEW DEVICE: %s (%s)\n", mac_str, deviceTypeName(type));
     } else {
-        // Known device - update record
-        DeviceRecord& record = device_cache[mac_str];
-        record.last_seen = now;
-        record.detection_count++;
-        record.rssi = rssi;  // Update to latest RSSI
+        // Known device - update record (capture times from both cores may arrive out of order)
+        if ((int32_t)(now - record->last_seen) > 0) record->last_seen = now;
+        record->detection_count++;
+        record->rssi = rssi;  // Update to latest RSSI
         
         // Update type if we have a more specific one
-        if (String(type) != "Unknown" && record.type == "Unknown") {
-            record.type = String(type);
+        if (type != DEVICE_UNKNOWN && record->type == DEVICE_UNKNOWN) {
+            record->type = type;
         }
         
-        printf("[DataMgr] KNOWN DEVICE: %s (seen %d times)\n", mac, record.detection_count);
+        printf("[DataMgr] KNOWN DEVICE: %s (seen %u times)\n", mac_str, (unsigned)record->detection_count);
     }
+    markDirty(record);
+    record->unexported = true;
+    deviceCount.set(devices.size());
     
-    // Add location if valid
-    if (lat != 0.0 && lon != 0.0) {
-        addLocation(mac, lat, lon);
+    // Add location if valid and not next to one already stored
+    if (lat_e6 != 0 && lon_e6 != 0) {
+        if (addLocation(record, lat_e6, lon_e6)) {
+            JournalEntry delta = {};
+            delta.kind = JOURNAL_LOCATION;
+            delta.mac = key;
+            delta.a = (uint32_t)lat_e6;
+            delta.b = (uint32_t)lon_e6;
+            queuePending(delta);
+        }
+        
+        // Every sighting refines the estimate, also those too close to store
+        EmitterEstimate* estimate = locations.estimate(record->location_id);
+        if (estimate) estimate->add(lat_e6, lon_e6, rssi);
     }
     
-    // Auto-flush check
-    autoFlush();
-    
-    return is_known;  // Return true if this was a known device
+    return is_known;
 }
 
-void DataManager::addLocation(const char* mac, double lat, double lon) {
-    char loc[30];
-    snprintf(loc, sizeof(loc), "%.6f,%.6f", lat, lon);
-    
-    String mac_str = String(mac);
+bool DataManager::addLocation(DeviceRecord* rec, int32_t lat, int32_t lon) {
+    return locations.add(&rec->location_id, lat, lon);
+}
+
+// Journal form of a device's estimate; false if it has none
+bool DataManager::estimateEntry(const DeviceRecord& rec, JournalEntry* out) {
+    const EmitterEstimate* estimate = locations.estimate(rec.location_id);
+    int32_t lat, lon;
+    float radius;
+    if (!estimate || !estimate->get(&lat, &lon, &radius)) return false;
     
-    if (device_locations.find(mac_str) == device_locations.end()) {
-        device_locations[mac_str] = String(loc);
-    } else {
-        // Only add if not duplicate
-        if (device_locations[mac_str].indexOf(loc) == -1) {
-            device_locations[mac_str] += ";" + String(loc);
-        }
-    }
+    *out = {};
+    out->kind = JOURNAL_ESTIMATE;
+    out->mac = rec.mac;
+    out->a = (uint32_t)lat;
+    out->b = (uint32_t)lon;
+    out->c = floatBits(estimate->weight);
+    out->d = floatBits(estimate->spread());
+    return true;
 }
 
-DeviceRecord* DataManager::getDevice(const char* mac) {
-    auto it = device_cache.find(String(mac));
-    if (it != device_cache.end()) {
-        return &it->second;
-    }
-    return nullptr;
+bool DataManager::getDevice(const uint8_t* mac, DeviceRecord* out) {
+    if (!lock || buffering) return false;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    DeviceRecord* rec = devices.find(macToKey(mac));
+    if (rec && out) *out = *rec;
+    xSemaphoreGive(lock);
+    return rec != nullptr;
 }
 
-bool DataManager::isKnownDevice(const char* mac) {
-    return device_cache.find(String(mac)) != device_cache.end();
+bool DataManager::isKnownDevice(const uint8_t* mac) {
+    return getDevice(mac, nullptr);
 }
 
-uint32_t DataManager::getDetectionCount(const char* mac) {
-    auto it = device_cache.find(String(mac));
-    return (it != device_cache.end()) ? it->second.detection_count : 0;
+uint32_t DataManager::getDetectionCount(const uint8_t* mac) {
+    DeviceRecord rec;
+    return getDevice(mac, &rec) ? rec.detection_count : 0;
 }
 
 void DataManager::autoFlush() {
-    unsigned long now = millis();
+    if (!lock || buffering) return;
     
-    // Flush based on time or cache size
-    if ((now - last_flush > FLUSH_INTERVAL) || 
-        (device_cache.size() > MAX_CACHE_SIZE)) {
-        flush();
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (millis() - last_flush > settingsManager.getSettings().log.flush_interval) {
+        flushLocked();
     }
+    bool due = compact_due && millis() - last_compact > COMPACT_RETRY_MS;
+    xSemaphoreGive(lock);
+    
+    if (due) startCompaction();
 }
 
+// A compaction in progress flushes everything itself
 void DataManager::flush() {
-    printf("[DataMgr] Flushing to SD card...\n");
-    saveToDatabase();
-    last_flush = millis();
+    if (!lock || buffering) return;
+    
+    xSemaphoreTake(lock, portMAX_DELAY);
+    flushLocked();
+    xSemaphoreGive(lock);
 }
 
-void DataManager::saveToDatabase() {
-    // Write main database
-    File db = SD.open(DB_FILE, FILE_WRITE);
-    if (!db) {
-        printf("[DataMgr] Failed to open database for writing\n");
-        return;
-    }
-    
-    db.println("# Flock Detection Database");
-    db.println("# Format: MAC,Type,RSSI,FirstSeen,LastSeen,Count");
+void DataManager::compact() {
+    if (!lock || !loaded) return;
+    startCompaction();
+}
+
+void DataManager::flushLocked() {
+    MetricTimer timer(flushLatency);
+    // Walks the dirty queue, so the cost is proportional to what changed since
+    // the last flush, not to the database size. Only an overflowed queue (more
+    // changes than the table holds devices) falls back to a table walk.
+    uint32_t written = 0;
     
-    for (auto& kv : device_cache) {
-        DeviceRecord& rec = kv.second;
-        db.print(rec.mac);
-        db.print(",");
-        db.print(rec.type);
-        db.print(",");
-        db.print(rec.rssi);
-        db.print(",");
-        db.print(rec.first_seen);
-        db.print(",");
-        db.print(rec.last_seen);
-        db.print(",");
-        db.println(rec.detection_count);
-    }
-    db.close();
+    // False if the journal did not take the device
+    auto journalDevice = [&](DeviceRecord* rec) {
+        JournalEntry entry = {};
+        entry.kind = JOURNAL_DEVICE;
+        entry.mac = rec->mac;
+        entry.a = rec->first_seen;
+        entry.b = rec->last_seen;
+        entry.c = rec->detection_count;
+        entry.rssi = rec->rssi;
+        entry.type = rec->type;
+        if (!journal.append(entry)) return false;
+        rec->dirty = false;
+        written++;
+        
+        if (estimateEntry(*rec, &entry) && journal.append(entry)) written++;
+        return true;
+    };
     
-    // Write locations database
-    File loc = SD.open(LOCATIONS_FILE, FILE_WRITE);
-    if (loc) {
-        for (auto& kv : device_locations) {
-            loc.print(kv.first);
-            loc.print(",");
-            loc.println(kv.second);
+    if (dirty_overflow) {
+        bool full = true;
+        for (uint32_t i = 0; i < devices.slotCount() && full; i++) {
+            DeviceRecord* rec = devices.slotAt(i);
+            if (rec && rec->dirty) full = journalDevice(rec);
+        }
+        if (full) clearDirtyQueue();
+    } else {
+        // Evicted or already written devices (queued twice) are skipped
+        uint32_t done = 0;
+        for (; done < dirty_count; done++) {
+            DeviceRecord* rec = devices.find(dirty_macs[done]);
+            if (rec && rec->dirty && !journalDevice(rec)) break;
         }
-        loc.close();
+        // Devices the journal did not take stay queued for the next flush
+        memmove(dirty_macs, dirty_macs + done, (dirty_count - done) * sizeof(uint64_t));
+        dirty_count -= done;
     }
     
-    // Write index
-    File idx = SD.open(INDEX_FILE, FILE_WRITE);
-    if (idx) {
-        for (auto& kv : device_cache) {
-            idx.println(kv.first);
-        }
-        idx.close();
+    // Entries the journal did not take stay queued for the next flush
+    uint32_t sent = 0;
+    while (sent < pending_count && journal.append(pending[sent])) sent++;
+    memmove(pending, pending + sent, (pending_count - sent) * sizeof(JournalEntry));
+    pending_count -= sent;
+    written += sent;
+    
+    if (written > 0) {
+        journal.sync();
+        printf("[DataMgr] Journaled %u records\n", (unsigned)written);
     }
+    last_flush = millis();
     
-    printf("[DataMgr] Saved %d devices to database\n", device_cache.size());
+    // Compaction runs from autoFlush(), never on the detection path
+    if (journal.journalSize() > COMPACT_THRESHOLD || pending_count > 0 || !journal.isOpen()) {
+        compact_due = true;
+    }
 }
 
-void DataManager::exportToGeoJSON(const char* filename) {
-    File file = SD.open(filename, FILE_WRITE);
-    if (!file) return;
-    
-    file.println("{");
-    file.println("  \"type\": \"FeatureCollection\",");
-    file.println("  \"features\": [");
+void DataManager::compactLocked() {
+    MetricTimer timer(compactLatency);
+    if (!journal.beginSnapshot()) {
+        printf("[DataMgr] Failed to open snapshot for writing\n");
+        return;
+    }
     
-    bool first = true;
-    for (auto& kv : device_cache) {
-        String mac = kv.first;
-        DeviceRecord& rec = kv.second;
+    bool ok = true;
+    for (uint32_t i = 0; i < devices.slotCount() && ok; i++) {
+        DeviceRecord* rec = devices.slotAt(i);
+        if (!rec) continue;
         
-        // Get locations for this device
-        auto loc_it = device_locations.find(mac);
-        if (loc_it == device_locations.end()) continue;
+        JournalEntry entry = {};
+        entry.kind = JOURNAL_DEVICE;
+        entry.mac = rec->mac;
+        entry.a = rec->first_seen;
+        entry.b = rec->last_seen;
+        entry.c = rec->detection_count;
+        entry.rssi = rec->rssi;
+        entry.type = rec->type;
+        ok = journal.writeSnapshot(entry);
+        if (ok && estimateEntry(*rec, &entry)) ok = journal.writeSnapshot(entry);
         
-        String locations = loc_it->second;
-        int pos = 0;
-        
-        while (pos < locations.length()) {
-            int semi = locations.indexOf(';', pos);
-            if (semi == -1) semi = locations.length();
-            
-            String loc = locations.substring(pos, semi);
-            int comma = loc.indexOf(',');
-            
-            if (comma > 0) {
-                String lat = loc.substring(0, comma);
-                String lon = loc.substring(comma + 1);
-                
-                if (!first) file.println(",");
-                first = false;
-                
-                file.println("    {");
-                file.println("      \"type\": \"Feature\",");
-                file.println("      \"geometry\": {");
-                file.println("        \"type\": \"Point\",");
-                file.print("        \"coordinates\": [");
-                file.print(lon);
-                file.print(", ");
-                file.print(lat);
-                file.println("]");
-                file.println("      },");
-                file.println("      \"properties\": {");
-                file.print("        \"mac\": \"");
-                file.print(mac);
-                file.println("\",");
-                file.print("        \"type\": \"");
-                file.print(rec.type);
-                file.println("\",");
-                file.print("        \"rssi\": ");
-                file.print(rec.rssi);
-                file.println(",");
-                file.print("        \"detections\": ");
-                file.println(rec.detection_count);
-                file.println("      }");
-                file.print("    }");
-            }
-            
-            pos = semi + 1;
+        // Oldest first so replay rebuilds the ring in the same order
+        uint8_t points = locations.count(rec->location_id);
+        for (uint8_t j = 0; j < points && ok; j++) {
+            GeoPoint point = locations.at(rec->location_id, j);
+            JournalEntry loc = {};
+            loc.kind = JOURNAL_LOCATION;
+            loc.mac = rec->mac;
+            loc.a = (uint32_t)point.lat;
+            loc.b = (uint32_t)point.lon;
+            ok = journal.writeSnapshot(loc);
         }
     }
     
-    file.println();
-    file.println("  ]");
-    file.println("}");
-    file.close();
+    if (!ok) {
+        journal.abortSnapshot();
+        printf("[DataMgr] Snapshot write failed - keeping journal\n");
+        return;
+    }
+    
+    // Records journaled or dirty so far are all in the snapshot
+    for (uint32_t i = 0; i < devices.slotCount(); i++) {
+        DeviceRecord* rec = devices.slotAt(i);
+        if (rec) rec->dirty = false;
+    }
+    clearDirtyQueue();
+    pending_count = 0;
     
-    printf("[DataMgr] GeoJSON exported to %s\n", filename);
+    if (journal.commitSnapshot()) {
+        compact_due = false;
+        printf("[DataMgr] Compacted %u devices into snapshot\n", (unsigned)devices.size());
+    }
 }
 
-void DataManager::exportToCSV(const char* filename) {
-    File file = SD.open(filename, FILE_WRITE);
-    if (!file) return;
+uint32_t DataManager::countForExport(bool changedOnly) {
+    if (!lock || !loaded) return 0;
     
-    file.println("MAC,Type,RSSI,FirstSeen,LastSeen,DetectionCount,Locations");
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < devices.slotCount(); i++) {
+        const DeviceRecord* rec = devices.slotAt(i);
+        if (rec && (!changedOnly || rec->unexported)) count++;
+    }
+    xSemaphoreGive(lock);
+    return count;
+}
+
+uint32_t DataManager::snapshotForExport(ExportRecord* out, uint32_t max, bool changedOnly) {
+    if (!lock || !loaded) return 0;
     
-    for (auto& kv : device_cache) {
-        String mac = kv.first;
-        DeviceRecord& rec = kv.second;
-        
-        file.print(mac);
-        file.print(",");
-        file.print(rec.type);
-        file.print(",");
-        file.print(rec.rssi);
-        file.print(",");
-        file.print(rec.first_seen);
-        file.print(",");
-        file.print(rec.last_seen);
-        file.print(",");
-        file.print(rec.detection_count);
-        file.print(",");
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < devices.slotCount() && count < max; i++) {
+        DeviceRecord* rec = devices.slotAt(i);
+        if (!rec || (changedOnly && !rec->unexported)) continue;
         
-        auto loc_it = device_locations.find(mac);
-        if (loc_it != device_locations.end()) {
-            file.print(loc_it->second);
+        ExportRecord& copy = out[count++];
+        copy.device = *rec;
+        copy.location_count = locations.count(rec->location_id);
+        for (uint8_t j = 0; j < copy.location_count; j++) {
+            copy.locations[j] = locations.at(rec->location_id, j);
         }
-        file.println();
+        const EmitterEstimate* estimate = locations.estimate(rec->location_id);
+        copy.located = estimate && estimate->get(&copy.estimate.lat, &copy.estimate.lon, &copy.radius);
+        rec->unexported = false;
     }
-    
-    file.close();
-    printf("[DataMgr] CSV exported to %s\n", filename);
+    xSemaphoreGive(lock);
+    return count;
 }
 
-void DataManager::exportSummary() {
-    printf("[DataMgr] Exporting all formats...\n");
-    
-    flush();  // Ensure database is up to date
+void DataManager::requeueExport(const ExportRecord* records, uint32_t count) {
+    if (!lock || !loaded) return;
     
-    exportToGeoJSON("/export_map.geojson");
-    exportToCSV("/export_data.csv");
-    
-    printf("[DataMgr] Export complete!\n");
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (uint32_t i = 0; i < count; i++) {
+        DeviceRecord* rec = devices.find(records[i].device.mac);
+        if (rec) rec->unexported = true;
+    }
+    xSemaphoreGive(lock);
 }
@@ -2,62 +2,131 @@
 #define DATA_MANAGER_H
 
 #include <Arduino.h>
-#include <map>
-#include <SD.h>
+#include "device_table.h"
+#include "detection_journal.h"
+#include "../location/location_history.h"
 
-// Lightweight device record for in-memory cache
-struct DeviceRecord {
-    String mac;
-    String type;
-    int rssi;
-    unsigned long first_seen;
-    unsigned long last_seen;
-    uint32_t detection_count;
-    bool is_new;  // True if first detection this session
+// Detections recorded while the database loads or compacts in the background
+// are kept here and applied, in order, once the table is free again
+#define DATA_EARLY_CAPACITY 64
+#define DATA_LOAD_TASK_STACK_SIZE 8192
+
+struct EarlyDetection {
+    uint64_t mac;
+    uint32_t time;                      // millis() when captured, not when buffered
+    int32_t lat;                        // Microdegrees, 0 = no fix
+    int32_t lon;
+    int8_t rssi;
+    DeviceType type;
+};
+
+// One device as copied out for an export
+struct ExportRecord {
+    DeviceRecord device;
+    uint8_t location_count;
+    GeoPoint locations[LOCATION_HISTORY_DEPTH];  // Oldest first
+    bool located;                       // estimate/radius valid
+    GeoPoint estimate;                  // Where the device probably is (EmitterEstimate)
+    float radius;                       // m
 };
 
 class DataManager {
 public:
-    void init();
-    
-    // Record a detection and return if it's a known device
-    bool recordDetection(const char* mac, const char* type, int rssi, 
-                         double lat, double lon);
-    
-    // Get device info
-    DeviceRecord* getDevice(const char* mac);
-    bool isKnownDevice(const char* mac);
-    uint32_t getDetectionCount(const char* mac);
-    
+    void init();  // Starts loading the database on a background task
+    bool isLoaded() { return loaded; }
+
+    // Record a detection and return if it's a known device (always false
+    // while the database loads or compacts - the detection is applied afterwards).
+    // time is the millis() the frame was captured at (DetectionRecord::time).
+    bool recordDetection(const uint8_t* mac, DeviceType type, int rssi,
+                         double lat, double lon, uint32_t time);
+
+    // Get device info (copied out - the table may be updated concurrently)
+    bool getDevice(const uint8_t* mac, DeviceRecord* out);
+    bool isKnownDevice(const uint8_t* mac);
+    uint32_t getDetectionCount(const uint8_t* mac);
+
     // Persistence
-    void flush();  // Write cache to SD
-    void autoFlush();  // Flush if interval exceeded
-    
-    // Export functions
-    void exportToGeoJSON(const char* filename);
-    void exportToCSV(const char* filename);
-    void exportSummary();  // Export all formats
-    
+    void flush();  // Append changed records to the journal
+    void autoFlush();  // Flush if interval exceeded, start a compaction when due
+    void compact();  // Rewrite the snapshot and restart the journal (background task)
+
+    // Export snapshot (see DataExporter). Devices are copied under the lock
+    // in one pass, so an export sees a consistent table; copied devices stop
+    // counting as changed until they are detected again.
+    uint32_t countForExport(bool changedOnly);
+    uint32_t snapshotForExport(ExportRecord* out, uint32_t max, bool changedOnly);
+    void requeueExport(const ExportRecord* records, uint32_t count);  // Export failed
+
     // Stats
-    uint32_t getTotalDevices() { return device_cache.size(); }
+    uint32_t getTotalDevices() { return devices.size(); }
+    uint32_t getCapacity() { return devices.capacity(); }
+    uint32_t getEvictedDevices() { return evicted_devices; }
     uint32_t getNewDevicesThisSession() { return new_devices_this_session; }
+    uint32_t getEarlyDropped() { return early_dropped; }
+    uint32_t getPendingDropped() { return pending_dropped; }
 
 private:
-    std::map<String, DeviceRecord> device_cache;
-    std::map<String, String> device_locations;  // MAC -> "lat1,lon1;lat2,lon2"
+    DeviceTable devices;
+    LocationHistory locations;          // Rings indexed by DeviceRecord::location_id
+    SemaphoreHandle_t lock = nullptr;   // Detections arrive from both cores
+    
+    // Background load and compaction
+    volatile bool loaded = false;       // First load done
+    volatile bool buffering = true;     // Detections go to early[]; cleared under earlyLock once it is drained
+    int8_t load_phase = -1;             // Boot profiler phase, ended by the load task
+    portMUX_TYPE earlyLock = portMUX_INITIALIZER_UNLOCKED;
+    EarlyDetection early[DATA_EARLY_CAPACITY];
+    uint32_t early_head = 0;
+    uint32_t early_count = 0;
+    uint32_t early_dropped = 0;
+    
+    // Persistence
+    DetectionJournal journal;
+    static const uint32_t PENDING_CAPACITY = 32;
+    JournalEntry pending[PENDING_CAPACITY];  // Location/removal deltas awaiting flush
+    uint32_t pending_count = 0;
+    uint32_t pending_dropped = 0;       // Journal kept failing; only a compaction saves these
+    uint64_t* dirty_macs = nullptr;     // Devices marked dirty since the last flush, in order
+    uint32_t dirty_count = 0;
+    uint32_t dirty_capacity = 0;
+    bool dirty_overflow = false;        // Queue full - the next flush walks the table
+    bool replaying = false;
+    bool compact_due = false;           // Journal too long or failing
+    unsigned long last_compact = 0;
     
+    // Legacy text database, imported once and renamed to *.imported
     const char* DB_FILE = "/detections.db";
     const char* LOCATIONS_FILE = "/locations.db";
     const char* INDEX_FILE = "/device_index.idx";
     
-    const uint32_t MAX_CACHE_SIZE = 500;
-    const uint32_t FLUSH_INTERVAL = 30000;  // 30 seconds
+    const uint32_t COMPACT_THRESHOLD = 64 * 1024;  // Journal bytes before compaction
+    const uint32_t COMPACT_RETRY_MS = 60000;       // Between compaction attempts
     unsigned long last_flush = 0;
     uint32_t new_devices_this_session = 0;
+    uint32_t evicted_devices = 0;
     
+    bool allocate(uint32_t capacity);
+    DeviceRecord* insertDevice(uint64_t mac);
+    void releaseLocations(DeviceRecord& rec);
+    void queuePending(const JournalEntry& entry);
+    void markDirty(DeviceRecord* rec);
+    void clearDirtyQueue();
     void loadDatabase();
-    void saveToDatabase();
-    void addLocation(const char* mac, double lat, double lon);
+    uint32_t reconcileEarly();
+    bool recordLocked(uint64_t key, DeviceType type, int rssi, int32_t lat_e6, int32_t lon_e6,
+                      unsigned long now);
+    static void loadTaskEntry(void* parameter);
+    static void compactTaskEntry(void* parameter);
+    void startCompaction();
+    bool importLegacyDatabase();
+    void flushLocked();
+    void compactLocked();
+    bool addLocation(DeviceRecord* rec, int32_t lat, int32_t lon);
+    bool estimateEntry(const DeviceRecord& rec, JournalEntry* out);
+    void seedEstimates();
+    void importLegacyLocations(DeviceRecord* rec, const char* text);
+    static void applyJournalEntry(const JournalEntry& entry, void* context);
     String getTimestamp();  // Returns RTC timestamp if available, else millis()
 };
 
@@ -0,0 +1,285 @@
+#include "detection_journal.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint8_t JOURNAL_MAGIC = 0xD5;
+
+// ============================================================================
+// CODEC
+// ============================================================================
+
+uint32_t journalCrc32(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void putU32(uint8_t* out, uint32_t v) {
+    out[0] = v & 0xFF;
+    out[1] = (v >> 8) & 0xFF;
+    out[2] = (v >> 16) & 0xFF;
+    out[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void journalEncode(const JournalEntry& entry, uint8_t* out) {
+    memset(out, 0, JOURNAL_RECORD_SIZE);
+    out[0] = JOURNAL_MAGIC;
+    out[1] = entry.kind;
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = (entry.mac >> (8 * (5 - i))) & 0xFF;
+    }
+    putU32(out + 8, entry.a);
+    putU32(out + 12, entry.b);
+    putU32(out + 16, entry.c);
+    out[20] = (uint8_t)entry.rssi;
+    out[21] = entry.type;
+    putU32(out + 22, entry.d);
+    putU32(out + 28, journalCrc32(out, 28));
+}
+
+bool journalDecode(const uint8_t* in, JournalEntry* out) {
+    if (in[0] != JOURNAL_MAGIC) return false;
+    if (in[1] < JOURNAL_DEVICE || in[1] > JOURNAL_ESTIMATE) return false;
+    if (getU32(in + 28) != journalCrc32(in, 28)) return false;
+
+    out->kind = (JournalKind)in[1];
+    out->mac = 0;
+    for (int i = 0; i < 6; i++) {
+        out->mac = (out->mac << 8) | in[2 + i];
+    }
+    out->a = getU32(in + 8);
+    out->b = getU32(in + 12);
+    out->c = getU32(in + 16);
+    out->rssi = (int8_t)in[20];
+    out->type = in[21];
+    out->d = getU32(in + 22);
+    return true;
+}
+
+// ============================================================================
+// FILES
+// ============================================================================
+
+static void closeFile(FileHandle*& file) {
+    delete file;
+    file = nullptr;
+}
+
+DetectionJournal::~DetectionJournal() {
+    closeFile(journalFile);
+    closeFile(snapshotFile);
+}
+
+void DetectionJournal::begin(FileSystem& filesystem) {
+    closeFile(journalFile);
+    closeFile(snapshotFile);
+    fs = &filesystem;
+
+    // Finish or discard a compaction interrupted by power loss
+    if (!fs->exists(SNAPSHOT_FILE) && fs->exists(SNAPSHOT_TMP_FILE) &&
+        snapshotComplete(SNAPSHOT_TMP_FILE)) {
+        fs->rename(SNAPSHOT_TMP_FILE, SNAPSHOT_FILE);
+        printf("[Journal] Recovered snapshot from interrupted compaction\n");
+    }
+    if (fs->exists(SNAPSHOT_TMP_FILE)) {
+        fs->remove(SNAPSHOT_TMP_FILE);
+    }
+
+    // Same for a repair: the copy was complete once the old journal was removed
+    if (fs->exists(JOURNAL_TMP_FILE)) {
+        if (!fs->exists(JOURNAL_FILE)) {
+            fs->rename(JOURNAL_TMP_FILE, JOURNAL_FILE);
+            printf("[Journal] Recovered journal from interrupted repair\n");
+        } else {
+            fs->remove(JOURNAL_TMP_FILE);
+        }
+    }
+}
+
+bool DetectionJournal::snapshotComplete(const char* path) {
+    FileHandle* file = fs->open(path, FILE_MODE_READ);
+    if (!file) return false;
+
+    size_t size = file->size();
+    bool complete = false;
+    if (size >= JOURNAL_RECORD_SIZE && size % JOURNAL_RECORD_SIZE == 0) {
+        uint8_t buf[JOURNAL_RECORD_SIZE];
+        JournalEntry entry;
+        if (file->seek(size - JOURNAL_RECORD_SIZE) &&
+            file->read(buf, JOURNAL_RECORD_SIZE) == JOURNAL_RECORD_SIZE &&
+            journalDecode(buf, &entry) && entry.kind == JOURNAL_END &&
+            entry.c == size / JOURNAL_RECORD_SIZE - 1) {
+            complete = true;
+        }
+    }
+    delete file;
+    return complete;
+}
+
+uint32_t DetectionJournal::replayFile(const char* path, ApplyFn apply, void* context,
+                                      bool stopAtEnd, uint32_t* validBytes, uint32_t* totalBytes) {
+    if (validBytes) *validBytes = 0;
+    if (totalBytes) *totalBytes = 0;
+    if (!fs->exists(path)) return 0;
+
+    FileHandle* file = fs->open(path, FILE_MODE_READ);
+    if (!file) return 0;
+
+    if (totalBytes) *totalBytes = file->size();
+
+    uint8_t buf[JOURNAL_RECORD_SIZE];
+    uint32_t records = 0;
+    uint32_t valid = 0;
+    JournalEntry entry;
+
+    while (file->read(buf, JOURNAL_RECORD_SIZE) == JOURNAL_RECORD_SIZE) {
+        if (!journalDecode(buf, &entry)) break;   // Torn or corrupt record
+        valid += JOURNAL_RECORD_SIZE;
+        if (entry.kind == JOURNAL_END) {
+            if (stopAtEnd) break;
+            continue;
+        }
+        apply(entry, context);
+        records++;
+    }
+    delete file;
+
+    if (validBytes) *validBytes = valid;
+    return records;
+}
+
+JournalReplayStats DetectionJournal::replay(ApplyFn apply, void* context) {
+    JournalReplayStats stats;
+    if (!fs) return stats;
+
+    stats.snapshotRecords = replayFile(SNAPSHOT_FILE, apply, context, true, nullptr, nullptr);
+
+    uint32_t valid = 0;
+    uint32_t total = 0;
+    stats.journalRecords = replayFile(JOURNAL_FILE, apply, context, false, &valid, &total);
+    stats.discardedBytes = total - valid;
+    stats.needsCompaction = stats.discardedBytes > 0;
+    journalBytes = valid;
+
+    if (stats.discardedBytes > 0) {
+        printf("[Journal] Discarded %u bytes of torn/corrupt journal tail\n",
+               (unsigned)stats.discardedBytes);
+
+        // Appending after the damage would hide every later record from replay
+        if (!repairJournal(valid)) {
+            printf("[Journal] Failed to cut %s - not appending until compaction\n", JOURNAL_FILE);
+            return stats;
+        }
+    }
+
+    openJournal();
+    return stats;
+}
+
+// Copies the first validBytes of the journal to a new file and swaps it in
+bool DetectionJournal::repairJournal(uint32_t validBytes) {
+    FileHandle* in = fs->open(JOURNAL_FILE, FILE_MODE_READ);
+    FileHandle* out = in ? fs->open(JOURNAL_TMP_FILE, FILE_MODE_WRITE) : nullptr;
+    bool ok = in && out;
+
+    uint8_t buf[JOURNAL_RECORD_SIZE * 8];
+    for (uint32_t copied = 0; ok && copied < validBytes; ) {
+        size_t n = validBytes - copied < sizeof(buf) ? validBytes - copied : sizeof(buf);
+        ok = in->read(buf, n) == n && out->write(buf, n) == n;
+        copied += n;
+    }
+    ok = ok && out->flush();
+    delete in;
+    delete out;
+
+    if (!ok) {
+        fs->remove(JOURNAL_TMP_FILE);
+        return false;
+    }
+
+    // The copy is durable; from here any interruption is recovered by begin()
+    return fs->remove(JOURNAL_FILE) && fs->rename(JOURNAL_TMP_FILE, JOURNAL_FILE);
+}
+
+bool DetectionJournal::openJournal() {
+    closeFile(journalFile);
+    journalFile = fs->open(JOURNAL_FILE, FILE_MODE_APPEND);
+    if (!journalFile) {
+        printf("[Journal] Failed to open %s\n", JOURNAL_FILE);
+        return false;
+    }
+    return true;
+}
+
+bool DetectionJournal::append(const JournalEntry& entry) {
+    if (!journalFile) return false;
+
+    uint8_t buf[JOURNAL_RECORD_SIZE];
+    journalEncode(entry, buf);
+    if (journalFile->write(buf, JOURNAL_RECORD_SIZE) != JOURNAL_RECORD_SIZE) {
+        return false;
+    }
+    journalBytes += JOURNAL_RECORD_SIZE;
+    return true;
+}
+
+bool DetectionJournal::sync() {
+    if (!journalFile) return false;
+    return journalFile->flush();
+}
+
+bool DetectionJournal::beginSnapshot() {
+    if (!fs) return false;
+    closeFile(snapshotFile);
+    snapshotFile = fs->open(SNAPSHOT_TMP_FILE, FILE_MODE_WRITE);
+    snapshotCount = 0;
+    return snapshotFile != nullptr;
+}
+
+bool DetectionJournal::writeSnapshot(const JournalEntry& entry) {
+    if (!snapshotFile) return false;
+
+    uint8_t buf[JOURNAL_RECORD_SIZE];
+    journalEncode(entry, buf);
+    if (snapshotFile->write(buf, JOURNAL_RECORD_SIZE) != JOURNAL_RECORD_SIZE) {
+        return false;
+    }
+    snapshotCount++;
+    return true;
+}
+
+bool DetectionJournal::commitSnapshot() {
+    JournalEntry end = {};
+    end.kind = JOURNAL_END;
+    end.c = snapshotCount;
+    if (!writeSnapshot(end) || !snapshotFile->flush()) {
+        abortSnapshot();
+        return false;
+    }
+    closeFile(snapshotFile);
+
+    // The tmp file is complete; from here any interruption is recovered by begin()
+    fs->remove(SNAPSHOT_FILE);
+    if (!fs->rename(SNAPSHOT_TMP_FILE, SNAPSHOT_FILE)) return false;
+
+    // Everything in the journal is now in the snapshot
+    closeFile(journalFile);
+    fs->remove(JOURNAL_FILE);
+    journalBytes = 0;
+    return openJournal();
+}
+
+void DetectionJournal::abortSnapshot() {
+    closeFile(snapshotFile);
+    fs->remove(SNAPSHOT_TMP_FILE);
+}
@@ -0,0 +1,114 @@
+#ifndef DETECTION_JOURNAL_H
+#define DETECTION_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hal/hal.h"
+
+// ============================================================================
+// DETECTION JOURNAL
+// ============================================================================
+//
+// Append-only binary log of fixed-size 32-byte records, each protected by a
+// CRC32. Flushing appends only the records that changed since the last flush.
+// Periodically the whole database is compacted into a snapshot file (same
+// record format, terminated by an END record) and the journal is restarted.
+//
+// Startup replays the snapshot and then the journal. Replay stops at the first
+// record with a bad magic byte or CRC, which is what a power cut in the middle
+// of an append leaves behind; the damaged tail is then cut off (the intact
+// prefix is copied to a new journal that replaces the old one) so later
+// appends follow the last good record. Device records carry the full device
+// state and location records are de-duplicated on apply, so replaying the
+// same record twice is harmless.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+//
+// Record layout (little-endian):
+//   0      magic (0xD5)
+//   1      kind
+//   2-7    MAC (big-endian, as printed)
+//   8-11   a: first_seen | latitude  (microdegrees)
+//   12-15  b: last_seen  | longitude (microdegrees)
+//   16-19  c: detection_count | record count (END) | weight (ESTIMATE, float)
+//   20     rssi
+//   21     device type
+//   22-25  d: spread (ESTIMATE, float m^2), else zero
+//   26-27  reserved (zero)
+//   28-31  CRC32 of bytes 0-27
+
+enum JournalKind : uint8_t {
+    JOURNAL_DEVICE = 1,     // Full device state (upsert)
+    JOURNAL_LOCATION = 2,   // Add one location to a device
+    JOURNAL_REMOVE = 3,     // Device evicted from the table
+    JOURNAL_END = 4,        // Snapshot terminator, c = number of records before it
+    JOURNAL_ESTIMATE = 5    // Device location estimate (EmitterEstimate::restore)
+};
+
+struct JournalEntry {
+    JournalKind kind;
+    uint64_t mac;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+    int8_t rssi;
+    uint8_t type;
+    uint32_t d;
+};
+
+static const size_t JOURNAL_RECORD_SIZE = 32;
+
+// Codec (no I/O)
+uint32_t journalCrc32(const uint8_t* data, size_t length);
+void journalEncode(const JournalEntry& entry, uint8_t* out);
+bool journalDecode(const uint8_t* in, JournalEntry* out);
+
+struct JournalReplayStats {
+    uint32_t snapshotRecords = 0;
+    uint32_t journalRecords = 0;
+    uint32_t discardedBytes = 0;   // Torn/corrupt tail of the journal
+    bool needsCompaction = false;  // Journal tail was damaged or snapshot was recovered
+};
+
+class DetectionJournal {
+public:
+    typedef void (*ApplyFn)(const JournalEntry& entry, void* context);
+
+    ~DetectionJournal();
+    void begin(FileSystem& fs);
+
+    // Replay snapshot then journal through apply()
+    JournalReplayStats replay(ApplyFn apply, void* context);
+
+    // Journal appends (buffered until sync)
+    bool append(const JournalEntry& entry);
+    bool sync();
+    uint32_t journalSize() { return journalBytes; }
+    bool isOpen() { return journalFile != nullptr; }
+
+    // Snapshot compaction: beginSnapshot, writeSnapshot for every record, commitSnapshot
+    bool beginSnapshot();
+    bool writeSnapshot(const JournalEntry& entry);
+    bool commitSnapshot();
+    void abortSnapshot();
+
+private:
+    FileSystem* fs = nullptr;
+    FileHandle* journalFile = nullptr;
+    FileHandle* snapshotFile = nullptr;
+    uint32_t journalBytes = 0;
+    uint32_t snapshotCount = 0;
+
+    const char* JOURNAL_FILE = "/detections.jrn";
+    const char* SNAPSHOT_FILE = "/detections.snap";
+    const char* SNAPSHOT_TMP_FILE = "/detections.snap.tmp";
+    const char* JOURNAL_TMP_FILE = "/detections.jrn.tmp";
+
+    bool openJournal();
+    bool repairJournal(uint32_t validBytes);
+    bool snapshotComplete(const char* path);
+    uint32_t replayFile(const char* path, ApplyFn apply, void* context,
+                        bool stopAtEnd, uint32_t* validBytes, uint32_t* totalBytes);
+};
+
+#endif // DETECTION_JOURNAL_H
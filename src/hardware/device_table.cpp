@@ -0,0 +1,177 @@
+#include "device_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <ctype.h>
+
+static const char* const DEVICE_TYPE_NAMES[] = {"Unknown", "WiFi", "BLE", "Raven"};
+
+const char* deviceTypeName(DeviceType type) {
+    return (type <= DEVICE_RAVEN) ? DEVICE_TYPE_NAMES[type] : DEVICE_TYPE_NAMES[0];
+}
+
+DeviceType deviceTypeFromName(const char* name) {
+    if (!name) return DEVICE_UNKNOWN;
+    for (uint8_t i = 1; i <= DEVICE_RAVEN; i++) {
+        if (strcasecmp(name, DEVICE_TYPE_NAMES[i]) == 0) return (DeviceType)i;
+    }
+    return DEVICE_UNKNOWN;
+}
+
+uint64_t macToKey(const uint8_t* mac) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        key = (key << 8) | mac[i];
+    }
+    return key;
+}
+
+void keyToMac(uint64_t key, uint8_t* mac) {
+    for (int i = 5; i >= 0; i--) {
+        mac[i] = key & 0xFF;
+        key >>= 8;
+    }
+}
+
+bool parseMac(const char* text, uint64_t* keyOut) {
+    if (!text) return false;
+
+    uint64_t key = 0;
+    int digits = 0;
+    for (const char* p = text; *p && digits < 12; p++) {
+        char c = tolower((unsigned char)*p);
+        int v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c == ':' || c == '-') continue;
+        else return false;
+        key = (key << 4) | (uint64_t)v;
+        digits++;
+    }
+    if (digits != 12) return false;
+    *keyOut = key;
+    return true;
+}
+
+void formatMac(uint64_t key, char* out) {
+    uint8_t mac[6];
+    keyToMac(key, mac);
+    snprintf(out, 18, "%02x:%02x:%02x:%02x:%02x:%02x",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+DeviceTable::~DeviceTable() {
+    free(table);
+}
+
+bool DeviceTable::init(uint32_t capacity) {
+    free(table);
+    table = nullptr;
+    slots = mask = count = maxDevices = 0;
+
+    if (capacity == 0) return false;
+
+    // Keep the load factor at or below 0.8 so probe chains stay short
+    uint32_t wanted = capacity + capacity / 4 + 1;
+    uint32_t n = 8;
+    while (n < wanted) n <<= 1;
+
+    table = (DeviceRecord*)calloc(n, sizeof(DeviceRecord));
+    if (!table) return false;
+
+    slots = n;
+    mask = n - 1;
+    maxDevices = capacity;
+    return true;
+}
+
+uint32_t DeviceTable::home(uint64_t mac) const {
+    // 64-bit finalizer (MurmurHash3 fmix64) spreads OUI-clustered keys
+    mac ^= mac >> 33;
+    mac *= 0xff51afd7ed558ccdULL;
+    mac ^= mac >> 33;
+    mac *= 0xc4ceb9fe1a85ec53ULL;
+    mac ^= mac >> 33;
+    return (uint32_t)mac & mask;
+}
+
+DeviceRecord* DeviceTable::find(uint64_t mac) {
+    if (!table) return nullptr;
+
+    for (uint32_t i = home(mac); ; i = (i + 1) & mask) {
+        if (!table[i].used) return nullptr;
+        if (table[i].mac == mac) return &table[i];
+    }
+}
+
+DeviceRecord* DeviceTable::insert(uint64_t mac, DeviceRecord* evictedOut, bool* didEvict) {
+    if (didEvict) *didEvict = false;
+    if (!table) return nullptr;
+
+    if (count >= maxDevices) {
+        uint32_t victim = findVictim();
+        if (evictedOut) *evictedOut = table[victim];
+        if (didEvict) *didEvict = true;
+        eraseSlot(victim);
+    }
+
+    uint32_t i = home(mac);
+    while (table[i].used) {
+        i = (i + 1) & mask;
+    }
+
+    memset(&table[i], 0, sizeof(DeviceRecord));
+    table[i].mac = mac;
+    table[i].used = 1;
+    count++;
+    return &table[i];
+}
+
+bool DeviceTable::remove(uint64_t mac) {
+    DeviceRecord* rec = find(mac);
+    if (!rec) return false;
+    eraseSlot(rec - table);
+    return true;
+}
+
+void DeviceTable::clear() {
+    if (table) memset(table, 0, slots * sizeof(DeviceRecord));
+    count = 0;
+}
+
+void DeviceTable::eraseSlot(uint32_t i) {
+    // Backward-shift deletion: pull later members of the probe chain into the
+    // hole so lookups never need tombstones
+    table[i].used = 0;
+    count--;
+
+    uint32_t hole = i;
+    for (uint32_t j = (i + 1) & mask; table[j].used; j = (j + 1) & mask) {
+        uint32_t h = home(table[j].mac);
+        // Move j into the hole unless its home lies cyclically in (hole, j]
+        bool stays = (hole <= j) ? (hole < h && h <= j) : (hole < h || h <= j);
+        if (!stays) {
+            table[hole] = table[j];
+            table[j].used = 0;
+            hole = j;
+        }
+    }
+}
+
+uint32_t DeviceTable::findVictim() const {
+    uint32_t victim = 0;
+    bool found = false;
+
+    for (uint32_t i = 0; i < slots; i++) {
+        if (!table[i].used) continue;
+        if (!found ||
+            table[i].detection_count < table[victim].detection_count ||
+            (table[i].detection_count == table[victim].detection_count &&
+             table[i].last_seen < table[victim].last_seen)) {
+            victim = i;
+            found = true;
+        }
+    }
+    return victim;
+}
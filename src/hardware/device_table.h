@@ -0,0 +1,88 @@
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// DEVICE TABLE
+// ============================================================================
+//
+// Preallocated open-addressing hash table of detected devices keyed by the
+// 48-bit MAC packed into a uint64_t. Linear probing with backward-shift
+// deletion (no tombstones). All memory is allocated once in init(), so a
+// long drive does not fragment the heap. When the table holds `capacity`
+// devices, inserting a new one evicts the device with the lowest detection
+// count (oldest last_seen breaks ties).
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+enum DeviceType : uint8_t {
+    DEVICE_UNKNOWN = 0,
+    DEVICE_WIFI = 1,
+    DEVICE_BLE = 2,
+    DEVICE_RAVEN = 3
+};
+
+const char* deviceTypeName(DeviceType type);
+DeviceType deviceTypeFromName(const char* name);
+
+// MAC helpers - keys hold the address big-endian in the low 48 bits
+uint64_t macToKey(const uint8_t* mac);
+void keyToMac(uint64_t key, uint8_t* mac);
+bool parseMac(const char* text, uint64_t* keyOut);
+void formatMac(uint64_t key, char* out);  // out must hold 18 bytes
+
+// Device record (POD - safe to memcpy and to write to storage as-is)
+struct DeviceRecord {
+    uint64_t mac;
+    uint32_t first_seen;
+    uint32_t last_seen;
+    uint32_t detection_count;
+    uint16_t location_id;    // Owner-defined slot for per-device extras
+    int8_t rssi;
+    DeviceType type;
+    uint8_t is_new;          // 1 if first detection this session
+    uint8_t dirty;           // Changed since last persisted (owner-managed)
+    uint8_t unexported;      // Changed since last export (owner-managed)
+    uint8_t used;            // Slot occupied (internal)
+};
+
+class DeviceTable {
+public:
+    ~DeviceTable();
+
+    // Allocate room for `capacity` devices; returns false on allocation failure
+    bool init(uint32_t capacity);
+
+    DeviceRecord* find(uint64_t mac);
+
+    // Insert a zeroed record for mac (must not already be present). If the
+    // table is full the weakest device is evicted first and copied to
+    // *evictedOut when provided. Returns nullptr only if init() failed.
+    DeviceRecord* insert(uint64_t mac, DeviceRecord* evictedOut = nullptr, bool* didEvict = nullptr);
+
+    bool remove(uint64_t mac);
+    void clear();
+
+    uint32_t size() const { return count; }
+    uint32_t capacity() const { return maxDevices; }
+
+    // Slot iteration: for (i < slotCount()) if (DeviceRecord* r = slotAt(i)) ...
+    uint32_t slotCount() const { return slots; }
+    DeviceRecord* slotAt(uint32_t i) { return (i < slots && table[i].used) ? &table[i] : nullptr; }
+    const DeviceRecord* slotAt(uint32_t i) const { return (i < slots && table[i].used) ? &table[i] : nullptr; }
+
+private:
+    DeviceRecord* table = nullptr;
+    uint32_t slots = 0;        // Power of two
+    uint32_t mask = 0;
+    uint32_t count = 0;
+    uint32_t maxDevices = 0;
+
+    uint32_t home(uint64_t mac) const;
+    void eraseSlot(uint32_t i);
+    uint32_t findVictim() const;
+};
+
+#endif // DEVICE_TABLE_H
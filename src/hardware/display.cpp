@@ -1,103 +1,153 @@
 #include "display.h"
+#include "../system/metrics.h"
 
 Display display;
 
-bool Display::begin() {
+static MetricHistogram frameLatency("oled.frame");  // Render + I2C push
+static MetricCounter bytesPushed("oled.bytes");
+
+// SSD1306 command and data streams over Wire, split to fit its buffer
+class WireOledBus : public OledBus {
+public:
+    void command(const uint8_t* bytes, size_t len) override { send(0x00, bytes, len); }
+    void data(const uint8_t* bytes, size_t len) override { send(0x40, bytes, len); }
+
+private:
+    static void send(uint8_t control, const uint8_t* bytes, size_t len) {
+        while (len > 0) {
+            size_t chunk = len < OLED_I2C_CHUNK ? len : OLED_I2C_CHUNK;
+            Wire.beginTransmission(OLED_ADDRESS);
+            Wire.write(control);
+            Wire.write(bytes, chunk);
+            Wire.endTransmission();
+            bytes += chunk;
+            len -= chunk;
+        }
+    }
+};
+
+static WireOledBus oledBus;
+
+bool Display::begin(uint8_t contrast, uint32_t i2cClock) {
     Wire.begin(OLED_SDA, OLED_SCL);
-    
-    if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDRESS)) {
-        printf("SSD1306 allocation failed!\n");
+    Wire.setClock(i2cClock);
+
+    Wire.beginTransmission(OLED_ADDRESS);
+    if (Wire.endTransmission() != 0) {
+        printf("SSD1306 not found at 0x%02X!\n", OLED_ADDRESS);
         return false;
     }
-    
-    printf("OLED display initialized (128x64)\n");
+
+    // 128x64, internal charge pump, horizontal addressing; same orientation
+    // and panel settings as the Adafruit driver used before
+    const uint8_t init[] = {
+        0xAE,               // Display off
+        0xD5, 0x80,         // Clock divide
+        0xA8, 0x3F,         // Multiplex 64
+        0xD3, 0x00,         // No offset
+        0x40,               // Start line 0
+        0x8D, 0x14,         // Charge pump on
+        0x20, 0x00,         // Horizontal addressing
+        0xA1, 0xC8,         // Segment remap, COM scan descending
+        0xDA, 0x12,         // COM pins
+        0x81, contrast,     // Contrast (display.brightness)
+        0xD9, 0xF1,         // Precharge
+        0xDB, 0x40,         // VCOMH deselect
+        0xA4, 0xA6,         // Follow RAM, normal (not inverted)
+        0x2E,               // Scrolling off
+        0xAF                // Display on
+    };
+    oledBus.command(init, sizeof(init));
+    canvas.invalidate();    // Controller RAM is random after power-up
+
+    if (!renderTask) {
+        xTaskCreatePinnedToCore(renderTaskEntry, "Display", DISPLAY_TASK_STACK_SIZE, this,
+                                tskIDLE_PRIORITY, &renderTask, 1);
+    }
+
+    printf("OLED display initialized (128x64, I2C %lu kHz)\n", (unsigned long)(i2cClock / 1000));
     return true;
 }
 
+// ============================================================================
+// SCREENS
+// ============================================================================
+
 void Display::showBootScreen() {
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    display.setCursor(0, 0);
-    display.println(F("FLOCK DETECTOR v2.0"));
-    display.println(F(""));
-    display.println(F("ESP32-WROOM-32"));
-    display.println(F("DevKit V4"));
-    display.println(F(""));
-    display.println(F("Initializing..."));
-    display.display();
+    OledScreen screen;
+    oledBootScreen(&screen);
+    post(screen, false);
 }
 
 void Display::update(bool deviceInRange, int totalDetections, int wifiDetections, int bleDetections,
                     bool gpsValid, double lat, double lon, const char* gpsStatus, bool sdInitialized) {
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    
-    // Line 1: Header
-    display.setCursor(0, 0);
-    display.println(F("FLOCK DETECTOR v2.0"));
-    
-    // Line 2: Status
-    display.print(F("Status: "));
-    if (deviceInRange) {
-        display.println(F("DETECTED!"));
-    } else {
-        display.println(F("SCANNING"));
-    }
-    
-    // Line 3-4: Detection counts (MORE PROMINENT)
-    display.setTextSize(1);
-    display.print(F("Total: "));
-    display.setTextSize(2);
-    display.println(totalDetections);
-    
-    display.setTextSize(1);
-    display.print(F("WiFi:"));
-    display.print(wifiDetections);
-    display.print(F(" BLE:"));
-    display.println(bleDetections);
-    
-    // Line 5: GPS status
-    display.print(F("GPS: "));
-    if (gpsValid) {
-        display.print(lat, 2);
-        display.print(F(","));
-        display.print(lon, 2);
+    OledStatus status = {deviceInRange, totalDetections, wifiDetections, bleDetections,
+                         gpsValid, lat, lon, gpsStatus, sdInitialized};
+    OledScreen screen;
+    oledStatusScreen(&screen, status);
+    post(screen, false);
+}
+
+// Shown for DISPLAY_ALERT_TIME, then the latest status; the caller carries on
+void Display::showDetection(const char* deviceType, int rssi, bool gpsValid, double lat, double lon) {
+    OledScreen screen;
+    oledDetectionScreen(&screen, deviceType, rssi, gpsValid, lat, lon);
+    post(screen, true);
+}
+
+void Display::showProgress(const char* title, uint8_t percent, uint32_t items) {
+    OledScreen screen;
+    oledProgressScreen(&screen, title, percent, items);
+    post(screen, false);
+}
+
+void Display::post(const OledScreen& screen, bool isAlert) {
+    if (!renderTask) return;
+
+    portENTER_CRITICAL(&mux);
+    if (isAlert) {
+        alert = screen;
+        alertUntil = millis() + DISPLAY_ALERT_TIME;
+        alertActive = true;
     } else {
-        display.print(gpsStatus);
+        latest = screen;
     }
-    
-    // Line 6: SD status
-    display.setCursor(90, 56);
-    display.print(F("SD:"));
-    display.print(sdInitialized ? F("OK") : F("X"));
-    
-    display.display();
+    portEXIT_CRITICAL(&mux);
+    xTaskNotifyGive(renderTask);
 }
 
-void Display::showDetection(const char* deviceType, int rssi, bool gpsValid, double lat, double lon) {
-    display.clearDisplay();
-    display.setTextSize(2);
-    display.setTextColor(SSD1306_WHITE);
-    display.setCursor(0, 0);
-    display.println(F("ALERT!"));
-    
-    display.setTextSize(1);
-    display.println(F(""));
-    display.print(F("Type: "));
-    display.println(deviceType);
-    display.print(F("RSSI: "));
-    display.print(rssi);
-    display.println(F(" dBm"));
-    
-    if (gpsValid) {
-        display.print(F("GPS: "));
-        display.print(lat, 2);
-        display.print(F(","));
-        display.println(lon, 2);
+// ============================================================================
+// RENDER TASK
+// ============================================================================
+
+void Display::renderTaskEntry(void* parameter) {
+    static_cast<Display*>(parameter)->renderLoop();
+}
+
+void Display::renderLoop() {
+    OledScreen screen;
+
+    while (1) {
+        uint32_t now = millis();
+        uint32_t alertLeft = 0;
+
+        portENTER_CRITICAL(&mux);
+        if (alertActive && (int32_t)(alertUntil - now) > 0) {
+            alertLeft = alertUntil - now;
+            screen = alert;
+        } else {
+            alertActive = false;
+            screen = latest;
+        }
+        portEXIT_CRITICAL(&mux);
+
+        {
+            MetricTimer timer(frameLatency);
+            canvas.render(screen);
+            bytesPushed.add(canvas.flush(oledBus));
+        }
+
+        // Sleep until the next post, or until the alert expires
+        ulTaskNotifyTake(pdTRUE, alertLeft ? pdMS_TO_TICKS(alertLeft) : portMAX_DELAY);
     }
-    
-    display.display();
-    delay(2000);
 }
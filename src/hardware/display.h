@@ -3,19 +3,39 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <Adafruit_SSD1306.h>
 #include "config/pins.h"
+#include "oled_canvas.h"
+#include "oled_screens.h"
+
+#define DISPLAY_TASK_STACK_SIZE 3072
+#define DISPLAY_ALERT_TIME 2000         // ms an alert stays up before the status returns
 
 class Display {
 public:
-    bool begin();
+    // Screens are posted to the render task and return immediately. Posts
+    // that arrive before it runs replace each other, so a burst of updates
+    // costs one frame; the canvas then pushes only the columns that changed.
+    bool begin(uint8_t contrast, uint32_t i2cClock);
     void showBootScreen();
     void update(bool deviceInRange, int totalDetections, int wifiDetections, int bleDetections, 
                 bool gpsValid, double lat, double lon, const char* gpsStatus, bool sdInitialized);
     void showDetection(const char* deviceType, int rssi, bool gpsValid, double lat, double lon);
+    void showProgress(const char* title, uint8_t percent, uint32_t items);  // Background jobs (export)
+
+    TaskHandle_t getRenderTask() { return renderTask; }
 
 private:
-    Adafruit_SSD1306 display{SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET};
+    OledCanvas canvas;                  // Render task only
+    OledScreen latest;                  // Guarded by mux
+    OledScreen alert;
+    uint32_t alertUntil = 0;
+    bool alertActive = false;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t renderTask = nullptr;
+
+    void post(const OledScreen& screen, bool isAlert);
+    static void renderTaskEntry(void* parameter);
+    void renderLoop();
 };
 
 extern Display display;
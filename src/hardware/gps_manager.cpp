@@ -1,74 +1,174 @@
 #include "gps_manager.h"
+#include "../location/geo.h"
+#include "../system/metrics.h"
 
 GPSManager gpsManager;
 
-void GPSManager::begin() {
-    gpsSerial.begin(9600, SERIAL_8N1, GPS_RX, GPS_TX);
+static MetricCounter fixesPublished("gps.fixes");
+
+void GPSManager::begin(bool ubx, uint8_t rateHz) {
+    ubxRequested = ubx;
+    this->rateHz = rateHz ? rateHz : 1;
+
+    gpsSerial.begin(GPS_NMEA_BAUD, SERIAL_8N1, GPS_RX, GPS_TX);
+    gpsSerial.onReceive(onReceive);
+
+    // Same core as the BLE task, away from the WiFi processing task
+    xTaskCreatePinnedToCore(taskEntry, "GPS", GPS_TASK_STACK_SIZE, this,
+                            GPS_TASK_PRIORITY, &task, 0);
     printf("GPS initialized on UART2 (RX:%d, TX:%d)\n", GPS_RX, GPS_TX);
 }
 
-void GPSManager::update() {
-    while (gpsSerial.available() > 0) {
-        gps.encode(gpsSerial.read());
+void GPSManager::getFix(GpsFix* out) {
+    snapshot.read(out);
+    if (out->valid && halMillis() - out->timestamp > GPS_FIX_TIMEOUT) {
+        out->valid = false;
+        out->hasCourse = false;
+        out->status = "LOST";
     }
 }
 
-bool GPSManager::isValid() {
-    return gps.location.isValid();
-}
-
-double GPSManager::latitude() {
-    return gps.location.lat();
+bool GPSManager::getFixAt(uint32_t time, GpsFix* out) {
+    GpsFix latest;
+    getFix(&latest);
+    portENTER_CRITICAL(&trackLock);
+    bool final = trackFixAt(track, latest, time, halMillis(), out);
+    portEXIT_CRITICAL(&trackLock);
+    return final;
 }
 
-double GPSManager::longitude() {
-    return gps.location.lng();
+// Runs in the UART driver's event task
+void GPSManager::onReceive() {
+    if (gpsManager.task) xTaskNotifyGive(gpsManager.task);
 }
 
-double GPSManager::altitude() {
-    return gps.altitude.meters();
+void GPSManager::taskEntry(void* parameter) {
+    static_cast<GPSManager*>(parameter)->run();
 }
 
-int GPSManager::satellites() {
-    return gps.satellites.value();
-}
+void GPSManager::run() {
+    if (ubxRequested) {
+        ubxActive = configureUbx();
+    }
+    if (!ubxActive) {
+        limitNmea();
+    }
+    printf("[GPS] %s\n", ubxActive ? "UBX NAV-PVT" : "NMEA (RMC/GGA)");
 
-String GPSManager::getLocation() {
-    if (gps.location.isValid()) {
-        return String(gps.location.lat(), 6) + "," + String(gps.location.lng(), 6);
+    while (1) {
+        // The timeout only matters if the receive callback is lost
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        drain();
     }
-    return "NO_FIX";
 }
 
-String GPSManager::getStatus() {
-    if (gps.location.isValid()) {
-        return "FIX";
-    } else if (gps.satellites.value() > 0) {
-        return "SEARCHING";
+// Feeds everything received; both parsers see every byte so the mode
+// switch needs no handover. Returns the last UBX message seen.
+UbxMessage GPSManager::drain() {
+    UbxMessage last = UBX_NONE;
+    uint8_t buffer[GPS_READ_CHUNK];
+    int available;
+
+    while ((available = gpsSerial.available()) > 0) {
+        size_t n = gpsSerial.readBytes(buffer, available < GPS_READ_CHUNK ? available : GPS_READ_CHUNK);
+        for (size_t i = 0; i < n; i++) {
+            if (nmea.encode(buffer[i])) {
+                publish(nmea.getFix());
+            }
+            UbxMessage message = ubx.encode(buffer[i]);
+            if (message == UBX_FIX) {
+                publish(ubx.getFix());
+            }
+            if (message != UBX_NONE) last = message;
+        }
     }
-    return "NO_GPS";
+    return last;
 }
 
-int GPSManager::getYear() {
-    return gps.date.year();
-}
+void GPSManager::publish(const GpsFix& fix) {
+    snapshot.publish(fix);
+    fixesPublished.add();
+    if (!fix.valid) return;
 
-int GPSManager::getMonth() {
-    return gps.date.month();
+    portENTER_CRITICAL(&trackLock);
+    track.add(fix.timestamp, toMicrodegrees(fix.latitude), toMicrodegrees(fix.longitude));
+    portEXIT_CRITICAL(&trackLock);
 }
 
-int GPSManager::getDay() {
-    return gps.date.day();
+// ============================================================================
+// RECEIVER CONFIGURATION
+// ============================================================================
+
+bool GPSManager::sendUbx(uint8_t msgClass, uint8_t msgId, const uint8_t* payload, uint16_t len, bool waitAck) {
+    uint8_t frame[UBX_CFG_PRT_LENGTH + UBX_FRAME_OVERHEAD];
+    size_t size = ubxFrame(msgClass, msgId, payload, len, frame);
+    gpsSerial.write(frame, size);
+    if (!waitAck) return true;
+
+    unsigned long start = millis();
+    while (millis() - start < GPS_ACK_TIMEOUT) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
+        UbxMessage reply = drain();
+        if ((reply == UBX_ACK || reply == UBX_NAK) &&
+            ubx.getAckClass() == msgClass && ubx.getAckId() == msgId) {
+            return reply == UBX_ACK;
+        }
+    }
+    return false;
 }
 
-int GPSManager::getHour() {
-    return gps.time.hour();
-}
+// Settings go to the receiver's RAM only; a power cycle restores NMEA
+bool GPSManager::configureUbx() {
+    uint8_t payload[UBX_CFG_PRT_LENGTH];
+    ubxCfgMsg(payload, UBX_CLASS_NAV, UBX_NAV_PVT, 1);
+
+    // NAV-PVT acknowledged: a u-blox with PVT support. After a reset of the
+    // ESP32 alone the receiver may still be at the fast baud rate.
+    bool ack = sendUbx(UBX_CLASS_CFG, UBX_CFG_MSG, payload, UBX_CFG_MSG_LENGTH, true);
+    if (!ack) {
+        gpsSerial.updateBaudRate(GPS_UBX_BAUD);
+        ack = sendUbx(UBX_CLASS_CFG, UBX_CFG_MSG, payload, UBX_CFG_MSG_LENGTH, true);
+        if (!ack) {
+            gpsSerial.updateBaudRate(GPS_NMEA_BAUD);
+            printf("[GPS] No UBX acknowledgement - staying on NMEA\n");
+            return false;
+        }
+    }
+
+    ubxCfgRate(payload, 1000 / rateHz);
+    if (!sendUbx(UBX_CLASS_CFG, UBX_CFG_RATE, payload, UBX_CFG_RATE_LENGTH, true)) {
+        printf("[GPS] Receiver rejected %u Hz, keeping its rate\n", rateHz);
+    }
 
-int GPSManager::getMinute() {
-    return gps.time.minute();
+    // UBX only on the way out; the reply comes at the new baud rate
+    ubxCfgPrtUart(payload, GPS_UBX_BAUD, false);
+    sendUbx(UBX_CLASS_CFG, UBX_CFG_PRT, payload, UBX_CFG_PRT_LENGTH, false);
+    gpsSerial.flush();
+    delay(20);
+    gpsSerial.updateBaudRate(GPS_UBX_BAUD);
+
+    uint32_t frames = ubx.getFrames();
+    unsigned long start = millis();
+    while (millis() - start < 2000 && ubx.getFrames() == frames) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        drain();
+    }
+    if (ubx.getFrames() == frames) {
+        gpsSerial.updateBaudRate(GPS_NMEA_BAUD);
+        printf("[GPS] No UBX data at %d baud - staying on NMEA\n", GPS_UBX_BAUD);
+        return false;
+    }
+    return true;
 }
 
-int GPSManager::getSecond() {
-    return gps.time.second();
+// u-blox PUBX,40: stop the sentences nothing reads (ignored by other modules)
+void GPSManager::limitNmea() {
+    static const char* const unused[] = {"GSV", "GSA", "GLL", "VTG"};
+    char body[32];
+    char line[48];
+    for (const char* type : unused) {
+        snprintf(body, sizeof(body), "PUBX,40,%s,0,0,0,0,0,0", type);
+        size_t n = nmeaFormat(line, sizeof(line), body);
+        gpsSerial.write((const uint8_t*)line, n);
+    }
 }
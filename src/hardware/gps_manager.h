@@ -2,32 +2,63 @@
 #define GPS_MANAGER_H
 
 #include <Arduino.h>
-#include <TinyGPSPlus.h>
 #include "config/pins.h"
+#include "hal/hal.h"
+#include "location/gps_snapshot.h"
+#include "location/gps_track.h"
+#include "location/nmea_parser.h"
+#include "location/ubx_parser.h"
 
+#define GPS_TASK_STACK_SIZE 4096
+#define GPS_TASK_PRIORITY 2             // Above the BLE task: the fix is published promptly
+#define GPS_NMEA_BAUD 9600              // Factory default of common modules
+#define GPS_UBX_BAUD 115200
+#define GPS_FIX_TIMEOUT 3000            // ms without an update before the fix counts as lost
+#define GPS_ACK_TIMEOUT 1000            // ms to wait for a UBX configuration reply
+#define GPS_READ_CHUNK 64
+
+// The GPS task wakes when the UART driver reports received data, feeds the
+// bytes to the NMEA and UBX parsers and publishes each updated fix to a
+// lock-free snapshot. Any task reads the latest fix with getFix(). Valid
+// fixes also go into a short track so getFixAt() can place a detection at
+// the moment it was captured rather than at the last fix before it.
+//
+// With ubx set, a u-blox module (7/M8 or later) is switched to binary
+// NAV-PVT at rateHz and GPS_UBX_BAUD; a module that does not acknowledge
+// stays on NMEA at GPS_NMEA_BAUD. Either way only RMC and GGA are parsed.
 class GPSManager {
 public:
-    void begin();
-    void update();
-    bool isValid();
-    double latitude();
-    double longitude();
-    double altitude();
-    int satellites();
-    String getLocation();
-    String getStatus();
-    
-    // Date/Time for RTC sync
-    int getYear();
-    int getMonth();
-    int getDay();
-    int getHour();
-    int getMinute();
-    int getSecond();
+    void begin(bool ubx, uint8_t rateHz);
+
+    // Latest fix; not valid once it is older than GPS_FIX_TIMEOUT
+    void getFix(GpsFix* out);
+
+    // Position at a halMillis() capture time; true when final (see LocationSource)
+    bool getFixAt(uint32_t time, GpsFix* out);
+
+    bool isUbx() { return ubxActive; }
+    TaskHandle_t getTask() { return task; }
 
 private:
-    TinyGPSPlus gps;
     HardwareSerial gpsSerial{2}; // UART2
+    NmeaParser nmea;             // GPS task only
+    UbxParser ubx;
+    GpsSnapshot snapshot;
+    GpsTrack track;
+    portMUX_TYPE trackLock = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t task = nullptr;
+    bool ubxRequested = false;
+    uint8_t rateHz = 1;
+    volatile bool ubxActive = false;
+
+    static void taskEntry(void* parameter);
+    static void onReceive();
+    void run();
+    UbxMessage drain();
+    void publish(const GpsFix& fix);
+    bool sendUbx(uint8_t msgClass, uint8_t msgId, const uint8_t* payload, uint16_t len, bool waitAck);
+    bool configureUbx();
+    void limitNmea();
 };
 
 extern GPSManager gpsManager;
@@ -0,0 +1,109 @@
+#include "led_animator.h"
+
+LedAnimation& LedAnimation::add(uint32_t color, uint8_t level, uint16_t duration, bool fade) {
+    if (count < LED_MAX_KEYFRAMES) {
+        frames[count].color = color;
+        frames[count].level = level;
+        frames[count].fade = fade;
+        frames[count].duration = duration;
+        count++;
+    }
+    return *this;
+}
+
+LedAnimation ledFlash(uint32_t color, uint8_t count, uint16_t duration, LedPriority priority) {
+    LedAnimation anim;
+    anim.priority = priority;
+    anim.repeat = count;
+    anim.add(color, 255, duration)
+        .add(0, 0, duration);
+    return anim;
+}
+
+LedAnimation ledKnownDeviceBlink(uint32_t color) {
+    return ledFlash(color, 2, 100, LED_PRIORITY_KNOWN);
+}
+
+LedAnimation ledRavenStrobe(uint32_t red, uint32_t white) {
+    LedAnimation anim;
+    anim.priority = LED_PRIORITY_CRITICAL;
+    anim.repeat = 5;
+    anim.add(red, 255, 100)
+        .add(white, 255, 100);
+    return anim;
+}
+
+bool LedAnimator::post(const LedAnimation& animation, uint32_t now) {
+    if (animation.count == 0) return false;
+
+    // Finished, even if the render task has not sampled it since
+    if (active && now - startTime >= cycleLength * current.repeat) active = false;
+
+    if (active && animation.priority < current.priority) {
+        dropped++;
+        return false;
+    }
+    if (active) preempted++;
+
+    current = animation;
+    if (current.repeat == 0) current.repeat = 1;
+    cycleLength = 0;
+    for (uint8_t i = 0; i < current.count; i++) {
+        cycleLength += current.frames[i].duration;
+    }
+    startTime = now;
+    active = true;
+    posted++;
+    return true;
+}
+
+void LedAnimator::cancel() {
+    active = false;
+}
+
+bool LedAnimator::render(uint32_t now, uint32_t* colorOut) {
+    if (!active) return false;
+
+    uint32_t elapsed = now - startTime;
+    if (cycleLength == 0 || elapsed >= cycleLength * current.repeat) {
+        active = false;
+        return false;
+    }
+
+    uint32_t t = elapsed % cycleLength;
+    uint8_t i = 0;
+    while (t >= current.frames[i].duration) {
+        t -= current.frames[i].duration;
+        i++;
+    }
+
+    const LedKeyframe& kf = current.frames[i];
+    uint32_t color = scale(kf.color, kf.level);
+    if (kf.fade) {
+        // Last keyframe fades back into the first on repeat
+        const LedKeyframe& next = current.frames[(i + 1) % current.count];
+        color = blend(color, scale(next.color, next.level), t, kf.duration);
+    }
+
+    *colorOut = color;
+    return true;
+}
+
+uint32_t LedAnimator::scale(uint32_t color, uint8_t level) {
+    uint32_t r = ((color >> 16) & 0xFF) * level / 255;
+    uint32_t g = ((color >> 8) & 0xFF) * level / 255;
+    uint32_t b = (color & 0xFF) * level / 255;
+    return (r << 16) | (g << 8) | b;
+}
+
+uint32_t LedAnimator::blend(uint32_t from, uint32_t to, uint32_t pos, uint32_t span) {
+    if (span == 0) return to;
+    uint32_t out = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        int32_t a = (from >> shift) & 0xFF;
+        int32_t b = (to >> shift) & 0xFF;
+        int32_t c = a + (b - a) * (int32_t)pos / (int32_t)span;
+        out |= (uint32_t)c << shift;
+    }
+    return out;
+}
@@ -0,0 +1,87 @@
+#ifndef LED_ANIMATOR_H
+#define LED_ANIMATOR_H
+
+#include <stdint.h>
+
+// ============================================================================
+// LED ANIMATOR
+// ============================================================================
+//
+// Declarative keyframe animations for the LED strip. An animation is a short
+// list of keyframes (color, level, duration) played `repeat` times; a keyframe
+// marked `fade` blends linearly into the next one. Detections post an
+// animation and return immediately; the render task samples the active
+// animation at a fixed rate.
+//
+// Only one animation plays at a time. A post with priority >= the playing
+// animation replaces it; a lower-priority post is dropped (a known-device
+// blink never interrupts a Raven strobe). A detection posts its flash first
+// and then, for a known device, the yellow blink, so the blink ranks above
+// the flash.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define LED_MAX_KEYFRAMES 8
+
+enum LedPriority : uint8_t {
+    LED_PRIORITY_AMBIENT = 0,   // Idle scanning pulse
+    LED_PRIORITY_INFO = 1,      // Heartbeat while a device stays in range
+    LED_PRIORITY_ALERT = 2,     // Detection flash, user feedback
+    LED_PRIORITY_KNOWN = 3,     // Known device re-detected (follows its detection flash)
+    LED_PRIORITY_CRITICAL = 4   // Raven strobe
+};
+
+struct LedKeyframe {
+    uint32_t color;        // 0x00RRGGBB
+    uint8_t level;         // 0-255 scale applied to color
+    bool fade;             // Blend into the next keyframe over duration
+    uint16_t duration;     // ms
+};
+
+struct LedAnimation {
+    LedKeyframe frames[LED_MAX_KEYFRAMES];
+    uint8_t count = 0;
+    uint8_t repeat = 1;
+    LedPriority priority = LED_PRIORITY_ALERT;
+
+    // Builder: anim.add(COLOR_RED, 255, 100).add(COLOR_OFF, 0, 100)
+    LedAnimation& add(uint32_t color, uint8_t level, uint16_t duration, bool fade = false);
+};
+
+// Effects LEDController plays, built here so a host can play the same ones
+LedAnimation ledFlash(uint32_t color, uint8_t count, uint16_t duration, LedPriority priority);
+LedAnimation ledKnownDeviceBlink(uint32_t color);
+LedAnimation ledRavenStrobe(uint32_t red, uint32_t white);
+
+class LedAnimator {
+public:
+    // Returns false if a higher-priority animation is playing
+    bool post(const LedAnimation& animation, uint32_t now);
+    void cancel();
+
+    // Sample the active animation; returns false when idle (show the base layer)
+    bool render(uint32_t now, uint32_t* colorOut);
+
+    bool isActive() const { return active; }
+    LedPriority activePriority() const { return current.priority; }
+
+    // Stats
+    uint32_t getPosted() const { return posted; }
+    uint32_t getPreempted() const { return preempted; }
+    uint32_t getDropped() const { return dropped; }
+
+    static uint32_t scale(uint32_t color, uint8_t level);
+    static uint32_t blend(uint32_t from, uint32_t to, uint32_t pos, uint32_t span);
+
+private:
+    LedAnimation current;
+    bool active = false;
+    uint32_t startTime = 0;
+    uint32_t cycleLength = 0;
+
+    uint32_t posted = 0;
+    uint32_t preempted = 0;
+    uint32_t dropped = 0;
+};
+
+#endif // LED_ANIMATOR_H
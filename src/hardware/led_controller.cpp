@@ -14,16 +14,83 @@ LEDController LED;
 
 void LEDController::begin() {
     strip.begin();
-    strip.setBrightness(50);
+    strip.setBrightness(brightness);
     strip.show();
+    
+    if (!lock) {
+        lock = xSemaphoreCreateMutex();
+    }
+    
+    // Low-priority renderer on Core 0, away from the WiFi processing task
+    if (!renderTask) {
+        xTaskCreatePinnedToCore(
+            renderTaskEntry,
+            "LED_Render",
+            LED_TASK_STACK_SIZE,
+            this,
+            1,
+            &renderTask,
+            0
+        );
+    }
+}
+
+void LEDController::renderTaskEntry(void* parameter) {
+    static_cast<LEDController*>(parameter)->renderLoop();
+}
+
+void LEDController::renderLoop() {
+    uint32_t shown[LED_COUNT];
+    bool first = true;
+    TickType_t lastWake = xTaskGetTickCount();
+    
+    while (1) {
+        uint32_t frame[LED_COUNT];
+        uint32_t color;
+        bool applyBrightness;
+        
+        xSemaphoreTake(lock, portMAX_DELAY);
+        if (animator.render(millis(), &color)) {
+            for (int i = 0; i < LED_COUNT; i++) frame[i] = color;
+        } else {
+            for (int i = 0; i < LED_COUNT; i++) frame[i] = base[i];
+        }
+        applyBrightness = brightnessChanged;
+        brightnessChanged = false;
+        if (applyBrightness) strip.setBrightness(brightness);
+        xSemaphoreGive(lock);
+        
+        // Only push to the strip when something changed
+        bool changed = first || applyBrightness;
+        for (int i = 0; i < LED_COUNT && !changed; i++) {
+            changed = frame[i] != shown[i];
+        }
+        if (changed) {
+            for (int i = 0; i < LED_COUNT; i++) {
+                strip.setPixelColor(i, frame[i]);
+                shown[i] = frame[i];
+            }
+            strip.show();
+            first = false;
+        }
+        
+        vTaskDelayUntil(&lastWake, LED_FRAME_INTERVAL / portTICK_PERIOD_MS);
+    }
 }
 
 void LEDController::setMode(LEDMode mode) {
     currentMode = mode;
 }
 
-void LEDController::setBrightness(uint8_t brightness) {
-    strip.setBrightness(brightness);
+void LEDController::setBrightness(uint8_t level) {
+    if (!lock) {
+        brightness = level;
+        return;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    brightness = level;
+    brightnessChanged = true;
+    xSemaphoreGive(lock);
 }
 
 void LEDController::setCustomFunctions(LEDFunction led0, LEDFunction led1, LEDFunction led2, LEDFunction led3) {
@@ -33,76 +100,79 @@ void LEDController::setCustomFunctions(LEDFunction led0, LEDFunction led1, LEDFu
     customFunctions[3] = led3;
 }
 
+void LEDController::setBase(uint8_t index, uint32_t color) {
+    if (index >= LED_COUNT || !lock) return;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    base[index] = color;
+    xSemaphoreGive(lock);
+}
+
 void LEDController::setLED(uint8_t index, uint32_t color) {
-    if (index >= LED_COUNT) return;
-    strip.setPixelColor(index, color);
-    strip.show();
+    setBase(index, color);
+}
+
+void LEDController::showProgress(uint8_t percent, uint32_t color) {
+    int lit = (percent * LED_COUNT + 99) / 100;  // First LED on as soon as work starts
+    for (int i = 0; i < LED_COUNT; i++) {
+        setBase(i, i < lit ? color : COLOR_OFF);
+    }
 }
 
 void LEDController::setAllLEDs(uint32_t color) {
     for (int i = 0; i < LED_COUNT; i++) {
-        strip.setPixelColor(i, color);
+        setBase(i, color);
     }
-    strip.show();
 }
 
+bool LEDController::play(const LedAnimation& animation) {
+    if (!lock) return false;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    bool accepted = animator.post(animation, millis());
+    xSemaphoreGive(lock);
+    return accepted;
+}
+
+// ============================================================================
+// EFFECTS
+// ============================================================================
+
 void LEDController::fadeIn(uint32_t color, int duration) {
-    for (int brightness = 0; brightness <= 50; brightness += 5) {
-        strip.setBrightness(brightness);
-        setAllLEDs(color);
-        delay(duration / 10);
-    }
-    strip.setBrightness(50);
+    LedAnimation anim;
+    anim.priority = LED_PRIORITY_ALERT;
+    anim.add(color, 0, duration, true)
+        .add(color, 255, 200);  // Hold at full before returning to the base layer
+    play(anim);
 }
 
-void LEDController::flash(uint32_t color, int count, int duration) {
-    for (int i = 0; i < count; i++) {
-        setAllLEDs(color);
-        delay(duration);
-        setAllLEDs(COLOR_OFF);
-        if (i < count - 1) delay(duration);
-    }
+void LEDController::flash(uint32_t color, int count, int duration, LedPriority priority) {
+    play(ledFlash(color, count, duration, priority));
 }
 
-void LEDController::pulse(uint32_t color, int duration) {
-    // Breathing effect
-    for (int brightness = 10; brightness <= 50; brightness += 5) {
-        strip.setBrightness(brightness);
-        setAllLEDs(color);
-        delay(duration / 16);
-    }
-    for (int brightness = 50; brightness >= 10; brightness -= 5) {
-        strip.setBrightness(brightness);
-        setAllLEDs(color);
-        delay(duration / 16);
-    }
-    strip.setBrightness(50);
-    setAllLEDs(COLOR_OFF);
+void LEDController::pulse(uint32_t color, int duration, LedPriority priority) {
+    // Breathing effect: 20% -> 100% -> 20%
+    LedAnimation anim;
+    anim.priority = priority;
+    anim.add(color, 51, duration / 2, true)
+        .add(color, 255, duration / 2, true)
+        .add(color, 51, 0);
+    play(anim);
 }
 
 void LEDController::scanningEffect() {
-    if (!pulsing && millis() - lastPulse > 3000) {
-        pulsing = true;
-        pulse(COLOR_GREEN, 500);
-        pulsing = false;
+    if (millis() - lastPulse > 3000) {
+        pulse(COLOR_GREEN, 500, LED_PRIORITY_AMBIENT);
         lastPulse = millis();
     }
 }
 
 void LEDController::ravenDetectionStrobe() {
     // Red and white strobe for critical threat
-    for (int i = 0; i < 5; i++) {
-        setAllLEDs(COLOR_RED);
-        delay(100);
-        setAllLEDs(COLOR_WHITE);
-        delay(100);
-    }
-    setAllLEDs(COLOR_OFF);
+    play(ledRavenStrobe(COLOR_RED, COLOR_WHITE));
 }
 
 void LEDController::knownDeviceAlert() {
-    // Yellow flash for known device (not as urgent)
-    flash(COLOR_YELLOW, 2, 100);
+    // Yellow flash for known device; replaces the detection flash posted just before
+    play(ledKnownDeviceBlink(COLOR_YELLOW));
 }
 
 // ============================================================================
@@ -113,18 +183,16 @@ void LEDController::updateStatus(bool systemOK, bool wifiActive, bool bleActive,
     if (currentMode != LED_MODE_STATUS) return;
     
     // LED 0: Power/System - Green=OK, Red=Error, Orange=Warning
-    strip.setPixelColor(0, systemOK ? COLOR_GREEN : COLOR_RED);
+    setBase(0, systemOK ? COLOR_GREEN : COLOR_RED);
     
     // LED 1: WiFi Detection - Blue when active
-    strip.setPixelColor(1, wifiActive ? COLOR_BLUE : COLOR_OFF);
+    setBase(1, wifiActive ? COLOR_BLUE : COLOR_OFF);
     
     // LED 2: BLE Detection - Purple when active
-    strip.setPixelColor(2, bleActive ? COLOR_PURPLE : COLOR_OFF);
+    setBase(2, bleActive ? COLOR_PURPLE : COLOR_OFF);
     
     // LED 3: GPS Status - Yellow=Locked, Orange=Searching, Off=Disabled
-    strip.setPixelColor(3, gpsLocked ? COLOR_YELLOW : (sdOK ? COLOR_ORANGE : COLOR_OFF));
-    
-    strip.show();
+    setBase(3, gpsLocked ? COLOR_YELLOW : (sdOK ? COLOR_ORANGE : COLOR_OFF));
 }
 
 void LEDController::updateSignalStrength(int rssi) {
@@ -138,15 +206,14 @@ void LEDController::updateSignalStrength(int rssi) {
     for (int i = 0; i < LED_COUNT; i++) {
         if (i < bars) {
             // Color gradient: Red (weak) -> Yellow -> Green (strong)
-            if (bars <= 1) strip.setPixelColor(i, COLOR_RED);
-            else if (bars == 2) strip.setPixelColor(i, COLOR_ORANGE);
-            else if (bars == 3) strip.setPixelColor(i, COLOR_YELLOW);
-            else strip.setPixelColor(i, COLOR_GREEN);
+            if (bars <= 1) setBase(i, COLOR_RED);
+            else if (bars == 2) setBase(i, COLOR_ORANGE);
+            else if (bars == 3) setBase(i, COLOR_YELLOW);
+            else setBase(i, COLOR_GREEN);
         } else {
-            strip.setPixelColor(i, COLOR_OFF);
+            setBase(i, COLOR_OFF);
         }
     }
-    strip.show();
 }
 
 void LEDController::updateDetectionCount(int count) {
@@ -158,12 +225,10 @@ void LEDController::updateDetectionCount(int count) {
     // LED 2: Lights up after 50 detections
     // LED 3: Lights up after 100 detections
     
-    strip.setPixelColor(0, count >= 1   ? COLOR_GREEN : COLOR_OFF);
-    strip.setPixelColor(1, count >= 10  ? COLOR_BLUE : COLOR_OFF);
-    strip.setPixelColor(2, count >= 50  ? COLOR_ORANGE : COLOR_OFF);
-    strip.setPixelColor(3, count >= 100 ? COLOR_RED : COLOR_OFF);
-    
-    strip.show();
+    setBase(0, count >= 1   ? COLOR_GREEN : COLOR_OFF);
+    setBase(1, count >= 10  ? COLOR_BLUE : COLOR_OFF);
+    setBase(2, count >= 50  ? COLOR_ORANGE : COLOR_OFF);
+    setBase(3, count >= 100 ? COLOR_RED : COLOR_OFF);
 }
 
 void LEDController::updateThreatLevel(int deviceCount) {
@@ -188,9 +253,8 @@ void LEDController::updateThreatLevel(int deviceCount) {
     }
     
     for (int i = 0; i < LED_COUNT; i++) {
-        strip.setPixelColor(i, i < litLEDs ? color : COLOR_OFF);
+        setBase(i, i < litLEDs ? color : COLOR_OFF);
     }
-    strip.show();
 }
 
 void LEDController::setLEDByFunction(uint8_t index, LEDFunction func, bool power, bool wifi, bool ble, bool gps, bool sd, bool scanning, bool detection) {
@@ -223,7 +287,7 @@ void LEDController::setLEDByFunction(uint8_t index, LEDFunction func, bool power
             break;
     }
     
-    strip.setPixelColor(index, color);
+    setBase(index, color);
 }
 
 void LEDController::updateCustomMode(bool power, bool wifi, bool ble, bool gps, bool sd, bool scanning, bool detection) {
@@ -232,6 +296,5 @@ void LEDController::updateCustomMode(bool power, bool wifi, bool ble, bool gps,
     for (int i = 0; i < LED_COUNT; i++) {
         setLEDByFunction(i, customFunctions[i], power, wifi, ble, gps, sd, scanning, detection);
     }
-    strip.show();
 }
 
@@ -5,6 +5,7 @@
 #include <Adafruit_NeoPixel.h>
 #include "config/pins.h"
 #include "config/settings.h"
+#include "led_animator.h"
 
 class LEDController {
 public:
@@ -18,6 +19,9 @@ public:
     static const uint32_t COLOR_WHITE;
     static const uint32_t COLOR_YELLOW;
 
+    // Effects are posted to the render task and return immediately.
+    // Mode updates and setLED/setAllLEDs write the base layer, which shows
+    // whenever no animation is playing.
     void begin();
     void setMode(LEDMode mode);
     void setBrightness(uint8_t brightness);
@@ -29,11 +33,13 @@ public:
     // Legacy unified mode (all LEDs same)
     void setAllLEDs(uint32_t color);
     void fadeIn(uint32_t color, int duration);
-    void flash(uint32_t color, int count, int duration);
-    void pulse(uint32_t color, int duration);
+    void flash(uint32_t color, int count, int duration, LedPriority priority = LED_PRIORITY_ALERT);
+    void pulse(uint32_t color, int duration, LedPriority priority = LED_PRIORITY_ALERT);
+    bool play(const LedAnimation& animation);
     void scanningEffect();
     void ravenDetectionStrobe();
     void knownDeviceAlert();  // Yellow flash for known devices
+    void showProgress(uint8_t percent, uint32_t color);  // Bar across the strip, any mode
     
     // Mode-specific updates
     void updateStatus(bool systemOK, bool wifiActive, bool bleActive, bool gpsLocked, bool sdOK);
@@ -42,12 +48,24 @@ public:
     void updateThreatLevel(int deviceCount);
     void updateCustomMode(bool power, bool wifi, bool ble, bool gps, bool sd, bool scanning, bool detection);
 
+    LedAnimator& getAnimator() { return animator; }
+    TaskHandle_t getRenderTask() { return renderTask; }
+
 private:
-    Adafruit_NeoPixel strip{LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800};
+    Adafruit_NeoPixel strip{LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800};  // Render task only
+    LedAnimator animator;
+    SemaphoreHandle_t lock = nullptr;   // Guards animator, base layer and brightness
+    TaskHandle_t renderTask = nullptr;
+    uint32_t base[LED_COUNT] = {0};
+    uint8_t brightness = 50;
+    bool brightnessChanged = false;
     unsigned long lastPulse = 0;
-    bool pulsing = false;
     LEDMode currentMode = LED_MODE_UNIFIED;
     
+    void setBase(uint8_t index, uint32_t color);
+    static void renderTaskEntry(void* parameter);
+    void renderLoop();
+    
     // Custom mode function assignments
     LEDFunction customFunctions[4] = {LED_FUNC_POWER, LED_FUNC_WIFI, LED_FUNC_BLE, LED_FUNC_GPS};
     
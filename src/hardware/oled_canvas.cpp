@@ -0,0 +1,249 @@
+#include "oled_canvas.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define OLED_CELL_WIDTH 6               // 5 px glyph + 1 px gap
+#define OLED_LARGE_CELLS 10             // 12 px cells at double size
+
+// Classic 5x7 font, ASCII 0x20-0x7E, one byte per column (bit 0 = top)
+static const uint8_t font5x7[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+    {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+    {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+
+static const uint8_t* glyph(char c) {
+    if (c < 0x20 || c > 0x7E) c = '?';
+    return font5x7[c - 0x20];
+}
+
+// Spreads 4 bits over 8 (each pixel doubled vertically)
+static uint8_t doubleBits(uint8_t nibble) {
+    uint8_t out = 0;
+    for (int i = 0; i < 4; i++) {
+        if (nibble & (1 << i)) out |= 3 << (i * 2);
+    }
+    return out;
+}
+
+// ============================================================================
+// SCREEN MODEL
+// ============================================================================
+
+static void setText(OledLine& line, uint8_t scale, const char* format, va_list args) {
+    char text[64];
+    vsnprintf(text, sizeof(text), format, args);
+
+    // Padded with spaces so a shorter text still overwrites the old one
+    size_t n = strlen(text);
+    if (n > OLED_TEXT_COLUMNS) n = OLED_TEXT_COLUMNS;
+    memcpy(line.text, text, n);
+    memset(line.text + n, ' ', OLED_TEXT_COLUMNS - n);
+    line.text[OLED_TEXT_COLUMNS] = '\0';
+    line.scale = scale;
+    line.bar = OLED_NO_BAR;
+}
+
+void OledScreen::clear() {
+    for (int row = 0; row < OLED_TEXT_ROWS; row++) {
+        memset(lines[row].text, ' ', OLED_TEXT_COLUMNS);
+        lines[row].text[OLED_TEXT_COLUMNS] = '\0';
+        lines[row].scale = 1;
+        lines[row].bar = OLED_NO_BAR;
+    }
+}
+
+void OledScreen::print(uint8_t row, const char* format, ...) {
+    if (row >= OLED_TEXT_ROWS) return;
+    va_list args;
+    va_start(args, format);
+    setText(lines[row], 1, format, args);
+    va_end(args);
+}
+
+void OledScreen::printLarge(uint8_t row, const char* format, ...) {
+    if (row + 1 >= OLED_TEXT_ROWS) return;
+    va_list args;
+    va_start(args, format);
+    setText(lines[row], 2, format, args);
+    va_end(args);
+}
+
+void OledScreen::printAt(uint8_t row, uint8_t column, const char* text) {
+    if (row >= OLED_TEXT_ROWS) return;
+    for (; *text && column < OLED_TEXT_COLUMNS; text++, column++) {
+        lines[row].text[column] = *text;
+    }
+}
+
+void OledScreen::bar(uint8_t row, uint8_t percent) {
+    if (row >= OLED_TEXT_ROWS) return;
+    memset(lines[row].text, ' ', OLED_TEXT_COLUMNS);
+    lines[row].scale = 1;
+    lines[row].bar = percent > 100 ? 100 : percent;
+}
+
+// ============================================================================
+// RASTERIZER
+// ============================================================================
+
+OledCanvas::OledCanvas() {
+    memset(frame, 0, sizeof(frame));
+    shown.clear();
+    invalidate();
+}
+
+void OledCanvas::invalidate() {
+    for (int page = 0; page < OLED_PAGES; page++) {
+        dirtyStart[page] = 0;
+        dirtyEnd[page] = OLED_WIDTH;
+    }
+}
+
+bool OledCanvas::isDirty() const {
+    for (int page = 0; page < OLED_PAGES; page++) {
+        if (dirtyStart[page] < dirtyEnd[page]) return true;
+    }
+    return false;
+}
+
+void OledCanvas::put(uint8_t page, uint8_t x, uint8_t bits) {
+    if (frame[page][x] == bits) return;
+    frame[page][x] = bits;
+    if (dirtyStart[page] >= dirtyEnd[page]) {
+        dirtyStart[page] = x;
+        dirtyEnd[page] = x + 1;
+    } else {
+        if (x < dirtyStart[page]) dirtyStart[page] = x;
+        if (x >= dirtyEnd[page]) dirtyEnd[page] = x + 1;
+    }
+}
+
+void OledCanvas::drawCell(uint8_t row, uint8_t cell, char c) {
+    const uint8_t* g = glyph(c);
+    uint8_t x = cell * OLED_CELL_WIDTH;
+    for (int i = 0; i < 5; i++) put(row, x + i, g[i]);
+    put(row, x + 5, 0);
+}
+
+void OledCanvas::drawLargeCell(uint8_t row, uint8_t cell, char c) {
+    const uint8_t* g = glyph(c);
+    uint8_t x = cell * OLED_CELL_WIDTH * 2;
+    for (int i = 0; i < 6; i++) {
+        uint8_t bits = i < 5 ? g[i] : 0;
+        uint8_t top = doubleBits(bits & 0x0F);
+        uint8_t bottom = doubleBits(bits >> 4);
+        put(row, x + i * 2, top);
+        put(row, x + i * 2 + 1, top);
+        put(row + 1, x + i * 2, bottom);
+        put(row + 1, x + i * 2 + 1, bottom);
+    }
+}
+
+// Outlined box across the line, filled from the left with a 1 px margin
+void OledCanvas::drawBar(uint8_t row, int8_t percent) {
+    uint8_t fillEnd = 2 + (OLED_WIDTH - 4) * percent / 100;
+    for (uint8_t x = 0; x < OLED_WIDTH; x++) {
+        uint8_t bits;
+        if (x == 0 || x == OLED_WIDTH - 1) bits = 0x7E;
+        else if (x >= 2 && x < fillEnd) bits = 0x5A;
+        else bits = 0x42;
+        put(row, x, bits);
+    }
+}
+
+void OledCanvas::drawLine(uint8_t row, const OledLine& line, const OledLine* previous) {
+    if (line.bar != OLED_NO_BAR) {
+        drawBar(row, line.bar);
+        return;
+    }
+
+    if (line.scale == 2) {
+        for (uint8_t cell = 0; cell < OLED_LARGE_CELLS; cell++) {
+            if (previous && previous->text[cell] == line.text[cell]) continue;
+            drawLargeCell(row, cell, line.text[cell]);
+        }
+        // Right margin not covered by the 10 large cells
+        for (uint8_t x = OLED_LARGE_CELLS * OLED_CELL_WIDTH * 2; x < OLED_WIDTH; x++) {
+            put(row, x, 0);
+            put(row + 1, x, 0);
+        }
+        return;
+    }
+
+    for (uint8_t cell = 0; cell < OLED_TEXT_COLUMNS; cell++) {
+        if (previous && previous->text[cell] == line.text[cell]) continue;
+        drawCell(row, cell, line.text[cell]);
+    }
+    for (uint8_t x = OLED_TEXT_COLUMNS * OLED_CELL_WIDTH; x < OLED_WIDTH; x++) put(row, x, 0);
+}
+
+void OledCanvas::render(const OledScreen& screen) {
+    for (uint8_t row = 0; row < OLED_TEXT_ROWS; row++) {
+        const OledLine& line = screen.lines[row];
+        const OledLine& old = shown.lines[row];
+
+        // A line covered by the large line above it is not drawn itself
+        bool covered = row > 0 && screen.lines[row - 1].scale == 2 && screen.lines[row - 1].bar == OLED_NO_BAR;
+        bool wasCovered = row > 0 && shown.lines[row - 1].scale == 2 && shown.lines[row - 1].bar == OLED_NO_BAR;
+        if (covered) continue;
+
+        // Same layout: only the changed cells; otherwise the whole line
+        bool sameLayout = !wasCovered && line.scale == old.scale && line.bar == old.bar;
+        if (sameLayout && line.bar == OLED_NO_BAR && memcmp(line.text, old.text, OLED_TEXT_COLUMNS) == 0) continue;
+        if (sameLayout && line.bar != OLED_NO_BAR) continue;
+        drawLine(row, line, sameLayout ? &old : nullptr);
+    }
+    shown = screen;
+}
+
+// ============================================================================
+// TRANSFER
+// ============================================================================
+
+size_t OledCanvas::flush(OledBus& bus) {
+    size_t sent = 0;
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        if (dirtyStart[page] >= dirtyEnd[page]) continue;
+
+        // Column and page window; horizontal addressing wraps inside it
+        uint8_t window[6] = {0x21, dirtyStart[page], (uint8_t)(dirtyEnd[page] - 1), 0x22, page, page};
+        bus.command(window, sizeof(window));
+        bus.data(&frame[page][dirtyStart[page]], dirtyEnd[page] - dirtyStart[page]);
+        sent += dirtyEnd[page] - dirtyStart[page];
+
+        dirtyStart[page] = OLED_WIDTH;
+        dirtyEnd[page] = 0;
+    }
+    return sent;
+}
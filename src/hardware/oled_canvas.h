@@ -0,0 +1,82 @@
+#ifndef OLED_CANVAS_H
+#define OLED_CANVAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// OLED CANVAS
+// ============================================================================
+//
+// Retained-mode model of the 128x64 SSD1306. A screen is 8 text lines of 21
+// cells (6x8 px, 5x7 font); a line can be drawn at double size (10 cells,
+// also covering the line below) or as a progress bar.
+//
+// render() compares the new screen with the one last drawn and rasterizes
+// only the cells whose character changed. Every column byte written is
+// compared with the framebuffer, so each page keeps the narrowest range of
+// columns that really differ; flush() sends one address window plus those
+// bytes per dirty page. A counter going from 12 to 13 costs one glyph
+// (about 6 data bytes) instead of the whole 1 KB frame.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define OLED_WIDTH 128
+#define OLED_PAGES 8                    // 8 pixel rows each
+#define OLED_TEXT_COLUMNS 21
+#define OLED_TEXT_ROWS 8
+#define OLED_NO_BAR -1
+
+// Where the bytes go: the I2C driver on the device, a counter on a host
+class OledBus {
+public:
+    virtual ~OledBus() {}
+    virtual void command(const uint8_t* bytes, size_t len) = 0;
+    virtual void data(const uint8_t* bytes, size_t len) = 0;
+};
+
+struct OledLine {
+    char text[OLED_TEXT_COLUMNS + 1];
+    uint8_t scale;                      // 1, or 2 (also covers the next line)
+    int8_t bar;                         // Percent for a progress bar, OLED_NO_BAR for text
+};
+
+struct OledScreen {
+    OledLine lines[OLED_TEXT_ROWS];
+
+    void clear();
+    void print(uint8_t row, const char* format, ...);
+    void printLarge(uint8_t row, const char* format, ...);
+    void printAt(uint8_t row, uint8_t column, const char* text);  // Overlays part of a line
+    void bar(uint8_t row, uint8_t percent);
+};
+
+class OledCanvas {
+public:
+    OledCanvas();
+
+    // Rasterize what differs from the last rendered screen
+    void render(const OledScreen& screen);
+
+    // Push dirty columns; returns the data bytes sent
+    size_t flush(OledBus& bus);
+
+    // Controller RAM is unknown (after init): push everything next flush
+    void invalidate();
+
+    bool isDirty() const;
+
+private:
+    uint8_t frame[OLED_PAGES][OLED_WIDTH];
+    uint8_t dirtyStart[OLED_PAGES];     // Dirty columns [start, end); clean if start >= end
+    uint8_t dirtyEnd[OLED_PAGES];
+    OledScreen shown;
+
+    void put(uint8_t page, uint8_t x, uint8_t bits);
+    void drawCell(uint8_t row, uint8_t cell, char c);
+    void drawLargeCell(uint8_t row, uint8_t cell, char c);
+    void drawBar(uint8_t row, int8_t percent);
+    void drawLine(uint8_t row, const OledLine& line, const OledLine* previous);
+};
+
+#endif // OLED_CANVAS_H
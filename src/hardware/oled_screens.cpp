@@ -0,0 +1,41 @@
+#include "oled_screens.h"
+
+void oledBootScreen(OledScreen* screen) {
+    screen->clear();
+    screen->print(0, "FLOCK DETECTOR v2.0");
+    screen->print(2, "ESP32-WROOM-32");
+    screen->print(3, "DevKit V4");
+    screen->print(5, "Initializing...");
+}
+
+void oledStatusScreen(OledScreen* screen, const OledStatus& status) {
+    screen->clear();
+    screen->print(0, "FLOCK DETECTOR v2.0");
+    screen->print(1, "Status: %s", status.deviceInRange ? "DETECTED!" : "SCANNING");
+    screen->printLarge(2, "Total %d", status.totalDetections);     // Rows 2-3
+    screen->print(4, "WiFi:%d BLE:%d", status.wifiDetections, status.bleDetections);
+    if (status.gpsValid) {
+        screen->print(5, "GPS: %.2f,%.2f", status.lat, status.lon);
+    } else {
+        screen->print(5, "GPS: %s", status.gpsStatus);
+    }
+    screen->printAt(7, 15, status.sdInitialized ? "SD:OK" : "SD:X");
+}
+
+void oledDetectionScreen(OledScreen* screen, const char* deviceType, int rssi, bool gpsValid, double lat, double lon) {
+    screen->clear();
+    screen->printLarge(0, "ALERT!");
+    screen->print(3, "Type: %s", deviceType);
+    screen->print(4, "RSSI: %d dBm", rssi);
+    if (gpsValid) {
+        screen->print(5, "GPS: %.2f,%.2f", lat, lon);
+    }
+}
+
+void oledProgressScreen(OledScreen* screen, const char* title, uint8_t percent, uint32_t items) {
+    screen->clear();
+    screen->print(0, "%s", title);
+    screen->print(2, "%u devices", (unsigned)items);
+    screen->bar(4, percent);
+    screen->print(6, "%u%%", (unsigned)percent);
+}
@@ -0,0 +1,28 @@
+#ifndef OLED_SCREENS_H
+#define OLED_SCREENS_H
+
+#include "oled_canvas.h"
+
+// Layouts of the screens the firmware shows, built as OledScreen models so
+// the renderer can diff them. Shared with the host build (program oled).
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+struct OledStatus {
+    bool deviceInRange;
+    int totalDetections;
+    int wifiDetections;
+    int bleDetections;
+    bool gpsValid;
+    double lat;
+    double lon;
+    const char* gpsStatus;
+    bool sdInitialized;
+};
+
+void oledBootScreen(OledScreen* screen);
+void oledStatusScreen(OledScreen* screen, const OledStatus& status);
+void oledDetectionScreen(OledScreen* screen, const char* deviceType, int rssi, bool gpsValid, double lat, double lon);
+void oledProgressScreen(OledScreen* screen, const char* title, uint8_t percent, uint32_t items);
+
+#endif // OLED_SCREENS_H
@@ -0,0 +1,186 @@
+#include "packet_capture.h"
+#include "sd_logger.h"
+#include <esp_timer.h>
+
+PacketCapture packetCapture;
+
+// HCI advertising report types -> link-layer PDU types
+static BlePduType pduTypeFromHci(uint8_t hciAdvType) {
+    switch (hciAdvType) {
+        case 1:  return BLE_PDU_ADV_DIRECT_IND;
+        case 2:  return BLE_PDU_ADV_SCAN_IND;
+        case 3:  return BLE_PDU_ADV_NONCONN_IND;
+        case 4:  return BLE_PDU_SCAN_RSP;
+        default: return BLE_PDU_ADV_IND;
+    }
+}
+
+bool PacketCapture::begin() {
+    if (!sdLogger.isInitialized()) {
+        printf("[Capture] SD card not available - capture disabled\n");
+        return false;
+    }
+
+    // Next free session number
+    char wifiName[24];
+    char bleName[24];
+    uint16_t session = 1;
+    xSemaphoreTake(sdLogger.getLock(), portMAX_DELAY);
+    for (; session < 10000; session++) {
+        snprintf(wifiName, sizeof(wifiName), "/cap%04u_wifi.pcap", session);
+        if (!SD.exists(wifiName)) break;
+    }
+    snprintf(bleName, sizeof(bleName), "/cap%04u_ble.pcap", session);
+
+    bool ok = openStream(wifi, wifiName, PCAP_LINKTYPE_RADIOTAP, CAPTURE_WIFI_BUFFER_SIZE) &&
+              openStream(ble, bleName, PCAP_LINKTYPE_BLE_LL_PHDR, CAPTURE_BLE_BUFFER_SIZE);
+    xSemaphoreGive(sdLogger.getLock());
+
+    if (!ok) {
+        printf("[Capture] Failed to start capture\n");
+        return false;
+    }
+
+    lastFlush = millis();
+    xTaskCreatePinnedToCore(
+        writerTaskEntry,
+        "Capture_Writer",
+        CAPTURE_TASK_STACK_SIZE,
+        this,
+        1,
+        &writerTask,
+        1
+    );
+    active = true;
+
+    printf("[Capture] Recording to %s and %s\n", wifiName, bleName);
+    return true;
+}
+
+bool PacketCapture::openStream(CaptureStream& stream, const char* filename, uint32_t linktype, size_t size) {
+    stream.size = size;
+    for (int i = 0; i < 2; i++) {
+        stream.buffers[i] = (uint8_t*)malloc(size);
+        if (!stream.buffers[i]) return false;
+    }
+
+    stream.file = SD.open(filename, FILE_WRITE);
+    if (!stream.file) {
+        return false;
+    }
+
+    uint8_t header[PCAP_FILE_HEADER_SIZE];
+    pcapFileHeader(header, linktype);
+    stream.file.write(header, sizeof(header));
+    stream.file.flush();
+    return true;
+}
+
+// ============================================================================
+// PRODUCERS (radio callbacks)
+// ============================================================================
+
+// Called with mux held. Returns room for one record, swapping buffers if the
+// active one is full; nullptr if both are waiting for the writer.
+uint8_t* PacketCapture::reserve(CaptureStream& stream, bool* handOver) {
+    uint8_t a = stream.active;
+    if (stream.fill[a] + PCAP_MAX_RECORD > stream.size) {
+        uint8_t other = a ^ 1;
+        if (stream.full[other]) {
+            stream.dropped++;
+            return nullptr;
+        }
+        stream.full[a] = true;
+        stream.active = a = other;
+        *handOver = true;
+    }
+    return stream.buffers[a] + stream.fill[a];
+}
+
+void PacketCapture::captureWiFi(const uint8_t* frame, size_t len, int8_t rssi, uint8_t channel) {
+    if (!active) return;
+    uint64_t now = esp_timer_get_time();
+    bool handOver = false;
+
+    portENTER_CRITICAL(&mux);
+    uint8_t* out = reserve(wifi, &handOver);
+    if (out) {
+        wifi.fill[wifi.active] += pcapEncodeWiFi(out, now, frame, len, rssi, channel);
+        wifi.records++;
+    }
+    portEXIT_CRITICAL(&mux);
+
+    if (handOver) xTaskNotifyGive(writerTask);
+}
+
+void PacketCapture::captureBle(const uint8_t* mac, bool randomAddress, uint8_t hciAdvType,
+                               const uint8_t* advData, size_t len, int8_t rssi) {
+    if (!active) return;
+    uint64_t now = esp_timer_get_time();
+    bool handOver = false;
+
+    portENTER_CRITICAL(&mux);
+    uint8_t* out = reserve(ble, &handOver);
+    if (out) {
+        ble.fill[ble.active] += pcapEncodeBle(out, now, mac, randomAddress, pduTypeFromHci(hciAdvType),
+                                              advData, len, rssi);
+        ble.records++;
+    }
+    portEXIT_CRITICAL(&mux);
+
+    if (handOver) xTaskNotifyGive(writerTask);
+}
+
+// ============================================================================
+// WRITER TASK
+// ============================================================================
+
+void PacketCapture::handOverPartial(CaptureStream& stream) {
+    portENTER_CRITICAL(&mux);
+    uint8_t a = stream.active;
+    if (stream.fill[a] > 0 && !stream.full[a ^ 1]) {
+        stream.full[a] = true;
+        stream.active = a ^ 1;
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+void PacketCapture::writeFull(CaptureStream& stream) {
+    for (int i = 0; i < 2; i++) {
+        if (!stream.full[i]) continue;
+
+        xSemaphoreTake(sdLogger.getLock(), portMAX_DELAY);
+        stream.file.write(stream.buffers[i], stream.fill[i]);
+        xSemaphoreGive(sdLogger.getLock());
+        stream.bytesWritten += stream.fill[i];
+
+        portENTER_CRITICAL(&mux);
+        stream.fill[i] = 0;
+        stream.full[i] = false;
+        portEXIT_CRITICAL(&mux);
+    }
+}
+
+void PacketCapture::writerTaskEntry(void* parameter) {
+    PacketCapture* capture = static_cast<PacketCapture*>(parameter);
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, CAPTURE_FLUSH_INTERVAL / portTICK_PERIOD_MS);
+
+        bool periodic = millis() - capture->lastFlush >= CAPTURE_FLUSH_INTERVAL;
+        if (periodic) {
+            capture->handOverPartial(capture->wifi);
+            capture->handOverPartial(capture->ble);
+        }
+
+        capture->writeFull(capture->wifi);
+        capture->writeFull(capture->ble);
+
+        if (periodic) {
+            xSemaphoreTake(sdLogger.getLock(), portMAX_DELAY);
+            capture->wifi.file.flush();
+            capture->ble.file.flush();
+            xSemaphoreGive(sdLogger.getLock());
+            capture->lastFlush = millis();
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef PACKET_CAPTURE_H
+#define PACKET_CAPTURE_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include "detection/pcap_format.h"
+
+// ============================================================================
+// PACKET CAPTURE
+// ============================================================================
+//
+// Records what the radios hand over to two pcap files on the SD card
+// (capNNNN_wifi.pcap, capNNNN_ble.pcap - see pcap_format.h) for replay on a
+// host. Enabled with log.capture_packets.
+//
+// Each file has two preallocated buffers. The radio callbacks encode records
+// into the active one under a spinlock and never touch the card; when it
+// fills up the buffers swap and a writer task on Core 1 writes the full one
+// (under sdLogger's lock). If the writer falls behind and both
+// buffers are full, records are dropped and counted. Partial buffers are
+// written every CAPTURE_FLUSH_INTERVAL.
+
+#define CAPTURE_WIFI_BUFFER_SIZE 8192    // Per buffer (two per file)
+#define CAPTURE_BLE_BUFFER_SIZE  4096
+#define CAPTURE_FLUSH_INTERVAL   5000    // ms
+#define CAPTURE_TASK_STACK_SIZE  4096
+
+struct CaptureStream {
+    File file;
+    uint8_t* buffers[2] = {nullptr, nullptr};
+    size_t size = 0;                 // Bytes per buffer
+    size_t fill[2] = {0, 0};
+    uint8_t active = 0;
+    bool full[2] = {false, false};   // Handed to the writer
+    uint32_t records = 0;
+    uint32_t dropped = 0;
+    uint32_t bytesWritten = 0;
+};
+
+class PacketCapture {
+public:
+    bool begin();
+    bool isActive() { return active; }
+
+    // Radio callbacks (WiFi driver task / NimBLE host task)
+    void captureWiFi(const uint8_t* frame, size_t len, int8_t rssi, uint8_t channel);
+    void captureBle(const uint8_t* mac, bool randomAddress, uint8_t hciAdvType,
+                    const uint8_t* advData, size_t len, int8_t rssi);
+
+    // Stats
+    uint32_t getWiFiRecords() { return wifi.records; }
+    uint32_t getBleRecords() { return ble.records; }
+    uint32_t getDropped() { return wifi.dropped + ble.dropped; }
+    uint32_t getBytesWritten() { return wifi.bytesWritten + ble.bytesWritten; }
+    TaskHandle_t getWriterTask() { return writerTask; }
+
+private:
+    CaptureStream wifi;
+    CaptureStream ble;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t writerTask = nullptr;
+    volatile bool active = false;
+    unsigned long lastFlush = 0;
+
+    bool openStream(CaptureStream& stream, const char* filename, uint32_t linktype, size_t size);
+    uint8_t* reserve(CaptureStream& stream, bool* handOver);
+    void writeFull(CaptureStream& stream);
+    void handOverPartial(CaptureStream& stream);
+    static void writerTaskEntry(void* parameter);
+};
+
+extern PacketCapture packetCapture;
+
+#endif // PACKET_CAPTURE_H
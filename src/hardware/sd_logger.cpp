@@ -1,69 +1,148 @@
 #include "sd_logger.h"
+#include "rtc_manager.h"
+#include "../config/settings.h"
+#include "../system/metrics.h"
+#include "../hal/esp32_hal.h"
 
 SDLogger sdLogger;
 
+static MetricHistogram rowLatency("sd.log_row");     // Including lock wait and any write
+static MetricHistogram writeLatency("sd.write");     // Sector writes
+static MetricHistogram syncLatency("sd.sync");       // Flush + sync
+static MetricCounter rowsLogged("sd.rows");
+
+static const char* CSV_HEADER =
+    "timestamp,protocol,detection_method,mac_address,rssi,ssid,device_name,gps_lat,gps_lon\n";
+
 bool SDLogger::begin() {
-    printf("Initializing SD card...\n");
+    if (!lock) {
+        lock = xSemaphoreCreateMutex();
+    }
     
-    SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
+    // Keep today's log open for the whole session
+    initialized = openDayFile(currentDay());
+    last_flush = millis();
     
-    if (!sd.begin(SD_CS, SD_SCK_MHZ(4))) {
-        printf("SD card initialization failed!\n");
-        initialized = false;
-        return false;
+    return initialized;
+}
+
+uint32_t SDLogger::currentDay() {
+    if (settingsManager.getHardware().enable_rtc && rtcManager.isValid()) {
+        DateTime now = rtcManager.now();
+        return now.year() * 10000UL + now.month() * 100UL + now.day();
     }
+    // No clock - fall back to days since boot
+    return millis() / 86400000UL;
+}
+
+bool SDLogger::openDayFile(uint32_t day) {
+    log.close();
     
-    printf("SD card initialized successfully\n");
-    initialized = true;
-    
-    // Create initial log file with header
     char filename[32];
-    sprintf(filename, "flock_%lu.csv", millis());
+    snprintf(filename, sizeof(filename), "/flock_%lu.csv", (unsigned long)day);
     
-    if (logFile.open(filename, O_WRONLY | O_CREAT | O_TRUNC)) {
-        logFile.println("timestamp,protocol,detection_method,mac_address,rssi,ssid,device_name,gps_lat,gps_lon");
-        logFile.close();
-        printf("Created log file: %s\n", filename);
-    } else {
-        printf("Failed to create log file\n");
+    log.attach(sdFileSystem.open(filename, FILE_MODE_APPEND));
+    if (!log.isOpen()) {
+        printf("Failed to open log file %s\n", filename);
+        return false;
     }
     
+    current_day = day;
+    
+    // New file - header goes in ahead of the first row
+    if (log.fileSize() == 0) {
+        log.append((const uint8_t*)CSV_HEADER, strlen(CSV_HEADER));
+    }
+    
+    printf("Logging to %s\n", filename);
     return true;
 }
 
-void SDLogger::logDetection(const char* protocol, const char* method, const char* mac,
+void SDLogger::logDetection(uint32_t time, const char* protocol, const char* method, const char* mac,
                            int rssi, const char* ssid, const char* name,
                            bool gpsValid, double lat, double lon) {
     if (!initialized) return;
+    MetricTimer timer(rowLatency);
     
-    // Create unique filename based on timestamp (one file per day)
-    char filename[32];
-    unsigned long hours = millis() / 3600000;
-    sprintf(filename, "flock_%lu.csv", hours / 24);
-    
-    if (logFile.open(filename, O_WRONLY | O_CREAT | O_APPEND)) {
-        logFile.print(millis());
-        logFile.print(",");
-        logFile.print(protocol);
-        logFile.print(",");
-        logFile.print(method);
-        logFile.print(",");
-        logFile.print(mac);
-        logFile.print(",");
-        logFile.print(rssi);
-        logFile.print(",");
-        logFile.print(ssid ? ssid : "");
-        logFile.print(",");
-        logFile.print(name ? name : "");
-        logFile.print(",");
-        if (gpsValid) {
-            logFile.print(lat, 6);
-            logFile.print(",");
-            logFile.print(lon, 6);
-        } else {
-            logFile.print(",");
+    char row[192];
+    int len;
+    if (gpsValid) {
+        len = snprintf(row, sizeof(row), "%lu,%s,%s,%s,%d,%s,%s,%.6f,%.6f\n",
+                       (unsigned long)time, protocol, method, mac, rssi,
+                       ssid ? ssid : "", name ? name : "", lat, lon);
+    } else {
+        len = snprintf(row, sizeof(row), "%lu,%s,%s,%s,%d,%s,%s,,\n",
+                       (unsigned long)time, protocol, method, mac, rssi,
+                       ssid ? ssid : "", name ? name : "");
+    }
+    if (len <= 0) return;
+    if (len >= (int)sizeof(row)) {
+        len = sizeof(row) - 1;
+        row[len - 1] = '\n';  // Truncated - keep the row terminated
+    }
+    
+    xSemaphoreTake(lock, portMAX_DELAY);
+    
+    // Day rollover - finish the old file before switching
+    uint32_t day = currentDay();
+    if (day != current_day) {
+        flushLocked();
+        if (!openDayFile(day)) {
+            xSemaphoreGive(lock);
+            return;
         }
-        logFile.println();
-        logFile.close();
     }
+    
+    if (log.getBuffered() + len > SD_SECTOR_BUFFER_SIZE) {
+        writeSectors();
+    }
+    if (!log.append((const uint8_t*)row, len)) {
+        xSemaphoreGive(lock);
+        return;                         // Card not taking writes - row lost
+    }
+    rows_logged++;
+    rowsLogged.add();
+    
+    // Size threshold: hand full sectors to the card
+    if (log.getBuffered() >= SD_SECTOR_BUFFER_SIZE - sizeof(row)) {
+        writeSectors();
+    }
+    
+    if (millis() - last_flush > settingsManager.getSettings().log.flush_interval) {
+        flushLocked();
+    }
+    
+    xSemaphoreGive(lock);
+}
+
+void SDLogger::writeSectors() {
+    // Up to the file's last sector boundary; the partial tail stays buffered
+    MetricTimer timer(writeLatency);
+    log.writeSectors();
+}
+
+void SDLogger::flushLocked() {
+    if (log.isOpen()) {
+        MetricTimer timer(syncLatency);
+        log.sync();
+    }
+    last_flush = millis();
+}
+
+void SDLogger::flush() {
+    if (!initialized) return;
+    
+    xSemaphoreTake(lock, portMAX_DELAY);
+    flushLocked();
+    xSemaphoreGive(lock);
+}
+
+void SDLogger::autoFlush() {
+    if (!initialized) return;
+    
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (log.getBuffered() > 0 && millis() - last_flush > settingsManager.getSettings().log.flush_interval) {
+        flushLocked();
+    }
+    xSemaphoreGive(lock);
 }
@@ -3,21 +3,49 @@
 
 #include <Arduino.h>
 #include <SPI.h>
-#include <SdFat.h>
+#include <SD.h>
 #include "config/pins.h"
+#include "sector_buffer.h"
+
+// Rows are formatted into a SectorBuffer and written to the open daily CSV in
+// writes that end on the file's 512-byte sector boundaries. The remainder is
+// written and synced when log.flush_interval elapses, when a tracked device
+// goes out of range, or on day rollover.
 
 class SDLogger {
 public:
-    bool begin();
-    void logDetection(const char* protocol, const char* method, const char* mac,
+    bool begin();      // The card is mounted by setup()
+    // time is the capture millis(), not when the row is written
+    void logDetection(uint32_t time, const char* protocol, const char* method, const char* mac,
                      int rssi, const char* ssid, const char* name,
                      bool gpsValid, double lat, double lon);
+    void flush();      // Write buffered rows and sync the file
+    void autoFlush();  // Flush if log.flush_interval exceeded
     bool isInitialized() { return initialized; }
 
+    // Other SPI-streaming users of the card (packet capture, camera index)
+    // hold getLock() while touching their files
+    SemaphoreHandle_t getLock() { return lock; }
+
+    // Stats
+    uint32_t getRowsLogged() { return rows_logged; }
+    uint32_t getSectorWrites() { return log.getSectorWrites(); }
+    uint32_t getSyncs() { return log.getSyncs(); }
+
 private:
-    SdFat sd;
-    SdFile logFile;
+    SectorBuffer log;                  // Owns the open file
     bool initialized = false;
+    SemaphoreHandle_t lock = nullptr;  // Detectors log from several tasks
+
+    uint32_t current_day = 0;          // YYYYMMDD from the RTC, or days since boot
+    unsigned long last_flush = 0;
+
+    uint32_t rows_logged = 0;
+
+    uint32_t currentDay();
+    bool openDayFile(uint32_t day);
+    void writeSectors();
+    void flushLocked();
 };
 
 extern SDLogger sdLogger;
@@ -0,0 +1,49 @@
+#include "sector_buffer.h"
+#include <string.h>
+
+void SectorBuffer::attach(FileHandle* opened) {
+    close();
+    file = opened;
+    offset = file ? file->size() : 0;
+}
+
+void SectorBuffer::close() {
+    delete file;
+    file = nullptr;
+    buffered = 0;
+}
+
+bool SectorBuffer::append(const uint8_t* data, size_t len) {
+    if (buffered + len > SD_SECTOR_BUFFER_SIZE) return false;
+    memcpy(buffer + buffered, data, len);
+    buffered += len;
+    return true;
+}
+
+// Writes the first len buffered bytes; what the card did not take stays buffered
+bool SectorBuffer::writeOut(size_t len) {
+    if (!file) return false;
+    size_t written = file->write(buffer, len);
+    if (written > 0) {
+        writes++;
+        sector_writes += (offset + written + SD_SECTOR_SIZE - 1) / SD_SECTOR_SIZE - offset / SD_SECTOR_SIZE;
+        offset += written;
+        buffered -= written;
+        memmove(buffer, buffer + written, buffered);
+    }
+    return written == len;
+}
+
+bool SectorBuffer::writeSectors() {
+    size_t tail = (offset + buffered) % SD_SECTOR_SIZE;
+    if (buffered <= tail) return true;  // No sector boundary in the buffer yet
+    return writeOut(buffered - tail);
+}
+
+bool SectorBuffer::sync() {
+    if (!file) return false;
+    bool ok = buffered == 0 || writeOut(buffered);
+    ok = file->flush() && ok;
+    syncs++;
+    return ok;
+}
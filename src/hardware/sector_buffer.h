@@ -0,0 +1,57 @@
+#ifndef SECTOR_BUFFER_H
+#define SECTOR_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hal/hal.h"
+
+// ============================================================================
+// SECTOR BUFFER
+// ============================================================================
+//
+// RAM buffer in front of a file that is only ever appended to. writeSectors()
+// hands the card everything up to the last sector boundary *of the file*: the
+// file offset is tracked from its size at attach(), so the first write after
+// opening a file of arbitrary size (or after sync() wrote a partial tail)
+// tops that sector up, and every later write covers whole sectors only. The
+// buffer is sector-aligned in memory so the driver can DMA straight from it.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define SD_SECTOR_SIZE 512
+#define SD_SECTOR_BUFFER_SIZE (4 * SD_SECTOR_SIZE)
+
+class SectorBuffer {
+public:
+    ~SectorBuffer() { close(); }
+
+    void attach(FileHandle* file);      // Takes ownership; appends go after its end
+    void close();                       // Drops what is still buffered
+    bool isOpen() { return file != nullptr; }
+
+    size_t getBuffered() { return buffered; }
+    uint32_t fileSize() { return offset + buffered; }  // Including buffered bytes
+
+    bool append(const uint8_t* data, size_t len);  // false if it does not fit
+    bool writeSectors();                // Up to the last sector boundary
+    bool sync();                        // Everything, then flush the file
+
+    // Stats
+    uint32_t getWrites() { return writes; }
+    uint32_t getSectorWrites() { return sector_writes; }   // Sectors touched, partial ones included
+    uint32_t getSyncs() { return syncs; }
+
+private:
+    alignas(SD_SECTOR_SIZE) uint8_t buffer[SD_SECTOR_BUFFER_SIZE];
+    FileHandle* file = nullptr;
+    size_t buffered = 0;
+    uint32_t offset = 0;                // File offset of buffer[0]
+
+    uint32_t writes = 0;
+    uint32_t sector_writes = 0;
+    uint32_t syncs = 0;
+
+    bool writeOut(size_t len);
+};
+
+#endif // SECTOR_BUFFER_H
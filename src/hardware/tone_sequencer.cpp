@@ -0,0 +1,66 @@
+#include "tone_sequencer.h"
+
+ToneSequence& ToneSequence::tone(uint16_t frequency, uint16_t duration) {
+    if (count < TONE_MAX_STEPS) {
+        steps[count].frequency = frequency;
+        steps[count].duration = duration;
+        count++;
+    }
+    return *this;
+}
+
+bool ToneSequencer::post(const ToneSequence& sequence, uint32_t now) {
+    if (sequence.count == 0) return false;
+
+    // Same sound already playing, queued or just played
+    bool duplicate = playing && current.sound == sequence.sound;
+    for (uint8_t i = 0; i < count && !duplicate; i++) {
+        duplicate = queue[(head + i) % TONE_QUEUE_DEPTH].sound == sequence.sound;
+    }
+    uint8_t slot = sequence.sound % SOUND_SLOTS;
+    if (!duplicate && started[slot] && now - lastStart[slot] < coalesceWindow) {
+        duplicate = true;
+    }
+    if (duplicate) {
+        coalesced++;
+        return false;
+    }
+
+    if (count >= TONE_QUEUE_DEPTH) {
+        overflows++;
+        return false;
+    }
+
+    queue[(head + count) % TONE_QUEUE_DEPTH] = sequence;
+    count++;
+    return true;
+}
+
+bool ToneSequencer::next(uint32_t now, ToneStep* stepOut) {
+    if (playing && step >= current.count) {
+        playing = false;
+    }
+
+    if (!playing) {
+        if (count == 0) return false;
+        current = queue[head];
+        head = (head + 1) % TONE_QUEUE_DEPTH;
+        count--;
+        step = 0;
+        playing = true;
+        played++;
+
+        uint8_t slot = current.sound % SOUND_SLOTS;
+        lastStart[slot] = now;
+        started[slot] = true;
+    }
+
+    *stepOut = current.steps[step++];
+    return true;
+}
+
+void ToneSequencer::clear() {
+    head = 0;
+    count = 0;
+    playing = false;
+}
@@ -0,0 +1,76 @@
+#ifndef TONE_SEQUENCER_H
+#define TONE_SEQUENCER_H
+
+#include <stdint.h>
+
+// ============================================================================
+// TONE SEQUENCER
+// ============================================================================
+//
+// Queue of short tone sequences (frequency/duration steps, frequency 0 is a
+// rest) played back one step at a time by a timer callback. Callers post a
+// sequence and return immediately.
+//
+// The queue holds at most TONE_QUEUE_DEPTH sequences. Each sequence carries
+// a sound id; a post is coalesced (dropped) if the same sound is already
+// queued or playing, or started less than the coalesce window ago, so a
+// burst of detections produces one alert instead of a backlog of beeps.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define TONE_MAX_STEPS 12
+#define TONE_QUEUE_DEPTH 4
+
+struct ToneStep {
+    uint16_t frequency;   // Hz, 0 = rest
+    uint16_t duration;    // ms
+};
+
+struct ToneSequence {
+    ToneStep steps[TONE_MAX_STEPS];
+    uint8_t count = 0;
+    uint8_t sound = 0;    // Caller-defined id used for coalescing
+
+    // Builder: seq.tone(2000, 100).rest(50).tone(2000, 100)
+    ToneSequence& tone(uint16_t frequency, uint16_t duration);
+    ToneSequence& rest(uint16_t duration) { return tone(0, duration); }
+};
+
+class ToneSequencer {
+public:
+    void setCoalesceWindow(uint32_t ms) { coalesceWindow = ms; }
+
+    // Returns false if the sequence was coalesced or the queue is full
+    bool post(const ToneSequence& sequence, uint32_t now);
+
+    // Advance to the next step; returns false when nothing is left to play
+    bool next(uint32_t now, ToneStep* stepOut);
+
+    bool isPlaying() const { return playing; }
+    void clear();
+
+    // Stats
+    uint32_t getPlayed() const { return played; }
+    uint32_t getCoalesced() const { return coalesced; }
+    uint32_t getOverflows() const { return overflows; }
+
+private:
+    ToneSequence queue[TONE_QUEUE_DEPTH];
+    uint8_t head = 0;
+    uint8_t count = 0;
+
+    ToneSequence current;
+    uint8_t step = 0;
+    bool playing = false;
+
+    static const int SOUND_SLOTS = 8;
+    uint32_t lastStart[SOUND_SLOTS] = {0};
+    bool started[SOUND_SLOTS] = {false};
+    uint32_t coalesceWindow = 1000;
+
+    uint32_t played = 0;
+    uint32_t coalesced = 0;
+    uint32_t overflows = 0;
+};
+
+#endif // TONE_SEQUENCER_H
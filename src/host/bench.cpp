@@ -0,0 +1,219 @@
+/*
+ * Bench mode: drives synthetic 802.11 and BLE traffic through each stage of
+ * the detection path and prints the results as JSON on stdout.
+ *
+ *   program bench [--datasets DIR] [--packets N] [--seed N]
+ *                 [--wifi-rate R] [--ble-rate R] [--match-ratio F]
+ *                 [--probe-ratio F] [--ssid-len MIN:MAX] [--devices N]
+ *                 [--skew S] [--out FILE]
+ *
+ * Stages (per packet, ns):
+ *   wifi_parse     parseWiFiFrame - the work of the sniffer callback
+ *   ble_parse      parseBleAdvert - the work of the NimBLE onResult callback
+ *   wifi_pipeline  DetectionPipeline::processWiFi (processing task)
+ *   ble_pipeline   DetectionPipeline::processBle
+ *   store          DetectionStore::record for each emitted detection; the
+ *                  host store uses the same DeviceTable as DataManager but
+ *                  no journal or SD writes
+ *   end_to_end     parse + pipeline
+ *
+ * "metrics" is the firmware's metrics registry (system/metrics.h) after the
+ * run, with the same histograms the stats command reports on the device.
+ *
+ * per_sec is the rate a stage sustains on its own (count / time spent in
+ * it); compare it with the offered wifi_rate/ble_rate for headroom. Each
+ * sample includes one steady_clock read (~20-30 ns).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "detection/detection_pipeline.h"
+#include "detection/frame_parser.h"
+#include "hal/native_hal.h"
+#include "system/metrics.h"
+#include "host.h"
+#include "latency.h"
+#include "synthetic_source.h"
+
+#define BENCH_STORE_CAPACITY 4096
+
+typedef std::chrono::steady_clock BenchClock;
+
+static uint64_t elapsedNs(BenchClock::time_point from, BenchClock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+// Times the store calls made from inside the pipeline
+class TimedStore : public DetectionStore {
+public:
+    TimedStore(DetectionStore* inner, LatencyRecorder* latency) : inner(inner), latency(latency) {}
+
+    bool record(const DetectionRecord& rec) override {
+        auto t0 = BenchClock::now();
+        bool known = inner->record(rec);
+        latency->add(elapsedNs(t0, BenchClock::now()));
+        return known;
+    }
+
+    bool isKnown(const uint8_t* mac) override { return inner->isKnown(mac); }
+
+private:
+    DetectionStore* inner;
+    LatencyRecorder* latency;
+};
+
+static void printPipelineJson(FILE* out, const PipelineStats& stats) {
+    fprintf(out, "{\"packets\":%u,\"matches\":%u,\"emitted\":%u,\"suppressed\":%u}",
+            (unsigned)stats.packets, (unsigned)stats.matches, (unsigned)stats.emitted,
+            (unsigned)stats.suppressed);
+}
+
+static void printStage(FILE* out, const char* name, LatencyRecorder& latency, bool last = false) {
+    fprintf(out, "    \"%s\": ", name);
+    printLatencyJson(out, latency.summarize());
+    fprintf(out, last ? "\n" : ",\n");
+}
+
+int runBench(int argc, char** argv) {
+    SyntheticConfig config;
+    const char* datasets = "datasets";
+    const char* outPath = nullptr;
+
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "[Bench] %s needs a value\n", arg);
+            return 2;
+        }
+        i++;
+        if (strcmp(arg, "--datasets") == 0) datasets = value;
+        else if (strcmp(arg, "--out") == 0) outPath = value;
+        else if (strcmp(arg, "--packets") == 0) config.packets = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--seed") == 0) config.seed = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--wifi-rate") == 0) config.wifiRate = atof(value);
+        else if (strcmp(arg, "--ble-rate") == 0) config.bleRate = atof(value);
+        else if (strcmp(arg, "--match-ratio") == 0) config.matchRatio = atof(value);
+        else if (strcmp(arg, "--probe-ratio") == 0) config.probeRatio = atof(value);
+        else if (strcmp(arg, "--devices") == 0) config.devices = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--skew") == 0) config.skew = atof(value);
+        else if (strcmp(arg, "--ssid-len") == 0) {
+            unsigned lo, hi;
+            if (sscanf(value, "%u:%u", &lo, &hi) != 2 || lo > hi || hi > 32) {
+                fprintf(stderr, "[Bench] --ssid-len expects MIN:MAX (0-32)\n");
+                return 2;
+            }
+            config.ssidMin = lo;
+            config.ssidMax = hi;
+        } else {
+            fprintf(stderr, "[Bench] Unknown option %s\n", arg);
+            return 2;
+        }
+    }
+
+    SyntheticSource source;
+    uint32_t seeds = source.loadDatasets(datasets);
+    if (seeds == 0) {
+        fprintf(stderr, "[Bench] No datasets in %s - using built-in targets\n", datasets);
+    }
+    source.begin(config);
+
+    LatencyRecorder wifiParse, bleParse, wifiPipeline, blePipeline, store, endToEnd;
+    endToEnd.reserve(config.packets);
+
+    FixedLocation location;
+    MemoryDetectionStore memoryStore;
+    TimedStore timedStore(&memoryStore, &store);
+    CountingAlerts alerts;
+    StreamEventSink events;
+    memoryStore.begin(BENCH_STORE_CAPACITY);
+    location.set(37.7749, -122.4194);
+
+    HalContext hal = {&location, &timedStore, &alerts, &events};
+    PipelineConfig pipelineConfig;
+    detectionPipeline.begin(hal, pipelineConfig);
+
+    RawPacket raw;
+    WiFiFrame frame;
+    BleAdvert advert;
+    uint32_t rejected = 0;
+    uint32_t targets = 0;
+
+    auto start = BenchClock::now();
+    while (source.nextRaw(&raw)) {
+        nativeSetTime(raw.micros);
+        uint32_t timestamp = (uint32_t)(raw.micros / 1000);
+        if (raw.target) targets++;
+
+        if (raw.kind == RADIO_WIFI) {
+            auto t0 = BenchClock::now();
+            bool accepted = parseWiFiFrame(raw.data, raw.len, raw.rssi, raw.channel, timestamp, &frame);
+            auto t1 = BenchClock::now();
+            wifiParse.add(elapsedNs(t0, t1));
+            if (!accepted) {
+                rejected++;
+                continue;
+            }
+            detectionPipeline.processWiFi(frame);
+            auto t2 = BenchClock::now();
+            wifiPipeline.add(elapsedNs(t1, t2));
+            endToEnd.add(elapsedNs(t0, t2));
+        } else {
+            auto t0 = BenchClock::now();
+            parseBleAdvert(raw.mac, raw.rssi, raw.data, raw.len, timestamp, &advert);
+            auto t1 = BenchClock::now();
+            detectionPipeline.processBle(advert);
+            auto t2 = BenchClock::now();
+            bleParse.add(elapsedNs(t0, t1));
+            blePipeline.add(elapsedNs(t1, t2));
+            endToEnd.add(elapsedNs(t0, t2));
+        }
+    }
+    double wall = std::chrono::duration<double>(BenchClock::now() - start).count();
+
+    FILE* out = stdout;
+    if (outPath) {
+        out = fopen(outPath, "w");
+        if (!out) {
+            fprintf(stderr, "[Bench] Cannot write %s\n", outPath);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"packets\":%u,\"seed\":%u,\"wifi_rate\":%.0f,\"ble_rate\":%.0f,"
+                 "\"match_ratio\":%g,\"probe_ratio\":%g,\"ssid_min\":%u,\"ssid_max\":%u,"
+                 "\"devices\":%u,\"skew\":%g,\"wifi_targets\":%u,\"ble_targets\":%u},\n",
+            (unsigned)config.packets, (unsigned)config.seed, config.wifiRate, config.bleRate,
+            config.matchRatio, config.probeRatio, (unsigned)config.ssidMin, (unsigned)config.ssidMax,
+            (unsigned)config.devices, config.skew, (unsigned)source.getWiFiTargets(),
+            (unsigned)source.getBleTargets());
+    fprintf(out, "  \"wall_seconds\": %.3f,\n", wall);
+    fprintf(out, "  \"stages\": {\n");
+    printStage(out, "wifi_parse", wifiParse);
+    printStage(out, "ble_parse", bleParse);
+    printStage(out, "wifi_pipeline", wifiPipeline);
+    printStage(out, "ble_pipeline", blePipeline);
+    printStage(out, "store", store);
+    printStage(out, "end_to_end", endToEnd, true);
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"pipeline\": {\"generated_targets\":%u,\"rejected_by_parser\":%u,\"wifi\":",
+            (unsigned)targets, (unsigned)rejected);
+    printPipelineJson(out, detectionPipeline.getWiFiStats());
+    fprintf(out, ",\"ble\":");
+    printPipelineJson(out, detectionPipeline.getBleStats());
+    fprintf(out, ",\"events\":%u,\"event_bytes\":%llu,\"event_overflows\":%u,\"devices\":%u}",
+            (unsigned)events.getEvents(), (unsigned long long)events.getBytes(),
+            (unsigned)detectionPipeline.getEventOverflows(), (unsigned)memoryStore.getDevices());
+
+    static char metrics[4096];
+    if (metricsFormatJson(metrics, sizeof(metrics))) {
+        fprintf(out, ",\n  \"metrics\": {%s}", metrics);
+    }
+    fprintf(out, "\n}\n");
+
+    if (out != stdout) fclose(out);
+    return 0;
+}
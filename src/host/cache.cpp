@@ -0,0 +1,167 @@
+/*
+ * Cache mode: checks the per-(MAC, method) cooldown in DetectionCache.
+ *
+ *   program cache
+ *
+ * Checks:
+ *   - a burst of sightings inside the cooldown is emitted once and the rest
+ *     suppressed; the first sighting after the cooldown is emitted again
+ *     with a summary of the burst (count, RSSI min/max/last, window length)
+ *   - the same MAC under another method has its own window
+ *   - a full probe run replaces the entry seen longest ago; that device is
+ *     emitted early, the others stay suppressed. Closed windows are reused
+ *     before anything is replaced.
+ *   - 200,000 sightings each of 30 and of 60 devices (one vendor, two
+ *     methods: 60 and 120 live windows for 128 slots) against an unbounded
+ *     reference: the cache never suppresses a sighting the reference emits,
+ *     every early emit is accounted for by a replacement, and 30 devices
+ *     fit without any
+ */
+
+#include <stdio.h>
+#include <map>
+#include <random>
+#include <vector>
+#include "detection/detection_cache.h"
+#include "check.h"
+#include "host.h"
+
+#define CACHE_COOLDOWN 1000
+
+static void macFor(uint32_t n, uint8_t* mac) {
+    mac[0] = 0x58;
+    mac[1] = 0x8e;
+    mac[2] = 0x81;
+    mac[3] = (n >> 16) & 0xFF;
+    mac[4] = (n >> 8) & 0xFF;
+    mac[5] = n & 0xFF;
+}
+
+// Home slot of a key, as DetectionCache::slotFor computes it
+static uint32_t homeOf(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (uint32_t)key & (DETECTION_CACHE_SLOTS - 1);
+}
+
+static void checkBurst() {
+    DetectionCache cache;
+    uint8_t mac[6];
+    macFor(1, mac);
+    DetectionSummary summary;
+    bool hasSummary = true;
+
+    expect(cache.shouldEmit(mac, "ssid", -70, 5000, CACHE_COOLDOWN, &summary, &hasSummary) && !hasSummary,
+           "first sighting emitted without a summary");
+    uint32_t emitted = 0;
+    for (uint32_t i = 1; i < 50; i++) {
+        int8_t rssi = -80 + (int8_t)(i % 25);
+        emitted += cache.shouldEmit(mac, "ssid", rssi, 5000 + i * 10, CACHE_COOLDOWN, &summary, &hasSummary);
+    }
+    expect(emitted == 0 && cache.getSuppressed() == 49, "burst inside the cooldown suppressed");
+
+    expect(!cache.shouldEmit(mac, "ssid", -60, 5999, CACHE_COOLDOWN), "last millisecond of the window suppressed");
+    expect(cache.shouldEmit(mac, "ssid", -65, 6000, CACHE_COOLDOWN, &summary, &hasSummary) && hasSummary,
+           "emitted again once the cooldown has passed");
+    expect(summary.sightings == 51 && summary.rssiMin == -80 && summary.rssiMax == -56 &&
+           summary.rssiLast == -60 && summary.windowMs == 999, "summary of the burst");
+
+    // A window with a single sighting has nothing to summarize
+    expect(cache.shouldEmit(mac, "ssid", -65, 7000, CACHE_COOLDOWN, &summary, &hasSummary) && !hasSummary,
+           "no summary for a window without repeats");
+
+    // Other method, own window; no cooldown means no suppression
+    expect(cache.shouldEmit(mac, "oui", -65, 7001, CACHE_COOLDOWN), "other method has its own window");
+    expect(!cache.shouldEmit(mac, "oui", -65, 7002, CACHE_COOLDOWN), "other method suppressed in its window");
+    expect(cache.shouldEmit(mac, "oui", -65, 7003, 0), "cooldown 0 always emits");
+}
+
+static void checkReplacement() {
+    // Nine devices whose home is the same slot: one more than a probe run holds
+    std::vector<uint32_t> devices;
+    uint32_t home = 0;
+    uint8_t mac[6];
+    for (uint32_t n = 0; devices.size() < DETECTION_CACHE_PROBES + 1; n++) {
+        macFor(n, mac);
+        uint32_t slot = homeOf(DetectionCache::makeKey(mac, "ssid"));
+        if (devices.empty()) home = slot;
+        if (slot == home) devices.push_back(n);
+    }
+
+    DetectionCache cache;
+    for (uint32_t i = 0; i < DETECTION_CACHE_PROBES; i++) {
+        macFor(devices[i], mac);
+        cache.shouldEmit(mac, "ssid", -70, 100 + i, CACHE_COOLDOWN);
+    }
+    macFor(devices[0], mac);
+    expect(!cache.shouldEmit(mac, "ssid", -70, 200, CACHE_COOLDOWN), "device 0 seen again (suppressed)");
+
+    macFor(devices[DETECTION_CACHE_PROBES], mac);
+    expect(cache.shouldEmit(mac, "ssid", -70, 300, CACHE_COOLDOWN) && cache.getReplaced() == 1,
+           "ninth device replaces an entry");
+
+    // Device 1 was seen longest ago; everyone else is still in their window
+    bool othersSuppressed = true;
+    for (uint32_t i = 0; i <= DETECTION_CACHE_PROBES; i++) {
+        if (i == 1) continue;
+        macFor(devices[i], mac);
+        othersSuppressed &= !cache.shouldEmit(mac, "ssid", -70, 400, CACHE_COOLDOWN);
+    }
+    expect(othersSuppressed, "devices still in the cache stay suppressed");
+    macFor(devices[1], mac);
+    expect(cache.shouldEmit(mac, "ssid", -70, 410, CACHE_COOLDOWN), "device seen longest ago was replaced");
+
+    // Once their windows have closed, entries are reused without replacing
+    uint32_t replaced = cache.getReplaced();
+    for (uint32_t n = 100000; n < 100000 + 4 * DETECTION_CACHE_SLOTS; n++) {
+        macFor(n, mac);
+        cache.shouldEmit(mac, "ssid", -70, 5000 + (n - 100000) * 10, 10);
+    }
+    expect(cache.getReplaced() == replaced, "closed windows reused before replacing");
+}
+
+static void checkAgainstReference(uint32_t devices) {
+    std::mt19937 rng(9);
+    DetectionCache cache;
+    std::map<uint64_t, uint32_t> windows;   // Key -> start of the window the cache opened
+    uint32_t now = 0;
+    uint32_t wrongSuppress = 0, early = 0, emitted = 0;
+
+    for (uint32_t i = 0; i < 200000; i++) {
+        now += rng() % 3;
+        uint8_t mac[6];
+        macFor(rng() % devices, mac);
+        const char* method = rng() % 4 ? "ssid" : "oui";
+        uint64_t key = DetectionCache::makeKey(mac, method);
+
+        auto it = windows.find(key);
+        bool reference = it == windows.end() || now - it->second >= CACHE_COOLDOWN;
+        bool emit = cache.shouldEmit(mac, method, -70, now, CACHE_COOLDOWN);
+        if (emit) {
+            windows[key] = now;
+            emitted++;
+            if (!reference) early++;
+        } else if (reference) {
+            wrongSuppress++;
+        }
+    }
+
+    printf("[Cache] Reference: 200000 sightings of %u devices, %u emitted, %u early (%u replacements)\n",
+           (unsigned)devices, (unsigned)emitted, (unsigned)early, (unsigned)cache.getReplaced());
+    expect(wrongSuppress == 0, "never suppresses a sighting the reference emits");
+    expect(early <= cache.getReplaced(), "early emits come from replacements");
+    if (devices <= 30) expect(cache.getReplaced() == 0, "60 windows fit in 128 slots without replacing");
+}
+
+int runCache(int, char**) {
+    checkBegin("Cache");
+    checkBurst();
+    checkReplacement();
+    checkAgainstReference(30);
+    checkAgainstReference(60);
+
+    return checkEnd();
+}
@@ -0,0 +1,264 @@
+/*
+ * Camindex mode: compiles the camera positions in datasets/ into the binary
+ * spatial index the firmware reads from the SD card (/cameras.idx), then
+ * checks it with the same lookup code the device runs.
+ *
+ *   program camindex [--datasets DIR] [--out FILE] [--distance M]
+ *                    [--check LAT,LON[,COURSE,KMH]]
+ *
+ * Sources, recognised by their header columns:
+ *   trilat,trilong,type   WiGLE exports (type BLE = Flock BLE, else WiFi)
+ *   coordinates           Pigvision.csv ("lat, lon" in one field)
+ *   latitude,longitude    maximum_dots.csv
+ *
+ * Positions closer than ~11 m (1e-4 deg grid) are merged; WiGLE keeps
+ * several trilaterated sightings of the same camera.
+ *
+ * --check looks up one position instead of building. Otherwise every
+ * built camera is looked up from 100 m south of it, stationary, and must
+ * raise an alert; the average card reads per reload are reported.
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+#include "hal/native_hal.h"
+#include "location/camera_index.h"
+#include "csv.h"
+#include "host.h"
+
+#define CAMINDEX_MERGE_MICRODEG 100     // 1e-4 deg grid for merging duplicates
+#define CAMINDEX_CHECK_SAMPLES 2000
+
+static bool parseCoordinate(const std::string& text, double* value) {
+    char* end;
+    *value = strtod(text.c_str(), &end);
+    return end != text.c_str();
+}
+
+static bool addCamera(std::vector<CameraRecord>& cameras, double lat, double lon, CameraKind kind) {
+    if (lat < -90 || lat > 90 || lon < -180 || lon >= 180) return false;
+    if (lat == 0 && lon == 0) return false;     // Missing position
+    CameraRecord record = {toMicrodegrees(lat), toMicrodegrees(lon), kind};
+    cameras.push_back(record);
+    return true;
+}
+
+static uint32_t loadFile(const std::string& path, std::vector<CameraRecord>& cameras) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) return 0;
+
+    std::vector<std::string> header;
+    if (!readCsvHeader(file, &header)) {
+        fclose(file);
+        return 0;
+    }
+    int trilatCol = csvColumn(header, "trilat");
+    int trilongCol = csvColumn(header, "trilong");
+    int typeCol = csvColumn(header, "type");
+    int coordCol = csvColumn(header, "coordinates");
+    int latCol = csvColumn(header, "latitude");
+    int lonCol = csvColumn(header, "longitude");
+
+    uint32_t added = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        std::vector<std::string> fields = splitCsv(line);
+        double lat, lon;
+        CameraKind kind;
+
+        if (trilatCol >= 0 && trilongCol >= 0) {
+            if ((int)fields.size() <= std::max(trilatCol, trilongCol)) continue;
+            if (!parseCoordinate(fields[trilatCol], &lat) || !parseCoordinate(fields[trilongCol], &lon)) continue;
+            bool ble = typeCol >= 0 && (int)fields.size() > typeCol && fields[typeCol] == "BLE";
+            kind = ble ? CAMERA_FLOCK_BLE : CAMERA_FLOCK_WIFI;
+        } else if (coordCol >= 0) {
+            if ((int)fields.size() <= coordCol) continue;
+            if (sscanf(fields[coordCol].c_str(), "%lf , %lf", &lat, &lon) != 2) continue;
+            kind = CAMERA_ALPR;
+        } else if (latCol >= 0 && lonCol >= 0) {
+            if ((int)fields.size() <= std::max(latCol, lonCol)) continue;
+            if (!parseCoordinate(fields[latCol], &lat) || !parseCoordinate(fields[lonCol], &lon)) continue;
+            kind = CAMERA_CCTV;
+        } else {
+            break;                              // No position columns
+        }
+
+        if (addCamera(cameras, lat, lon, kind)) added++;
+    }
+    fclose(file);
+    return added;
+}
+
+// ============================================================================
+// BUILD
+// ============================================================================
+
+static bool writeIndex(const char* path, std::vector<CameraRecord>& cameras, CameraIndexHeader* header) {
+    std::sort(cameras.begin(), cameras.end(), [](const CameraRecord& a, const CameraRecord& b) {
+        uint32_t ka = cameraTileKey(a.lat, a.lon);
+        uint32_t kb = cameraTileKey(b.lat, b.lon);
+        if (ka != kb) return ka < kb;
+        if (a.lat != b.lat) return a.lat < b.lat;
+        return a.lon < b.lon;
+    });
+
+    // Merge near-duplicates, first (lowest) position wins
+    std::vector<CameraRecord> merged;
+    std::set<std::pair<int32_t, int32_t>> seen;
+    for (const CameraRecord& camera : cameras) {
+        auto cell = std::make_pair(camera.lat / CAMINDEX_MERGE_MICRODEG, camera.lon / CAMINDEX_MERGE_MICRODEG);
+        if (seen.insert(cell).second) merged.push_back(camera);
+    }
+    cameras.swap(merged);
+
+    std::vector<std::pair<uint32_t, uint32_t>> directory;   // Tile key, first record
+    for (uint32_t i = 0; i < cameras.size(); i++) {
+        uint32_t key = cameraTileKey(cameras[i].lat, cameras[i].lon);
+        if (directory.empty() || directory.back().first != key) directory.emplace_back(key, i);
+    }
+    header->tileCount = directory.size();
+    header->recordCount = cameras.size();
+
+    FILE* out = fopen(path, "wb");
+    if (!out) return false;
+
+    uint8_t raw[CAMERA_INDEX_HEADER_SIZE];
+    cameraWriteHeader(raw, *header);
+    fwrite(raw, 1, CAMERA_INDEX_HEADER_SIZE, out);
+    for (const auto& entry : directory) {
+        cameraWriteDirEntry(raw, entry.first, entry.second);
+        fwrite(raw, 1, CAMERA_INDEX_DIR_ENTRY_SIZE, out);
+    }
+    for (const CameraRecord& camera : cameras) {
+        cameraWriteRecord(raw, camera);
+        fwrite(raw, 1, CAMERA_INDEX_RECORD_SIZE, out);
+    }
+    bool ok = ferror(out) == 0;
+    return fclose(out) == 0 && ok;
+}
+
+// ============================================================================
+// LOOKUP
+// ============================================================================
+
+static void printAlert(const CameraAlert& alert) {
+    printf("{\"type\":\"camera_ahead\",\"kind\":\"%s\",\"distance_m\":%u,\"bearing\":%u,"
+           "\"latitude\":%.6f,\"longitude\":%.6f}\n",
+           cameraKindName(alert.camera.kind), alert.distance, alert.bearing,
+           fromMicrodegrees(alert.camera.lat), fromMicrodegrees(alert.camera.lon));
+}
+
+static int checkPosition(const char* path, const CameraAlertConfig& config, const char* position) {
+    double lat, lon, course = 0, speed = 0;
+    int n = sscanf(position, "%lf,%lf,%lf,%lf", &lat, &lon, &course, &speed);
+    if (n != 2 && n != 4) {
+        fprintf(stderr, "[CamIndex] --check expects LAT,LON[,COURSE,KMH]\n");
+        return 2;
+    }
+
+    StdioFileReader reader;
+    if (!reader.open(path) || !cameraIndex.begin(&reader, config)) {
+        fprintf(stderr, "[CamIndex] Cannot read %s\n", path);
+        return 1;
+    }
+
+    CameraFix fix = {toMicrodegrees(lat), toMicrodegrees(lon), n == 4, (float)course, (float)speed};
+    CameraAlert alert;
+    bool found = false;
+    while (cameraIndex.update(fix, &alert)) {   // Nearest first, each once
+        printAlert(alert);
+        found = true;
+    }
+    printf("[CamIndex] %u cameras cached, %u card reads\n",
+           cameraIndex.getCachedCount(), (unsigned)reader.getReads());
+    if (!found) printf("[CamIndex] No known camera within %u m\n", config.alertDistance);
+    return 0;
+}
+
+// Every camera (or an even sample) must alert from 100 m away
+static int verifyIndex(const char* path, const CameraAlertConfig& config, const std::vector<CameraRecord>& cameras) {
+    StdioFileReader reader;
+    if (!reader.open(path) || !cameraIndex.begin(&reader, config)) {
+        fprintf(stderr, "[CamIndex] Cannot read back %s\n", path);
+        return 1;
+    }
+
+    uint32_t step = cameras.size() / CAMINDEX_CHECK_SAMPLES + 1;
+    uint32_t checked = 0;
+    uint32_t missed = 0;
+    int64_t now = 0;
+    for (uint32_t i = 0; i < cameras.size(); i += step) {
+        now += (int64_t)config.realertTime * 1000;    // Forget earlier alerts
+        nativeSetTime(now);
+
+        CameraFix fix = {cameras[i].lat - geoMetersToLatMicrodeg(100), cameras[i].lon, false, 0, 0};
+        CameraAlert alert;
+        if (!cameraIndex.update(fix, &alert) || alert.distance > 100) missed++;
+        checked++;
+    }
+
+    uint32_t reloads = cameraIndex.getReloads();
+    printf("[CamIndex] Checked %u cameras: %u missed, %u reloads, %.1f card reads per reload\n",
+           (unsigned)checked, (unsigned)missed, (unsigned)reloads,
+           reloads ? (double)reader.getReads() / reloads : 0.0);
+    return missed ? 1 : 0;
+}
+
+int runCamIndex(int argc, char** argv) {
+    const char* datasets = "datasets";
+    const char* outPath = "cameras.idx";
+    const char* check = nullptr;
+    CameraAlertConfig config;
+
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "[CamIndex] %s needs a value\n", arg);
+            return 2;
+        }
+        i++;
+        if (strcmp(arg, "--datasets") == 0) datasets = value;
+        else if (strcmp(arg, "--out") == 0) outPath = value;
+        else if (strcmp(arg, "--check") == 0) check = value;
+        else if (strcmp(arg, "--distance") == 0) config.alertDistance = strtoul(value, nullptr, 10);
+        else {
+            fprintf(stderr, "[CamIndex] Unknown option %s\n", arg);
+            return 2;
+        }
+    }
+
+    if (check) return checkPosition(outPath, config, check);
+
+    DIR* d = opendir(datasets);
+    if (!d) {
+        fprintf(stderr, "[CamIndex] Cannot open %s\n", datasets);
+        return 1;
+    }
+    std::vector<CameraRecord> cameras;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr) {
+        size_t n = strlen(entry->d_name);
+        if (n < 4 || strcmp(entry->d_name + n - 4, ".csv") != 0) continue;
+        uint32_t added = loadFile(std::string(datasets) + "/" + entry->d_name, cameras);
+        if (added) printf("[CamIndex] %s: %u positions\n", entry->d_name, (unsigned)added);
+    }
+    closedir(d);
+
+    CameraIndexHeader header;
+    if (!writeIndex(outPath, cameras, &header)) {
+        fprintf(stderr, "[CamIndex] Cannot write %s\n", outPath);
+        return 1;
+    }
+    printf("[CamIndex] Wrote %s: %u cameras in %u tiles, %u bytes\n", outPath,
+           (unsigned)header.recordCount, (unsigned)header.tileCount,
+           (unsigned)cameraRecordOffset(header, header.recordCount));
+
+    return verifyIndex(outPath, config, cameras);
+}
@@ -0,0 +1,306 @@
+/*
+ * Channels mode: replays a channel trace through the ChannelScheduler and
+ * through the hopping it replaced, and compares what each one hears.
+ *
+ *   program channels [TRACE]
+ *
+ * A trace is a CSV of the frames on the air, one per line:
+ *
+ *   millis,channel,match
+ *   1200,6,0
+ *   1312,3,1
+ *
+ * `match` is 1 for frames the detectors flag (Flock/Raven hits). The
+ * scheduler is stepped every 10 ms, as the hop task calls hopChannel, and
+ * the old policy every millisecond; a frame is heard when the radio is on
+ * its channel at that millisecond. The scheduler is fed the frame counts and matches it would
+ * see on the device. The old policy is the fixed 200 ms sequential hop that
+ * jumps to 1/6/11 every other hop once nothing was detected for 10 s.
+ *
+ * Reported per channel: frames and matches on the air, matches each policy
+ * heard (hits) and the longest time each left the channel unvisited.
+ *
+ * Without a trace, a synthetic 10-minute drive is used (busy APs on 1/6/11,
+ * quieter ones elsewhere, cameras passing on several channels) and checked:
+ * the scheduler hears more matches than the old hopping and never leaves a
+ * channel for longer than max_revisit plus one max_dwell.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "detection/channel_scheduler.h"
+#include "check.h"
+#include "csv.h"
+#include "host.h"
+
+#define HOP_TICK 10                     // CHANNEL_HOP_TICK, the hop task period
+#define OLD_HOP_INTERVAL 200            // CHANNEL_HOP_INTERVAL before the scheduler
+#define OLD_IDLE_TIME 10000             // No detection for this long -> priority channels
+#define SYNTHETIC_DURATION 600000       // ms
+
+struct TraceFrame {
+    uint32_t time;
+    uint8_t channel;
+    bool match;
+};
+
+struct ChannelStats {
+    uint32_t hits[CHANNEL_SCHEDULER_MAX_CHANNELS + 1] = {0};
+    uint32_t worstRevisit[CHANNEL_SCHEDULER_MAX_CHANNELS + 1] = {0};  // ms
+    uint32_t hops = 0;
+
+    uint32_t totalHits() const {
+        uint32_t total = 0;
+        for (int ch = 1; ch <= CHANNEL_SCHEDULER_MAX_CHANNELS; ch++) total += hits[ch];
+        return total;
+    }
+};
+
+// ============================================================================
+// POLICIES
+// ============================================================================
+
+// ChannelScheduler as WiFiDetector::hopChannel drives it (device defaults)
+class ScheduledHopping {
+public:
+    explicit ScheduledHopping(uint8_t channels) { config.channels = channels; }
+
+    void begin(uint32_t now) {
+        scheduler.begin(config, now);
+        start = now;
+    }
+
+    uint8_t channelAt(uint32_t now) {
+        if ((now - start) % HOP_TICK == 0 && scheduler.due(now)) {
+            scheduler.next(frames, now);
+            frames = 0;
+        }
+        return scheduler.current();
+    }
+
+    void heard(const TraceFrame& frame, uint32_t now) {
+        frames++;
+        if (frame.match) scheduler.recordMatch(frame.channel, now);
+    }
+
+    const ChannelSchedulerConfig& getConfig() const { return config; }
+
+private:
+    ChannelSchedulerConfig config;
+    ChannelScheduler scheduler;
+    uint32_t frames = 0;
+    uint32_t start = 0;
+};
+
+// The hopping WiFiDetector::hopChannel did before the scheduler
+class OldHopping {
+public:
+    explicit OldHopping(uint8_t channels) : maxChannel(channels) {}
+
+    void begin(uint32_t now) {
+        lastHop = now;
+        lastDetection = now;            // Boot: millis() and lastDetection both 0
+    }
+
+    uint8_t channelAt(uint32_t now) {
+        if (now - lastHop > OLD_HOP_INTERVAL) {
+            current++;
+            if (current > maxChannel) {
+                current = 1;
+                cycles++;
+            }
+            if (now - lastDetection > OLD_IDLE_TIME && cycles > 0) {
+                if (usePriority) {
+                    current = PRIORITY_CHANNELS[priorityIdx];
+                    priorityIdx = (priorityIdx + 1) % 3;
+                }
+                usePriority = !usePriority;
+            }
+            lastHop = now;
+        }
+        return current;
+    }
+
+    void heard(const TraceFrame& frame, uint32_t now) {
+        if (frame.match) lastDetection = now;
+    }
+
+private:
+    static constexpr uint8_t PRIORITY_CHANNELS[3] = {1, 6, 11};
+    uint8_t maxChannel;
+    uint8_t current = 1;
+    uint32_t lastHop = 0;
+    uint32_t lastDetection = 0;
+    uint8_t cycles = 0;
+    uint8_t priorityIdx = 0;
+    bool usePriority = false;
+};
+
+template <class Policy>
+static ChannelStats simulate(Policy& policy, const std::vector<TraceFrame>& trace, uint8_t channels) {
+    ChannelStats stats;
+    uint32_t start = trace.front().time;
+    uint32_t end = trace.back().time + 1;
+    uint32_t left[CHANNEL_SCHEDULER_MAX_CHANNELS + 1];   // When the radio last left the channel
+    for (int ch = 0; ch <= CHANNEL_SCHEDULER_MAX_CHANNELS; ch++) left[ch] = start;
+
+    policy.begin(start);
+    uint8_t current = policy.channelAt(start);
+    size_t f = 0;
+    for (uint32_t now = start; now < end; now++) {
+        uint8_t channel = policy.channelAt(now);
+        if (channel != current) {
+            uint32_t away = now - left[channel];
+            if (away > stats.worstRevisit[channel]) stats.worstRevisit[channel] = away;
+            left[current] = now;
+            current = channel;
+            stats.hops++;
+        }
+        for (; f < trace.size() && trace[f].time == now; f++) {
+            if (trace[f].channel != current) continue;
+            if (trace[f].match) stats.hits[current]++;
+            policy.heard(trace[f], now);
+        }
+    }
+
+    // Channels still waiting when the trace ends
+    for (uint8_t ch = 1; ch <= channels; ch++) {
+        uint32_t away = ch == current ? 0 : end - left[ch];
+        if (away > stats.worstRevisit[ch]) stats.worstRevisit[ch] = away;
+    }
+    return stats;
+}
+
+// ============================================================================
+// TRACES
+// ============================================================================
+
+static bool loadTrace(const char* path, std::vector<TraceFrame>* trace) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "[Channels] Cannot open %s\n", path);
+        return false;
+    }
+
+    std::vector<std::string> header;
+    int timeCol = -1, channelCol = -1, matchCol = -1;
+    if (readCsvHeader(file, &header)) {
+        timeCol = csvColumn(header, "millis");
+        channelCol = csvColumn(header, "channel");
+        matchCol = csvColumn(header, "match");
+    }
+    if (timeCol < 0 || channelCol < 0 || matchCol < 0) {
+        fprintf(stderr, "[Channels] %s: expected a millis,channel,match header\n", path);
+        fclose(file);
+        return false;
+    }
+
+    char line[256];
+    uint32_t skipped = 0;
+    while (fgets(line, sizeof(line), file)) {
+        std::vector<std::string> fields = splitCsv(line);
+        int channel = (int)fields.size() > channelCol ? atoi(fields[channelCol].c_str()) : 0;
+        if ((int)fields.size() <= std::max(timeCol, matchCol) || channel < 1 ||
+            channel > CHANNEL_SCHEDULER_MAX_CHANNELS) {
+            skipped++;
+            continue;
+        }
+        trace->push_back({(uint32_t)strtoul(fields[timeCol].c_str(), nullptr, 10), (uint8_t)channel,
+                          atoi(fields[matchCol].c_str()) != 0});
+    }
+    fclose(file);
+
+    std::stable_sort(trace->begin(), trace->end(),
+                     [](const TraceFrame& a, const TraceFrame& b) { return a.time < b.time; });
+    if (skipped) printf("[Channels] %s: %u lines skipped\n", path, (unsigned)skipped);
+    if (trace->empty()) fprintf(stderr, "[Channels] %s: no frames\n", path);
+    return !trace->empty();
+}
+
+// Beacons of the APs around a drive plus cameras passing on a few channels
+static std::vector<TraceFrame> syntheticTrace() {
+    std::mt19937 rng(13);
+    std::vector<TraceFrame> trace;
+
+    // APs per channel: crowded 1/6/11, a few elsewhere
+    static const uint8_t APS[14] = {0, 7, 1, 2, 0, 1, 9, 0, 1, 2, 0, 6, 0, 1};
+    for (uint8_t ch = 1; ch <= 13; ch++) {
+        for (int ap = 0; ap < APS[ch]; ap++) {
+            for (uint32_t t = rng() % 102; t < SYNTHETIC_DURATION; t += 102) {
+                trace.push_back({t, ch, false});
+            }
+        }
+    }
+
+    // Cameras in range for 10-40 s, one frame every 300-900 ms
+    static const uint8_t CAMERA_CHANNELS[] = {1, 3, 6, 6, 9, 11, 13, 4, 11, 8};
+    uint32_t t = 5000;
+    for (uint8_t ch : CAMERA_CHANNELS) {
+        uint32_t until = t + 10000 + rng() % 30000;
+        for (uint32_t at = t; at < until; at += 300 + rng() % 600) {
+            trace.push_back({at, ch, true});
+        }
+        t = until + 10000 + rng() % 40000;
+    }
+
+    std::stable_sort(trace.begin(), trace.end(),
+                     [](const TraceFrame& a, const TraceFrame& b) { return a.time < b.time; });
+    return trace;
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+static void compare(const std::vector<TraceFrame>& trace, bool check) {
+    uint8_t channels = 13;
+    uint32_t frames[CHANNEL_SCHEDULER_MAX_CHANNELS + 1] = {0};
+    uint32_t matches[CHANNEL_SCHEDULER_MAX_CHANNELS + 1] = {0};
+    for (const auto& frame : trace) {
+        frames[frame.channel]++;
+        if (frame.match) matches[frame.channel]++;
+        if (frame.channel > channels) channels = frame.channel;
+    }
+
+    ScheduledHopping scheduled(channels);
+    OldHopping old(channels);
+    ChannelStats s = simulate(scheduled, trace, channels);
+    ChannelStats o = simulate(old, trace, channels);
+
+    uint32_t duration = trace.back().time + 1 - trace.front().time;
+    printf("[Channels] %u frames over %.1f s\n", (unsigned)trace.size(), duration / 1000.0);
+    printf("[Channels] channel   frames  matches | hits: scheduler    old | worst revisit: scheduler      old\n");
+    uint32_t airMatches = 0, worstScheduled = 0;
+    for (uint8_t ch = 1; ch <= channels; ch++) {
+        printf("[Channels] %7u %8u %8u |            %6u %6u |             %6u ms %6u ms\n", (unsigned)ch,
+               (unsigned)frames[ch], (unsigned)matches[ch], (unsigned)s.hits[ch], (unsigned)o.hits[ch],
+               (unsigned)s.worstRevisit[ch], (unsigned)o.worstRevisit[ch]);
+        airMatches += matches[ch];
+        if (s.worstRevisit[ch] > worstScheduled) worstScheduled = s.worstRevisit[ch];
+    }
+    printf("[Channels] total   %8u %8u |            %6u %6u | hops: %u scheduler, %u old\n",
+           (unsigned)trace.size(), (unsigned)airMatches, (unsigned)s.totalHits(), (unsigned)o.totalHits(),
+           (unsigned)s.hops, (unsigned)o.hops);
+
+    if (!check) return;
+    const ChannelSchedulerConfig& cfg = scheduled.getConfig();
+    expect(s.totalHits() > o.totalHits(), "scheduler hears more matches than the old hopping");
+    expect(worstScheduled <= cfg.max_revisit + cfg.max_dwell, "every channel revisited within max_revisit + max_dwell");
+}
+
+int runChannels(int argc, char** argv) {
+    checkBegin("Channels");
+    if (argc > 0) {
+        std::vector<TraceFrame> trace;
+        if (!loadTrace(argv[0], &trace)) return 1;
+        compare(trace, false);
+        return 0;
+    }
+
+    compare(syntheticTrace(), true);
+
+    return checkEnd();
+}
@@ -0,0 +1,26 @@
+#include "check.h"
+#include <stdio.h>
+
+static const char* checkModule = "Host";
+static int failures = 0;
+
+void checkBegin(const char* module) {
+    checkModule = module;
+    failures = 0;
+}
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        printf("[%s] FAIL: %s\n", checkModule, what);
+        failures++;
+    }
+}
+
+int checkFailures() {
+    return failures;
+}
+
+int checkEnd() {
+    printf("[%s] %s\n", checkModule, failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
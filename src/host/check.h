@@ -0,0 +1,20 @@
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+// Pass/fail bookkeeping shared by the checking modes. A mode names itself,
+// calls expect() for each check and returns checkEnd():
+//
+//   int runRing(int, char**) {
+//       checkBegin("Ring");
+//       expect(ring.empty(), "new ring is empty");   // "[Ring] FAIL: ..." when false
+//       return checkEnd();                           // "[Ring] OK" -> 0, "[Ring] FAILED" -> 1
+//   }
+//
+// Main thread only.
+
+void checkBegin(const char* module);            // Name in the FAIL/OK lines; resets the count
+void expect(bool condition, const char* what);
+int checkFailures();                            // Failed checks since checkBegin
+int checkEnd();                                 // Prints OK/FAILED, returns the exit status
+
+#endif // HOST_CHECK_H
@@ -0,0 +1,32 @@
+#include "csv.h"
+
+std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            fields.emplace_back();
+        } else if (c != '\r' && c != '\n') {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+int csvColumn(const std::vector<std::string>& header, const char* name) {
+    for (size_t i = 0; i < header.size(); i++) {
+        if (header[i] == name) return i;
+    }
+    return -1;
+}
+
+bool readCsvHeader(FILE* file, std::vector<std::string>* header) {
+    char line[4096];
+    if (!fgets(line, sizeof(line), file)) return false;
+    std::string text = line;
+    if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.erase(0, 3);  // BOM
+    *header = splitCsv(text);
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef HOST_CSV_H
+#define HOST_CSV_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Minimal CSV reading for the datasets/ exports (WiGLE, Pigvision,
+// maximum_dots): one record per line, double quotes protect commas.
+
+// Splits one CSV line, honouring double quotes
+std::vector<std::string> splitCsv(const std::string& line);
+
+// Index of a header column, -1 if absent
+int csvColumn(const std::vector<std::string>& header, const char* name);
+
+// Reads the header line (UTF-8 BOM stripped); false on an empty file
+bool readCsvHeader(FILE* file, std::vector<std::string>* header);
+
+#endif // HOST_CSV_H
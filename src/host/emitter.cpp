@@ -0,0 +1,241 @@
+/*
+ * Emitter mode: checks the per-device location estimate on simulated
+ * drive-bys past an emitter at a known position.
+ *
+ *   program emitter
+ *
+ * A car passes on straight roads at 15 m/s. Like the firmware, it records
+ * a sighting at most every 2 s (the detection cooldown), and only while the
+ * signal is above -95 dBm. RSSI follows a log-distance model (-40 dBm at 1 m,
+ * exponent 2.5) with 5 dB shadowing. Positions have 3 m of GPS noise.
+ * Sightings go through LocationHistory and EmitterEstimate exactly as
+ * DataManager feeds them.
+ *
+ * Each scenario runs 500 times with different noise and timing. It reports
+ * the estimate's mean and 90th percentile error and how often the emitter
+ * is inside the reported radius. For comparison it also reports the
+ * plain mean of the sightings and the strongest sighting. Last, it checks
+ * that a restore()d estimate continues like the original.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "location/emitter_estimate.h"
+#include "location/location_history.h"
+#include "check.h"
+#include "host.h"
+
+#define EMITTER_ORIGIN_LAT 41090800     // Microdegrees
+#define EMITTER_ORIGIN_LON -81557500
+#define EMITTER_TRIALS 500
+#define EMITTER_SPEED 15.0              // m/s
+#define EMITTER_COOLDOWN 2.0            // s between recorded sightings
+#define EMITTER_SENSITIVITY -95.0       // dBm
+#define EMITTER_TX_POWER -40.0          // dBm at 1 m
+#define EMITTER_MODEL_EXPONENT 2.5
+#define EMITTER_SHADOWING 5.0           // dB
+#define EMITTER_GPS_NOISE 3.0           // m
+#define EMITTER_ROAD_LENGTH 600.0       // m each side of the closest approach
+
+// A straight road: closest approach `offset` m from the emitter, heading `bearing`
+struct Road {
+    double offset;
+    double bearing;                     // Degrees, 0 = north
+};
+
+struct Scenario {
+    const char* name;
+    Road roads[2];
+    uint8_t roadCount;
+    uint8_t passes;                     // Per road, alternating direction
+};
+
+struct Sighting {
+    double north;                       // m from the emitter
+    double east;
+    int8_t rssi;
+};
+
+static int32_t toLat(double north) {
+    return EMITTER_ORIGIN_LAT + (int32_t)lround(north / 0.111195);
+}
+
+static int32_t toLon(double east) {
+    return EMITTER_ORIGIN_LON + (int32_t)lround(east / (0.111195 * cos(EMITTER_ORIGIN_LAT * 1e-6 * M_PI / 180)));
+}
+
+static double errorMeters(double north, double east) {
+    return sqrt(north * north + east * east);
+}
+
+static void drivePass(const Road& road, bool reverse, std::mt19937& rng, std::vector<Sighting>& out) {
+    std::normal_distribution<double> shadowing(0, EMITTER_SHADOWING);
+    std::normal_distribution<double> gps(0, EMITTER_GPS_NOISE);
+    std::uniform_real_distribution<double> phase(0, EMITTER_COOLDOWN);
+
+    double heading = road.bearing * M_PI / 180;
+    double dirNorth = cos(heading) * (reverse ? -1 : 1);
+    double dirEast = sin(heading) * (reverse ? -1 : 1);
+    // Closest point: perpendicular to the road, to the right of the heading
+    double closestNorth = -sin(heading) * road.offset;
+    double closestEast = cos(heading) * road.offset;
+
+    double last = -1e9;
+    for (double s = -EMITTER_ROAD_LENGTH + phase(rng); s <= EMITTER_ROAD_LENGTH; s += 0.1 * EMITTER_SPEED) {
+        double north = closestNorth + dirNorth * s;
+        double east = closestEast + dirEast * s;
+        double distance = std::max(1.0, errorMeters(north, east));
+        double rssi = EMITTER_TX_POWER - 10 * EMITTER_MODEL_EXPONENT * log10(distance) + shadowing(rng);
+        double t = s / EMITTER_SPEED;
+        if (rssi < EMITTER_SENSITIVITY || t - last < EMITTER_COOLDOWN) continue;
+        last = t;
+        out.push_back({north + gps(rng), east + gps(rng), (int8_t)lround(std::max(-127.0, rssi))});
+    }
+}
+
+struct ScenarioResult {
+    std::vector<double> estimate;
+    std::vector<double> mean;
+    std::vector<double> strongest;
+    uint32_t covered = 0;
+    uint32_t located = 0;
+    double sightings = 0;
+    double radius = 0;
+};
+
+static double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(p * (values.size() - 1))];
+}
+
+static double average(const std::vector<double>& values) {
+    double sum = 0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+static ScenarioResult runScenario(const Scenario& scenario, uint32_t seed) {
+    std::mt19937 rng(seed);
+    LocationHistory history;
+    history.init(1);
+    ScenarioResult result;
+
+    for (uint32_t trial = 0; trial < EMITTER_TRIALS; trial++) {
+        std::vector<Sighting> sightings;
+        for (uint8_t r = 0; r < scenario.roadCount; r++) {
+            for (uint8_t p = 0; p < scenario.passes; p++) {
+                drivePass(scenario.roads[r], p & 1, rng, sightings);
+            }
+        }
+        if (sightings.empty()) continue;
+
+        // As DataManager::recordDetection does
+        uint16_t id = LOCATION_NONE;
+        double sumNorth = 0, sumEast = 0;
+        const Sighting* strongest = &sightings[0];
+        for (const Sighting& s : sightings) {
+            int32_t lat = toLat(s.north);
+            int32_t lon = toLon(s.east);
+            history.add(&id, lat, lon);
+            if (EmitterEstimate* estimate = history.estimate(id)) estimate->add(lat, lon, s.rssi);
+            sumNorth += s.north;
+            sumEast += s.east;
+            if (s.rssi > strongest->rssi) strongest = &s;
+        }
+
+        int32_t lat, lon;
+        float radius;
+        if (!history.estimate(id)->get(&lat, &lon, &radius)) continue;
+        double north = (lat - EMITTER_ORIGIN_LAT) * 0.111195;
+        double east = (lon - EMITTER_ORIGIN_LON) * 0.111195 * cos(EMITTER_ORIGIN_LAT * 1e-6 * M_PI / 180);
+        double error = errorMeters(north, east);
+
+        result.estimate.push_back(error);
+        result.mean.push_back(errorMeters(sumNorth / sightings.size(), sumEast / sightings.size()));
+        result.strongest.push_back(errorMeters(strongest->north, strongest->east));
+        if (error <= radius) result.covered++;
+        result.located++;
+        result.sightings += sightings.size();
+        result.radius += radius;
+        history.release(id);
+    }
+
+    result.sightings /= result.located;
+    result.radius /= result.located;
+    printf("[Emitter] %-24s %5.1f sightings  estimate %5.1f m (p90 %5.1f)  radius %5.1f m covers %3.0f%%"
+           "  mean %5.1f m  strongest %5.1f m\n",
+           scenario.name, result.sightings, average(result.estimate), percentile(result.estimate, 0.9),
+           result.radius, 100.0 * result.covered / result.located, average(result.mean),
+           average(result.strongest));
+    return result;
+}
+
+static void checkScenarios() {
+    static const Scenario scenarios[] = {
+        {"1 pass, 10 m off road", {{10, 90}}, 1, 1},
+        {"1 pass, 40 m off road", {{40, 90}}, 1, 1},
+        {"6 passes, 25 m", {{25, 90}}, 1, 6},
+        {"crossing roads, 3 each", {{25, 90}, {30, 0}}, 2, 3},
+    };
+
+    for (uint32_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        ScenarioResult r = runScenario(scenarios[i], 1000 + i);
+        expect(r.located == EMITTER_TRIALS, "every trial locates the emitter");
+        expect(average(r.estimate) < average(r.mean), "estimate beats the plain mean of the sightings");
+        expect(r.covered >= r.located * 9 / 10, "radius covers the emitter in 90% of trials");
+    }
+}
+
+// ============================================================================
+// RESTORE
+// ============================================================================
+
+static void checkRestore() {
+    std::mt19937 rng(7);
+    std::vector<Sighting> sightings;
+    Road road = {20, 45};
+    for (int p = 0; p < 4; p++) drivePass(road, p & 1, rng, sightings);
+
+    EmitterEstimate original;
+    original.clear();
+    size_t half = sightings.size() / 2;
+    for (size_t i = 0; i < half; i++) {
+        original.add(toLat(sightings[i].north), toLon(sightings[i].east), sightings[i].rssi);
+    }
+
+    // What a reboot keeps: centroid, total weight, spread
+    int32_t lat, lon;
+    float radius;
+    original.get(&lat, &lon, &radius);
+    EmitterEstimate restored;
+    restored.restore(lat, lon, original.weight, original.spread());
+
+    int32_t rLat, rLon;
+    float rRadius;
+    restored.get(&rLat, &rLon, &rRadius);
+    expect(rLat == lat && rLon == lon && fabsf(rRadius - radius) < 0.1f, "restore keeps the estimate");
+
+    for (size_t i = half; i < sightings.size(); i++) {
+        original.add(toLat(sightings[i].north), toLon(sightings[i].east), sightings[i].rssi);
+        restored.add(toLat(sightings[i].north), toLon(sightings[i].east), sightings[i].rssi);
+    }
+    original.get(&lat, &lon, &radius);
+    restored.get(&rLat, &rLon, &rRadius);
+    expect(abs(rLat - lat) <= 2 && abs(rLon - lon) <= 2 && fabsf(rRadius - radius) < 0.5f,
+           "restored estimate continues like the original");
+
+    EmitterEstimate empty;
+    empty.clear();
+    expect(!empty.get(&lat, &lon, &radius), "no sightings, no estimate");
+}
+
+int runEmitter(int, char**) {
+    checkBegin("Emitter");
+    checkScenarios();
+    checkRestore();
+
+    return checkEnd();
+}
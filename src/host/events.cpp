@@ -0,0 +1,369 @@
+/*
+ * Events mode: golden output checks for the detection event writer.
+ *
+ *   program events
+ *
+ * A fixed WiFi, BLE and Raven event are written in both encodings and
+ * compared byte for byte with the lines and frames below. The WiFi SSID
+ * carries quotes, a backslash and control characters; the BLE name a DEL
+ * (passed through) and a control character (escaped as \u001f). Checks:
+ *   - JSON lines and binary frames match the golden outputs
+ *   - each binary frame has the sync bytes, the event kind, a payload
+ *     length matching the frame and a CRC-16/CCITT-FALSE computed here
+ *   - every capacity short of the full size returns 0 and writes nothing
+ *     past the capacity; the exact size succeeds
+ *   - a string longer than 255 bytes is cut to 255 in the binary frame and
+ *     kept whole in the JSON line
+ *   - nothing is allocated: operator new and malloc/calloc/realloc are
+ *     counted around writeDetectionEvent and around DetectionPipeline
+ *     detections (match, cooldown, emitEvent) in both encodings
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include "detection/detection_pipeline.h"
+#include "detection/event_writer.h"
+#include "detection/uuid_matcher.h"
+#include "hal/native_hal.h"
+#include "check.h"
+#include "host.h"
+
+// ============================================================================
+// ALLOCATION COUNTING
+// ============================================================================
+
+// Replaces the global allocators for the whole host program; only counts
+// while `counting` is set
+static bool counting = false;
+static uint32_t allocations = 0;
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+extern "C" void* malloc(size_t size) {
+    if (counting) allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    if (counting) allocations++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (counting) allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+static void* rawAlloc(size_t size) { return __libc_malloc(size); }
+static void rawFree(void* ptr) { __libc_free(ptr); }
+#else
+static void* rawAlloc(size_t size) { return malloc(size); }
+static void rawFree(void* ptr) { free(ptr); }
+#endif
+
+void* operator new(size_t size) {
+    if (counting) allocations++;
+    void* ptr = rawAlloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    rawFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    rawFree(ptr);
+}
+
+// ============================================================================
+// FIXED EVENTS
+// ============================================================================
+
+static const DetectionSummary summary = {12, -81, -52, -60, 4870};
+
+static DetectionEvent wifiEvent() {
+    DetectionEvent e;
+    e.kind = EVENT_WIFI;
+    e.timestamp = 123456;
+    e.method = "ssid_pattern";
+    e.mac = "58:8e:81:0a:bc:de";
+    e.rssi = -67;
+    e.ssid = "Flock \"cam\"\\1\n\t\x01\r\b\f";
+    e.channel = 6;
+    e.matchedPattern = "flock";
+    e.summary = &summary;
+    e.gpsValid = true;
+    e.latitude = 37.7749;
+    e.longitude = -122.419416;
+    e.altitude = 16.5;
+    e.satellites = 9;
+    return e;
+}
+
+static DetectionEvent bleEvent() {
+    DetectionEvent e;
+    e.kind = EVENT_BLE;
+    e.timestamp = 5;
+    e.method = "ble_name";
+    e.mac = "ec:1b:bd:00:00:01";
+    e.rssi = -90;
+    e.name = "Penguin\x7f\x1f";
+    e.gpsStatus = "NO_FIX";
+    return e;
+}
+
+static DetectionEvent ravenEvent() {
+    DetectionEvent e;
+    e.kind = EVENT_RAVEN;
+    e.timestamp = 4000000000u;
+    e.method = "raven_service_uuid";
+    e.mac = "d8:f3:bc:11:22:33";
+    e.rssi = -45;
+    e.name = "";                        // Omitted
+    e.ravenServiceUuid = "00003100-0000-1000-8000-00805f9b34fb";
+    e.ravenServiceDescription = "GPS Location";
+    e.ravenFirmwareVersion = "1.3.x";
+    e.gpsValid = true;
+    e.latitude = -33.8688;
+    e.longitude = 151.2093;
+    e.altitude = -2;
+    e.satellites = 4;
+    e.serviceUuids[0] = "0000180a-0000-1000-8000-00805f9b34fb";
+    e.serviceUuids[1] = "00003100-0000-1000-8000-00805f9b34fb";
+    e.serviceUuidCount = 2;
+    e.hasServiceUuids = true;
+    return e;
+}
+
+// ============================================================================
+// GOLDEN OUTPUTS
+// ============================================================================
+
+static const char* WIFI_JSON =
+    "{\"timestamp\":123456,\"detection_time\":\"123.456s\",\"protocol\":\"wifi\","
+    "\"detection_method\":\"ssid_pattern\",\"alert_level\":\"HIGH\",\"device_category\":\"FLOCK_SAFETY\","
+    "\"ssid\":\"Flock \\\"cam\\\"\\\\1\\n\\t\\u0001\\r\\b\\f\",\"rssi\":-67,\"channel\":6,"
+    "\"matched_pattern\":\"flock\",\"cooldown_summary\":{\"sightings\":12,\"rssi_min\":-81,"
+    "\"rssi_max\":-52,\"rssi_last\":-60,\"duration_ms\":4870},\"mac_address\":\"58:8e:81:0a:bc:de\","
+    "\"gps_latitude\":37.7749,\"gps_longitude\":-122.419416,\"gps_altitude\":16.5,\"gps_satellites\":9}";
+
+static const char* WIFI_BINARY =
+    "f10c01b000010340e20100020340e201000301047769666904010c737369645f7061747465726e05"
+    "01044849474806010c464c4f434b5f534146455459090113466c6f636b202263616d225c310a0901"
+    "0d080c0b02bdffffff0c03060000000e0105666c6f636b0f051c030c0000001d02afffffff1e02cc"
+    "ffffff1f02c4ffffff20030613000000070a011135383a38653a38313a30613a62633a6465170434"
+    "66400218042807b4f8190420c5fb001a02090000009fd9";
+
+static const char* BLE_JSON =
+    "{\"timestamp\":5,\"detection_time\":\"0.005s\",\"protocol\":\"bluetooth_le\","
+    "\"detection_method\":\"ble_name\",\"alert_level\":\"HIGH\",\"device_category\":\"FLOCK_SAFETY\","
+    "\"mac_address\":\"ec:1b:bd:00:00:01\",\"rssi\":-90,\"device_name\":\"Penguin\x7f" "\\u001f\","
+    "\"gps_status\":\"NO_FIX\"}";
+
+static const char* BLE_BINARY =
+    "f10c026b0001030500000002030500000003010c626c7565746f6f74685f6c65040108626c655f6e"
+    "616d650501044849474806010c464c4f434b5f5341464554590a011165633a31623a62643a30303a"
+    "30303a30310b02a6ffffff0d010950656e6775696e7f1f1b01064e4f5f4649587556";
+
+static const char* RAVEN_JSON =
+    "{\"timestamp\":4000000000,\"detection_time\":\"4000000.000s\",\"protocol\":\"bluetooth_le\","
+    "\"detection_method\":\"raven_service_uuid\",\"device_type\":\"RAVEN_GUNSHOT_DETECTOR\","
+    "\"manufacturer\":\"SoundThinking/ShotSpotter\",\"mac_address\":\"d8:f3:bc:11:22:33\",\"rssi\":-45,"
+    "\"gps_latitude\":-33.8688,\"gps_longitude\":151.2093,\"gps_altitude\":-2,\"gps_satellites\":4,"
+    "\"raven_service_uuid\":\"00003100-0000-1000-8000-00805f9b34fb\","
+    "\"raven_service_description\":\"GPS Location\",\"raven_firmware_version\":\"1.3.x\","
+    "\"threat_level\":\"CRITICAL\",\"threat_score\":100,"
+    "\"service_uuids\":[\"0000180a-0000-1000-8000-00805f9b34fb\",\"00003100-0000-1000-8000-00805f9b34fb\"]}";
+
+static const char* RAVEN_BINARY =
+    "f10c033801010300286bee020300286bee03010c626c7565746f6f74685f6c65040112726176656e"
+    "5f736572766963655f75756964070116524156454e5f47554e53484f545f4445544543544f520801"
+    "19536f756e645468696e6b696e672f53686f7453706f747465720a011164383a66333a62633a3131"
+    "3a32323a33330b02d3ffffff17040034fbfd1804544503091904807be1ff1a020400000011012430"
+    "303030333130302d303030302d313030302d383030302d30303830356639623334666212010c4750"
+    "53204c6f636174696f6e130105312e332e78140108435249544943414c1502640000001606160124"
+    "30303030313830612d303030302d313030302d383030302d30303830356639623334666216012430"
+    "303030333130302d303030302d313030302d383030302d303038303566396233346662000731bd";
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+static std::string toHex(const uint8_t* data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < len; i++) {
+        hex += digits[data[i] >> 4];
+        hex += digits[data[i] & 0x0F];
+    }
+    return hex;
+}
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection, no xorout)
+static uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            bool top = ((crc >> 15) ^ (data[i] >> bit)) & 1;
+            crc = (uint16_t)(crc << 1) ^ (top ? 0x1021 : 0);
+        }
+    }
+    return crc;
+}
+
+static bool validFrame(const uint8_t* frame, size_t len, EventKind kind) {
+    if (len < 7 || frame[0] != 0xF1 || frame[1] != 0x0C || frame[2] != kind) return false;
+    size_t payload = frame[3] | (frame[4] << 8);
+    uint16_t crc = frame[len - 2] | (frame[len - 1] << 8);
+    return payload == len - 7 && crc == crc16(frame + 2, len - 4);
+}
+
+// Every capacity short of the full size must fail without writing past it
+static bool checkCapacities(const DetectionEvent& event, EventEncoding encoding, const uint8_t* full, size_t len) {
+    uint8_t buffer[EVENT_BUFFER_SIZE + 1];
+    for (size_t capacity = 0; capacity < len; capacity++) {
+        memset(buffer, 0xA5, sizeof(buffer));
+        if (writeDetectionEvent(event, encoding, buffer, capacity) != 0) return false;
+        for (size_t i = capacity; i < sizeof(buffer); i++) {
+            if (buffer[i] != 0xA5) return false;
+        }
+    }
+    memset(buffer, 0xA5, sizeof(buffer));
+    return writeDetectionEvent(event, encoding, buffer, len) == len &&
+           memcmp(buffer, full, len) == 0 && buffer[len] == 0xA5;
+}
+
+static void checkGolden(const char* label, const DetectionEvent& event, const char* json, const char* binary) {
+    uint8_t buffer[EVENT_BUFFER_SIZE];
+    char what[96];
+
+    size_t len = writeDetectionEvent(event, EVENT_ENCODING_JSON, buffer, sizeof(buffer));
+    bool same = len == strlen(json) && memcmp(buffer, json, len) == 0;
+    if (!same) printf("[Events] %s JSON: %.*s\n", label, (int)len, buffer);
+    snprintf(what, sizeof(what), "%s JSON matches the golden line", label);
+    expect(same, what);
+    snprintf(what, sizeof(what), "%s JSON fails cleanly below %u bytes", label, (unsigned)len);
+    expect(checkCapacities(event, EVENT_ENCODING_JSON, buffer, len), what);
+    size_t jsonLen = len;
+
+    len = writeDetectionEvent(event, EVENT_ENCODING_BINARY, buffer, sizeof(buffer));
+    std::string hex = toHex(buffer, len);
+    if (hex != binary) printf("[Events] %s binary: %s\n", label, hex.c_str());
+    snprintf(what, sizeof(what), "%s binary matches the golden frame", label);
+    expect(hex == binary, what);
+    snprintf(what, sizeof(what), "%s binary frame header, length and CRC", label);
+    expect(validFrame(buffer, len, event.kind), what);
+    snprintf(what, sizeof(what), "%s binary fails cleanly below %u bytes", label, (unsigned)len);
+    expect(checkCapacities(event, EVENT_ENCODING_BINARY, buffer, len), what);
+
+    printf("[Events] %-5s %3u-byte JSON line, %3u-byte frame\n", label, (unsigned)jsonLen, (unsigned)len);
+}
+
+static void checkLongName() {
+    std::string name(300, 'n');
+    DetectionEvent event = bleEvent();
+    event.name = name.c_str();
+    uint8_t buffer[EVENT_BUFFER_SIZE];
+
+    size_t len = writeDetectionEvent(event, EVENT_ENCODING_BINARY, buffer, sizeof(buffer));
+    const uint8_t field[] = {0x0d, 0x01, 0xff};    // device_name, string, 255 bytes
+    uint8_t* at = len ? (uint8_t*)memmem(buffer, len, field, sizeof(field)) : nullptr;
+    expect(validFrame(buffer, len, EVENT_BLE) && at && at + sizeof(field) + 255 < buffer + len &&
+           at[sizeof(field) + 255] != 'n', "long name cut to 255 bytes in the frame");
+
+    len = writeDetectionEvent(event, EVENT_ENCODING_JSON, buffer, sizeof(buffer));
+    std::string line((const char*)buffer, len);
+    expect(line.find("\"device_name\":\"" + name + "\"") != std::string::npos, "long name whole in the JSON line");
+}
+
+// Serializing and emitting a detection must not touch the heap
+static void checkNoAllocations() {
+    // The hooks themselves must see an allocation
+    counting = true;
+    allocations = 0;
+    delete new std::string(64, 'x');
+#ifdef __GLIBC__
+    free(malloc(16));
+#endif
+    counting = false;
+    expect(allocations >= 2, "allocation hooks count");
+
+    uint8_t buffer[EVENT_BUFFER_SIZE];
+    DetectionEvent events[] = {wifiEvent(), bleEvent(), ravenEvent()};
+
+    counting = true;
+    allocations = 0;
+    size_t written = 0;
+    for (const DetectionEvent& event : events) {
+        written += writeDetectionEvent(event, EVENT_ENCODING_JSON, buffer, sizeof(buffer));
+        written += writeDetectionEvent(event, EVENT_ENCODING_BINARY, buffer, sizeof(buffer));
+        written += writeDetectionEvent(event, EVENT_ENCODING_JSON, buffer, 10);   // Overflow path
+    }
+    counting = false;
+    printf("[Events] writeDetectionEvent: %u allocations for 9 calls\n", (unsigned)allocations);
+    expect(written > 0 && allocations == 0, "writeDetectionEvent allocates nothing");
+
+    // The pipeline with only an event sink: match, cooldown, emitEvent
+    static DetectionPipeline pipeline;
+    StreamEventSink sink;
+    HalContext hal = {nullptr, nullptr, nullptr, &sink};
+    const uint8_t wifiMac[6] = {0x02, 0x00, 0x00, 0x10, 0x20, 0x30};
+    const uint8_t ravenMac[6] = {0x02, 0x00, 0x00, 0x40, 0x50, 0x60};
+
+    WiFiFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    memcpy(frame.mac, wifiMac, 6);
+    frame.frame_type = 0x80;
+    frame.channel = 6;
+    frame.rssi = -60;
+    snprintf(frame.ssid, sizeof(frame.ssid), "Flock \"cam\" 1");
+    frame.ssid_len = strlen(frame.ssid);
+
+    BleAdvert advert;
+    memset(&advert, 0, sizeof(advert));
+    memcpy(advert.mac, ravenMac, 6);
+    advert.rssi = -70;
+    snprintf(advert.name, sizeof(advert.name), "Penguin-1");
+    UUIDMatcher::parse("00003100-0000-1000-8000-00805f9b34fb", advert.uuids[0]);
+    advert.uuid_count = 1;
+
+    uint32_t emitted = 0;
+    for (int binary = 0; binary < 2; binary++) {
+        PipelineConfig config;
+        config.binaryEvents = binary;
+        pipeline.begin(hal, config);
+        frame.timestamp = advert.timestamp = 1000 + binary * 100000;
+
+        counting = true;
+        allocations = 0;
+        emitted += pipeline.processWiFi(frame);
+        emitted += pipeline.processBle(advert);
+        counting = false;
+        printf("[Events] Pipeline, %s events: %u allocations\n", binary ? "binary" : "JSON",
+               (unsigned)allocations);
+        expect(allocations == 0, "DetectionPipeline emits events without allocating");
+    }
+    expect(emitted == 4 && sink.getEvents() == 4, "pipeline emitted every detection");
+}
+
+int runEvents(int, char**) {
+    checkBegin("Events");
+    // Check value from the CRC catalogue, so the frames are not just checked against themselves
+    expect(crc16((const uint8_t*)"123456789", 9) == 0x29B1, "CRC-16/CCITT-FALSE check value");
+
+    checkGolden("WiFi", wifiEvent(), WIFI_JSON, WIFI_BINARY);
+    checkGolden("BLE", bleEvent(), BLE_JSON, BLE_BINARY);
+    checkGolden("Raven", ravenEvent(), RAVEN_JSON, RAVEN_BINARY);
+    checkLongName();
+    checkNoAllocations();
+
+    return checkEnd();
+}
@@ -0,0 +1,286 @@
+/*
+ * Gps mode: checks the firmware's NMEA and UBX parsers and the fix snapshot
+ * against known input, or feeds a recorded receiver log through them.
+ *
+ *   program gps [LOG]
+ *
+ * Without a log: RMC/GGA from several talkers and hemispheres, filtered
+ * sentence types, bad checksums, split and noisy input, NAV-PVT and
+ * ACK/NAK frames built with the same encoder the firmware sends with, and a
+ * two-thread snapshot check (every copy a reader gets must be one whole
+ * published fix).
+ *
+ * With a log (raw bytes as the UART delivers them, NMEA or UBX): prints the
+ * counts and the last fix.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "location/gps_snapshot.h"
+#include "location/nmea_parser.h"
+#include "location/ubx_parser.h"
+#include "check.h"
+#include "host.h"
+
+static bool near(double a, double b, double tolerance) {
+    return fabs(a - b) <= tolerance;
+}
+
+// Returns how many fixes the text produced
+static int feedNmea(NmeaParser& parser, const char* text) {
+    int updates = 0;
+    for (const char* p = text; *p; p++) {
+        if (parser.encode(*p)) updates++;
+    }
+    return updates;
+}
+
+static UbxMessage feedUbx(UbxParser& parser, const uint8_t* bytes, size_t len) {
+    UbxMessage last = UBX_NONE;
+    for (size_t i = 0; i < len; i++) {
+        UbxMessage message = parser.encode(bytes[i]);
+        if (message != UBX_NONE) last = message;
+    }
+    return last;
+}
+
+// ============================================================================
+// NMEA
+// ============================================================================
+
+static void checkNmea() {
+    NmeaParser parser;
+    expect(feedNmea(parser,
+                    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+                    "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n"
+                    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n") == 2,
+           "GGA and RMC applied, GSV skipped");
+    const GpsFix& fix = parser.getFix();
+    expect(fix.valid && strcmp(fix.status, "FIX") == 0, "RMC 'A' is a fix");
+    expect(near(fix.latitude, 48.1173, 1e-6) && near(fix.longitude, 11.516667, 1e-6), "position");
+    expect(near(fix.altitude, 545.4, 1e-6) && fix.satellites == 8, "GGA altitude and satellites");
+    expect(fix.hasCourse && near(fix.speedKmh, 22.4 * 1.852, 1e-3) && near(fix.course, 84.4, 1e-3),
+           "RMC speed and course");
+    expect(fix.hasTime && fix.year == 2094 && fix.month == 3 && fix.day == 23 &&
+           fix.hour == 12 && fix.minute == 35 && fix.second == 19,
+           "RMC date and time (two-digit year taken as 20yy)");
+    expect(parser.getSkipped() == 1, "one sentence skipped by type");
+
+    // Multi-constellation talker, southern/western hemisphere, empty course
+    expect(feedNmea(parser,
+                    "$GNGGA,083559.00,3351.8231,S,15112.6012,W,1,11,0.9,22.0,M,20.0,M,,*4B\r\n"
+                    "$GNRMC,083559.00,A,3351.8231,S,15112.6012,W,0.004,,171026,,,A*6B\r\n") == 2,
+           "GN talker accepted");
+    expect(near(fix.latitude, -33.863718, 1e-6) && near(fix.longitude, -151.21002, 1e-6),
+           "S/W hemispheres are negative");
+    expect(!fix.hasCourse, "empty course field means no course");
+    expect(fix.satellites == 11 && fix.year == 2026 && fix.day == 17, "satellites and date");
+
+    // Checksum and framing errors change nothing
+    uint32_t errors = parser.getChecksumErrors();
+    expect(feedNmea(parser, "$GNRMC,083600.00,A,0000.0000,N,00000.0000,E,0.0,,171026,,,A*00\r\n") == 0,
+           "bad checksum rejected");
+    expect(feedNmea(parser, "$GNRMC,083600.00,A,0000.0000,N,00000.0000,E\r\n") == 0,
+           "missing checksum rejected");
+    expect(parser.getChecksumErrors() == errors + 2, "checksum errors counted");
+    expect(near(fix.latitude, -33.863718, 1e-6), "fix kept after rejected sentences");
+
+    // Fix lost
+    expect(feedNmea(parser,
+                    "$GNRMC,083600.00,V,,,,,,,171026,,,N*6D\r\n"
+                    "$GNGGA,083600.00,,,,,0,03,99.9,,,,,,*4F\r\n") == 2,
+           "void sentences applied");
+    expect(!fix.valid && fix.satellites == 3 && strcmp(fix.status, "SEARCHING") == 0,
+           "no fix while searching");
+
+    // Noise, a truncated sentence and a new '$' mid-line resynchronise
+    NmeaParser noisy;
+    expect(feedNmea(noisy,
+                    "\xb5\x62garbage$GPRMC,1235"
+                    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\n") == 1,
+           "resynchronises on '$'");
+    expect(noisy.getFix().valid, "fix after noise");
+
+    char line[96];
+    nmeaFormat(line, sizeof(line), "PUBX,40,GSV,0,0,0,0,0,0");
+    expect(strcmp(line, "$PUBX,40,GSV,0,0,0,0,0,0*59\r\n") == 0, "PUBX command checksum");
+}
+
+// ============================================================================
+// UBX
+// ============================================================================
+
+static void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = v >> (i * 8);
+}
+
+static size_t makePvt(uint8_t* out, int32_t lat, int32_t lon, uint8_t fixType, uint8_t satellites) {
+    uint8_t pvt[UBX_NAV_PVT_LENGTH] = {0};
+    pvt[4] = 2026 & 0xFF;
+    pvt[5] = 2026 >> 8;
+    pvt[6] = 10;
+    pvt[7] = 17;
+    pvt[8] = 8;
+    pvt[9] = 36;
+    pvt[10] = 5;
+    pvt[11] = 0x07;                     // validDate, validTime, fullyResolved
+    pvt[20] = fixType;
+    pvt[21] = fixType ? 0x01 : 0x00;    // gnssFixOK
+    pvt[23] = satellites;
+    putU32(pvt + 24, lon);
+    putU32(pvt + 28, lat);
+    putU32(pvt + 36, 231500);           // hMSL, mm
+    putU32(pvt + 60, 13889);            // gSpeed, mm/s
+    putU32(pvt + 64, 27000000);         // headMot, 1e-5 deg
+    return ubxFrame(UBX_CLASS_NAV, UBX_NAV_PVT, pvt, sizeof(pvt), out);
+}
+
+static void checkUbx() {
+    UbxParser parser;
+    uint8_t frame[UBX_NAV_PVT_LENGTH + UBX_FRAME_OVERHEAD];
+
+    size_t n = makePvt(frame, 410908000, -815575000, 3, 14);
+    expect(n == sizeof(frame), "NAV-PVT frame size");
+    expect(feedUbx(parser, frame, n) == UBX_FIX, "NAV-PVT applied");
+    const GpsFix& fix = parser.getFix();
+    expect(fix.valid && near(fix.latitude, 41.0908, 1e-7) && near(fix.longitude, -81.5575, 1e-7),
+           "PVT position");
+    expect(fix.satellites == 14 && near(fix.altitude, 231.5, 1e-6), "PVT satellites and altitude");
+    expect(fix.hasCourse && near(fix.speedKmh, 50.0, 0.01) && near(fix.course, 270.0, 1e-6),
+           "PVT speed and heading");
+    expect(fix.hasTime && fix.year == 2026 && fix.month == 10 && fix.hour == 8 && fix.second == 5,
+           "PVT date and time");
+
+    // Corrupt checksum, then junk and a split frame with a repeated sync byte
+    n = makePvt(frame, 0, 0, 0, 2);
+    frame[n - 1] ^= 0xFF;
+    expect(feedUbx(parser, frame, n) == UBX_NONE && parser.getChecksumErrors() == 1,
+           "bad checksum rejected");
+    expect(fix.valid, "fix kept after a rejected frame");
+
+    const uint8_t junk[] = {'$', 'G', 0xB5, 0xB5};
+    feedUbx(parser, junk, sizeof(junk));
+    n = makePvt(frame, 0, 0, 0, 2);
+    expect(feedUbx(parser, frame + 1, n - 1) == UBX_FIX, "resynchronises on a repeated sync byte");
+    expect(!fix.valid && strcmp(fix.status, "SEARCHING") == 0, "no-fix PVT");
+
+    // A corrupt length must not swallow what follows
+    const uint8_t badLength[] = {UBX_SYNC_1, UBX_SYNC_2, 0x01, 0x07, 0xFF, 0xFF};
+    feedUbx(parser, badLength, sizeof(badLength));
+    n = makePvt(frame, 410908000, -815575000, 3, 9);
+    expect(feedUbx(parser, frame, n) == UBX_FIX && fix.valid, "recovers after a corrupt length");
+
+    // Replies to configuration
+    uint8_t payload[2] = {UBX_CLASS_CFG, UBX_CFG_MSG};
+    uint8_t reply[2 + UBX_FRAME_OVERHEAD];
+    n = ubxFrame(UBX_CLASS_ACK, UBX_ACK_ACK, payload, 2, reply);
+    expect(feedUbx(parser, reply, n) == UBX_ACK && parser.getAckClass() == UBX_CLASS_CFG &&
+           parser.getAckId() == UBX_CFG_MSG, "ACK-ACK");
+    payload[1] = UBX_CFG_RATE;
+    n = ubxFrame(UBX_CLASS_ACK, UBX_ACK_NAK, payload, 2, reply);
+    expect(feedUbx(parser, reply, n) == UBX_NAK && parser.getAckId() == UBX_CFG_RATE, "ACK-NAK");
+
+    // CFG-MSG enabling NAV-PVT, as documented by u-blox
+    uint8_t cfg[UBX_CFG_MSG_LENGTH];
+    uint8_t out[UBX_CFG_MSG_LENGTH + UBX_FRAME_OVERHEAD];
+    ubxCfgMsg(cfg, UBX_CLASS_NAV, UBX_NAV_PVT, 1);
+    ubxFrame(UBX_CLASS_CFG, UBX_CFG_MSG, cfg, sizeof(cfg), out);
+    const uint8_t expected[] = {0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x01, 0x13, 0x51};
+    expect(memcmp(out, expected, sizeof(expected)) == 0, "CFG-MSG frame bytes");
+}
+
+// ============================================================================
+// SNAPSHOT
+// ============================================================================
+
+// Fields that must always agree within one published fix
+static bool consistent(const GpsFix& fix) {
+    return fix.latitude == fix.longitude && fix.satellites == (int)fix.altitude &&
+           fix.timestamp == (uint32_t)fix.satellites;
+}
+
+static void checkSnapshot() {
+    GpsSnapshot snapshot;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> torn{0};
+    std::atomic<uint32_t> reads{0};
+
+    std::thread reader([&]() {
+        GpsFix fix;
+        while (!done.load()) {
+            snapshot.read(&fix);
+            if (!consistent(fix)) torn++;
+            reads++;
+        }
+    });
+
+    GpsFix fix;
+    const int writes = 200000;
+    for (int i = 1; i <= writes; i++) {
+        fix.latitude = fix.longitude = i;
+        fix.altitude = i;
+        fix.satellites = i;
+        fix.timestamp = i;
+        snapshot.publish(fix);
+    }
+    done = true;
+    reader.join();
+
+    GpsFix last;
+    snapshot.read(&last);
+    printf("[Gps] Snapshot: %d writes, %u concurrent reads, %u torn\n", writes,
+           (unsigned)reads.load(), (unsigned)torn.load());
+    expect(torn.load() == 0, "no torn snapshot reads");
+    expect(last.satellites == writes && snapshot.getVersion() == (uint32_t)writes, "last fix visible");
+}
+
+// ============================================================================
+// LOG REPLAY
+// ============================================================================
+
+static int replayLog(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "[Gps] Cannot open %s\n", path);
+        return 1;
+    }
+
+    NmeaParser nmea;
+    UbxParser ubx;
+    GpsFix last;
+    uint32_t fixes = 0;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (nmea.encode((char)c)) {
+            last = nmea.getFix();
+            fixes++;
+        }
+        if (ubx.encode((uint8_t)c) == UBX_FIX) {
+            last = ubx.getFix();
+            fixes++;
+        }
+    }
+    fclose(file);
+
+    printf("[Gps] NMEA: %u applied, %u skipped, %u bad; UBX: %u frames, %u bad\n",
+           (unsigned)nmea.getSentences(), (unsigned)nmea.getSkipped(),
+           (unsigned)nmea.getChecksumErrors(), (unsigned)ubx.getFrames(),
+           (unsigned)ubx.getChecksumErrors());
+    printf("[Gps] %u fixes, last: %s %.6f,%.6f %d sats\n", (unsigned)fixes, last.status,
+           last.latitude, last.longitude, last.satellites);
+    return 0;
+}
+
+int runGps(int argc, char** argv) {
+    checkBegin("Gps");
+    if (argc > 0) return replayLog(argv[0]);
+
+    checkNmea();
+    checkUbx();
+    checkSnapshot();
+
+    return checkEnd();
+}
@@ -0,0 +1,46 @@
+#ifndef HOST_H
+#define HOST_H
+
+// ============================================================================
+// HOST DRIVER MODES
+// ============================================================================
+//
+//   program                         self-check with sample packets
+//   program replay <pcap>... [opts] replay captures through the pipeline
+//   program bench [opts]            synthetic load, per-stage JSON report
+//   program camindex [opts]         build the SD card camera index
+//   program oled                    bytes each display update puts on I2C
+//   program gps [log]               NMEA/UBX parser checks or log replay
+//   program track                   capture-time positions on synthetic drives
+//   program emitter                 device location estimate on simulated drive-bys
+//   program ring                    FrameRing order, drops, two-thread check
+//   program matchers [opts]         matchers vs the old linear scans and datasets
+//   program table                   DeviceTable checks + benchmark vs std::map
+//   program journal                 DetectionJournal power-loss checks
+//   program sdlog                   SectorBuffer write/sync checks on a recording file
+//   program leds                    LED animation priority/ordering checks
+//   program cache                   DetectionCache cooldown/replacement checks
+//   program events                  event writer golden JSON/binary outputs
+//   program channels [trace]        ChannelScheduler vs the old hopping on a channel trace
+//
+// Patterns are loaded and the matchers built before a mode runs.
+
+int runSelfCheck();
+int runReplay(int argc, char** argv);
+int runBench(int argc, char** argv);
+int runCamIndex(int argc, char** argv);
+int runOled(int argc, char** argv);
+int runGps(int argc, char** argv);
+int runTrack(int argc, char** argv);
+int runEmitter(int argc, char** argv);
+int runRing(int argc, char** argv);
+int runMatchers(int argc, char** argv);
+int runTable(int argc, char** argv);
+int runJournal(int argc, char** argv);
+int runSdlog(int argc, char** argv);
+int runLeds(int argc, char** argv);
+int runCache(int argc, char** argv);
+int runEvents(int argc, char** argv);
+int runChannels(int argc, char** argv);
+
+#endif // HOST_H
@@ -0,0 +1,219 @@
+/*
+ * Flock You - host driver for the [env:native] build
+ *
+ * Runs the detection pipeline on Linux against the native HAL:
+ *   pio run -e native && .pio/build/native/program
+ *   .pio/build/native/program replay cap0001_wifi.pcap cap0001_ble.pcap
+ *   .pio/build/native/program bench --datasets datasets > bench.json
+ *   .pio/build/native/program camindex --datasets datasets --out cameras.idx
+ *   .pio/build/native/program oled
+ *   .pio/build/native/program gps
+ *   .pio/build/native/program track
+ *   .pio/build/native/program emitter
+ *   .pio/build/native/program ring
+ *   .pio/build/native/program matchers --datasets datasets
+ *   .pio/build/native/program table
+ *   .pio/build/native/program journal
+ *   .pio/build/native/program sdlog
+ *   .pio/build/native/program leds
+ *   .pio/build/native/program cache
+ *   .pio/build/native/program events
+ *   .pio/build/native/program channels channel_trace.csv
+ *
+ * Without arguments it checks how raw management frames are classified,
+ * feeds one sample packet per detection method (plus a repeat and a packet
+ * that must not match) and checks what came out. The
+ * other modes live in replay.cpp, bench.cpp, camindex.cpp, oled.cpp,
+ * gps.cpp, track.cpp, emitter.cpp, ring.cpp, matchers.cpp, table.cpp,
+ * journal.cpp, sdlog.cpp, leds.cpp, cache.cpp, events.cpp and channels.cpp.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "config/builtin_patterns.h"
+#include "config/patterns.h"
+#include "detection/detection_pipeline.h"
+#include "detection/frame_parser.h"
+#include "detection/oui_matcher.h"
+#include "detection/pattern_matcher.h"
+#include "detection/uuid_matcher.h"
+#include "hal/native_hal.h"
+#include "check.h"
+#include "host.h"
+
+// ============================================================================
+// SAMPLE PACKETS
+// ============================================================================
+
+static WiFiFrame makeWiFi(const char* ssid, const uint8_t* mac, uint8_t type, uint32_t now) {
+    WiFiFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    memcpy(frame.mac, mac, 6);
+    frame.frame_type = type;
+    frame.channel = 6;
+    frame.rssi = -60;
+    snprintf(frame.ssid, sizeof(frame.ssid), "%s", ssid);
+    frame.ssid_len = strlen(frame.ssid);
+    frame.timestamp = now;
+    return frame;
+}
+
+static BleAdvert makeBle(const char* name, const uint8_t* mac, const char* uuid, uint32_t now) {
+    BleAdvert advert;
+    memset(&advert, 0, sizeof(advert));
+    memcpy(advert.mac, mac, 6);
+    advert.rssi = -70;
+    snprintf(advert.name, sizeof(advert.name), "%s", name);
+    if (uuid && UUIDMatcher::parse(uuid, advert.uuids[0])) {
+        advert.uuid_count = 1;
+    }
+    advert.timestamp = now;
+    return advert;
+}
+
+// ============================================================================
+// SELF-CHECK
+// ============================================================================
+
+// frame_type of a raw management frame with this frame control byte, 0 if rejected
+static uint8_t classify(uint8_t frameControl) {
+    uint8_t raw[24 + 12 + 2] = {0};     // Header, beacon fixed fields, empty SSID element
+    raw[0] = frameControl;
+    WiFiFrame frame;
+    return parseWiFiFrame(raw, sizeof(raw), -60, 6, 0, &frame) ? frame.frame_type : 0;
+}
+
+// Before frame_parser, the sniffer used (frame_ctrl & 0xFF) >> 2: beacons
+// came out as 0x20 ("probe_request") and probe requests as 0x10 (dropped)
+static void checkFrameTypes() {
+    expect(classify(0x40) == 0x20, "probe request classified as probe request");
+    expect(classify(0x80) == 0x80, "beacon classified as beacon");
+    expect(classify(0x50) == 0 && classify(0xB0) == 0 && classify(0x08) == 0,
+           "probe responses, auth and data frames rejected");
+}
+
+int runSelfCheck() {
+    checkBegin("Host");
+    checkFrameTypes();
+
+    FixedLocation location;
+    MemoryDetectionStore store;
+    CountingAlerts alerts;
+    StreamEventSink events(stdout);
+    store.begin(256);
+    location.set(37.7749, -122.4194);
+
+    HalContext hal = {&location, &store, &alerts, &events};
+    PipelineConfig config;
+    detectionPipeline.begin(hal, config);
+    nativeSetTime(1000000);
+
+    const uint8_t flockMac[6] = {0x58, 0x8e, 0x81, 0x12, 0x34, 0x56};
+    const uint8_t otherMac[6] = {0x02, 0x00, 0x00, 0xaa, 0xbb, 0xcc};
+
+    expect(detectionPipeline.processWiFi(makeWiFi("Flock-A1B2C3", otherMac, 0x80, 1000)),
+           "SSID pattern beacon");
+    expect(detectionPipeline.processWiFi(makeWiFi("", flockMac, 0x20, 1000)),
+           "MAC prefix probe request");
+    expect(!detectionPipeline.processWiFi(makeWiFi("", flockMac, 0x20, 1500)),
+           "repeat inside cooldown is suppressed");
+    expect(!detectionPipeline.processWiFi(makeWiFi("HomeNetwork", otherMac, 0x80, 1500)),
+           "unrelated beacon does not match");
+
+    const uint8_t bleMac[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+    const uint8_t ravenMac[6] = {0x02, 0x66, 0x77, 0x88, 0x99, 0xaa};
+    expect(detectionPipeline.processBle(makeBle("Penguin-1234", bleMac, nullptr, 2000)),
+           "BLE device name");
+    expect(detectionPipeline.processBle(makeBle("", ravenMac, RAVEN_GPS_SERVICE, 2000)),
+           "Raven service UUID");
+
+    nativeSetTime(5000000);
+    expect(detectionPipeline.processWiFi(makeWiFi("", flockMac, 0x20, 5000)),
+           "device reported again after cooldown");
+
+    const PipelineStats& wifi = detectionPipeline.getWiFiStats();
+    const PipelineStats& ble = detectionPipeline.getBleStats();
+    printf("[Host] WiFi: %u frames, %u matches, %u emitted, %u suppressed\n",
+           (unsigned)wifi.packets, (unsigned)wifi.matches, (unsigned)wifi.emitted,
+           (unsigned)wifi.suppressed);
+    printf("[Host] BLE: %u adverts, %u matches, %u emitted, %u suppressed\n",
+           (unsigned)ble.packets, (unsigned)ble.matches, (unsigned)ble.emitted,
+           (unsigned)ble.suppressed);
+    printf("[Host] %u events, %u devices stored, %u alerts\n",
+           (unsigned)events.getEvents(), (unsigned)store.getDevices(),
+           (unsigned)alerts.getDetected());
+
+    expect(events.getEvents() == 5, "5 events written");
+    expect(store.getDevices() == 4, "4 devices stored");
+
+    return checkEnd();
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv) {
+    loadBuiltinPatterns();
+    ouiMatcher.build();
+    ssidMatcher.build();
+    nameMatcher.build();
+
+    if (argc > 1 && strcmp(argv[1], "replay") == 0) {
+        return runReplay(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return runBench(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "camindex") == 0) {
+        return runCamIndex(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "oled") == 0) {
+        return runOled(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "gps") == 0) {
+        return runGps(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "track") == 0) {
+        return runTrack(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "emitter") == 0) {
+        return runEmitter(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "ring") == 0) {
+        return runRing(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "matchers") == 0) {
+        return runMatchers(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "table") == 0) {
+        return runTable(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "journal") == 0) {
+        return runJournal(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "sdlog") == 0) {
+        return runSdlog(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "leds") == 0) {
+        return runLeds(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "cache") == 0) {
+        return runCache(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "events") == 0) {
+        return runEvents(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "channels") == 0) {
+        return runChannels(argc - 2, argv + 2);
+    }
+    if (argc > 1) {
+        printf("Usage: %s [replay <capture.pcap>... [--events] [--repeat N] | bench [options] |"
+               " camindex [options] | oled | gps [log] | track | emitter | ring |"
+               " matchers [options] | table | journal | sdlog | leds | cache | events |"
+               " channels [trace]]\n",
+               argv[0]);
+        return 2;
+    }
+    return runSelfCheck();
+}
@@ -0,0 +1,287 @@
+/*
+ * Journal mode: power-loss checks for the DetectionJournal (snapshot plus
+ * append-only journal) on an in-memory filesystem.
+ *
+ *   program journal
+ *
+ * Torn tail: garbage after the last good record is cut off at boot, so
+ * records appended afterwards are replayed; a repair interrupted after any
+ * number of file operations is finished or undone by the next boot.
+ *
+ * Power cuts: 2000 boots of the same filesystem. Each boot replays the
+ * files, then appends random device, location and removal records with
+ * occasional syncs and compactions until power is lost after a random
+ * number of file operations. The cut keeps a random part of every file's
+ * unsynced tail, its last byte sometimes garbled (a torn record); some cuts
+ * land in the middle of the next boot's own repair or recovery. Replay must
+ * give the state after some record appended since the last sync or
+ * compaction (everything committed, plus a prefix of what was in flight),
+ * and exactly the last state after a clean shutdown.
+ */
+
+#include <stdio.h>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "hal/native_hal.h"
+#include "hardware/detection_journal.h"
+#include "check.h"
+#include "host.h"
+
+#define JOURNAL_BOOTS 2000
+#define JOURNAL_DEVICES 40
+
+// What the data manager rebuilds from the records, reduced to what the
+// records carry
+struct Device {
+    uint32_t a, b, c;
+    std::set<std::pair<uint32_t, uint32_t>> locations;
+
+    bool operator==(const Device& other) const {
+        return a == other.a && b == other.b && c == other.c && locations == other.locations;
+    }
+};
+
+typedef std::map<uint64_t, Device> State;
+
+static void applyState(const JournalEntry& entry, void* context) {
+    State& state = *static_cast<State*>(context);
+    switch (entry.kind) {
+        case JOURNAL_DEVICE: {
+            Device& dev = state[entry.mac];
+            dev.a = entry.a;
+            dev.b = entry.b;
+            dev.c = entry.c;
+            break;
+        }
+        case JOURNAL_LOCATION: {
+            auto it = state.find(entry.mac);
+            if (it != state.end()) it->second.locations.insert(std::make_pair(entry.a, entry.b));
+            break;
+        }
+        case JOURNAL_REMOVE:
+            state.erase(entry.mac);
+            break;
+        default:
+            break;
+    }
+}
+
+static JournalEntry randomEntry(std::mt19937& rng, const State& state) {
+    JournalEntry entry = {};
+    entry.mac = 0x588e81000000ULL + rng() % JOURNAL_DEVICES;
+    auto it = state.find(entry.mac);
+    uint32_t roll = rng() % 10;
+
+    if (it != state.end() && roll < 3) {
+        entry.kind = JOURNAL_LOCATION;
+        entry.a = 37000000 + rng() % 1000;
+        entry.b = (uint32_t)-122000000 + rng() % 1000;
+    } else if (it != state.end() && roll < 4) {
+        entry.kind = JOURNAL_REMOVE;
+    } else {
+        entry.kind = JOURNAL_DEVICE;
+        entry.a = it != state.end() ? it->second.a : rng();
+        entry.b = rng();
+        entry.c = it != state.end() ? it->second.c + 1 : 1;
+        entry.rssi = -40 - (int8_t)(rng() % 50);
+        entry.type = rng() % 4;
+    }
+    return entry;
+}
+
+// The whole state as a new snapshot, as DataManager::compactLocked writes it
+static bool compactState(DetectionJournal& journal, const State& state) {
+    if (!journal.beginSnapshot()) return false;
+    for (const auto& dev : state) {
+        JournalEntry entry = {};
+        entry.kind = JOURNAL_DEVICE;
+        entry.mac = dev.first;
+        entry.a = dev.second.a;
+        entry.b = dev.second.b;
+        entry.c = dev.second.c;
+        if (!journal.writeSnapshot(entry)) return false;
+        for (const auto& point : dev.second.locations) {
+            JournalEntry loc = {};
+            loc.kind = JOURNAL_LOCATION;
+            loc.mac = dev.first;
+            loc.a = point.first;
+            loc.b = point.second;
+            if (!journal.writeSnapshot(loc)) return false;
+        }
+    }
+    return journal.commitSnapshot();
+}
+
+static JournalReplayStats boot(DetectionJournal& journal, MemoryFileSystem& fs, State* out) {
+    out->clear();
+    journal.begin(fs);
+    return journal.replay(applyState, out);
+}
+
+// ============================================================================
+// TORN TAIL
+// ============================================================================
+
+// A journal of `records` synced records followed by `garbage` stray bytes
+static void buildTornJournal(MemoryFileSystem& fs, State* model, uint32_t records, uint32_t garbage) {
+    std::mt19937 rng(records);
+    {
+        DetectionJournal journal;
+        State replayed;
+        boot(journal, fs, &replayed);
+        for (uint32_t i = 0; i < records; i++) {
+            JournalEntry entry = randomEntry(rng, *model);
+            journal.append(entry);
+            applyState(entry, model);
+        }
+        journal.sync();
+    }
+
+    FileHandle* file = fs.open("/detections.jrn", FILE_MODE_APPEND);
+    for (uint32_t i = 0; i < garbage; i++) {
+        uint8_t byte = 0xD5 + i;
+        file->write(&byte, 1);
+    }
+    delete file;
+}
+
+static void checkTornTail() {
+    MemoryFileSystem fs;
+    State model;
+    buildTornJournal(fs, &model, 10, 45);
+
+    State replayed;
+    {
+        DetectionJournal journal;
+        JournalReplayStats stats = boot(journal, fs, &replayed);
+        expect(replayed == model && stats.journalRecords == 10, "records before the damage replayed");
+        expect(stats.discardedBytes == 45 && stats.needsCompaction, "damaged tail reported");
+        expect(fs.contents("/detections.jrn")->size() == 10 * JOURNAL_RECORD_SIZE,
+               "journal cut back to the last good record");
+        expect(!fs.exists("/detections.jrn.tmp"), "repair copy swapped in");
+
+        std::mt19937 rng(11);
+        for (int i = 0; i < 5; i++) {
+            JournalEntry entry = randomEntry(rng, model);
+            expect(journal.append(entry), "append after repair");
+            applyState(entry, &model);
+        }
+        journal.sync();
+    }
+    {
+        DetectionJournal journal;
+        JournalReplayStats stats = boot(journal, fs, &replayed);
+        expect(replayed == model && stats.journalRecords == 15 && stats.discardedBytes == 0,
+               "records appended after the repair survive the next boot");
+    }
+
+    // Power lost after every possible number of file operations in the repair
+    uint32_t budgets = 0;
+    for (uint32_t budget = 0; budget < 12; budget++) {
+        MemoryFileSystem cut;
+        State written;
+        buildTornJournal(cut, &written, 20, 7);
+        {
+            DetectionJournal journal;
+            cut.failAfter(budget);
+            boot(journal, cut, &replayed);
+        }
+        bool failed = cut.hasFailed();
+        cut.powerCut(budget);
+        {
+            DetectionJournal journal;
+            boot(journal, cut, &replayed);
+        }
+        DetectionJournal journal;
+        JournalReplayStats stats = boot(journal, cut, &replayed);
+        expect(replayed == written && stats.discardedBytes == 0 && !cut.exists("/detections.jrn.tmp"),
+               "interrupted repair finished or redone on the next boot");
+        if (failed) budgets++;
+    }
+    printf("[Journal] Torn tail: 45 stray bytes cut, repair interrupted at %u points\n", (unsigned)budgets);
+}
+
+// ============================================================================
+// POWER CUTS
+// ============================================================================
+
+static void checkPowerCuts() {
+    std::mt19937 rng(7);
+    MemoryFileSystem fs;
+    State model;                        // After the last record the journal took
+    std::vector<State> inFlight{State()};  // States since the last sync/compaction
+    bool exact = true;                  // Last shutdown was clean
+
+    uint32_t crashes = 0, bootCrashes = 0, repairs = 0, compactions = 0, records = 0;
+    uint32_t unsynced = 0;              // Replays that kept records after the last sync
+    bool matched = true;
+    bool exactMatched = true;
+
+    for (uint32_t n = 0; n < JOURNAL_BOOTS; n++) {
+        {
+            DetectionJournal journal;
+            if (rng() % 8 == 0) fs.failAfter(rng() % 6);   // Power lost during boot
+            State replayed;
+            JournalReplayStats stats = boot(journal, fs, &replayed);
+
+            if (fs.hasFailed()) {
+                bootCrashes++;
+            } else {
+                if (stats.discardedBytes) repairs++;
+                size_t k = 0;
+                while (k < inFlight.size() && !(inFlight[k] == replayed)) k++;
+                if (k == inFlight.size()) matched = false;
+                if (exact && !(replayed == model)) exactMatched = false;
+                if (!exact && k > 0 && k < inFlight.size()) unsynced++;
+
+                model = replayed;
+                inFlight.assign(1, model);
+                bool crash = rng() % 4 != 0;
+                if (crash) fs.failAfter(rng() % 300);
+
+                uint32_t ops = 50 + rng() % 150;
+                for (uint32_t i = 0; i < ops && !fs.hasFailed(); i++) {
+                    uint32_t roll = rng() % 64;
+                    if (roll < 8) {
+                        if (journal.sync()) inFlight.assign(1, model);
+                    } else if (roll == 8) {
+                        // DataManager syncs before compacting
+                        if (journal.sync() && compactState(journal, model)) {
+                            inFlight.assign(1, model);
+                            compactions++;
+                        }
+                    } else {
+                        JournalEntry entry = randomEntry(rng, model);
+                        if (!journal.append(entry)) break;
+                        applyState(entry, &model);
+                        inFlight.push_back(model);
+                        records++;
+                    }
+                }
+                exact = !fs.hasFailed();
+                if (!exact) crashes++;
+            }
+        }
+        fs.powerCut(rng());
+    }
+
+    printf("[Journal] Power cuts: %u boots, %u records, %u compactions, %u cuts mid-run,"
+           " %u during boot, %u tails repaired, %u replays kept unsynced records\n",
+           (unsigned)JOURNAL_BOOTS, (unsigned)records, (unsigned)compactions, (unsigned)crashes,
+           (unsigned)bootCrashes, (unsigned)repairs, (unsigned)unsynced);
+    expect(matched, "replay gives the committed state plus a prefix of the unsynced records");
+    expect(exactMatched, "replay after a clean shutdown gives the last state");
+    expect(crashes > 0 && bootCrashes > 0 && repairs > 0 && compactions > 0,
+           "cuts mid-run and during boot, repairs and compactions all exercised");
+}
+
+int runJournal(int, char**) {
+    checkBegin("Journal");
+    checkTornTail();
+    checkPowerCuts();
+
+    return checkEnd();
+}
@@ -0,0 +1,32 @@
+#include "latency.h"
+#include <algorithm>
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+}
+
+LatencySummary LatencyRecorder::summarize() {
+    std::sort(samples.begin(), samples.end());
+
+    LatencySummary s;
+    uint64_t total = 0;
+    for (uint32_t ns : samples) total += ns;
+
+    s.count = samples.size();
+    s.seconds = total / 1e9;
+    s.perSecond = total ? s.count / s.seconds : 0;
+    s.p50 = percentile(samples, 0.50);
+    s.p90 = percentile(samples, 0.90);
+    s.p99 = percentile(samples, 0.99);
+    s.p999 = percentile(samples, 0.999);
+    s.max = samples.empty() ? 0 : samples.back();
+    return s;
+}
+
+void printLatencyJson(FILE* out, const LatencySummary& s) {
+    fprintf(out, "{\"count\":%u,\"per_sec\":%.0f,\"p50_ns\":%u,\"p90_ns\":%u,"
+                 "\"p99_ns\":%u,\"p999_ns\":%u,\"max_ns\":%u}",
+            (unsigned)s.count, s.perSecond, (unsigned)s.p50, (unsigned)s.p90,
+            (unsigned)s.p99, (unsigned)s.p999, (unsigned)s.max);
+}
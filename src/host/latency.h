@@ -0,0 +1,35 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Per-operation timings (ns) for the host benchmarks. Samples are kept and
+// sorted at the end, so percentiles are exact.
+struct LatencySummary {
+    uint32_t count = 0;
+    double seconds = 0;        // Sum of samples
+    double perSecond = 0;      // count / seconds: rate the stage alone sustains
+    uint32_t p50 = 0;
+    uint32_t p90 = 0;
+    uint32_t p99 = 0;
+    uint32_t p999 = 0;
+    uint32_t max = 0;
+};
+
+class LatencyRecorder {
+public:
+    void reserve(size_t count) { samples.reserve(count); }
+    void add(uint64_t ns) { samples.push_back(ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns); }
+    void clear() { samples.clear(); }
+    LatencySummary summarize();
+
+private:
+    std::vector<uint32_t> samples;
+};
+
+// {"count":..,"per_sec":..,"p50_ns":..,...} without a trailing newline
+void printLatencyJson(FILE* out, const LatencySummary& s);
+
+#endif // LATENCY_H
@@ -0,0 +1,88 @@
+/*
+ * LEDs mode: checks which LED animation wins when several are posted for
+ * the same detection, using the effects LEDController plays.
+ *
+ *   program leds
+ *
+ * BoardAlerts posts the detection flash (blue or purple, ALERT; the Raven
+ * strobe, CRITICAL) and then, for the first detection of a known device,
+ * the yellow blink. Checks:
+ *   - known device: the yellow blink replaces the flash and plays out
+ *   - new device: the flash plays
+ *   - known Raven: the strobe keeps playing, the blink is dropped
+ *   - a Raven strobe posted during the yellow blink takes over
+ *   - another device's flash, the heartbeat and the idle pulse posted
+ *     during the blink are dropped; after it ends the next flash plays
+ */
+
+#include <stdio.h>
+#include "hardware/led_animator.h"
+#include "check.h"
+#include "host.h"
+
+static const uint32_t BLUE = 0x0000FF;
+static const uint32_t RED = 0xFF0000;
+static const uint32_t WHITE = 0xFFFFFF;
+static const uint32_t YELLOW = 0xFFFF00;
+static const uint32_t ORANGE = 0xFFA500;
+static const uint32_t GREEN = 0x00FF00;
+
+// Color shown at `now`, 0 when idle or dark
+static uint32_t shown(LedAnimator& animator, uint32_t now) {
+    uint32_t color = 0;
+    return animator.render(now, &color) ? color : 0;
+}
+
+// What BoardAlerts posts for one detection
+static void detection(LedAnimator& animator, uint32_t now, bool raven, bool known) {
+    animator.post(raven ? ledRavenStrobe(RED, WHITE) : ledFlash(BLUE, 1, 200, LED_PRIORITY_ALERT), now);
+    if (known) animator.post(ledKnownDeviceBlink(YELLOW), now);
+}
+
+static void checkOrdering() {
+    LedAnimator known;
+    detection(known, 1000, false, true);
+    expect(known.activePriority() == LED_PRIORITY_KNOWN, "known device: blink replaces the flash");
+    expect(shown(known, 1050) == YELLOW && shown(known, 1150) == 0 && shown(known, 1250) == YELLOW,
+           "known device: yellow blinks twice");
+    expect(shown(known, 1400) == 0 && !known.isActive(), "known device: blink ends after 400 ms");
+
+    LedAnimator fresh;
+    detection(fresh, 1000, false, false);
+    expect(shown(fresh, 1100) == BLUE && shown(fresh, 1300) == 0, "new device: flash plays");
+
+    LedAnimator raven;
+    detection(raven, 1000, true, true);
+    expect(raven.activePriority() == LED_PRIORITY_CRITICAL && raven.getDropped() == 1,
+           "known Raven: blink dropped");
+    expect(shown(raven, 1050) == RED && shown(raven, 1150) == WHITE && shown(raven, 1950) == WHITE,
+           "known Raven: strobe plays out");
+
+    LedAnimator overridden;
+    detection(overridden, 1000, false, true);
+    detection(overridden, 1120, true, false);
+    expect(shown(overridden, 1130) == RED && overridden.activePriority() == LED_PRIORITY_CRITICAL,
+           "Raven strobe takes over from the blink");
+
+    LedAnimator busy;
+    detection(busy, 1000, false, true);
+    detection(busy, 1100, false, false);                    // Another device
+    LedAnimation heartbeat;
+    heartbeat.priority = LED_PRIORITY_INFO;
+    heartbeat.add(ORANGE, 255, 400);
+    LedAnimation idle;
+    idle.priority = LED_PRIORITY_AMBIENT;
+    idle.add(GREEN, 255, 500);
+    busy.post(heartbeat, 1150);
+    busy.post(idle, 1160);
+    expect(busy.getDropped() == 3 && shown(busy, 1250) == YELLOW, "blink not interrupted by flash, heartbeat or idle pulse");
+    detection(busy, 1400, false, false);
+    expect(shown(busy, 1450) == BLUE, "next flash plays after the blink");
+}
+
+int runLeds(int, char**) {
+    checkBegin("LEDs");
+    checkOrdering();
+
+    return checkEnd();
+}
@@ -0,0 +1,639 @@
+/*
+ * Matchers mode: checks the detection matchers against known cases and
+ * against the linear scans they replaced, and times both.
+ *
+ *   program matchers [--datasets DIR]
+ *
+ * OUI: the built-in prefixes, parsing, de-duplication, and 200,000 random
+ * addresses (a quarter sharing a table prefix) looked up in the sorted
+ * table and with the old per-prefix strncasecmp over the formatted address,
+ * with 20 and 4096 prefixes loaded.
+ *
+ * SSID/name automaton: known SSIDs and names and overlapping patterns. The
+ * corpus is the ssid and name fields of datasets/Flock-*.csv (cycled to
+ * 200,000 strings): every one must match the built-in SSID patterns, and
+ * the built-in SSID and name patterns are compared with strcasestr over
+ * every pattern on it. A fuzz pass follows: 200,000 random strings (built
+ * from pattern letters so that partial matches are common, an eighth with a
+ * pattern planted in random case) with the built-in SSID patterns and with
+ * 200 random ones. The reported pattern must occur in the text and end
+ * earliest.
+ *
+ * Raven UUIDs: parsing and formatting, the built-in services, near misses
+ * (same 32-bit short form, one byte off elsewhere), 16- and 32-bit UUIDs
+ * widened onto the Bluetooth base, a full table, and Raven fingerprints.
+ * Every firmware in datasets/raven_configurations.json advertises its
+ * services as 128-bit and as 16-bit UUIDs and must fingerprint to the same
+ * services; its characteristic UUIDs must not match. 200,000 UUIDs drawn
+ * from that file (half one byte off), then 200,000 random ones (a quarter
+ * Raven services, a quarter one byte off), are compared with the old
+ * format-then-strcasecmp scan.
+ *
+ * Every random case must agree with the old scan. Times are ns per lookup
+ * (steady_clock around the whole loop, -O2 host build); they compare the
+ * approaches and are not ESP32 figures.
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "detection/frame_parser.h"
+#include "detection/oui_matcher.h"
+#include "detection/pattern_matcher.h"
+#include "detection/raven_detector.h"
+#include "detection/uuid_matcher.h"
+#include "check.h"
+#include "csv.h"
+#include "host.h"
+
+#define MATCHERS_LOOKUPS 200000
+
+static const char* datasetDir = "datasets";
+
+typedef std::chrono::steady_clock MatchClock;
+
+static double nsPer(MatchClock::time_point from, MatchClock::time_point to, size_t count) {
+    return std::chrono::duration<double, std::nano>(to - from).count() / count;
+}
+
+// ============================================================================
+// OUI
+// ============================================================================
+
+// The baseline: format the address, compare against every "aa:bb:cc" text
+static bool linearOui(const std::vector<std::string>& prefixes, const uint8_t* mac) {
+    char text[18];
+    snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    for (const std::string& prefix : prefixes) {
+        if (strncasecmp(text, prefix.c_str(), 8) == 0) return true;
+    }
+    return false;
+}
+
+static void compareOui(size_t prefixCount, std::mt19937& rng) {
+    std::vector<std::string> prefixes;
+    OUIMatcher matcher;
+    char text[9];
+    while (prefixes.size() < prefixCount) {
+        uint32_t oui = rng() & 0xFFFFFF;
+        snprintf(text, sizeof(text), "%02X:%02x:%02x", oui >> 16, (oui >> 8) & 0xFF, oui & 0xFF);
+        prefixes.push_back(text);
+        matcher.addPrefix(text);
+    }
+    matcher.build();
+
+    // A quarter of the addresses carry a loaded prefix
+    std::vector<uint8_t> macs(MATCHERS_LOOKUPS * 6);
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) {
+        uint8_t* mac = &macs[i * 6];
+        for (int b = 0; b < 6; b++) mac[b] = rng();
+        if (i % 4 == 0) {
+            uint32_t oui;
+            OUIMatcher::parse(prefixes[rng() % prefixes.size()].c_str(), &oui);
+            mac[0] = oui >> 16;
+            mac[1] = oui >> 8;
+            mac[2] = oui;
+        }
+    }
+
+    std::vector<uint8_t> fast(MATCHERS_LOOKUPS), slow(MATCHERS_LOOKUPS);
+    auto t0 = MatchClock::now();
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) fast[i] = matcher.contains(&macs[i * 6]);
+    auto t1 = MatchClock::now();
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) slow[i] = linearOui(prefixes, &macs[i * 6]);
+    auto t2 = MatchClock::now();
+
+    size_t hits = 0;
+    bool agree = true;
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) {
+        hits += fast[i];
+        if (fast[i] != slow[i]) agree = false;
+    }
+    printf("[Matchers] OUI, %4u prefixes: table %6.1f ns, linear scan %8.1f ns per lookup (%u hits)\n",
+           (unsigned)matcher.size(), nsPer(t0, t1, MATCHERS_LOOKUPS), nsPer(t1, t2, MATCHERS_LOOKUPS),
+           (unsigned)hits);
+    expect(agree, "OUI table agrees with the linear scan");
+    expect(hits >= MATCHERS_LOOKUPS / 4, "OUI hits include every planted prefix");
+}
+
+static void checkOui() {
+    // Built-in table (loaded by main)
+    const uint8_t flock[6] = {0x58, 0x8e, 0x81, 0x01, 0x02, 0x03};
+    const uint8_t lastBuiltin[6] = {0xe4, 0xaa, 0xea, 0xff, 0xff, 0xff};
+    const uint8_t neighbour[6] = {0x58, 0x8e, 0x82, 0x01, 0x02, 0x03};
+    const uint8_t zero[6] = {0, 0, 0, 0, 0, 0};
+    expect(ouiMatcher.contains(flock), "built-in prefix 58:8e:81 matches");
+    expect(ouiMatcher.contains(lastBuiltin), "last built-in prefix e4:aa:ea matches");
+    expect(!ouiMatcher.contains(neighbour), "adjacent prefix 58:8e:82 does not match");
+    expect(!ouiMatcher.contains(zero), "00:00:00 does not match");
+
+    uint32_t oui = 0;
+    expect(OUIMatcher::parse("58:8E:81", &oui) && oui == 0x588e81, "parse colon form, upper case");
+    expect(OUIMatcher::parse("58-8e-81", &oui) && oui == 0x588e81, "parse dash form");
+    expect(OUIMatcher::parse("588e81", &oui) && oui == 0x588e81, "parse bare hex");
+    expect(!OUIMatcher::parse("58:8e", &oui), "reject short prefix");
+    expect(!OUIMatcher::parse("58:8g:81", &oui), "reject non-hex digit");
+    expect(!OUIMatcher::parse(nullptr, &oui), "reject null");
+
+    OUIMatcher matcher;
+    expect(!matcher.contains(flock), "empty table matches nothing");
+    matcher.addPrefix("58:8e:81");
+    matcher.addPrefix("58-8E-81");
+    matcher.addPrefix(0xFF588e81);          // Only the low 24 bits count
+    matcher.addPrefix("00:00:01");
+    matcher.build();
+    expect(matcher.size() == 2, "duplicates removed on build");
+    expect(matcher.contains(flock) && !matcher.contains(neighbour), "rebuilt table matches");
+    expect(matcher.contains((uint32_t)0x000001) && !matcher.contains((uint32_t)0), "lowest prefixes");
+
+    std::mt19937 rng(1);
+    compareOui(20, rng);
+    compareOui(4096, rng);
+}
+
+// ============================================================================
+// SSID / NAME PATTERNS
+// ============================================================================
+
+// End of the first case-insensitive occurrence of pattern in text, or -1
+static int firstEnd(const std::string& text, const std::string& pattern) {
+    const char* found = strcasestr(text.c_str(), pattern.c_str());
+    return found ? (int)(found - text.c_str() + pattern.size()) : -1;
+}
+
+// The baseline: strcasestr for every pattern
+static bool linearPattern(const std::vector<std::string>& patterns, const std::string& text) {
+    for (const std::string& pattern : patterns) {
+        if (strcasestr(text.c_str(), pattern.c_str())) return true;
+    }
+    return false;
+}
+
+// The automaton's answer must be a pattern that occurs and ends first
+static bool validMatch(const std::vector<std::string>& patterns, const std::string& text, int index) {
+    int earliest = -1;
+    for (const std::string& pattern : patterns) {
+        int end = firstEnd(text, pattern);
+        if (end >= 0 && (earliest < 0 || end < earliest)) earliest = end;
+    }
+    if (index < 0) return earliest < 0;
+    return firstEnd(text, patterns[index]) == earliest;
+}
+
+static std::string randomText(const std::string& alphabet, std::mt19937& rng) {
+    std::string text(rng() % 33, ' ');
+    for (char& c : text) c = alphabet[rng() % alphabet.size()];
+    return text;
+}
+
+// Strings built from pattern letters, an eighth with a pattern planted in random case
+static std::vector<std::string> fuzzTexts(const std::vector<std::string>& patterns, std::mt19937& rng) {
+    std::string alphabet = "-_ 0123456789";
+    for (const std::string& pattern : patterns) alphabet += pattern;
+    std::vector<std::string> texts(MATCHERS_LOOKUPS);
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) {
+        std::string text = randomText(alphabet, rng);
+        if (i % 8 == 0) {
+            std::string pattern = patterns[rng() % patterns.size()];
+            for (char& c : pattern) {
+                if (rng() & 1) c = (c >= 'a' && c <= 'z') ? c - 32 : (c >= 'A' && c <= 'Z') ? c + 32 : c;
+            }
+            text.insert(rng() % (text.size() + 1), pattern);
+        }
+        texts[i] = text;
+    }
+    return texts;
+}
+
+// The ssid and name fields of datasets/Flock-*.csv (WiGLE exports of Flock
+// cameras), cycled to MATCHERS_LOOKUPS strings; empty without the files
+static std::vector<std::string> flockTexts(size_t* distinct) {
+    std::vector<std::string> corpus;
+    DIR* d = opendir(datasetDir);
+    if (d) {
+        struct dirent* entry;
+        while ((entry = readdir(d)) != nullptr) {
+            size_t n = strlen(entry->d_name);
+            if (strncmp(entry->d_name, "Flock-", 6) != 0 || n < 4 ||
+                strcmp(entry->d_name + n - 4, ".csv") != 0) continue;
+
+            std::string path = std::string(datasetDir) + "/" + entry->d_name;
+            FILE* file = fopen(path.c_str(), "r");
+            if (!file) continue;
+            std::vector<std::string> header;
+            int ssidCol = -1, nameCol = -1;
+            if (readCsvHeader(file, &header)) {
+                ssidCol = csvColumn(header, "ssid");
+                nameCol = csvColumn(header, "name");
+            }
+            char line[4096];
+            while ((ssidCol >= 0 || nameCol >= 0) && fgets(line, sizeof(line), file)) {
+                std::vector<std::string> fields = splitCsv(line);
+                for (int col : {ssidCol, nameCol}) {
+                    if (col >= 0 && (int)fields.size() > col && !fields[col].empty()) {
+                        corpus.push_back(fields[col]);
+                    }
+                }
+            }
+            fclose(file);
+        }
+        closedir(d);
+    }
+
+    *distinct = corpus.size();
+    std::vector<std::string> texts;
+    for (size_t i = 0; !corpus.empty() && i < MATCHERS_LOOKUPS; i++) texts.push_back(corpus[i % corpus.size()]);
+    return texts;
+}
+
+static void comparePatterns(const char* name, const std::vector<std::string>& patterns,
+                            const std::vector<std::string>& texts) {
+    PatternMatcher matcher;
+    for (const std::string& pattern : patterns) matcher.addPattern(pattern.c_str());
+    matcher.build();
+
+    size_t count = texts.size();
+    std::vector<int> fast(count);
+    std::vector<uint8_t> slow(count);
+    auto t0 = MatchClock::now();
+    for (size_t i = 0; i < count; i++) fast[i] = matcher.match(texts[i].c_str());
+    auto t1 = MatchClock::now();
+    for (size_t i = 0; i < count; i++) slow[i] = linearPattern(patterns, texts[i]);
+    auto t2 = MatchClock::now();
+
+    size_t hits = 0;
+    bool agree = true;
+    bool earliest = true;
+    for (size_t i = 0; i < count; i++) {
+        hits += fast[i] >= 0;
+        if ((fast[i] >= 0) != (slow[i] != 0)) agree = false;
+        if (!validMatch(patterns, texts[i], fast[i])) earliest = false;
+    }
+    printf("[Matchers] %s, %3u patterns (%5u states): automaton %6.1f ns, strcasestr scan %7.1f ns"
+           " per string (%u hits)\n",
+           name, (unsigned)matcher.size(), (unsigned)matcher.stateCount(),
+           nsPer(t0, t1, count), nsPer(t1, t2, count), (unsigned)hits);
+    expect(agree, "automaton agrees with the strcasestr scan");
+    expect(earliest, "automaton reports the pattern that ends first");
+}
+
+static void checkPatterns() {
+    // Built-in tables (loaded by main)
+    expect(ssidMatcher.match("Flock-A1B2C3") >= 0, "SSID Flock-A1B2C3");
+    expect(ssidMatcher.match("my FLOCK cam") >= 0, "SSID with pattern inside, upper case");
+    expect(ssidMatcher.match("FS Ext Battery 0042") >= 0, "SSID FS Ext Battery");
+    expect(ssidMatcher.match("Pigvisio") < 0, "SSID with a truncated pattern");
+    expect(ssidMatcher.match("HomeNetwork") < 0, "unrelated SSID");
+    expect(ssidMatcher.match("") < 0, "empty SSID");
+    expect(nameMatcher.match("Penguin-1234") >= 0, "BLE name Penguin-1234");
+    expect(nameMatcher.match("pigvision") >= 0, "BLE name in lower case");
+    expect(nameMatcher.match("Pengui") < 0, "BLE name with a truncated pattern");
+    expect(ssidMatcher.match("xxFlock", 4) < 0 && ssidMatcher.match("xxFlock", 7) >= 0,
+           "only the given length is scanned");
+
+    // Overlaps and shared prefixes/suffixes exercise the failure links
+    PatternMatcher matcher;
+    const char* words[] = {"he", "she", "his", "hers", "flock", "lock", "ock-"};
+    for (const char* word : words) matcher.addPattern(word);
+    expect(matcher.addPattern("HERS") == 3, "equivalent pattern returns the existing index");
+    expect(matcher.addPattern("") == -1, "empty pattern rejected");
+    matcher.build();
+    int m = matcher.match("ushers");
+    expect(m == 0 || m == 1, "ushers: he/she end first");
+    expect(matcher.match("ahishers") == 2, "ahishers: his ends first");
+    expect(matcher.match("xflocx lock") == 5, "failure link from flocx to lock");
+    expect(matcher.match("FLOCK-") == 4, "flock ends before ock-");
+    expect(matcher.match("hx sx hi") < 0, "no pattern");
+    expect(strcmp(matcher.getPattern(3), "hers") == 0, "original spelling kept");
+
+    std::vector<std::string> builtinSsids, builtinNames;
+    for (size_t i = 0; i < ssidMatcher.size(); i++) builtinSsids.push_back(ssidMatcher.getPattern(i));
+    for (size_t i = 0; i < nameMatcher.size(); i++) builtinNames.push_back(nameMatcher.getPattern(i));
+
+    // Real Flock SSIDs and names: every one must be detected
+    size_t distinct = 0;
+    std::vector<std::string> flock = flockTexts(&distinct);
+    expect(!flock.empty(), "Flock-*.csv loaded");
+    if (!flock.empty()) {
+        printf("[Matchers] Flock corpus: %u SSIDs/names\n", (unsigned)distinct);
+        bool detected = true;
+        for (size_t i = 0; i < distinct; i++) detected &= ssidMatcher.match(flock[i].c_str()) >= 0;
+        expect(detected, "every Flock SSID/name in the datasets matches the built-in SSID patterns");
+        comparePatterns("SSID built-in, Flock corpus", builtinSsids, flock);
+        comparePatterns("Name built-in, Flock corpus", builtinNames, flock);
+    }
+
+    // Random strings as an extra fuzz pass
+    std::mt19937 rng(2);
+    comparePatterns("SSID built-in, fuzz", builtinSsids, fuzzTexts(builtinSsids, rng));
+
+    std::vector<std::string> many;
+    while (many.size() < 200) {
+        std::string pattern(3 + rng() % 6, ' ');
+        for (char& c : pattern) c = "abcdefghAB"[rng() % 10];
+        bool duplicate = false;
+        for (const std::string& p : many) duplicate |= strcasecmp(p.c_str(), pattern.c_str()) == 0;
+        if (!duplicate) many.push_back(pattern);
+    }
+    comparePatterns("Random, fuzz", many, fuzzTexts(many, rng));
+}
+
+// ============================================================================
+// RAVEN SERVICE UUIDS
+// ============================================================================
+
+static const char* RAVEN_TEXTS[] = {
+    RAVEN_DEVICE_INFO_SERVICE, RAVEN_GPS_SERVICE, RAVEN_POWER_SERVICE, RAVEN_NETWORK_SERVICE,
+    RAVEN_UPLOAD_SERVICE, RAVEN_ERROR_SERVICE, RAVEN_OLD_HEALTH_SERVICE, RAVEN_OLD_LOCATION_SERVICE
+};
+static const int RAVEN_TEXT_COUNT = sizeof(RAVEN_TEXTS) / sizeof(RAVEN_TEXTS[0]);
+
+// The baseline: format the advertised UUID, compare against every service text
+static int linearUuid(const uint8_t* uuid128) {
+    char text[37];
+    UUIDMatcher::format(uuid128, text);
+    for (int i = 0; i < RAVEN_TEXT_COUNT; i++) {
+        if (strcasecmp(text, RAVEN_TEXTS[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static BleAdvert ravenAdvert(const int* services, int count) {
+    BleAdvert advert;
+    memset(&advert, 0, sizeof(advert));
+    for (int i = 0; i < count; i++) {
+        UUIDMatcher::parse(RAVEN_TEXTS[services[i]], advert.uuids[i]);
+    }
+    advert.uuid_count = count;
+    return advert;
+}
+
+// `pool` empty: random 128-bit UUIDs, a quarter Raven services and a quarter
+// one byte off; otherwise UUIDs drawn from the pool, half of them one byte off
+static void compareUuids(const char* name, const std::vector<std::string>& pool, std::mt19937& rng) {
+    std::vector<uint8_t> uuids(MATCHERS_LOOKUPS * 16);
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) {
+        uint8_t* uuid = &uuids[i * 16];
+        for (int b = 0; b < 16; b++) uuid[b] = rng();
+        if (!pool.empty()) {
+            UUIDMatcher::parse(pool[rng() % pool.size()].c_str(), uuid);
+            if (i % 2 == 1) uuid[rng() % 16] ^= 1 + rng() % 255;
+        } else if (i % 4 < 2) {
+            UUIDMatcher::parse(RAVEN_TEXTS[rng() % RAVEN_TEXT_COUNT], uuid);
+            if (i % 4 == 1) uuid[rng() % 16] ^= 1 + rng() % 255;   // Near miss
+        }
+    }
+
+    std::vector<int> fast(MATCHERS_LOOKUPS), slow(MATCHERS_LOOKUPS);
+    auto t0 = MatchClock::now();
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) fast[i] = ravenUuidMatcher.match(&uuids[i * 16]);
+    auto t1 = MatchClock::now();
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) slow[i] = linearUuid(&uuids[i * 16]);
+    auto t2 = MatchClock::now();
+
+    size_t hits = 0;
+    bool agree = true;
+    for (size_t i = 0; i < MATCHERS_LOOKUPS; i++) {
+        hits += fast[i] >= 0;
+        if (fast[i] != slow[i]) agree = false;
+    }
+    printf("[Matchers] Raven UUIDs, %s, %u services: binary %6.1f ns, format + strcasecmp %6.1f ns"
+           " per UUID (%u hits)\n",
+           name, (unsigned)ravenUuidMatcher.size(), nsPer(t0, t1, MATCHERS_LOOKUPS),
+           nsPer(t1, t2, MATCHERS_LOOKUPS), (unsigned)hits);
+    expect(agree, "UUID matcher agrees with the string scan");
+    if (pool.empty()) {
+        expect(hits >= MATCHERS_LOOKUPS / 4, "every unmodified Raven UUID matches");   // A near miss can hit another service
+    }
+}
+
+// One firmware version in datasets/raven_configurations.json
+struct RavenConfig {
+    std::string firmware;
+    std::vector<std::string> services;          // In order of first appearance
+    std::vector<std::string> characteristics;
+};
+
+// Next double-quoted string from *pos on (the file has no escapes)
+static bool nextString(const std::string& text, size_t* pos, std::string* out) {
+    size_t open = text.find('"', *pos);
+    size_t close = open == std::string::npos ? open : text.find('"', open + 1);
+    if (close == std::string::npos) return false;
+    *out = text.substr(open + 1, close - open - 1);
+    *pos = close + 1;
+    return true;
+}
+
+static std::vector<RavenConfig> loadRavenConfigs(const std::string& path) {
+    std::vector<RavenConfig> configs;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return configs;
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) text.append(chunk, n);
+    fclose(file);
+
+    size_t pos = 0;
+    std::string key, value;
+    while (nextString(text, &pos, &key)) {
+        if (key != "firmwareVersion" && key != "serviceUuid" && key != "characteristicUuid") continue;
+        if (!nextString(text, &pos, &value)) break;
+        if (key == "firmwareVersion") {
+            configs.push_back(RavenConfig());
+            configs.back().firmware = value;
+        } else if (!configs.empty()) {
+            std::vector<std::string>& list =
+                key == "serviceUuid" ? configs.back().services : configs.back().characteristics;
+            if (std::find(list.begin(), list.end(), value) == list.end()) list.push_back(value);
+        }
+    }
+    return configs;
+}
+
+// Advertising data carrying the services, parsed as the NimBLE callback does.
+// `shortForm` sends UUIDs on the Bluetooth base as one 16-bit list (AD 0x03),
+// everything else goes out as 128-bit (AD 0x07).
+static BleAdvert advertFor(const std::vector<std::string>& services, bool shortForm) {
+    uint8_t raw[512];
+    size_t len = 0;
+    size_t listStart = 0;
+    for (const std::string& text : services) {
+        uint8_t uuid[16], base[16];
+        if (!UUIDMatcher::parse(text.c_str(), uuid)) continue;
+        UUIDMatcher::widen(uuid[12] | (uuid[13] << 8), base);
+        if (shortForm && memcmp(uuid, base, 16) == 0) {
+            if (listStart == 0) {
+                listStart = len + 1;        // Length byte of the 16-bit list
+                raw[len++] = 1;
+                raw[len++] = 0x03;
+            }
+            raw[listStart - 1] += 2;
+            raw[len++] = uuid[12];
+            raw[len++] = uuid[13];
+        } else {
+            raw[len++] = 17;
+            raw[len++] = 0x07;
+            memcpy(raw + len, uuid, 16);
+            len += 16;
+        }
+    }
+    static const uint8_t mac[6] = {0xd8, 0xf3, 0xbc, 0x00, 0x00, 0x01};
+    BleAdvert advert;
+    parseBleAdvert(mac, -60, raw, len, 0, &advert);
+    return advert;
+}
+
+// Every firmware in the dataset, advertising its services in both forms
+static void checkRavenDataset(std::mt19937& rng) {
+    std::vector<RavenConfig> configs = loadRavenConfigs(std::string(datasetDir) + "/raven_configurations.json");
+    expect(!configs.empty(), "raven_configurations.json loaded");
+
+    std::vector<std::string> pool;
+    for (const RavenConfig& config : configs) {
+        uint32_t expected = 0;
+        for (const std::string& service : config.services) {
+            for (int i = 0; i < RAVEN_TEXT_COUNT; i++) {
+                if (strcasecmp(service.c_str(), RAVEN_TEXTS[i]) == 0) expected |= 1u << i;
+            }
+            pool.push_back(service);
+        }
+
+        RavenFingerprint longFp, shortFp;
+        bool longOk = RavenDetector::fingerprint(advertFor(config.services, false), &longFp);
+        bool shortOk = RavenDetector::fingerprint(advertFor(config.services, true), &shortFp);
+        const char* estimate = RavenDetector::estimateFirmwareVersion(shortFp.services);
+        printf("[Matchers] Raven %s: %u services, %u characteristics, services 0x%02x, estimated %s\n",
+               config.firmware.c_str(), (unsigned)config.services.size(),
+               (unsigned)config.characteristics.size(), (unsigned)shortFp.services, estimate);
+
+        char what[96];
+        snprintf(what, sizeof(what), "Raven %s fingerprinted from 128-bit UUIDs", config.firmware.c_str());
+        expect(longOk && longFp.services == expected, what);
+        snprintf(what, sizeof(what), "Raven %s fingerprinted from 16-bit UUIDs", config.firmware.c_str());
+        expect(shortOk && shortFp.services == expected && shortFp.primary == longFp.primary, what);
+        if (config.firmware.compare(0, 4, "1.1.") == 0 || config.firmware.compare(0, 4, "1.3.") == 0) {
+            snprintf(what, sizeof(what), "Raven %s firmware estimate", config.firmware.c_str());
+            expect(strncmp(estimate, config.firmware.c_str(), 4) == 0, what);
+        }
+
+        // Characteristics are not services; the malformed one must not parse
+        bool none = true;
+        for (const std::string& characteristic : config.characteristics) {
+            uint8_t uuid[16];
+            if (!UUIDMatcher::parse(characteristic.c_str(), uuid)) continue;
+            if (ravenUuidMatcher.match(uuid) != linearUuid(uuid)) none = false;
+            pool.push_back(characteristic);
+        }
+        snprintf(what, sizeof(what), "Raven %s characteristics agree with the string scan", config.firmware.c_str());
+        expect(none, what);
+    }
+
+    if (!pool.empty()) compareUuids("dataset", pool, rng);
+}
+
+static void checkUuids() {
+    uint8_t uuid[16];
+    char text[37];
+    expect(UUIDMatcher::parse(RAVEN_GPS_SERVICE, uuid) && uuid[12] == 0x00 && uuid[13] == 0x31 &&
+           uuid[0] == 0xfb, "parse stores little-endian");
+    UUIDMatcher::format(uuid, text);
+    expect(strcmp(text, RAVEN_GPS_SERVICE) == 0, "format round-trips");
+    expect(UUIDMatcher::parse("00003100000010008000 00805F9B34FB", uuid) == false, "reject space");
+    expect(UUIDMatcher::parse("0000310000001000800000805F9B34FB", uuid) &&
+           ravenUuidMatcher.match(uuid) == RAVEN_SVC_GPS, "parse without dashes, upper case");
+    expect(!UUIDMatcher::parse("00003100-0000-1000-8000-00805f9b34f", uuid), "reject 31 digits");
+    expect(!UUIDMatcher::parse("00003100-0000-1000-8000-00805f9b34fb0", uuid), "reject 33 digits");
+    expect(!UUIDMatcher::parse("00003100-0000-1000-8000-00805f9b34fg", uuid), "reject non-hex digit");
+
+    // Built-in services (loaded by main), index == RavenService bit
+    bool indexed = true;
+    for (int i = 0; i < RAVEN_TEXT_COUNT; i++) {
+        UUIDMatcher::parse(RAVEN_TEXTS[i], uuid);
+        if (ravenUuidMatcher.match(uuid) != i) indexed = false;
+    }
+    expect(indexed, "each built-in service matches its RavenService index");
+    UUIDMatcher::parse("0000180b-0000-1000-8000-00805f9b34fb", uuid);
+    expect(ravenUuidMatcher.match(uuid) < 0, "neighbouring short form does not match");
+    UUIDMatcher::parse("0000180a-0000-1000-8000-00805f9b34fc", uuid);
+    expect(ravenUuidMatcher.match(uuid) < 0, "same short form, different base does not match");
+
+    UUIDMatcher full;
+    bool added = true;
+    for (int i = 0; i < UUID_MATCHER_MAX; i++) {
+        snprintf(text, sizeof(text), "%08x-0000-1000-8000-00805f9b34fb", i);
+        if (full.addUuid(text) != i) added = false;
+    }
+    expect(added && full.addUuid(RAVEN_GPS_SERVICE) == -1, "table holds UUID_MATCHER_MAX entries");
+    expect(full.addUuid("not a uuid") == -1, "invalid UUID rejected");
+    UUIDMatcher::parse("0000001f-0000-1000-8000-00805f9b34fb", uuid);
+    expect(full.match(uuid) == UUID_MATCHER_MAX - 1, "last entry of a full table matches");
+
+    // Fingerprints: services in one pass, primary in advertisement order
+    RavenFingerprint fp;
+    const int latest[] = {RAVEN_SVC_POWER, RAVEN_SVC_GPS, RAVEN_SVC_DEVICE_INFO};
+    expect(RavenDetector::fingerprint(ravenAdvert(latest, 3), &fp) &&
+           fp.services == 0x07 && fp.primary == RAVEN_SVC_POWER, "1.3.x fingerprint");
+    expect(strcmp(RavenDetector::estimateFirmwareVersion(fp.services), "1.3.x (Latest)") == 0,
+           "1.3.x firmware estimate");
+    const int legacy[] = {RAVEN_SVC_OLD_HEALTH, RAVEN_SVC_OLD_LOCATION};
+    expect(RavenDetector::fingerprint(ravenAdvert(legacy, 2), &fp) &&
+           fp.primary == RAVEN_SVC_OLD_HEALTH &&
+           strcmp(RavenDetector::estimateFirmwareVersion(fp.services), "1.1.x (Legacy)") == 0,
+           "1.1.x fingerprint");
+    expect(!RavenDetector::fingerprint(ravenAdvert(legacy, 0), &fp) && fp.services == 0,
+           "no UUIDs, no fingerprint");
+
+    // 16- and 32-bit forms are widened onto the Bluetooth base UUID
+    UUIDMatcher::widen(0x3100, uuid);
+    expect(ravenUuidMatcher.match(uuid) == RAVEN_SVC_GPS, "16-bit 0x3100 widens to the GPS service");
+    UUIDMatcher::format(uuid, text);
+    expect(strcmp(text, RAVEN_GPS_SERVICE) == 0, "widened UUID formats as the 128-bit text");
+    UUIDMatcher::widen(0x180b, uuid);
+    expect(ravenUuidMatcher.match(uuid) < 0, "16-bit neighbour does not match");
+    UUIDMatcher::widen(0x00013200, uuid);
+    expect(ravenUuidMatcher.match(uuid) < 0, "32-bit value with the same low half does not match");
+
+    static const uint8_t mac[6] = {0xd8, 0xf3, 0xbc, 0x00, 0x00, 0x02};
+    const uint8_t shortAdvert[] = {
+        5, 0x02, 0x0a, 0x18, 0x00, 0x31,                // Incomplete 16-bit list: 180a, 3100
+        5, 0x05, 0x00, 0x32, 0x00, 0x00,                // Complete 32-bit list: 00003200
+        4, 0x03, 0x19, 0x18, 0xff,                      // 16-bit 1819 plus a stray byte
+        8, 0x09, 'R', 'a', 'v', 'e', 'n', '-', '1'
+    };
+    BleAdvert advert;
+    parseBleAdvert(mac, -60, shortAdvert, sizeof(shortAdvert), 0, &advert);
+    expect(advert.uuid_count == 4 && strcmp(advert.name, "Raven-1") == 0, "16/32-bit lists parsed, stray byte ignored");
+    RavenFingerprint fp16;
+    expect(RavenDetector::fingerprint(advert, &fp16) && fp16.primary == RAVEN_SVC_DEVICE_INFO &&
+           fp16.services == ((1u << RAVEN_SVC_DEVICE_INFO) | (1u << RAVEN_SVC_GPS) |
+                             (1u << RAVEN_SVC_POWER) | (1u << RAVEN_SVC_OLD_LOCATION)),
+           "fingerprint from 16- and 32-bit UUIDs");
+    uint8_t manyShort[2 + 2 * 12] = {1 + 2 * 12, 0x03};
+    for (int i = 0; i < 12; i++) manyShort[2 + 2 * i] = i;
+    parseBleAdvert(mac, -60, manyShort, sizeof(manyShort), 0, &advert);
+    expect(advert.uuid_count == BLE_ADVERT_MAX_UUIDS, "16-bit list capped at BLE_ADVERT_MAX_UUIDS");
+
+    std::mt19937 rng(3);
+    checkRavenDataset(rng);
+    compareUuids("random", std::vector<std::string>(), rng);
+}
+
+int runMatchers(int argc, char** argv) {
+    checkBegin("Matchers");
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--datasets") == 0) datasetDir = argv[i + 1];
+    }
+
+    checkOui();
+    checkPatterns();
+    checkUuids();
+
+    return checkEnd();
+}
@@ -0,0 +1,105 @@
+/*
+ * Oled mode: renders the firmware's screens through the same canvas the
+ * display task uses and counts what each update would put on the I2C bus.
+ *
+ *   program oled
+ *
+ * For every step: data bytes, command bytes, Wire transactions and the
+ * transfer time at the configured OLED_I2C_CLOCK, next to a full-frame push
+ * (1024 bytes, as the Adafruit driver sent for every update). Fails if an
+ * unchanged screen pushes anything or a counter update needs more than a
+ * tenth of a full frame.
+ */
+
+#include <stdio.h>
+#include "config/pins.h"
+#include "hardware/oled_canvas.h"
+#include "hardware/oled_screens.h"
+#include "check.h"
+#include "host.h"
+
+#define OLED_FRAME_BYTES (OLED_WIDTH * OLED_PAGES)
+
+// Counts bytes as the device's Wire bus would send them
+class CountingOledBus : public OledBus {
+public:
+    size_t dataBytes = 0;
+    size_t commandBytes = 0;
+    size_t transactions = 0;
+
+    void command(const uint8_t*, size_t len) override { add(len, &commandBytes); }
+    void data(const uint8_t*, size_t len) override { add(len, &dataBytes); }
+
+    void reset() { dataBytes = commandBytes = transactions = 0; }
+
+    // Address + control byte per transaction, 9 clocks per byte (with ACK)
+    double transferMicros(uint32_t clock) const {
+        size_t wire = dataBytes + commandBytes + transactions * 2;
+        return wire * 9 * 1e6 / clock;
+    }
+
+private:
+    void add(size_t len, size_t* total) {
+        *total += len;
+        transactions += (len + OLED_I2C_CHUNK - 1) / OLED_I2C_CHUNK;
+    }
+};
+
+static CountingOledBus bus;
+static OledCanvas canvas;
+
+static size_t step(const char* name, const OledScreen& screen) {
+    bus.reset();
+    canvas.render(screen);
+    canvas.flush(bus);
+    printf("  %-22s %5u data  %3u cmd  %3u txn  %7.0f us\n", name, (unsigned)bus.dataBytes,
+           (unsigned)bus.commandBytes, (unsigned)bus.transactions, bus.transferMicros(OLED_I2C_CLOCK));
+    return bus.dataBytes;
+}
+
+int runOled(int, char**) {
+    checkBegin("Oled");
+
+    CountingOledBus full;
+    full.data(nullptr, OLED_FRAME_BYTES);
+    printf("[Oled] Bytes pushed per update at %u kHz (full frame: %u data, %.0f us)\n",
+           (unsigned)(OLED_I2C_CLOCK / 1000), OLED_FRAME_BYTES, full.transferMicros(OLED_I2C_CLOCK));
+
+    OledScreen screen;
+    OledStatus status = {false, 12, 8, 4, true, 41.0912, -81.5641, "Locked", true};
+
+    oledBootScreen(&screen);
+    step("boot (full push)", screen);
+
+    oledStatusScreen(&screen, status);
+    step("first status", screen);
+
+    expect(step("unchanged status", screen) == 0, "unchanged screen pushed no data");
+
+    status.totalDetections = 13;
+    status.wifiDetections = 9;
+    oledStatusScreen(&screen, status);
+    expect(step("counter update", screen) * 10 <= OLED_FRAME_BYTES,
+           "counter update pushed at most a tenth of a frame");
+
+    status.lat = 41.1034;
+    oledStatusScreen(&screen, status);
+    step("GPS moved", screen);
+
+    status.deviceInRange = true;
+    oledStatusScreen(&screen, status);
+    step("device in range", screen);
+
+    oledDetectionScreen(&screen, "Flock WiFi", -62, true, status.lat, status.lon);
+    step("detection alert", screen);
+
+    oledStatusScreen(&screen, status);
+    step("alert expired", screen);
+
+    for (uint8_t percent = 40; percent <= 45; percent += 5) {
+        oledProgressScreen(&screen, "EXPORTING", percent, 1500);
+        step(percent == 40 ? "export progress" : "progress +5%", screen);
+    }
+
+    return checkEnd();
+}
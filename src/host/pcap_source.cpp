@@ -0,0 +1,108 @@
+#include "pcap_source.h"
+#include <stdio.h>
+#include <string.h>
+#include "detection/frame_parser.h"
+#include "detection/pcap_format.h"
+
+bool PcapSource::add(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("[Replay] Cannot open %s\n", path);
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    uint32_t linktype = 0;
+    if (data.size() < PCAP_FILE_HEADER_SIZE || !pcapParseFileHeader(data.data(), &linktype)) {
+        printf("[Replay] %s is not a pcap file\n", path);
+        return false;
+    }
+
+    Stream* stream;
+    if (linktype == PCAP_LINKTYPE_RADIOTAP) {
+        stream = &wifi;
+    } else if (linktype == PCAP_LINKTYPE_BLE_LL_PHDR) {
+        stream = &ble;
+    } else {
+        printf("[Replay] %s has unsupported linktype %u\n", path, (unsigned)linktype);
+        return false;
+    }
+    if (!stream->data.empty()) {
+        printf("[Replay] %s: only one %s capture per run\n", path, stream == &ble ? "BLE" : "WiFi");
+        return false;
+    }
+
+    stream->data.swap(data);
+    stream->ble = (stream == &ble);
+    rewind();
+    return true;
+}
+
+void PcapSource::rewind() {
+    wifi.pos = wifi.data.empty() ? 0 : PCAP_FILE_HEADER_SIZE;
+    ble.pos = ble.data.empty() ? 0 : PCAP_FILE_HEADER_SIZE;
+    wifi.pending = false;
+    ble.pending = false;
+    records = 0;
+    skipped = 0;
+}
+
+// Parses the next record header; false at end of file (a record cut short by
+// a power loss ends the stream)
+bool PcapSource::peek(Stream& stream) {
+    if (stream.pending) return true;
+    if (stream.pos + PCAP_RECORD_HEADER_SIZE > stream.data.size()) return false;
+    if (!pcapParseRecordHeader(&stream.data[stream.pos], &stream.micros, &stream.length)) return false;
+    if (stream.pos + PCAP_RECORD_HEADER_SIZE + stream.length > stream.data.size()) return false;
+    stream.pending = true;
+    return true;
+}
+
+bool PcapSource::decode(Stream& stream, RadioPacket* out) {
+    const uint8_t* record = &stream.data[stream.pos + PCAP_RECORD_HEADER_SIZE];
+    size_t length = stream.length;
+    stream.pos += PCAP_RECORD_HEADER_SIZE + length;
+    stream.pending = false;
+    records++;
+
+    out->micros = (int64_t)stream.micros;
+    uint32_t timestamp = (uint32_t)(stream.micros / 1000);
+    int8_t rssi;
+
+    if (stream.ble) {
+        uint8_t mac[6];
+        const uint8_t* advData;
+        size_t advLen;
+        if (!pcapDecodeBle(record, length, mac, &advData, &advLen, &rssi)) return false;
+        out->kind = RADIO_BLE;
+        parseBleAdvert(mac, rssi, advData, advLen, timestamp, &out->ble);
+        return true;
+    }
+
+    const uint8_t* frame;
+    size_t frameLen;
+    uint8_t channel;
+    if (!pcapDecodeWiFi(record, length, &frame, &frameLen, &rssi, &channel)) return false;
+    out->kind = RADIO_WIFI;
+    return parseWiFiFrame(frame, frameLen, rssi, channel, timestamp, &out->wifi);
+}
+
+bool PcapSource::next(RadioPacket* out) {
+    while (true) {
+        bool haveWiFi = peek(wifi);
+        bool haveBle = peek(ble);
+        if (!haveWiFi && !haveBle) return false;
+
+        // Oldest record first
+        Stream& stream = (haveWiFi && (!haveBle || wifi.micros <= ble.micros)) ? wifi : ble;
+        if (decode(stream, out)) return true;
+        skipped++;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef PCAP_SOURCE_H
+#define PCAP_SOURCE_H
+
+#include <stdint.h>
+#include <vector>
+#include "hal/hal.h"
+
+// Replays a WiFi and/or BLE capture written by PacketCapture. Files are
+// loaded into memory up front so next() measures parsing, not disk I/O.
+// Records from the two files are merged in timestamp order; records the
+// frame parser rejects (weak, wrong subtype) are skipped and counted.
+class PcapSource : public RadioSource {
+public:
+    // Adds one capture file; its linktype says whether it is WiFi or BLE
+    bool add(const char* path);
+    bool next(RadioPacket* out) override;
+    void rewind();
+
+    uint32_t getRecords() const { return records; }
+    uint32_t getSkipped() const { return skipped; }
+
+private:
+    struct Stream {
+        std::vector<uint8_t> data;
+        size_t pos = 0;
+        bool ble = false;
+        bool pending = false;       // Next record header parsed
+        uint64_t micros = 0;
+        uint32_t length = 0;
+    };
+
+    Stream wifi;
+    Stream ble;
+    uint32_t records = 0;
+    uint32_t skipped = 0;
+
+    bool peek(Stream& stream);
+    bool decode(Stream& stream, RadioPacket* out);
+};
+
+#endif // PCAP_SOURCE_H
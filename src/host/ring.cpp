@@ -0,0 +1,140 @@
+/*
+ * Ring mode: checks the lock-free FrameRing that hands sniffed frames from
+ * the WiFi callback to the processing task.
+ *
+ *   program ring
+ *
+ * Single-threaded: FIFO order across many wraparounds of the slot index and
+ * the drop count when the ring is full. Two threads: a producer pushes
+ * numbered records in bursts of 128 (twice the ring) while a consumer
+ * pops them, so the ring both runs full and drains. Every record popped
+ * must be whole (no half-written slot) and in push order, popped + dropped
+ * must equal pushed, and the missing sequence numbers must be exactly the
+ * dropped ones.
+ */
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include "detection/frame_ring.h"
+#include "check.h"
+#include "host.h"
+
+#define RING_THREAD_RECORDS 100000
+
+// About the size of a WiFiFrame, so a copy is not a single store
+struct Record {
+    uint32_t seq;
+    uint32_t words[11];                 // All derived from seq
+
+    void fill(uint32_t n) {
+        seq = n;
+        for (int i = 0; i < 11; i++) words[i] = n * 2654435761u + i;
+    }
+    bool whole() const {
+        for (int i = 0; i < 11; i++) {
+            if (words[i] != seq * 2654435761u + i) return false;
+        }
+        return true;
+    }
+};
+
+static void checkSingleThread() {
+    FrameRing<Record, 8> ring;
+    Record r;
+
+    // Fill past capacity: the extra pushes are dropped, not overwritten
+    for (uint32_t i = 0; i < 10; i++) {
+        r.fill(i);
+        bool pushed = ring.push(r);
+        expect(pushed == (i < 8), i < 8 ? "push into free slot" : "push into full ring fails");
+    }
+    expect(ring.size() == 8 && ring.droppedCount() == 2 && ring.pushedCount() == 8,
+           "full ring counts 2 drops");
+    expect(ring.highWaterMark() == 8, "high-water mark reaches capacity");
+
+    uint32_t expected = 0;
+    while (ring.pop(r)) {
+        expect(r.seq == expected++ && r.whole(), "full ring pops in push order");
+    }
+    expect(expected == 8 && ring.empty(), "full ring drains");
+
+    // Uneven push/pop batches walk the indices around the slots many times
+    uint32_t next = 100;
+    expected = 100;
+    bool inOrder = true;
+    for (uint32_t round = 0; round < 1000; round++) {
+        uint32_t pushes = 1 + round % 7;
+        for (uint32_t i = 0; i < pushes; i++) {
+            r.fill(next++);
+            ring.push(r);
+        }
+        uint32_t pops = round & 1 ? pushes - 1 : pushes + 1;     // Never more than 8 queued
+        for (uint32_t i = 0; i < pops && ring.pop(r); i++) {
+            if (r.seq != expected++ || !r.whole()) inOrder = false;
+        }
+    }
+    while (ring.pop(r)) {
+        if (r.seq != expected++ || !r.whole()) inOrder = false;
+    }
+    expect(inOrder, "order kept across wraparound");
+    expect(expected == next && ring.droppedCount() == 2, "no drops while there is room");
+}
+
+static void checkTwoThreads() {
+    static FrameRing<Record, 64> ring;
+    std::atomic<bool> done{false};
+    uint32_t popped = 0;
+    uint32_t gaps = 0;                  // Records missing between two pops
+    uint32_t outOfOrder = 0;
+    uint32_t torn = 0;
+    int64_t last = -1;
+
+    std::thread consumer([&]() {
+        Record r;
+        while (true) {
+            bool finished = done.load();
+            if (!ring.pop(r)) {
+                if (finished) break;
+                continue;
+            }
+            if (!r.whole()) torn++;
+            if ((int64_t)r.seq <= last) {
+                outOfOrder++;
+            } else {
+                gaps += r.seq - (uint32_t)(last + 1);
+            }
+            last = r.seq;
+            popped++;
+        }
+    });
+
+    Record r;
+    for (uint32_t i = 0; i < RING_THREAD_RECORDS; i++) {
+        if (i % 128 == 0) {
+            while (!ring.empty()) std::this_thread::yield();
+        }
+        r.fill(i);
+        ring.push(r);
+    }
+    done = true;
+    consumer.join();
+    gaps += RING_THREAD_RECORDS - 1 - last;     // Dropped after the last one popped
+
+    printf("[Ring] Two threads: %u pushed, %u popped, %u dropped (ring full), high-water %u/%u\n",
+           (unsigned)RING_THREAD_RECORDS, (unsigned)popped, (unsigned)ring.droppedCount(),
+           (unsigned)ring.highWaterMark(), (unsigned)ring.capacity());
+    expect(torn == 0, "no torn records");
+    expect(outOfOrder == 0, "records popped in push order");
+    expect(popped + ring.droppedCount() == RING_THREAD_RECORDS, "popped + dropped = pushed");
+    expect(popped == ring.pushedCount() && gaps == ring.droppedCount(),
+           "exactly the dropped records are missing");
+}
+
+int runRing(int, char**) {
+    checkBegin("Ring");
+    checkSingleThread();
+    checkTwoThreads();
+
+    return checkEnd();
+}
@@ -0,0 +1,217 @@
+/*
+ * SD log mode: checks the SectorBuffer behind the CSV detection log on a
+ * fake file that records every write and flush instead of storing them.
+ *
+ *   program sdlog
+ *
+ * Rows of random length are fed the way SDLogger feeds them (hand sectors
+ * to the card when the buffer is nearly full, sync every so often) onto a
+ * new file and onto files whose size is not a sector multiple. Checks:
+ *   - the file ends up holding exactly the old bytes plus every row
+ *   - every write starts from the 512-byte aligned buffer
+ *   - every write ends on a sector boundary of the file, except the tail
+ *     written by a sync; the first write after opening tops up the sector
+ *     the old data ended in
+ *   - the write, sync and sector counters match the calls the file saw
+ *     (sectors counted from the byte ranges actually written)
+ *   - a card that stops taking writes loses rows, never buffer contents
+ *
+ * The same rows are also fed through the previous policy (whole buffer
+ * sectors regardless of the file offset) to count writes that end inside a
+ * sector, which the card has to read back and rewrite.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "hardware/sector_buffer.h"
+#include "check.h"
+#include "host.h"
+
+#define SDLOG_ROWS 20000
+#define SDLOG_ROW_MAX 192               // SDLogger's row buffer
+
+// Every call the fake file saw
+struct Recording {
+    std::vector<uint8_t> data;
+    struct Write {
+        uint32_t offset;
+        uint32_t len;
+        bool aligned;                   // Source buffer on a sector boundary
+        bool synced;                    // Last write before a flush
+    };
+    std::vector<Write> writes;
+    uint32_t flushes = 0;
+    uint32_t accept = UINT32_MAX;       // Bytes the card still takes
+};
+
+class RecordingFile : public FileHandle {
+public:
+    explicit RecordingFile(Recording* recording) : rec(recording) {}
+
+    size_t read(uint8_t*, size_t) override { return 0; }
+    bool seek(uint32_t) override { return false; }
+    uint32_t size() override { return rec->data.size(); }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        if (len > rec->accept) len = rec->accept;
+        if (len == 0) return 0;
+        rec->accept -= len;
+        rec->writes.push_back({(uint32_t)rec->data.size(), (uint32_t)len,
+                               (uintptr_t)data % SD_SECTOR_SIZE == 0, false});
+        rec->data.insert(rec->data.end(), data, data + len);
+        return len;
+    }
+
+    bool flush() override {
+        if (!rec->writes.empty()) rec->writes.back().synced = true;
+        rec->flushes++;
+        return true;
+    }
+
+private:
+    Recording* rec;
+};
+
+static std::string randomRow(std::mt19937& rng, uint32_t n) {
+    char row[SDLOG_ROW_MAX];
+    int len = snprintf(row, sizeof(row), "%u,wifi,ssid_pattern,58:8e:81:%02x:%02x:%02x,%d,",
+                       (unsigned)n, (unsigned)(rng() & 0xFF), (unsigned)(rng() & 0xFF),
+                       (unsigned)(rng() & 0xFF), -40 - (int)(rng() % 50));
+    uint32_t pad = rng() % (sizeof(row) - len - 1);
+    for (uint32_t i = 0; i < pad; i++) row[len++] = 'a' + i % 26;
+    row[len - 1] = '\n';
+    return std::string(row, len);
+}
+
+static uint32_t sectorsTouched(uint32_t offset, uint32_t len) {
+    return (offset + len + SD_SECTOR_SIZE - 1) / SD_SECTOR_SIZE - offset / SD_SECTOR_SIZE;
+}
+
+// Writes that end inside a sector without being a sync's tail
+static uint32_t midSectorEnds(const Recording& rec) {
+    uint32_t count = 0;
+    for (const auto& w : rec.writes) {
+        if ((w.offset + w.len) % SD_SECTOR_SIZE != 0 && !w.synced) count++;
+    }
+    return count;
+}
+
+// The policy before the offset was tracked: whole buffer sectors
+static void feedOld(Recording* rec, const std::vector<std::string>& rows, uint32_t syncEvery) {
+    RecordingFile file(rec);
+    uint8_t buffer[SD_SECTOR_BUFFER_SIZE];
+    size_t buffered = 0;
+    auto writeSectors = [&]() {
+        size_t whole = buffered - buffered % SD_SECTOR_SIZE;
+        if (whole == 0) return;
+        file.write(buffer, whole);
+        buffered -= whole;
+        memmove(buffer, buffer + whole, buffered);
+    };
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (buffered + rows[i].size() > sizeof(buffer)) writeSectors();
+        memcpy(buffer + buffered, rows[i].data(), rows[i].size());
+        buffered += rows[i].size();
+        if (buffered >= sizeof(buffer) - SDLOG_ROW_MAX) writeSectors();
+        if ((i + 1) % syncEvery == 0 || i + 1 == rows.size()) {
+            file.write(buffer, buffered);
+            buffered = 0;
+            file.flush();
+        }
+    }
+}
+
+static void checkRun(uint32_t existing, uint32_t syncEvery) {
+    std::mt19937 rng(existing + syncEvery);
+    std::vector<std::string> rows;
+    for (uint32_t i = 0; i < SDLOG_ROWS; i++) rows.push_back(randomRow(rng, i));
+
+    Recording rec;
+    rec.data.assign(existing, '#');
+    std::string expected(existing, '#');
+
+    SectorBuffer log;
+    log.attach(new RecordingFile(&rec));
+    bool appended = true;
+    for (size_t i = 0; i < rows.size(); i++) {
+        const std::string& row = rows[i];
+        if (log.getBuffered() + row.size() > SD_SECTOR_BUFFER_SIZE) log.writeSectors();
+        appended &= log.append((const uint8_t*)row.data(), row.size());
+        expected += row;
+        if (log.getBuffered() >= SD_SECTOR_BUFFER_SIZE - SDLOG_ROW_MAX) log.writeSectors();
+        if ((i + 1) % syncEvery == 0 || i + 1 == rows.size()) log.sync();
+    }
+
+    bool aligned = true;
+    uint32_t sectors = 0;
+    for (const auto& w : rec.writes) {
+        aligned &= w.aligned;
+        sectors += sectorsTouched(w.offset, w.len);
+    }
+    bool topUp = rec.writes.empty() || existing % SD_SECTOR_SIZE == 0 ||
+                 (rec.writes[0].offset + rec.writes[0].len) % SD_SECTOR_SIZE == 0 || rec.writes[0].synced;
+
+    Recording old;
+    old.data.assign(existing, '#');
+    feedOld(&old, rows, syncEvery);
+
+    printf("[SDLog] %5u-byte file, sync every %5u rows: %4u writes (%u end mid-sector), %4u syncs,"
+           " %5u sectors; old policy: %4u writes (%u end mid-sector)\n",
+           (unsigned)existing, (unsigned)syncEvery, (unsigned)rec.writes.size(), (unsigned)midSectorEnds(rec),
+           (unsigned)rec.flushes, (unsigned)sectors, (unsigned)old.writes.size(), (unsigned)midSectorEnds(old));
+
+    expect(appended && rec.data.size() == expected.size() &&
+           memcmp(rec.data.data(), expected.data(), expected.size()) == 0, "file holds old bytes plus every row");
+    expect(aligned, "writes start from the sector-aligned buffer");
+    expect(midSectorEnds(rec) == 0, "writes end on sector boundaries except sync tails");
+    expect(topUp, "first write tops up the sector the old data ended in");
+    expect(log.getWrites() == rec.writes.size() && log.getSyncs() == rec.flushes &&
+           log.getSectorWrites() == sectors, "write, sync and sector counters match the file");
+    expect(old.data == rec.data, "old policy writes the same bytes");
+}
+
+// The card stops taking data part-way through a write
+static void checkFailingCard() {
+    std::mt19937 rng(3);
+    Recording rec;
+    rec.accept = 5000;
+    std::string accepted;
+
+    SectorBuffer log;
+    log.attach(new RecordingFile(&rec));
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        std::string row = randomRow(rng, i);
+        if (log.getBuffered() + row.size() > SD_SECTOR_BUFFER_SIZE) log.writeSectors();
+        if (log.append((const uint8_t*)row.data(), row.size())) {
+            accepted += row;
+        } else {
+            lost++;
+        }
+        if (log.getBuffered() >= SD_SECTOR_BUFFER_SIZE - SDLOG_ROW_MAX) log.writeSectors();
+    }
+    size_t held = log.getBuffered();
+    rec.accept = UINT32_MAX;            // Card back
+    bool synced = log.sync();
+
+    printf("[SDLog] Failing card: %u rows lost while full, %u bytes held until it came back\n",
+           (unsigned)lost, (unsigned)held);
+    expect(lost > 0 && held <= SD_SECTOR_BUFFER_SIZE, "full buffer refuses rows instead of overflowing");
+    expect(synced && rec.data.size() == accepted.size() &&
+           memcmp(rec.data.data(), accepted.data(), accepted.size()) == 0, "every accepted row written once");
+}
+
+int runSdlog(int, char**) {
+    checkBegin("SDLog");
+    checkRun(0, SDLOG_ROWS);
+    checkRun(0, 50);
+    checkRun(1000, 50);
+    checkRun(4097, 7);
+    checkRun(511, 1);
+    checkFailingCard();
+
+    return checkEnd();
+}
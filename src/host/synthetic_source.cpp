@@ -0,0 +1,302 @@
+#include "synthetic_source.h"
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include "config/patterns.h"
+#include "detection/frame_parser.h"
+#include "detection/uuid_matcher.h"
+#include "csv.h"
+
+static const uint8_t BLE_FLAGS[] = {0x02, 0x01, 0x06};
+static const uint8_t WIFI_RATES[] = {0x01, 0x08, 0x82, 0x84, 0x8b, 0x96, 0x0c, 0x12, 0x18, 0x24};
+static const char NAME_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_ ";
+
+// ============================================================================
+// DATASET SEEDING
+// ============================================================================
+
+static bool parseMac(const std::string& text, uint8_t* mac) {
+    unsigned b[6];
+    if (sscanf(text.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) mac[i] = (uint8_t)b[i];
+    return true;
+}
+
+uint32_t SyntheticSource::loadDatasets(const char* dir) {
+    DIR* d = opendir(dir);
+    if (!d) return 0;
+
+    uint32_t loaded = 0;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr) {
+        size_t n = strlen(entry->d_name);
+        if (n < 4 || strcmp(entry->d_name + n - 4, ".csv") != 0) continue;
+
+        std::string path = std::string(dir) + "/" + entry->d_name;
+        FILE* file = fopen(path.c_str(), "r");
+        if (!file) continue;
+
+        std::vector<std::string> header;
+        if (!readCsvHeader(file, &header)) {
+            fclose(file);
+            continue;
+        }
+        int macCol = csvColumn(header, "netid");
+        int ssidCol = csvColumn(header, "ssid");
+        int typeCol = csvColumn(header, "type");
+
+        // Only wigle-style exports carry MACs
+        if (macCol < 0) {
+            fclose(file);
+            continue;
+        }
+
+        char line[4096];
+        while (fgets(line, sizeof(line), file)) {
+            std::vector<std::string> fields = splitCsv(line);
+            if ((int)fields.size() <= macCol) continue;
+
+            SyntheticDevice dev;
+            if (!parseMac(fields[macCol], dev.mac)) continue;
+            const char* name = ssidCol >= 0 && (int)fields.size() > ssidCol ? fields[ssidCol].c_str() : "";
+            snprintf(dev.name, sizeof(dev.name), "%s", name);
+
+            bool ble = typeCol >= 0 && (int)fields.size() > typeCol && fields[typeCol] == "BLE";
+            (ble ? bleTargets : wifiTargets).push_back(dev);
+            loaded++;
+        }
+        fclose(file);
+    }
+    closedir(d);
+    return loaded;
+}
+
+// A few devices per pattern family when no datasets are available
+void SyntheticSource::addBuiltinTargets() {
+    static const uint8_t wifiOuis[][3] = {{0x70, 0xc9, 0x4e}, {0x3c, 0x91, 0x80}, {0xd8, 0xf3, 0xbc}};
+    static const uint8_t bleOuis[][3] = {{0x58, 0x8e, 0x81}, {0xcc, 0xcc, 0xcc}, {0xec, 0x1b, 0xbd}};
+
+    for (int i = 0; i < 30; i++) {
+        SyntheticDevice dev;
+        memcpy(dev.mac, wifiOuis[i % 3], 3);
+        for (int b = 3; b < 6; b++) dev.mac[b] = rng();
+        snprintf(dev.name, sizeof(dev.name), "Flock-%02X%02X%02X", dev.mac[3], dev.mac[4], dev.mac[5]);
+        wifiTargets.push_back(dev);
+
+        memcpy(dev.mac, bleOuis[i % 3], 3);
+        snprintf(dev.name, sizeof(dev.name), "%s", i % 2 ? "FS Ext Battery" : "Penguin");
+        bleTargets.push_back(dev);
+    }
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+static std::vector<double> zipfCdf(size_t n, double skew) {
+    std::vector<double> cdf(n);
+    double total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += 1.0 / pow((double)(i + 1), skew);
+        cdf[i] = total;
+    }
+    for (double& c : cdf) c /= total;
+    return cdf;
+}
+
+void SyntheticSource::randomName(char* out, uint8_t len) {
+    for (uint8_t i = 0; i < len; i++) {
+        out[i] = NAME_CHARS[rng() % (sizeof(NAME_CHARS) - 1)];
+    }
+    out[len] = '\0';
+}
+
+void SyntheticSource::makeBackground(std::vector<SyntheticDevice>& pool, bool ble) {
+    pool.assign(config.devices, SyntheticDevice());
+    std::uniform_int_distribution<int> ssidLen(config.ssidMin, config.ssidMax);
+
+    for (SyntheticDevice& dev : pool) {
+        for (int b = 0; b < 6; b++) dev.mac[b] = rng();
+        dev.mac[0] = (dev.mac[0] & 0xFC) | 0x02;     // Locally administered, unicast
+
+        if (!ble) {
+            randomName(dev.name, ssidLen(rng));
+        } else {
+            // Most phones and tags advertise no name; some carry a vendor UUID
+            if (rng() % 10 < 4) randomName(dev.name, 6 + rng() % 7);
+            if (rng() % 10 < 2) {
+                for (int b = 0; b < 16; b++) dev.uuid[b] = rng();
+                dev.hasUuid = true;
+            }
+        }
+    }
+}
+
+void SyntheticSource::begin(const SyntheticConfig& cfg) {
+    config = cfg;
+    if (config.ssidMax > 32) config.ssidMax = 32;
+    if (config.ssidMin > config.ssidMax) config.ssidMin = config.ssidMax;
+    if (config.devices == 0) config.devices = 1;
+    rng.seed(config.seed);
+
+    if (wifiTargets.empty() && bleTargets.empty()) addBuiltinTargets();
+
+    // Raven units are identified by service UUIDs, not MACs or names
+    static const char* ravenUuids[] = {RAVEN_GPS_SERVICE, RAVEN_POWER_SERVICE, RAVEN_OLD_HEALTH_SERVICE};
+    for (const char* uuid : ravenUuids) {
+        SyntheticDevice dev;
+        for (int b = 0; b < 6; b++) dev.mac[b] = rng();
+        dev.mac[0] = (dev.mac[0] & 0xFC) | 0x02;
+        dev.name[0] = '\0';
+        dev.hasUuid = UUIDMatcher::parse(uuid, dev.uuid);
+        bleTargets.push_back(dev);
+    }
+
+    makeBackground(wifiBackground, false);
+    makeBackground(bleBackground, true);
+    wifiZipf = zipfCdf(wifiBackground.size(), config.skew);
+    bleZipf = zipfCdf(bleBackground.size(), config.skew);
+    wifiTargetZipf = zipfCdf(wifiTargets.size(), config.skew);
+    bleTargetZipf = zipfCdf(bleTargets.size(), config.skew);
+
+    nextWiFi = 0;
+    nextBle = 0;
+    generated = 0;
+    sequence = 0;
+}
+
+// ============================================================================
+// GENERATION
+// ============================================================================
+
+const SyntheticDevice& SyntheticSource::pick(const std::vector<SyntheticDevice>& pool,
+                                             const std::vector<double>& cdf) {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    size_t i = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    return pool[i < pool.size() ? i : pool.size() - 1];
+}
+
+size_t SyntheticSource::buildWiFiFrame(uint8_t* out, const SyntheticDevice& dev, bool probe) {
+    uint8_t* p = out;
+    *p++ = probe ? 0x40 : 0x80;            // Frame control
+    *p++ = 0;
+    *p++ = 0;                              // Duration
+    *p++ = 0;
+    memset(p, 0xFF, 6);                    // addr1: broadcast
+    p += 6;
+    memcpy(p, dev.mac, 6);                 // addr2: transmitter
+    p += 6;
+    if (probe) {
+        memset(p, 0xFF, 6);                // addr3: wildcard BSSID
+    } else {
+        memcpy(p, dev.mac, 6);             // addr3: BSSID
+    }
+    p += 6;
+    *p++ = (sequence << 4) & 0xFF;
+    *p++ = sequence >> 4;
+    sequence = (sequence + 1) & 0x0FFF;
+
+    if (!probe) {
+        memset(p, 0, 8);                   // Timestamp
+        p += 8;
+        *p++ = 0x64;                       // Beacon interval
+        *p++ = 0x00;
+        *p++ = 0x31;                       // Capabilities
+        *p++ = 0x04;
+    }
+
+    // Phones mostly send wildcard probes
+    uint8_t ssidLen = strlen(dev.name);
+    if (probe && rng() % 2) ssidLen = 0;
+    *p++ = 0;
+    *p++ = ssidLen;
+    memcpy(p, dev.name, ssidLen);
+    p += ssidLen;
+
+    memcpy(p, WIFI_RATES, sizeof(WIFI_RATES));
+    p += sizeof(WIFI_RATES);
+    if (!probe) {
+        *p++ = 3;                          // DS parameter set
+        *p++ = 1;
+        *p++ = 6;
+    }
+    memset(p, 0, 4);                       // FCS
+    p += 4;
+    return p - out;
+}
+
+size_t SyntheticSource::buildAdvert(uint8_t* out, const SyntheticDevice& dev) {
+    uint8_t* p = out;
+    memcpy(p, BLE_FLAGS, sizeof(BLE_FLAGS));
+    p += sizeof(BLE_FLAGS);
+
+    size_t nameLen = strlen(dev.name);
+    if (nameLen > 26) nameLen = 26;
+    if (nameLen) {
+        *p++ = nameLen + 1;
+        *p++ = 0x09;                       // Complete local name
+        memcpy(p, dev.name, nameLen);
+        p += nameLen;
+    }
+    if (dev.hasUuid) {
+        *p++ = 17;
+        *p++ = 0x07;                       // Complete 128-bit UUID list
+        memcpy(p, dev.uuid, 16);
+        p += 16;
+    }
+    return p - out;
+}
+
+bool SyntheticSource::nextRaw(RawPacket* out) {
+    if (generated >= config.packets) return false;
+    if (config.wifiRate <= 0 && config.bleRate <= 0) return false;
+    generated++;
+
+    bool ble = config.wifiRate <= 0 || (config.bleRate > 0 && nextBle < nextWiFi);
+    double rate = ble ? config.bleRate : config.wifiRate;
+    double& arrival = ble ? nextBle : nextWiFi;
+    out->micros = (int64_t)arrival;
+    arrival += std::exponential_distribution<double>(rate)(rng) * 1e6;
+
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    std::vector<SyntheticDevice>& targets = ble ? bleTargets : wifiTargets;
+    out->target = u < config.matchRatio && !targets.empty();
+
+    const SyntheticDevice& dev = out->target
+        ? pick(targets, ble ? bleTargetZipf : wifiTargetZipf)
+        : pick(ble ? bleBackground : wifiBackground, ble ? bleZipf : wifiZipf);
+
+    out->rssi = config.rssiMin + (int)(rng() % (config.rssiMax - config.rssiMin + 1));
+    out->channel = 1 + rng() % 11;
+    memcpy(out->mac, dev.mac, 6);
+    if (ble) {
+        out->kind = RADIO_BLE;
+        out->len = buildAdvert(out->data, dev);
+    } else {
+        out->kind = RADIO_WIFI;
+        out->len = buildWiFiFrame(out->data, dev, rng() % 1000 < config.probeRatio * 1000);
+    }
+    return true;
+}
+
+bool SyntheticSource::next(RadioPacket* out) {
+    RawPacket raw;
+    while (nextRaw(&raw)) {
+        out->kind = raw.kind;
+        out->micros = raw.micros;
+        uint32_t timestamp = (uint32_t)(raw.micros / 1000);
+        if (raw.kind == RADIO_BLE) {
+            parseBleAdvert(raw.mac, raw.rssi, raw.data, raw.len, timestamp, &out->ble);
+            return true;
+        }
+        if (parseWiFiFrame(raw.data, raw.len, raw.rssi, raw.channel, timestamp, &out->wifi)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,94 @@
+#ifndef SYNTHETIC_SOURCE_H
+#define SYNTHETIC_SOURCE_H
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+#include "detection/pcap_format.h"
+#include "hal/hal.h"
+
+// ============================================================================
+// SYNTHETIC RF SOURCE
+// ============================================================================
+//
+// Generates raw 802.11 beacons/probe requests and BLE advertising payloads
+// (the bytes the sniffer and NimBLE callbacks see) for the host benchmarks.
+//
+// Surveillance devices ("targets") are seeded from the MAC/SSID columns of
+// the wigle-style CSVs in datasets/; without them a handful are made up from
+// the built-in patterns. Background devices get random locally administered
+// MACs, so they never hit an OUI prefix. Arrivals are Poisson at the
+// configured rates and device popularity follows a Zipf distribution.
+
+struct SyntheticConfig {
+    uint32_t seed = 1;
+    uint32_t packets = 200000;     // WiFi + BLE; next() returns false after that
+    double wifiRate = 2000;        // Frames per second of air time
+    double bleRate = 500;          // Adverts per second
+    double matchRatio = 0.01;      // Share of packets sent by targets
+    double probeRatio = 0.3;       // Share of WiFi frames that are probe requests
+    uint8_t ssidMin = 4;           // Background SSID length range
+    uint8_t ssidMax = 16;
+    uint32_t devices = 2000;       // Background devices per radio
+    double skew = 1.0;             // Zipf exponent (0 = uniform)
+    int8_t rssiMin = -95;          // Some fall under WIFI_RSSI_THRESHOLD
+    int8_t rssiMax = -40;
+};
+
+struct SyntheticDevice {
+    uint8_t mac[6];
+    char name[33];                 // SSID / BLE local name, "" = none
+    uint8_t uuid[16];              // BLE service UUID
+    bool hasUuid = false;
+};
+
+// One packet as the radio hands it over
+struct RawPacket {
+    RadioPacketKind kind;
+    int64_t micros;
+    uint8_t data[PCAP_SNAPLEN];    // 802.11 frame with FCS / BLE AD structures
+    size_t len;
+    uint8_t mac[6];                // BLE advertiser (WiFi: inside data)
+    int8_t rssi;
+    uint8_t channel;
+    bool target;
+};
+
+class SyntheticSource : public RadioSource {
+public:
+    // Reads targets from every CSV in dir that has a netid column. Returns
+    // the number loaded.
+    uint32_t loadDatasets(const char* dir);
+    void begin(const SyntheticConfig& config);
+
+    bool nextRaw(RawPacket* out);
+    bool next(RadioPacket* out) override;   // Parsed; skips rejected frames
+
+    uint32_t getWiFiTargets() const { return wifiTargets.size(); }
+    uint32_t getBleTargets() const { return bleTargets.size(); }
+
+private:
+    SyntheticConfig config;
+    std::mt19937 rng;
+    std::vector<SyntheticDevice> wifiTargets;
+    std::vector<SyntheticDevice> bleTargets;
+    std::vector<SyntheticDevice> wifiBackground;
+    std::vector<SyntheticDevice> bleBackground;
+    std::vector<double> wifiZipf;    // Cumulative weights per pool size
+    std::vector<double> bleZipf;
+    std::vector<double> wifiTargetZipf;
+    std::vector<double> bleTargetZipf;
+    double nextWiFi = 0;             // Arrival times (us)
+    double nextBle = 0;
+    uint32_t generated = 0;
+    uint16_t sequence = 0;
+
+    void addBuiltinTargets();
+    void makeBackground(std::vector<SyntheticDevice>& pool, bool ble);
+    const SyntheticDevice& pick(const std::vector<SyntheticDevice>& pool, const std::vector<double>& cdf);
+    void randomName(char* out, uint8_t len);
+    size_t buildWiFiFrame(uint8_t* out, const SyntheticDevice& dev, bool probe);
+    size_t buildAdvert(uint8_t* out, const SyntheticDevice& dev);
+};
+
+#endif // SYNTHETIC_SOURCE_H
@@ -0,0 +1,359 @@
+/*
+ * Table mode: checks the open-addressing DeviceTable that holds the device
+ * database and benchmarks it against std::map.
+ *
+ *   program table
+ *
+ * Checks:
+ *   - 200,000 random inserts, lookups, updates and removals over a small,
+ *     OUI-clustered key space, compared with std::map after every step
+ *     (with a full slot scan every 1000 steps: every occupied slot must be
+ *     reachable from its home without crossing an empty one)
+ *   - backward-shift deletion around the wrap point: a probe chain that
+ *     runs from the last slot into slot 0, with removals at its start,
+ *     middle and end
+ *   - a full table: every insert evicts the device with the lowest
+ *     detection count (oldest last_seen on ties), compared with a reference
+ *     model over 20,000 inserts
+ *   - MAC and device type helpers
+ *
+ * The benchmark reports ns per operation for lookups that hit, lookups that
+ * miss and insert+remove pairs at several table sizes, for DeviceTable and
+ * std::map<uint64_t, DeviceRecord> (host -O2 build; compare the two, not
+ * the absolute numbers, with the ESP32).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+#include "hardware/device_table.h"
+#include "check.h"
+#include "host.h"
+
+typedef std::chrono::steady_clock TableClock;
+
+// Index of a record inside the table's slot array
+static int32_t slotOf(DeviceTable& table, const DeviceRecord* rec) {
+    for (uint32_t i = 0; i < table.slotCount(); i++) {
+        if (table.slotAt(i) == rec) return i;
+    }
+    return -1;
+}
+
+// Every occupied slot found by find(), and the count matches
+static bool consistent(DeviceTable& table) {
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < table.slotCount(); i++) {
+        DeviceRecord* rec = table.slotAt(i);
+        if (!rec) continue;
+        used++;
+        if (table.find(rec->mac) != rec) return false;
+    }
+    return used == table.size();
+}
+
+// ============================================================================
+// RANDOM OPERATIONS AGAINST STD::MAP
+// ============================================================================
+
+static void checkRandom() {
+    std::mt19937_64 rng(4);
+    DeviceTable table;
+    table.init(2048);                   // Never full: 1024 distinct keys below
+    std::map<uint64_t, uint32_t> model;  // mac -> detection_count
+
+    // 1024 keys in 4 OUIs, like a street of cameras from one vendor
+    std::vector<uint64_t> keys;
+    for (uint32_t i = 0; i < 1024; i++) {
+        keys.push_back(((uint64_t)(0x588e81 + (i & 3)) << 24) | (rng() & 0xFFFFFF));
+    }
+
+    bool agree = true;
+    bool chains = true;
+    for (uint32_t step = 0; step < 200000 && agree; step++) {
+        uint64_t mac = keys[rng() % keys.size()];
+        DeviceRecord* rec = table.find(mac);
+        auto it = model.find(mac);
+        if ((rec != nullptr) != (it != model.end())) agree = false;
+
+        switch (rng() % 4) {
+            case 0:
+            case 1:                     // Insert or update
+                if (!rec) {
+                    rec = table.insert(mac);
+                    model[mac] = 0;
+                }
+                rec->detection_count++;
+                model[mac]++;
+                break;
+            case 2:                     // Remove
+                if (table.remove(mac) != (it != model.end())) agree = false;
+                model.erase(mac);
+                break;
+            default:                    // Lookup only
+                if (rec && rec->detection_count != it->second) agree = false;
+                break;
+        }
+        if (table.size() != model.size()) agree = false;
+        if (step % 1000 == 0 && !consistent(table)) chains = false;
+    }
+    for (const auto& entry : model) {
+        DeviceRecord* rec = table.find(entry.first);
+        if (!rec || rec->detection_count != entry.second) agree = false;
+    }
+
+    printf("[Table] Random: 200000 operations, %u devices left, %u slots\n",
+           (unsigned)table.size(), (unsigned)table.slotCount());
+    expect(agree, "random operations agree with std::map");
+    expect(chains && consistent(table), "every device reachable from its home slot");
+}
+
+// ============================================================================
+// WRAP POINT
+// ============================================================================
+
+// A key whose home is `slot` in an empty table like `table`
+static uint64_t keyWithHome(DeviceTable& table, uint32_t slot, uint64_t start) {
+    for (uint64_t mac = start; ; mac++) {
+        table.clear();
+        if (slotOf(table, table.insert(mac)) == (int32_t)slot) {
+            table.clear();
+            return mac;
+        }
+    }
+}
+
+static void checkWrap() {
+    DeviceTable table;
+    table.init(8);                      // 16 slots
+    uint32_t last = table.slotCount() - 1;
+
+    // a, b, c all want the last slot; d wants slot 0; e wants slot 1
+    uint64_t a = keyWithHome(table, last, 1);
+    uint64_t b = keyWithHome(table, last, a + 1);
+    uint64_t c = keyWithHome(table, last, b + 1);
+    uint64_t d = keyWithHome(table, 0, 1);
+    uint64_t e = keyWithHome(table, 1, 1);
+
+    const uint64_t order[] = {a, b, c, d, e};
+    for (uint64_t mac : order) table.insert(mac);
+    expect(slotOf(table, table.find(a)) == (int32_t)last && slotOf(table, table.find(b)) == 0 &&
+           slotOf(table, table.find(c)) == 1 && slotOf(table, table.find(d)) == 2 &&
+           slotOf(table, table.find(e)) == 3, "probe chain wraps from the last slot into slot 0");
+
+    // Removing the chain's first member shifts everything back across the wrap
+    table.remove(a);
+    expect(slotOf(table, table.find(b)) == (int32_t)last && slotOf(table, table.find(c)) == 0 &&
+           slotOf(table, table.find(d)) == 1 && slotOf(table, table.find(e)) == 2,
+           "backward shift across the wrap point");
+    expect(!table.find(a) && consistent(table), "chain intact after removing its head");
+
+    // Middle of the chain (slot 0), then its tail
+    table.remove(c);
+    expect(slotOf(table, table.find(d)) == 0 && slotOf(table, table.find(e)) == 1 &&
+           consistent(table), "removal at slot 0 keeps the chain");
+    table.remove(e);
+    expect(table.find(b) && table.find(d) && !table.find(e) && consistent(table),
+           "removal at the end of the chain");
+    expect(table.size() == 2, "two devices left");
+
+    // Reinsert in another order; every member still found
+    const uint64_t reorder[] = {e, c, a};
+    for (uint64_t mac : reorder) table.insert(mac);
+    bool found = true;
+    for (uint64_t mac : order) found &= table.find(mac) != nullptr;
+    expect(found && consistent(table), "reinserted keys found");
+}
+
+// ============================================================================
+// FULL TABLE
+// ============================================================================
+
+static void checkEviction() {
+    std::mt19937 rng(5);
+    const uint32_t capacity = 100;
+    DeviceTable table;
+    table.init(capacity);
+
+    struct Model {
+        uint32_t count;
+        uint32_t lastSeen;
+    };
+    std::map<uint64_t, Model> model;
+    uint32_t clock = 0;
+
+    // Fill to capacity: no evictions yet
+    bool evicted = false;
+    for (uint32_t i = 0; i < capacity; i++) {
+        uint64_t mac = 0x020000000000ULL + i;
+        bool did;
+        DeviceRecord* rec = table.insert(mac, nullptr, &did);
+        evicted |= did;
+        rec->detection_count = 1 + rng() % 5;
+        rec->last_seen = ++clock;
+        model[mac] = {rec->detection_count, rec->last_seen};
+    }
+    expect(!evicted && table.size() == capacity, "no eviction until the table is full");
+
+    // Every further insert evicts min(detection_count, last_seen)
+    bool rightVictim = true;
+    bool stillFull = true;
+    for (uint32_t i = 0; i < 20000; i++) {
+        auto weakest = model.begin();
+        for (auto it = model.begin(); it != model.end(); ++it) {
+            if (it->second.count < weakest->second.count ||
+                (it->second.count == weakest->second.count &&
+                 it->second.lastSeen < weakest->second.lastSeen)) {
+                weakest = it;
+            }
+        }
+
+        uint64_t mac = 0x030000000000ULL + i;
+        DeviceRecord victim;
+        bool did = false;
+        DeviceRecord* rec = table.insert(mac, &victim, &did);
+        if (!did || victim.mac != weakest->first || table.find(weakest->first)) rightVictim = false;
+        model.erase(weakest);
+
+        rec->detection_count = 1 + rng() % 5;
+        rec->last_seen = ++clock;
+        model[mac] = {rec->detection_count, rec->last_seen};
+
+        // Detections on random survivors raise their counts
+        auto it = model.begin();
+        std::advance(it, rng() % model.size());
+        DeviceRecord* seen = table.find(it->first);
+        if (!seen) {
+            rightVictim = false;
+            break;
+        }
+        seen->detection_count = ++it->second.count;
+        seen->last_seen = it->second.lastSeen = ++clock;
+
+        if (table.size() != capacity) stillFull = false;
+    }
+    printf("[Table] Full: 20000 inserts into a table of %u, each evicting the weakest device\n",
+           (unsigned)capacity);
+    expect(rightVictim, "evicts lowest detection count, oldest last_seen on ties");
+    expect(stillFull && consistent(table), "table stays full and consistent");
+}
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void checkHelpers() {
+    const uint8_t mac[6] = {0x58, 0x8e, 0x81, 0x0a, 0xbc, 0xde};
+    uint64_t key = macToKey(mac);
+    uint8_t back[6];
+    keyToMac(key, back);
+    char text[18];
+    formatMac(key, text);
+    expect(key == 0x588e810abcdeULL && memcmp(back, mac, 6) == 0, "MAC <-> key");
+    expect(strcmp(text, "58:8e:81:0a:bc:de") == 0, "formatMac");
+
+    uint64_t parsed = 0;
+    expect(parseMac("58:8E:81:0A:BC:DE", &parsed) && parsed == key, "parseMac colons, upper case");
+    expect(parseMac("58-8e-81-0a-bc-de", &parsed) && parsed == key, "parseMac dashes");
+    expect(!parseMac("58:8e:81:0a:bc", &parsed), "parseMac rejects short address");
+    expect(!parseMac("58:8e:81:0a:bc:dx", &parsed), "parseMac rejects non-hex digit");
+
+    expect(deviceTypeFromName("raven") == DEVICE_RAVEN && deviceTypeFromName("WiFi") == DEVICE_WIFI,
+           "deviceTypeFromName");
+    expect(deviceTypeFromName("toaster") == DEVICE_UNKNOWN && deviceTypeFromName(nullptr) == DEVICE_UNKNOWN,
+           "unknown type names");
+    expect(strcmp(deviceTypeName((DeviceType)9), "Unknown") == 0, "out-of-range type name");
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+static double nsPer(TableClock::time_point from, TableClock::time_point to, size_t count) {
+    return std::chrono::duration<double, std::nano>(to - from).count() / count;
+}
+
+static void bench(uint32_t devices) {
+    std::mt19937_64 rng(devices);
+    std::vector<uint64_t> present(devices), absent(devices);
+    for (uint32_t i = 0; i < devices; i++) {
+        present[i] = ((uint64_t)0x588e81 << 24 | (rng() & 0xFFFFFF)) + ((uint64_t)(i & 7) << 40);
+        absent[i] = rng() & 0xFFFFFFFFFFFFULL;
+    }
+
+    DeviceTable table;
+    table.init(devices * 2);            // Room for the insert+remove pairs below
+    std::map<uint64_t, DeviceRecord> map;
+    for (uint64_t mac : present) {
+        if (!table.find(mac)) table.insert(mac);
+        map[mac].mac = mac;
+    }
+
+    const uint32_t rounds = 2000000 / devices + 1;
+    const size_t ops = (size_t)rounds * devices;
+    uint64_t found = 0;                 // Also keeps the lookups from being optimized out
+
+    auto t0 = TableClock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint64_t mac : present) found += table.find(mac) != nullptr;
+    }
+    auto t1 = TableClock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint64_t mac : present) found += map.find(mac) != map.end();
+    }
+    auto t2 = TableClock::now();
+    double hitTable = nsPer(t0, t1, ops), hitMap = nsPer(t1, t2, ops);
+
+    t0 = TableClock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint64_t mac : absent) found += table.find(mac) != nullptr;
+    }
+    t1 = TableClock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint64_t mac : absent) found += map.find(mac) != map.end();
+    }
+    t2 = TableClock::now();
+    double missTable = nsPer(t0, t1, ops), missMap = nsPer(t1, t2, ops);
+
+    t0 = TableClock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint64_t mac : absent) {
+            if (table.find(mac)) continue;
+            table.insert(mac);
+            table.remove(mac);
+        }
+    }
+    t1 = TableClock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint64_t mac : absent) {
+            if (map.count(mac)) continue;
+            map[mac].mac = mac;
+            map.erase(mac);
+        }
+    }
+    t2 = TableClock::now();
+    double churnTable = nsPer(t0, t1, ops), churnMap = nsPer(t1, t2, ops);
+
+    printf("[Table] %6u devices  hit %5.1f ns (map %6.1f)  miss %5.1f ns (map %6.1f)"
+           "  insert+remove %5.1f ns (map %6.1f)\n",
+           (unsigned)devices, hitTable, hitMap, missTable, missMap, churnTable, churnMap);
+    expect(found == 2 * (uint64_t)ops, "every present device found, no absent one");
+    expect(consistent(table) && table.size() == map.size(), "benchmark leaves both tables equal");
+}
+
+int runTable(int, char**) {
+    checkBegin("Table");
+    checkRandom();
+    checkWrap();
+    checkEviction();
+    checkHelpers();
+
+    bench(500);
+    bench(5000);
+    bench(50000);
+
+    return checkEnd();
+}
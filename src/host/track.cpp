@@ -0,0 +1,290 @@
+/*
+ * Track mode: checks the GPS track the firmware uses to place detections at
+ * their capture time, on synthetic drives with a known true position.
+ *
+ *   program track
+ *
+ * Each drive adds one fix per receiver epoch, then places a detection every
+ * 37 ms between the first and last fix. The interpolated error is compared
+ * with using the latest fix at or before the capture (what a detection got
+ * before the track existed). Drives: straight at 30 m/s and a 150 m radius
+ * curve at 20 m/s, at 1 and 5 Hz, and one across the millis() wrap.
+ *
+ * Then the edges (repeated and late epochs, gaps, ring overwrite,
+ * extrapolation) and the pipeline: a detection captured after the latest
+ * fix is emitted at once but stored only when the next fix arrives.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "detection/detection_pipeline.h"
+#include "hal/native_hal.h"
+#include "location/geo.h"
+#include "location/gps_track.h"
+#include "check.h"
+#include "host.h"
+
+#define TRACK_ORIGIN_LAT 37.7749
+#define TRACK_ORIGIN_LON -122.4194
+#define TRACK_METERS_PER_DEGREE 111320.0
+#define TRACK_SAMPLE_STEP 37            // ms between placed detections
+
+// ============================================================================
+// SYNTHETIC DRIVES
+// ============================================================================
+
+// Meters north and east of the origin after t seconds
+typedef void (*PathFn)(double t, double* north, double* east);
+
+static void straightPath(double t, double* north, double* east) {
+    *north = 30.0 * t * 0.5;            // 30 m/s, bearing 60
+    *east = 30.0 * t * 0.8660254;
+}
+
+static void curvePath(double t, double* north, double* east) {
+    double angle = 20.0 * t / 150.0;    // 20 m/s around a 150 m radius
+    *north = 150.0 * sin(angle);
+    *east = 150.0 * (1.0 - cos(angle));
+}
+
+static double cosOrigin() {
+    return cos(TRACK_ORIGIN_LAT * M_PI / 180.0);
+}
+
+static void pathPoint(PathFn path, double t, int32_t* lat, int32_t* lon) {
+    double north, east;
+    path(t, &north, &east);
+    *lat = toMicrodegrees(TRACK_ORIGIN_LAT + north / TRACK_METERS_PER_DEGREE);
+    *lon = toMicrodegrees(TRACK_ORIGIN_LON + east / (TRACK_METERS_PER_DEGREE * cosOrigin()));
+}
+
+// Distance from the true (unrounded) position
+static double errorMeters(PathFn path, double t, int32_t lat, int32_t lon) {
+    double north, east;
+    path(t, &north, &east);
+    double dNorth = (fromMicrodegrees(lat) - TRACK_ORIGIN_LAT) * TRACK_METERS_PER_DEGREE - north;
+    double dEast = (fromMicrodegrees(lon) - TRACK_ORIGIN_LON) * TRACK_METERS_PER_DEGREE * cosOrigin() - east;
+    return sqrt(dNorth * dNorth + dEast * dEast);
+}
+
+struct DriveResult {
+    double meanError;               // Interpolated
+    double maxError;
+    double latestMeanError;         // Latest fix at or before the capture
+    double latestMaxError;
+};
+
+static DriveResult drive(const char* name, PathFn path, uint32_t start, uint32_t interval, uint32_t fixes) {
+    GpsTrack track;
+    for (uint32_t i = 0; i < fixes; i++) {
+        int32_t lat, lon;
+        pathPoint(path, i * interval / 1000.0, &lat, &lon);
+        track.add(start + i * interval, lat, lon);
+    }
+
+    DriveResult result = {};
+    uint32_t samples = 0;
+    uint32_t notInterpolated = 0;
+    uint32_t end = (fixes - 1) * interval;
+    for (uint32_t offset = 0; offset <= end; offset += TRACK_SAMPLE_STEP) {
+        double t = offset / 1000.0;
+        int32_t lat, lon;
+        if (track.positionAt(start + offset, &lat, &lon) != TRACK_INTERPOLATED) notInterpolated++;
+        double error = errorMeters(path, t, lat, lon);
+
+        int32_t latestLat, latestLon;
+        pathPoint(path, (offset / interval) * interval / 1000.0, &latestLat, &latestLon);
+        double latestError = errorMeters(path, t, latestLat, latestLon);
+
+        result.meanError += error;
+        result.latestMeanError += latestError;
+        if (error > result.maxError) result.maxError = error;
+        if (latestError > result.latestMaxError) result.latestMaxError = latestError;
+        samples++;
+    }
+    result.meanError /= samples;
+    result.latestMeanError /= samples;
+
+    printf("[Track] %-16s interpolated %.2f m mean, %.2f m max; latest fix %.1f m mean, %.1f m max\n",
+           name, result.meanError, result.maxError, result.latestMeanError, result.latestMaxError);
+    expect(notInterpolated == 0, "every capture inside the track interpolates");
+    return result;
+}
+
+static void checkDrives() {
+    DriveResult r;
+
+    r = drive("straight 1 Hz", straightPath, 10000, 1000, 60);
+    expect(r.maxError < 0.5, "straight 1 Hz within rounding");
+    expect(r.meanError * 20 < r.latestMeanError, "straight 1 Hz beats the latest fix");
+
+    r = drive("straight 5 Hz", straightPath, 10000, 200, 60);
+    expect(r.maxError < 0.5, "straight 5 Hz within rounding");
+
+    r = drive("curve 1 Hz", curvePath, 10000, 1000, 60);
+    expect(r.maxError < 1.0, "curve 1 Hz within the chord sag");
+    expect(r.meanError * 10 < r.latestMeanError, "curve 1 Hz beats the latest fix");
+
+    r = drive("curve 5 Hz", curvePath, 10000, 200, 60);
+    expect(r.maxError < 0.5, "curve 5 Hz within rounding");
+
+    r = drive("millis() wrap", straightPath, 0xFFFFFFFFu - 20000, 1000, 60);
+    expect(r.maxError < 0.5, "interpolation across the millis() wrap");
+}
+
+// ============================================================================
+// EDGES
+// ============================================================================
+
+static void checkEdges() {
+    GpsTrack track;
+    int32_t lat, lon;
+    expect(track.positionAt(1000, &lat, &lon) == TRACK_NONE, "empty track has no position");
+
+    // GGA and RMC of one epoch, then a late sentence of an older epoch
+    track.add(1000, 100, 100);
+    track.add(1000, 200, 200);
+    track.add(500, 900, 900);
+    expect(track.size() == 1, "one point per epoch, older epochs ignored");
+    expect(track.at(0).lat == 200, "repeat epoch updates the newest point");
+
+    track.add(2000, 1200, 1200);
+    expect(track.positionAt(1500, &lat, &lon) == TRACK_INTERPOLATED && lat == 700,
+           "midpoint interpolates");
+    expect(track.positionAt(2000, &lat, &lon) == TRACK_INTERPOLATED && lat == 1200,
+           "at the newest fix is final");
+    expect(track.positionAt(2500, &lat, &lon) == TRACK_EXTRAPOLATED && lat == 1700,
+           "after the newest fix extrapolates");
+    expect(track.positionAt(2000 + GPS_TRACK_MAX_EXTRAPOLATION + 1, &lat, &lon) == TRACK_NONE,
+           "extrapolation is bounded");
+    expect(track.positionAt(800, &lat, &lon) == TRACK_NEAREST && lat == 200,
+           "before the track takes the oldest fix");
+
+    // Gap wider than GPS_TRACK_MAX_GAP: neighbours are used, the middle is unknown
+    track.add(2000 + GPS_TRACK_MAX_GAP + 4000, 5000, 5000);
+    expect(track.positionAt(3000, &lat, &lon) == TRACK_NEAREST && lat == 1200,
+           "near the start of a gap takes the fix before it");
+    expect(track.positionAt(2000 + GPS_TRACK_MAX_GAP + 3500, &lat, &lon) == TRACK_NEAREST && lat == 5000,
+           "near the end of a gap takes the fix after it");
+    expect(track.positionAt(2000 + (GPS_TRACK_MAX_GAP + 4000) / 2, &lat, &lon) == TRACK_NONE,
+           "middle of a long gap has no position");
+
+    // Ring overwrite keeps the newest GPS_TRACK_SIZE epochs
+    track.clear();
+    for (uint32_t i = 0; i < GPS_TRACK_SIZE * 3; i++) {
+        track.add(i * 1000, i * 10, 0);
+    }
+    uint32_t last = GPS_TRACK_SIZE * 3 - 1;
+    expect(track.size() == GPS_TRACK_SIZE, "ring holds GPS_TRACK_SIZE points");
+    expect(track.at(0).time == (last - GPS_TRACK_SIZE + 1) * 1000, "oldest point is overwritten first");
+    expect(track.positionAt(last * 1000 - 10500, &lat, &lon) == TRACK_INTERPOLATED &&
+           lat == (int32_t)(last * 10 - 105), "interpolates after wrapping the ring");
+    expect(track.positionAt((last - GPS_TRACK_SIZE) * 1000 - GPS_TRACK_MAX_EXTRAPOLATION, &lat, &lon) == TRACK_NONE,
+           "overwritten history has no position");
+
+    // Finality as LocationSource::getFixAt() reports it
+    GpsFix latest;
+    latest.valid = true;
+    latest.satellites = 9;
+    GpsFix fix;
+    uint32_t newest = last * 1000;
+    expect(!trackFixAt(track, latest, newest + 400, newest + 500, &fix) && fix.valid,
+           "extrapolated fix waits for the next epoch");
+    expect(trackFixAt(track, latest, newest + 400, newest + 400 + GPS_TRACK_MAX_EXTRAPOLATION + 1, &fix),
+           "overdue next epoch stops the wait");
+    expect(trackFixAt(track, latest, newest - 400, newest, &fix) && fix.satellites == 9,
+           "interpolated fix is final and keeps the receiver details");
+    expect(trackFixAt(track, latest, newest + GPS_TRACK_MAX_EXTRAPOLATION + 1, newest, &fix) && !fix.valid,
+           "no track position means no fix");
+}
+
+// ============================================================================
+// PIPELINE
+// ============================================================================
+
+// Keeps the last stored detection
+class RecordingStore : public DetectionStore {
+public:
+    bool record(const DetectionRecord& rec) override {
+        records++;
+        time = rec.time;
+        valid = rec.fix->valid;
+        lat = toMicrodegrees(rec.fix->latitude);
+        lon = toMicrodegrees(rec.fix->longitude);
+        return false;
+    }
+    bool isKnown(const uint8_t*) override { return false; }
+
+    uint32_t records = 0;
+    uint32_t time = 0;
+    bool valid = false;
+    int32_t lat = 0;
+    int32_t lon = 0;
+};
+
+static WiFiFrame flockBeacon(uint8_t id, uint32_t now) {
+    WiFiFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    const uint8_t mac[6] = {0x02, 0x00, 0x00, 0xaa, 0xbb, id};
+    memcpy(frame.mac, mac, 6);
+    frame.frame_type = 0x80;
+    frame.channel = 6;
+    frame.rssi = -60;
+    snprintf(frame.ssid, sizeof(frame.ssid), "Flock-A1B2C3");
+    frame.ssid_len = strlen(frame.ssid);
+    frame.timestamp = now;
+    return frame;
+}
+
+static void addFix(TrackLocation& location, uint32_t time) {
+    int32_t lat, lon;
+    pathPoint(straightPath, time / 1000.0, &lat, &lon);
+    location.addFix(time, fromMicrodegrees(lat), fromMicrodegrees(lon));
+}
+
+static void checkPipeline() {
+    TrackLocation location;
+    RecordingStore store;
+    CountingAlerts alerts;
+    StreamEventSink events;
+    HalContext hal = {&location, &store, &alerts, &events};
+    PipelineConfig config;
+    detectionPipeline.begin(hal, config);
+
+    addFix(location, 1000);
+    addFix(location, 2000);
+    nativeSetTime(2500 * 1000);
+    expect(detectionPipeline.processWiFi(flockBeacon(1, 2400)), "beacon detected");
+    expect(events.getEvents() == 1 && alerts.getDetected() == 1, "event and alert are not delayed");
+    expect(store.records == 0, "extrapolated position is not stored");
+
+    detectionPipeline.resolvePending();
+    expect(detectionPipeline.getPendingCount() == 1, "waits until the next fix");
+
+    addFix(location, 3000);
+    nativeSetTime(3050 * 1000);
+    detectionPipeline.resolvePending();
+    expect(store.records == 1 && detectionPipeline.getPendingCount() == 0, "stored after the next fix");
+    expect(store.time == 2400, "stored with the capture time");
+    double error = errorMeters(straightPath, 2.4, store.lat, store.lon);
+    printf("[Track] Pipeline: stored %.2f m from the true position at capture\n", error);
+    expect(store.valid && error < 0.5, "stored position interpolated at the capture time");
+
+    // The receiver goes quiet: stored with the extrapolated position once overdue
+    expect(detectionPipeline.processWiFi(flockBeacon(2, 3100)), "second beacon detected");
+    detectionPipeline.resolvePending();
+    expect(store.records == 1, "second beacon waits");
+    nativeSetTime((3100 + GPS_TRACK_MAX_EXTRAPOLATION + 1) * 1000);
+    detectionPipeline.resolvePending();
+    expect(store.records == 2 && store.valid, "overdue fix stores the extrapolated position");
+}
+
+int runTrack(int, char**) {
+    checkBegin("Track");
+    checkDrives();
+    checkEdges();
+    checkPipeline();
+
+    return checkEnd();
+}
@@ -0,0 +1,162 @@
+#include "camera_index.h"
+#include <stdio.h>
+
+#define CAMERA_PAGE_RECORDS 32          // Records decoded per card read
+
+CameraIndex cameraIndex;
+
+bool CameraIndex::begin(FileReader* reader, const CameraAlertConfig& config) {
+    this->reader = reader;
+    this->config = config;
+    loaded = false;
+    cacheValid = false;
+    cacheCount = 0;
+
+    uint8_t raw[CAMERA_INDEX_HEADER_SIZE];
+    if (!reader->readAt(0, raw, sizeof(raw)) || !cameraReadHeader(raw, &header)) {
+        printf("[Cameras] Index missing or wrong version\n");
+        return false;
+    }
+
+    loaded = true;
+    printf("[Cameras] Index: %u cameras in %u tiles, alert within %u m\n",
+           (unsigned)header.recordCount, (unsigned)header.tileCount, config.alertDistance);
+    return true;
+}
+
+// ============================================================================
+// DIRECTORY SEARCH
+// ============================================================================
+
+bool CameraIndex::readDirEntry(uint32_t index, uint32_t* key, uint32_t* firstRecord) {
+    uint8_t raw[CAMERA_INDEX_DIR_ENTRY_SIZE];
+    if (!reader->readAt(cameraDirOffset(index), raw, sizeof(raw))) return false;
+    cameraReadDirEntry(raw, key, firstRecord);
+    return true;
+}
+
+uint32_t CameraIndex::lowerBound(uint32_t key) {
+    uint32_t lo = 0;
+    uint32_t hi = header.tileCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t midKey, first;
+        if (!readDirEntry(mid, &midKey, &first)) return header.tileCount;
+        if (midKey < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Tiles firstKey..lastKey of one row are adjacent in the directory and
+// their records are one contiguous run
+void CameraIndex::loadTiles(uint32_t firstKey, uint32_t lastKey, int32_t lat, int32_t lon, double radius) {
+    uint32_t index = lowerBound(firstKey);
+    uint32_t key, first;
+    if (index >= header.tileCount || !readDirEntry(index, &key, &first)) return;
+
+    while (key <= lastKey) {
+        uint32_t nextKey = 0;
+        uint32_t end = header.recordCount;
+        bool more = index + 1 < header.tileCount;
+        if (more && !readDirEntry(index + 1, &nextKey, &end)) return;
+
+        uint8_t page[CAMERA_PAGE_RECORDS * CAMERA_INDEX_RECORD_SIZE];
+        for (uint32_t r = first; r < end; r += CAMERA_PAGE_RECORDS) {
+            uint32_t n = end - r < CAMERA_PAGE_RECORDS ? end - r : CAMERA_PAGE_RECORDS;
+            if (!reader->readAt(cameraRecordOffset(header, r), page, n * CAMERA_INDEX_RECORD_SIZE)) return;
+
+            for (uint32_t i = 0; i < n; i++) {
+                CameraRecord record;
+                cameraReadRecord(page + i * CAMERA_INDEX_RECORD_SIZE, key, &record);
+                if (geoDistanceMeters(lat, lon, record.lat, record.lon) > radius) continue;
+                if (cacheCount < CAMERA_CACHE_SIZE) cache[cacheCount++] = record;
+                else cacheFull = true;
+            }
+        }
+
+        if (!more) break;
+        index++;
+        key = nextKey;
+        first = end;
+    }
+}
+
+void CameraIndex::reload(int32_t lat, int32_t lon) {
+    double radius = config.alertDistance + config.reloadDistance;
+    int32_t dLat = geoMetersToLatMicrodeg(radius);
+    int32_t dLon = geoMetersToLonMicrodeg(radius, lat);
+    uint32_t south = cameraTileKey(lat - dLat, lon - dLon);
+    uint32_t north = cameraTileKey(lat + dLat, lon + dLon);
+
+    cacheCount = 0;
+    cacheFull = false;
+    for (uint32_t row = south >> 16; row <= north >> 16; row++) {
+        loadTiles((row << 16) | (south & 0xFFFF), (row << 16) | (north & 0xFFFF), lat, lon, radius);
+    }
+
+    if (cacheFull) {
+        printf("[Cameras] More than %u cameras within %.0f m - keeping the first\n",
+               CAMERA_CACHE_SIZE, radius);
+    }
+    cacheLat = lat;
+    cacheLon = lon;
+    cacheValid = true;
+    reloads++;
+}
+
+// ============================================================================
+// ALERTS
+// ============================================================================
+
+bool CameraIndex::recentlyAlerted(const CameraRecord& camera, uint32_t now) {
+    for (int i = 0; i < CAMERA_ALERT_MEMORY; i++) {
+        const RecentAlert& r = recent[i];
+        if (r.lat == camera.lat && r.lon == camera.lon && now - r.time < config.realertTime) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CameraIndex::update(const CameraFix& fix, CameraAlert* alert) {
+    if (!loaded || config.alertDistance == 0) return false;
+
+    if (!cacheValid || geoDistanceMeters(cacheLat, cacheLon, fix.lat, fix.lon) > config.reloadDistance) {
+        reload(fix.lat, fix.lon);
+    }
+
+    // Below walking-ish speed the GPS course is noise: any direction counts
+    bool moving = fix.hasCourse && fix.speedKmh >= config.minSpeed;
+    uint32_t now = halMillis();
+    int best = -1;
+    double bestDistance = config.alertDistance;
+    double bestBearing = 0;
+
+    for (int i = 0; i < cacheCount; i++) {
+        const CameraRecord& camera = cache[i];
+        double distance = geoDistanceMeters(fix.lat, fix.lon, camera.lat, camera.lon);
+        if (distance > bestDistance) continue;
+
+        double bearing = geoBearingDegrees(fix.lat, fix.lon, camera.lat, camera.lon);
+        if (moving && geoBearingDifference(bearing, fix.course) > config.aheadAngle) continue;
+        if (recentlyAlerted(camera, now)) continue;
+
+        best = i;
+        bestDistance = distance;
+        bestBearing = bearing;
+    }
+    if (best < 0) return false;
+
+    RecentAlert& slot = recent[recentNext];
+    slot.lat = cache[best].lat;
+    slot.lon = cache[best].lon;
+    slot.time = now;
+    recentNext = (recentNext + 1) % CAMERA_ALERT_MEMORY;
+
+    alert->camera = cache[best];
+    alert->distance = (uint16_t)bestDistance;
+    alert->bearing = (uint16_t)bestBearing % 360;
+    alerts++;
+    return true;
+}
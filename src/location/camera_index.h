@@ -0,0 +1,99 @@
+#ifndef CAMERA_INDEX_H
+#define CAMERA_INDEX_H
+
+#include <stdint.h>
+#include "camera_index_format.h"
+#include "hal/hal.h"
+
+// ============================================================================
+// KNOWN CAMERA LOOKUP
+// ============================================================================
+//
+// Raises "known camera ahead" alerts from the camera index on the SD card
+// (camera_index_format.h) before any RF contact.
+//
+// Only the tiles around the current fix are held in RAM. When the fix has
+// moved more than reloadDistance from where the cache was filled, the tiles
+// covering alertDistance + reloadDistance are found by binary search over
+// the on-card directory (one row of tiles per search, log2(tiles) 8-byte
+// reads each) and their record pages read in. Between reloads a fix costs
+// a scan of the cached records and no card access.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define CAMERA_CACHE_SIZE 256           // Records held around the last reload
+#define CAMERA_ALERT_MEMORY 8           // Recently alerted cameras not repeated
+
+struct CameraAlertConfig {
+    uint16_t alertDistance = 300;       // m
+    uint16_t reloadDistance = 500;      // m moved before the cache is refilled
+    uint8_t aheadAngle = 60;            // +/- degrees from course counted as ahead
+    uint8_t minSpeed = 8;               // km/h; slower and the course is ignored
+    uint32_t realertTime = 600000;      // ms before the same camera alerts again
+};
+
+struct CameraFix {
+    int32_t lat;                        // Microdegrees
+    int32_t lon;
+    bool hasCourse;
+    float course;                       // Degrees, 0 = north
+    float speedKmh;
+};
+
+struct CameraAlert {
+    CameraRecord camera;
+    uint16_t distance;                  // m
+    uint16_t bearing;                   // From the fix, 0 = north
+};
+
+class CameraIndex {
+public:
+    // Reads and checks the header; reader must outlive the index
+    bool begin(FileReader* reader, const CameraAlertConfig& config);
+    bool isLoaded() { return loaded; }
+
+    // Call per GPS fix. Returns true and fills alert when a camera not
+    // alerted recently is within alertDistance (and ahead when moving).
+    bool update(const CameraFix& fix, CameraAlert* alert);
+
+    uint32_t getCameraCount() { return header.recordCount; }
+    uint32_t getTileCount() { return header.tileCount; }
+    uint16_t getCachedCount() { return cacheCount; }
+    uint32_t getReloads() { return reloads; }
+    uint32_t getAlerts() { return alerts; }
+
+private:
+    FileReader* reader = nullptr;
+    CameraAlertConfig config;
+    CameraIndexHeader header = {0, 0};
+    bool loaded = false;
+
+    CameraRecord cache[CAMERA_CACHE_SIZE];
+    uint16_t cacheCount = 0;
+    bool cacheValid = false;
+    bool cacheFull = false;             // Area had more cameras than fit
+    int32_t cacheLat = 0;
+    int32_t cacheLon = 0;
+
+    struct RecentAlert {
+        int32_t lat;
+        int32_t lon;
+        uint32_t time;
+    };
+    RecentAlert recent[CAMERA_ALERT_MEMORY] = {};
+    uint8_t recentNext = 0;
+
+    uint32_t reloads = 0;
+    uint32_t alerts = 0;
+
+    bool readDirEntry(uint32_t index, uint32_t* key, uint32_t* firstRecord);
+    uint32_t lowerBound(uint32_t key);  // First directory entry with key >= key
+    uint32_t recordsEnd(uint32_t index);
+    void reload(int32_t lat, int32_t lon);
+    void loadTiles(uint32_t firstKey, uint32_t lastKey, int32_t lat, int32_t lon, double radius);
+    bool recentlyAlerted(const CameraRecord& camera, uint32_t now);
+};
+
+extern CameraIndex cameraIndex;
+
+#endif // CAMERA_INDEX_H
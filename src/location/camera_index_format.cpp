@@ -0,0 +1,97 @@
+#include "camera_index_format.h"
+
+static const int32_t LAT_OFFSET = 90 * 1000000;    // Rows/cols count from -90 / -180
+static const int32_t LON_OFFSET = 180 * 1000000;
+
+static void putU16(uint8_t* out, uint16_t v) {
+    out[0] = v & 0xFF;
+    out[1] = v >> 8;
+}
+
+static void putU32(uint8_t* out, uint32_t v) {
+    out[0] = v & 0xFF;
+    out[1] = (v >> 8) & 0xFF;
+    out[2] = (v >> 16) & 0xFF;
+    out[3] = (v >> 24) & 0xFF;
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+const char* cameraKindName(CameraKind kind) {
+    switch (kind) {
+        case CAMERA_FLOCK_WIFI: return "flock_wifi";
+        case CAMERA_FLOCK_BLE:  return "flock_ble";
+        case CAMERA_ALPR:       return "alpr";
+        case CAMERA_CCTV:       return "cctv";
+        default:                return "unknown";
+    }
+}
+
+uint32_t cameraTileKey(int32_t lat, int32_t lon) {
+    uint32_t row = (uint32_t)(lat + LAT_OFFSET) / CAMERA_TILE_MICRODEG;
+    uint32_t col = (uint32_t)(lon + LON_OFFSET) / CAMERA_TILE_MICRODEG;
+    return (row << 16) | (col & 0xFFFF);
+}
+
+void cameraTileOrigin(uint32_t key, int32_t* lat, int32_t* lon) {
+    *lat = (int32_t)(key >> 16) * CAMERA_TILE_MICRODEG - LAT_OFFSET;
+    *lon = (int32_t)(key & 0xFFFF) * CAMERA_TILE_MICRODEG - LON_OFFSET;
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+void cameraWriteHeader(uint8_t* out, const CameraIndexHeader& header) {
+    for (int i = 0; i < CAMERA_INDEX_HEADER_SIZE; i++) out[i] = 0;
+    putU32(out, CAMERA_INDEX_MAGIC);
+    putU16(out + 4, CAMERA_INDEX_VERSION);
+    putU16(out + 6, CAMERA_INDEX_RECORD_SIZE);
+    putU32(out + 8, CAMERA_TILE_MICRODEG);
+    putU32(out + 12, header.tileCount);
+    putU32(out + 16, header.recordCount);
+}
+
+bool cameraReadHeader(const uint8_t* in, CameraIndexHeader* header) {
+    if (getU32(in) != CAMERA_INDEX_MAGIC) return false;
+    if (getU16(in + 4) != CAMERA_INDEX_VERSION) return false;
+    if (getU16(in + 6) != CAMERA_INDEX_RECORD_SIZE) return false;
+    if (getU32(in + 8) != CAMERA_TILE_MICRODEG) return false;
+    header->tileCount = getU32(in + 12);
+    header->recordCount = getU32(in + 16);
+    return true;
+}
+
+void cameraWriteDirEntry(uint8_t* out, uint32_t key, uint32_t firstRecord) {
+    putU32(out, key);
+    putU32(out + 4, firstRecord);
+}
+
+void cameraReadDirEntry(const uint8_t* in, uint32_t* key, uint32_t* firstRecord) {
+    *key = getU32(in);
+    *firstRecord = getU32(in + 4);
+}
+
+void cameraWriteRecord(uint8_t* out, const CameraRecord& record) {
+    int32_t originLat, originLon;
+    cameraTileOrigin(cameraTileKey(record.lat, record.lon), &originLat, &originLon);
+    putU16(out, (uint16_t)(record.lat - originLat));
+    putU16(out + 2, (uint16_t)(record.lon - originLon));
+    out[4] = record.kind;
+    out[5] = 0;                 // Flags (reserved)
+}
+
+void cameraReadRecord(const uint8_t* in, uint32_t tileKey, CameraRecord* record) {
+    int32_t originLat, originLon;
+    cameraTileOrigin(tileKey, &originLat, &originLon);
+    record->lat = originLat + getU16(in);
+    record->lon = originLon + getU16(in + 2);
+    record->kind = (CameraKind)in[4];
+}
@@ -0,0 +1,80 @@
+#ifndef CAMERA_INDEX_FORMAT_H
+#define CAMERA_INDEX_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "geo.h"
+
+// ============================================================================
+// CAMERA INDEX FORMAT
+// ============================================================================
+//
+// Known camera positions compiled from datasets/ by the host tool
+// (`program camindex`) into /cameras.idx on the SD card:
+//
+//   header     32 bytes (magic, version, counts)
+//   directory  tile_count x {u32 tile key, u32 first record}, sorted by key
+//   records    record_count x {u16 lat offset, u16 lon offset, u8 kind, u8 flags}
+//
+// The world is cut into CAMERA_TILE_MICRODEG (0.01 deg, about 1.1 km) tiles;
+// a tile key is (row << 16) | col, so keys sort row-major and a tile's
+// records are one contiguous page. Offsets are microdegrees from the tile's
+// south-west corner (< 10000, ~0.1 m resolution). A tile's record count is
+// the next entry's first record minus its own.
+//
+// All integers little-endian.
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define CAMERA_INDEX_MAGIC 0x49435946        // "FYCI"
+#define CAMERA_INDEX_VERSION 1
+#define CAMERA_INDEX_HEADER_SIZE 32
+#define CAMERA_INDEX_DIR_ENTRY_SIZE 8
+#define CAMERA_INDEX_RECORD_SIZE 6
+#define CAMERA_TILE_MICRODEG 10000
+#define CAMERA_INDEX_FILE "/cameras.idx"
+
+// Where a position came from
+enum CameraKind : uint8_t {
+    CAMERA_UNKNOWN = 0,
+    CAMERA_FLOCK_WIFI = 1,      // WiGLE WiFi sighting of a Flock camera
+    CAMERA_FLOCK_BLE = 2,       // WiGLE BLE sighting (FS Ext Battery, Penguin)
+    CAMERA_ALPR = 3,            // Mapped ALPR camera (Pigvision.csv)
+    CAMERA_CCTV = 4             // Municipal camera list (maximum_dots.csv)
+};
+
+struct CameraIndexHeader {
+    uint32_t tileCount;
+    uint32_t recordCount;
+};
+
+struct CameraRecord {
+    int32_t lat;                // Microdegrees
+    int32_t lon;
+    CameraKind kind;
+};
+
+const char* cameraKindName(CameraKind kind);
+
+// Tile containing a position, and a tile's south-west corner
+uint32_t cameraTileKey(int32_t lat, int32_t lon);
+void cameraTileOrigin(uint32_t key, int32_t* lat, int32_t* lon);
+
+void cameraWriteHeader(uint8_t* out, const CameraIndexHeader& header);
+bool cameraReadHeader(const uint8_t* in, CameraIndexHeader* header);
+
+void cameraWriteDirEntry(uint8_t* out, uint32_t key, uint32_t firstRecord);
+void cameraReadDirEntry(const uint8_t* in, uint32_t* key, uint32_t* firstRecord);
+
+// Records are stored relative to their tile
+void cameraWriteRecord(uint8_t* out, const CameraRecord& record);
+void cameraReadRecord(const uint8_t* in, uint32_t tileKey, CameraRecord* record);
+
+// File offsets
+inline uint32_t cameraDirOffset(uint32_t index) {
+    return CAMERA_INDEX_HEADER_SIZE + index * CAMERA_INDEX_DIR_ENTRY_SIZE;
+}
+inline uint32_t cameraRecordOffset(const CameraIndexHeader& header, uint32_t index) {
+    return cameraDirOffset(header.tileCount) + index * CAMERA_INDEX_RECORD_SIZE;
+}
+
+#endif // CAMERA_INDEX_FORMAT_H
@@ -0,0 +1,68 @@
+#include "emitter_estimate.h"
+#include <math.h>
+
+static const float METERS_PER_MICRODEGREE = 0.111195f;     // Along a meridian
+static const float MICRODEG_TO_RAD = 3.14159265f / 180.0f / 1000000.0f;
+
+#define EMITTER_RSSI_MIN -100
+#define EMITTER_RSSI_MAX -20            // Anything stronger is treated as this
+
+static float sightingWeight(int8_t rssi) {
+    int r = rssi;
+    if (r < EMITTER_RSSI_MIN) r = EMITTER_RSSI_MIN;
+    if (r > EMITTER_RSSI_MAX) r = EMITTER_RSSI_MAX;     // Also catches 0 = unknown
+    return powf(10.0f, 3.0f * (r - EMITTER_RSSI_REF) / (10.0f * EMITTER_PATH_LOSS));   // 1/d^3
+}
+
+// Meters per microdegree of longitude at the anchor
+static float lonScale(int32_t lat) {
+    return METERS_PER_MICRODEGREE * cosf(lat * MICRODEG_TO_RAD);
+}
+
+void EmitterEstimate::clear() {
+    anchorLat = anchorLon = 0;
+    weight = north = east = squares = 0;
+}
+
+void EmitterEstimate::add(int32_t lat, int32_t lon, int8_t rssi) {
+    if (weight <= 0) {
+        clear();
+        anchorLat = lat;
+        anchorLon = lon;
+    }
+
+    float w = sightingWeight(rssi);
+    float n = (lat - anchorLat) * METERS_PER_MICRODEGREE;
+    float e = (lon - anchorLon) * lonScale(anchorLat);
+    weight += w;
+    north += w * n;
+    east += w * e;
+    squares += w * (n * n + e * e);
+}
+
+float EmitterEstimate::spread() const {
+    if (weight <= 0) return 0;
+    float n = north / weight;
+    float e = east / weight;
+    float s = squares / weight - (n * n + e * e);
+    return s > 0 ? s : 0;       // Rounding can leave a tiny negative
+}
+
+bool EmitterEstimate::get(int32_t* lat, int32_t* lon, float* radius) const {
+    if (weight <= 0) return false;
+
+    *lat = anchorLat + (int32_t)lroundf(north / weight / METERS_PER_MICRODEGREE);
+    *lon = anchorLon + (int32_t)lroundf(east / weight / lonScale(anchorLat));
+    float r = sqrtf(spread());
+    *radius = r > EMITTER_MIN_RADIUS ? r : EMITTER_MIN_RADIUS;
+    return true;
+}
+
+void EmitterEstimate::restore(int32_t lat, int32_t lon, float weight, float spread) {
+    clear();
+    if (weight <= 0) return;
+    anchorLat = lat;
+    anchorLon = lon;
+    this->weight = weight;
+    squares = weight * spread;  // Sums about the centroid: the offsets cancel
+}
@@ -0,0 +1,53 @@
+#ifndef EMITTER_ESTIMATE_H
+#define EMITTER_ESTIMATE_H
+
+#include <stdint.h>
+
+// ============================================================================
+// EMITTER ESTIMATE
+// ============================================================================
+//
+// Where a device probably is, from the positions it was heard at: a centroid
+// of the sightings weighted by received power. On a log-distance path-loss
+// model the weight 10^(3 * (rssi - EMITTER_RSSI_REF) / (10 * EMITTER_PATH_LOSS))
+// is proportional to 1/d^3, so the sightings closest to the emitter count
+// most and a drive-by centres on the point of closest approach. (1/d^2
+// lets the many far sightings along a road widen the radius; 1/d^4 lets
+// shadowing on the few near ones move the centroid.)
+//
+// The state is fixed-size (weighted sums of offsets from the first sighting,
+// in meters) and add() is O(1), so a camera passed every day never grows.
+// The uncertainty radius is the weighted RMS distance of the sightings from
+// the centroid, at least EMITTER_MIN_RADIUS. The centroid, total weight and
+// spread are enough to restore() the state after a reboot.
+//
+// Float math throughout: the ESP32 has a single-precision FPU.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define EMITTER_RSSI_REF -60            // dBm given weight 1
+#define EMITTER_PATH_LOSS 2.5f          // Log-distance exponent (2 = free space)
+#define EMITTER_MIN_RADIUS 20.0f        // m; one road cannot tell which side the emitter is on
+
+struct EmitterEstimate {
+    int32_t anchorLat;                  // Microdegrees, first sighting (or restored centroid)
+    int32_t anchorLon;
+    float weight;                       // Sum of weights, 0 = no sightings
+    float north;                        // Weighted sums of offsets from the anchor (m)
+    float east;
+    float squares;                      // Weighted sum of squared offsets (m^2)
+
+    void clear();
+    void add(int32_t lat, int32_t lon, int8_t rssi);
+
+    // Centroid and uncertainty radius (m); false without sightings
+    bool get(int32_t* lat, int32_t* lon, float* radius) const;
+
+    // Weighted mean squared distance of the sightings from the centroid (m^2)
+    float spread() const;
+
+    // State equivalent to one with this centroid, total weight and spread
+    void restore(int32_t lat, int32_t lon, float weight, float spread);
+};
+
+#endif // EMITTER_ESTIMATE_H
@@ -0,0 +1,43 @@
+#include "geo.h"
+#include <math.h>
+
+static const double EARTH_RADIUS_M = 6371000.0;
+static const double MICRODEG_TO_RAD = M_PI / 180.0 / 1000000.0;
+
+int32_t toMicrodegrees(double degrees) {
+    return (int32_t)lround(degrees * 1000000.0);
+}
+
+double fromMicrodegrees(int32_t microdegrees) {
+    return microdegrees / 1000000.0;
+}
+
+double geoDistanceMeters(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2) {
+    double meanLat = (lat1 + (double)lat2) / 2 * MICRODEG_TO_RAD;
+    double x = (lon2 - (double)lon1) * MICRODEG_TO_RAD * cos(meanLat);
+    double y = (lat2 - (double)lat1) * MICRODEG_TO_RAD;
+    return sqrt(x * x + y * y) * EARTH_RADIUS_M;
+}
+
+double geoBearingDegrees(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2) {
+    double meanLat = (lat1 + (double)lat2) / 2 * MICRODEG_TO_RAD;
+    double x = (lon2 - (double)lon1) * cos(meanLat);
+    double y = lat2 - (double)lat1;
+    double bearing = atan2(x, y) * 180.0 / M_PI;
+    return bearing < 0 ? bearing + 360.0 : bearing;
+}
+
+double geoBearingDifference(double a, double b) {
+    double d = fmod(fabs(a - b), 360.0);
+    return d > 180.0 ? 360.0 - d : d;
+}
+
+int32_t geoMetersToLatMicrodeg(double meters) {
+    return (int32_t)ceil(meters / EARTH_RADIUS_M / MICRODEG_TO_RAD);
+}
+
+int32_t geoMetersToLonMicrodeg(double meters, int32_t latitude) {
+    double c = cos(latitude * MICRODEG_TO_RAD);
+    if (c < 0.01) c = 0.01;  // Poles
+    return (int32_t)ceil(meters / (EARTH_RADIUS_M * c) / MICRODEG_TO_RAD);
+}
@@ -0,0 +1,29 @@
+#ifndef GEO_H
+#define GEO_H
+
+#include <stdint.h>
+
+// ============================================================================
+// GEO HELPERS
+// ============================================================================
+//
+// Positions as int32 microdegrees (~0.11 m at the equator). Distances use the
+// equirectangular approximation, accurate to well under 1% at the few-km
+// ranges the firmware deals with.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+int32_t toMicrodegrees(double degrees);
+double fromMicrodegrees(int32_t microdegrees);
+
+double geoDistanceMeters(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);
+double geoBearingDegrees(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);  // 0 = north
+
+// Smallest difference between two bearings (0-180)
+double geoBearingDifference(double a, double b);
+
+// Microdegrees spanned by a distance (longitude shrinks with latitude)
+int32_t geoMetersToLatMicrodeg(double meters);
+int32_t geoMetersToLonMicrodeg(double meters, int32_t latitude);
+
+#endif // GEO_H
@@ -0,0 +1,49 @@
+#ifndef GPS_SNAPSHOT_H
+#define GPS_SNAPSHOT_H
+
+#include <stdint.h>
+#include <atomic>
+#include "hal/hal.h"
+
+// ============================================================================
+// GPS FIX SNAPSHOT
+// ============================================================================
+//
+// Latest fix, written by the GPS task and read by any task without locks.
+// Two slots: publish() fills the one readers are not pointed at, then
+// swaps the version with a release store. A reader copies the current slot
+// and retries only if a whole publish finished during the copy, so it never
+// waits on a writer that was preempted half-way.
+//
+// Exactly one context may call publish().
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+class GpsSnapshot {
+public:
+    void publish(const GpsFix& fix) {
+        uint32_t v = version.load(std::memory_order_relaxed);
+        slots[(v + 1) & 1] = fix;
+        version.store(v + 1, std::memory_order_release);
+    }
+
+    void read(GpsFix* out) const {
+        uint32_t v = version.load(std::memory_order_acquire);
+        while (true) {
+            *out = slots[v & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t now = version.load(std::memory_order_relaxed);
+            if (now == v) return;
+            v = now;                    // Slot may have been rewritten; copy the new one
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+    }
+
+    uint32_t getVersion() const { return version.load(std::memory_order_acquire); }  // Fixes published
+
+private:
+    std::atomic<uint32_t> version{0};
+    GpsFix slots[2];
+};
+
+#endif // GPS_SNAPSHOT_H
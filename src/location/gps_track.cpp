@@ -0,0 +1,110 @@
+#include "gps_track.h"
+#include "geo.h"
+
+const TrackPoint& GpsTrack::at(uint32_t i) const {
+    return points[(head + GPS_TRACK_SIZE - count + i) % GPS_TRACK_SIZE];
+}
+
+void GpsTrack::add(uint32_t time, int32_t lat, int32_t lon) {
+    if (count > 0) {
+        TrackPoint& newest = points[(head + GPS_TRACK_SIZE - 1) % GPS_TRACK_SIZE];
+        int32_t step = (int32_t)(time - newest.time);
+        if (step < 0) return;
+        if (step == 0) {                        // Another sentence of the same epoch
+            newest.lat = lat;
+            newest.lon = lon;
+            return;
+        }
+    }
+
+    points[head] = {time, lat, lon};
+    head = (head + 1) % GPS_TRACK_SIZE;
+    if (count < GPS_TRACK_SIZE) count++;
+}
+
+// a + (b - a) * t / span, rounded
+static int32_t lerp(int32_t a, int32_t b, int32_t t, int32_t span) {
+    int64_t delta = (int64_t)(b - a) * t;
+    delta += delta >= 0 ? span / 2 : -(span / 2);
+    return a + (int32_t)(delta / span);
+}
+
+TrackResult GpsTrack::positionAt(uint32_t time, int32_t* lat, int32_t* lon) const {
+    if (count == 0) return TRACK_NONE;
+
+    int32_t target = age(time);
+    const TrackPoint& oldest = at(0);
+    const TrackPoint& newest = at(count - 1);
+
+    // Before the whole track (should not happen for fresh detections)
+    if (target < 0) {
+        if (-target > GPS_TRACK_MAX_EXTRAPOLATION) return TRACK_NONE;
+        *lat = oldest.lat;
+        *lon = oldest.lon;
+        return TRACK_NEAREST;
+    }
+
+    // After the newest fix: carry on along the last segment
+    int32_t newestAge = age(newest.time);
+    if (target >= newestAge) {
+        int32_t past = target - newestAge;
+        if (past > GPS_TRACK_MAX_EXTRAPOLATION) return TRACK_NONE;
+        *lat = newest.lat;
+        *lon = newest.lon;
+        if (count >= 2 && past > 0) {
+            const TrackPoint& previous = at(count - 2);
+            int32_t span = (int32_t)(newest.time - previous.time);
+            if (span <= GPS_TRACK_MAX_GAP) {
+                *lat = lerp(previous.lat, newest.lat, span + past, span);
+                *lon = lerp(previous.lon, newest.lon, span + past, span);
+            }
+        }
+        return past == 0 ? TRACK_INTERPOLATED : TRACK_EXTRAPOLATED;
+    }
+
+    // Last point at or before the target: lo
+    uint32_t lo = 0;
+    uint32_t hi = count - 1;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (age(at(mid).time) <= target) lo = mid;
+        else hi = mid;
+    }
+
+    const TrackPoint& a = at(lo);
+    const TrackPoint& b = at(hi);
+    int32_t span = (int32_t)(b.time - a.time);
+    int32_t offset = target - age(a.time);
+    if (span > GPS_TRACK_MAX_GAP) {
+        bool first = offset <= span - offset;
+        if ((first ? offset : span - offset) > GPS_TRACK_MAX_EXTRAPOLATION) return TRACK_NONE;
+        const TrackPoint& closest = first ? a : b;
+        *lat = closest.lat;
+        *lon = closest.lon;
+        return TRACK_NEAREST;
+    }
+    *lat = lerp(a.lat, b.lat, offset, span);
+    *lon = lerp(a.lon, b.lon, offset, span);
+    return TRACK_INTERPOLATED;
+}
+
+bool trackFixAt(const GpsTrack& track, const GpsFix& latest, uint32_t time, uint32_t now, GpsFix* out) {
+    *out = latest;
+    int32_t lat, lon;
+    TrackResult result = track.positionAt(time, &lat, &lon);
+    if (result == TRACK_NONE) {
+        if (out->valid) {
+            out->valid = false;                 // Track ended long before (or after) that time
+            out->hasCourse = false;
+            out->status = "LOST";
+        }
+        return true;
+    }
+
+    out->valid = true;
+    out->status = "FIX";
+    out->latitude = fromMicrodegrees(lat);
+    out->longitude = fromMicrodegrees(lon);
+    if (result != TRACK_EXTRAPOLATED) return true;
+    return (int32_t)(now - time) > GPS_TRACK_MAX_EXTRAPOLATION;
+}
@@ -0,0 +1,63 @@
+#ifndef GPS_TRACK_H
+#define GPS_TRACK_H
+
+#include <stdint.h>
+#include "hal/hal.h"
+
+// ============================================================================
+// GPS TRACK
+// ============================================================================
+//
+// Ring of the most recent fixes (one point per receiver epoch), used to
+// place a detection where the device was when the packet was captured
+// rather than where the last fix said. Times are halMillis(); comparisons
+// are relative to the oldest point, so millis() wrap-around is harmless.
+//
+// positionAt() binary-searches the ring: between two fixes (no more than
+// GPS_TRACK_MAX_GAP apart) it interpolates linearly; after the newest fix it
+// extrapolates from the last two, up to GPS_TRACK_MAX_EXTRAPOLATION.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define GPS_TRACK_SIZE 64                   // 64 s at 1 Hz, 12 s at 5 Hz
+#define GPS_TRACK_MAX_GAP 5000              // ms; wider gaps are not bridged
+#define GPS_TRACK_MAX_EXTRAPOLATION 3000    // ms past the newest fix (GPS_FIX_TIMEOUT)
+
+enum TrackResult : uint8_t {
+    TRACK_NONE = 0,                 // No usable fix near that time
+    TRACK_INTERPOLATED = 1,         // Between two fixes (final)
+    TRACK_EXTRAPOLATED = 2,         // After the newest fix (improves once the next arrives)
+    TRACK_NEAREST = 3               // Next to a gap or before the track: closest fix (final)
+};
+
+struct TrackPoint {
+    uint32_t time;                  // halMillis() of the epoch
+    int32_t lat;                    // Microdegrees
+    int32_t lon;
+};
+
+class GpsTrack {
+public:
+    // Appends a fix; a repeat of the newest epoch updates it, older ones are ignored
+    void add(uint32_t time, int32_t lat, int32_t lon);
+    void clear() { count = 0; }
+
+    TrackResult positionAt(uint32_t time, int32_t* lat, int32_t* lon) const;
+
+    uint32_t size() const { return count; }
+    const TrackPoint& at(uint32_t i) const;     // 0 = oldest
+
+private:
+    TrackPoint points[GPS_TRACK_SIZE];
+    uint32_t head = 0;              // Next write slot
+    uint32_t count = 0;
+
+    int32_t age(uint32_t time) const { return (int32_t)(time - at(0).time); }
+};
+
+// Fix at a capture time for LocationSource::getFixAt(): the track's position
+// with everything else from the latest fix. Returns true when final, i.e.
+// not extrapolated or the next fix is overdue.
+bool trackFixAt(const GpsTrack& track, const GpsFix& latest, uint32_t time, uint32_t now, GpsFix* out);
+
+#endif // GPS_TRACK_H
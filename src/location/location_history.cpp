@@ -0,0 +1,71 @@
+#include "location_history.h"
+#include <stdlib.h>
+
+LocationHistory::~LocationHistory() {
+    free(pool);
+    free(freeIds);
+}
+
+bool LocationHistory::init(uint32_t capacity) {
+    if (capacity > LOCATION_NONE) capacity = LOCATION_NONE;
+
+    free(pool);
+    free(freeIds);
+    pool = (Ring*)calloc(capacity, sizeof(Ring));
+    freeIds = (uint16_t*)calloc(capacity, sizeof(uint16_t));
+    if (!pool || !freeIds) {
+        rings = freeCount = 0;
+        return false;
+    }
+
+    // Hand out ids from the low end first
+    rings = capacity;
+    freeCount = capacity;
+    for (uint32_t i = 0; i < capacity; i++) {
+        freeIds[i] = capacity - 1 - i;
+    }
+    return true;
+}
+
+bool LocationHistory::acquire(uint16_t* id) {
+    if (*id != LOCATION_NONE) return true;
+    if (freeCount == 0) return false;
+    *id = freeIds[--freeCount];
+    pool[*id].head = 0;
+    pool[*id].count = 0;
+    pool[*id].estimate.clear();
+    return true;
+}
+
+bool LocationHistory::add(uint16_t* id, int32_t lat, int32_t lon) {
+    if (!acquire(id)) return false;
+
+    Ring& ring = pool[*id];
+    for (uint8_t i = 0; i < ring.count; i++) {
+        if (geoDistanceMeters(ring.points[i].lat, ring.points[i].lon, lat, lon) < LOCATION_MIN_SPACING) {
+            return false;
+        }
+    }
+
+    ring.points[ring.head].lat = lat;
+    ring.points[ring.head].lon = lon;
+    ring.head = (ring.head + 1) % LOCATION_HISTORY_DEPTH;
+    if (ring.count < LOCATION_HISTORY_DEPTH) ring.count++;
+    return true;
+}
+
+void LocationHistory::release(uint16_t id) {
+    if (id == LOCATION_NONE || id >= rings) return;
+    pool[id].count = 0;
+    freeIds[freeCount++] = id;
+}
+
+uint8_t LocationHistory::count(uint16_t id) const {
+    return id < rings ? pool[id].count : 0;
+}
+
+GeoPoint LocationHistory::at(uint16_t id, uint8_t index) const {
+    const Ring& ring = pool[id];
+    uint8_t oldest = (ring.head + LOCATION_HISTORY_DEPTH - ring.count) % LOCATION_HISTORY_DEPTH;
+    return ring.points[(oldest + index) % LOCATION_HISTORY_DEPTH];
+}
@@ -0,0 +1,78 @@
+#ifndef LOCATION_HISTORY_H
+#define LOCATION_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "emitter_estimate.h"
+#include "geo.h"
+
+// ============================================================================
+// LOCATION HISTORY
+// ============================================================================
+//
+// Where each device has been seen: a preallocated pool of fixed-size rings of
+// int32 microdegree points, one ring per device that has a fix. The owner
+// keeps the ring id (DeviceRecord::location_id); LOCATION_NONE until the
+// first point. A point within LOCATION_MIN_SPACING of one already stored is
+// dropped, so parking next to a camera adds one point, not one per fix.
+// When a ring is full the oldest point is overwritten.
+//
+// Each ring also carries the device's EmitterEstimate, which the owner
+// updates with every sighting, including those too close to store.
+//
+// Adding a point is O(LOCATION_HISTORY_DEPTH) with no allocation; all memory
+// is taken once in init().
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define LOCATION_HISTORY_DEPTH 8        // Points kept per device
+#define LOCATION_MIN_SPACING 25         // m between stored points
+#define LOCATION_NONE 0xFFFF
+
+struct GeoPoint {
+    int32_t lat;                        // Microdegrees
+    int32_t lon;
+};
+
+class LocationHistory {
+public:
+    ~LocationHistory();
+
+    // Room for `capacity` rings (at most LOCATION_NONE); false on allocation failure
+    bool init(uint32_t capacity);
+
+    // Adds a point to ring *id, taking a free ring when *id is LOCATION_NONE.
+    // Returns false if the point was too close to a stored one or no ring
+    // was free.
+    bool add(uint16_t* id, int32_t lat, int32_t lon);
+    void release(uint16_t id);
+
+    // Takes a free (empty) ring when *id is LOCATION_NONE; false if none is free
+    bool acquire(uint16_t* id);
+
+    // Points of a ring, oldest first
+    uint8_t count(uint16_t id) const;
+    GeoPoint at(uint16_t id, uint8_t index) const;
+
+    // Estimate of ring id, nullptr for LOCATION_NONE
+    EmitterEstimate* estimate(uint16_t id) { return id < rings ? &pool[id].estimate : nullptr; }
+    const EmitterEstimate* estimate(uint16_t id) const { return id < rings ? &pool[id].estimate : nullptr; }
+
+    uint32_t capacity() const { return rings; }
+    uint32_t available() const { return freeCount; }
+
+private:
+    struct Ring {
+        GeoPoint points[LOCATION_HISTORY_DEPTH];
+        uint8_t head;                   // Next slot to write
+        uint8_t count;
+        EmitterEstimate estimate;
+    };
+
+    Ring* pool = nullptr;
+    uint16_t* freeIds = nullptr;
+    uint32_t rings = 0;
+    uint32_t freeCount = 0;
+};
+
+#endif // LOCATION_HISTORY_H
@@ -0,0 +1,181 @@
+#include "nmea_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static uint8_t checksum(const char* text, size_t len) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; i++) sum ^= (uint8_t)text[i];
+    return sum;
+}
+
+// "ddmm.mmmm" / "dddmm.mmmm" and hemisphere to signed degrees
+static bool parseCoordinate(const char* value, const char* hemisphere, double* out) {
+    if (!value[0] || !hemisphere[0]) return false;
+    double raw = strtod(value, nullptr);
+    int degrees = (int)(raw / 100);
+    double result = degrees + (raw - degrees * 100) / 60.0;
+    if (hemisphere[0] == 'S' || hemisphere[0] == 'W') result = -result;
+    *out = result;
+    return true;
+}
+
+// "hhmmss.ss"
+static bool parseTime(const char* value, GpsFix* fix) {
+    if (strlen(value) < 6) return false;
+    fix->hour = (value[0] - '0') * 10 + (value[1] - '0');
+    fix->minute = (value[2] - '0') * 10 + (value[3] - '0');
+    fix->second = (value[4] - '0') * 10 + (value[5] - '0');
+    return true;
+}
+
+// "ddmmyy"
+static bool parseDate(const char* value, GpsFix* fix) {
+    if (strlen(value) < 6) return false;
+    fix->day = (value[0] - '0') * 10 + (value[1] - '0');
+    fix->month = (value[2] - '0') * 10 + (value[3] - '0');
+    fix->year = 2000 + (value[4] - '0') * 10 + (value[5] - '0');
+    return true;
+}
+
+// ============================================================================
+// FRAMING
+// ============================================================================
+
+bool NmeaParser::encode(char c) {
+    if (c == '$') {
+        state = NMEA_BODY;
+        length = 0;
+        started = halMillis();
+        return false;
+    }
+    if (state == NMEA_IDLE) return false;
+
+    if (c == '\r' || c == '\n') {
+        state = NMEA_IDLE;
+        return finish();
+    }
+
+    if (length >= NMEA_MAX_SENTENCE - 1) {
+        state = NMEA_IDLE;              // Runaway line (binary data, lost end of line)
+        return false;
+    }
+    sentence[length++] = c;
+
+    // "GPRMC": the type is known after five characters
+    if (length == 5) {
+        bool wanted = memcmp(sentence + 2, "RMC", 3) == 0 || memcmp(sentence + 2, "GGA", 3) == 0;
+        if (!wanted) {
+            skipped++;
+            state = NMEA_IDLE;
+        }
+    }
+    return false;
+}
+
+bool NmeaParser::finish() {
+    sentence[length] = '\0';
+    char* star = strchr(sentence, '*');
+    if (!star || star[1] == '\0' || star[2] == '\0') {
+        checksumErrors++;
+        return false;
+    }
+    int hi = hexValue(star[1]);
+    int lo = hexValue(star[2]);
+    if (hi < 0 || lo < 0 || checksum(sentence, star - sentence) != (hi << 4 | lo)) {
+        checksumErrors++;
+        return false;
+    }
+    *star = '\0';
+
+    char* fields[NMEA_MAX_FIELDS];
+    int count = 0;
+    char* p = sentence;
+    while (count < NMEA_MAX_FIELDS) {
+        fields[count++] = p;
+        char* comma = strchr(p, ',');
+        if (!comma) break;
+        *comma = '\0';
+        p = comma + 1;
+    }
+
+    if (count > 1) markEpoch(fields[1]);
+    if (memcmp(fields[0] + 2, "RMC", 3) == 0) applyRmc(fields, count);
+    else applyGga(fields, count);
+    sentences++;
+    return true;
+}
+
+// ============================================================================
+// SENTENCES
+// ============================================================================
+
+// RMC: type, time, status, lat, N/S, lon, E/W, knots, course, date, ...
+void NmeaParser::applyRmc(char** fields, int count) {
+    if (count < 10) return;
+
+    double lat, lon;
+    fix.valid = fields[2][0] == 'A' &&
+                parseCoordinate(fields[3], fields[4], &lat) &&
+                parseCoordinate(fields[5], fields[6], &lon);
+    if (fix.valid) {
+        fix.latitude = lat;
+        fix.longitude = lon;
+        fix.timestamp = epochStarted;
+    }
+
+    // Some receivers leave the course empty when stationary
+    fix.hasCourse = fix.valid && fields[7][0] && fields[8][0];
+    if (fix.hasCourse) {
+        fix.speedKmh = strtod(fields[7], nullptr) * 1.852;
+        fix.course = strtod(fields[8], nullptr);
+    }
+
+    fix.hasTime = parseTime(fields[1], &fix) && parseDate(fields[9], &fix);
+    updateStatus();
+}
+
+// GGA: type, time, lat, N/S, lon, E/W, quality, satellites, hdop, altitude, ...
+void NmeaParser::applyGga(char** fields, int count) {
+    if (count < 10) return;
+
+    fix.satellites = atoi(fields[7]);
+    double lat, lon;
+    bool valid = atoi(fields[6]) > 0 &&
+                 parseCoordinate(fields[2], fields[3], &lat) &&
+                 parseCoordinate(fields[4], fields[5], &lon);
+    fix.valid = valid;                  // Quality 0 matches an RMC 'V'
+    if (valid) {
+        fix.latitude = lat;
+        fix.longitude = lon;
+        fix.altitude = strtod(fields[9], nullptr);
+        fix.timestamp = epochStarted;
+    }
+    updateStatus();
+}
+
+// GGA and RMC of one epoch carry the same time field; the fix is stamped
+// with the arrival of the first of them
+void NmeaParser::markEpoch(const char* time) {
+    if (strncmp(time, epoch, sizeof(epoch)) == 0) return;
+    snprintf(epoch, sizeof(epoch), "%s", time);
+    epochStarted = started;
+}
+
+void NmeaParser::updateStatus() {
+    if (fix.valid) fix.status = "FIX";
+    else if (fix.satellites > 0) fix.status = "SEARCHING";
+    else fix.status = "NO_GPS";
+}
+
+size_t nmeaFormat(char* out, size_t size, const char* body) {
+    int n = snprintf(out, size, "$%s*%02X\r\n", body, checksum(body, strlen(body)));
+    return n > 0 && (size_t)n < size ? n : 0;
+}
@@ -0,0 +1,59 @@
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hal/hal.h"
+
+// ============================================================================
+// NMEA PARSER
+// ============================================================================
+//
+// Incremental parser for the two sentences the firmware uses: RMC (fix
+// status, position, speed, course, date) and GGA (satellites, altitude).
+// Any talker is accepted ($GP, $GN, $GL...). Other sentences are dropped
+// as soon as their type is known, without buffering or checksumming the
+// rest, so GSV/GSA bursts cost one compare per byte.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define NMEA_MAX_SENTENCE 96            // 82 by the standard; some receivers run longer
+#define NMEA_MAX_FIELDS 20
+
+class NmeaParser {
+public:
+    // Feeds one received byte; true when an RMC or GGA sentence updated the fix
+    bool encode(char c);
+
+    const GpsFix& getFix() const { return fix; }
+
+    uint32_t getSentences() const { return sentences; }          // RMC/GGA applied
+    uint32_t getSkipped() const { return skipped; }              // Other sentence types
+    uint32_t getChecksumErrors() const { return checksumErrors; }
+
+private:
+    enum State : uint8_t { NMEA_IDLE, NMEA_BODY };
+
+    char sentence[NMEA_MAX_SENTENCE];   // Between '$' and end of line
+    uint8_t length = 0;
+    State state = NMEA_IDLE;
+    uint32_t started = 0;               // halMillis() at '$'
+    char epoch[12] = "";                // UTC time field of the current epoch
+    uint32_t epochStarted = 0;          // halMillis() at its first sentence
+    GpsFix fix;
+
+    uint32_t sentences = 0;
+    uint32_t skipped = 0;
+    uint32_t checksumErrors = 0;
+
+    bool finish();
+    void markEpoch(const char* time);
+    void applyRmc(char** fields, int count);
+    void applyGga(char** fields, int count);
+    void updateStatus();
+};
+
+// "$<body>*XX\r\n" with the checksum filled in; returns the length
+size_t nmeaFormat(char* out, size_t size, const char* body);
+
+#endif // NMEA_PARSER_H
@@ -0,0 +1,193 @@
+#include "ubx_parser.h"
+#include <string.h>
+
+static uint16_t readU16(const uint8_t* p) {
+    return p[0] | (uint16_t)p[1] << 8;
+}
+
+static uint32_t readU32(const uint8_t* p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void writeU16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void writeU32(uint8_t* p, uint32_t v) {
+    writeU16(p, v);
+    writeU16(p + 2, v >> 16);
+}
+
+// ============================================================================
+// FRAMING
+// ============================================================================
+
+void UbxParser::checksumByte(uint8_t byte) {
+    ckA += byte;
+    ckB += ckA;
+}
+
+UbxMessage UbxParser::encode(uint8_t byte) {
+    switch (state) {
+        case UBX_WAIT_SYNC_1:
+            if (byte == UBX_SYNC_1) {
+                state = UBX_WAIT_SYNC_2;
+                started = halMillis();
+            }
+            break;
+        case UBX_WAIT_SYNC_2:
+            if (byte == UBX_SYNC_2) {
+                state = UBX_READ_CLASS;
+                ckA = ckB = 0;
+            } else if (byte != UBX_SYNC_1) {
+                state = UBX_WAIT_SYNC_1;
+            }
+            break;
+        case UBX_READ_CLASS:
+            msgClass = byte;
+            checksumByte(byte);
+            state = UBX_READ_ID;
+            break;
+        case UBX_READ_ID:
+            msgId = byte;
+            checksumByte(byte);
+            state = UBX_READ_LENGTH_1;
+            break;
+        case UBX_READ_LENGTH_1:
+            length = byte;
+            checksumByte(byte);
+            state = UBX_READ_LENGTH_2;
+            break;
+        case UBX_READ_LENGTH_2:
+            length |= (uint16_t)byte << 8;
+            checksumByte(byte);
+            received = 0;
+            if (length > UBX_MAX_LENGTH) {
+                state = UBX_WAIT_SYNC_1;    // Corrupt header; do not swallow the stream
+                checksumErrors++;
+            } else {
+                state = length ? UBX_READ_PAYLOAD : UBX_READ_CK_A;
+            }
+            break;
+        case UBX_READ_PAYLOAD:
+            if (received < UBX_MAX_PAYLOAD) payload[received] = byte;
+            received++;
+            checksumByte(byte);
+            if (received == length) state = UBX_READ_CK_A;
+            break;
+        case UBX_READ_CK_A:
+            if (byte != ckA) {
+                checksumErrors++;
+                state = UBX_WAIT_SYNC_1;
+            } else {
+                state = UBX_READ_CK_B;
+            }
+            break;
+        case UBX_READ_CK_B:
+            state = UBX_WAIT_SYNC_1;
+            if (byte != ckB) {
+                checksumErrors++;
+                break;
+            }
+            frames++;
+            return finish();
+    }
+    return UBX_NONE;
+}
+
+UbxMessage UbxParser::finish() {
+    if (length > UBX_MAX_PAYLOAD) return UBX_OTHER;
+
+    if (msgClass == UBX_CLASS_NAV && msgId == UBX_NAV_PVT && length == UBX_NAV_PVT_LENGTH) {
+        applyPvt();
+        return UBX_FIX;
+    }
+    if (msgClass == UBX_CLASS_ACK && length == 2) {
+        ackClass = payload[0];
+        ackId = payload[1];
+        return msgId == UBX_ACK_ACK ? UBX_ACK : UBX_NAK;
+    }
+    return UBX_OTHER;
+}
+
+// ============================================================================
+// NAV-PVT
+// ============================================================================
+
+void UbxParser::applyPvt() {
+    const uint8_t* p = payload;
+    uint8_t validFlags = p[11];
+    uint8_t fixType = p[20];
+    bool fixOk = p[21] & 0x01;
+
+    fix.valid = fixOk && (fixType == 2 || fixType == 3);
+    fix.satellites = p[23];
+    if (fix.valid) {
+        fix.longitude = (int32_t)readU32(p + 24) * 1e-7;
+        fix.latitude = (int32_t)readU32(p + 28) * 1e-7;
+        fix.altitude = (int32_t)readU32(p + 36) / 1000.0;       // Above mean sea level
+        fix.speedKmh = (int32_t)readU32(p + 60) * 0.0036;       // mm/s
+        fix.course = (int32_t)readU32(p + 64) * 1e-5;           // Heading of motion
+        fix.timestamp = started;
+    }
+    fix.hasCourse = fix.valid;
+
+    // validDate and validTime
+    fix.hasTime = (validFlags & 0x03) == 0x03;
+    if (fix.hasTime) {
+        fix.year = readU16(p + 4);
+        fix.month = p[6];
+        fix.day = p[7];
+        fix.hour = p[8];
+        fix.minute = p[9];
+        fix.second = p[10];
+    }
+
+    if (fix.valid) fix.status = "FIX";
+    else if (fix.satellites > 0) fix.status = "SEARCHING";
+    else fix.status = "NO_GPS";
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+size_t ubxFrame(uint8_t msgClass, uint8_t msgId, const uint8_t* payload, uint16_t len, uint8_t* out) {
+    out[0] = UBX_SYNC_1;
+    out[1] = UBX_SYNC_2;
+    out[2] = msgClass;
+    out[3] = msgId;
+    writeU16(out + 4, len);
+    if (len) memcpy(out + 6, payload, len);
+
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < 6 + (size_t)len; i++) {
+        a += out[i];
+        b += a;
+    }
+    out[6 + len] = a;
+    out[7 + len] = b;
+    return len + UBX_FRAME_OVERHEAD;
+}
+
+void ubxCfgMsg(uint8_t* payload, uint8_t msgClass, uint8_t msgId, uint8_t rate) {
+    payload[0] = msgClass;
+    payload[1] = msgId;
+    payload[2] = rate;                  // Per navigation solution; 0 = off
+}
+
+void ubxCfgRate(uint8_t* payload, uint16_t measureMs) {
+    writeU16(payload, measureMs);
+    writeU16(payload + 2, 1);           // One solution per measurement
+    writeU16(payload + 4, 1);           // Aligned to GPS time
+}
+
+void ubxCfgPrtUart(uint8_t* payload, uint32_t baud, bool nmeaOut) {
+    memset(payload, 0, UBX_CFG_PRT_LENGTH);
+    payload[0] = 1;                     // UART1
+    writeU32(payload + 4, 0x000008D0);  // 8 data bits, no parity, 1 stop bit
+    writeU32(payload + 8, baud);
+    writeU16(payload + 12, 0x0003);     // In: UBX + NMEA
+    writeU16(payload + 14, nmeaOut ? 0x0003 : 0x0001);
+}
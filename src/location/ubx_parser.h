@@ -0,0 +1,95 @@
+#ifndef UBX_PARSER_H
+#define UBX_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hal/hal.h"
+
+// ============================================================================
+// UBX PARSER
+// ============================================================================
+//
+// u-blox binary protocol: sync 0xB5 0x62, class, id, little-endian length,
+// payload, 8-bit Fletcher checksum over class..payload. The firmware uses
+// NAV-PVT (position, velocity, UTC time in one 92-byte message, u-blox 7/M8
+// and later) and the ACK-ACK/ACK-NAK replies to configuration messages.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define UBX_SYNC_1 0xB5
+#define UBX_SYNC_2 0x62
+#define UBX_FRAME_OVERHEAD 8            // Sync, class, id, length, checksum
+#define UBX_MAX_PAYLOAD 100             // Longer messages are checked and skipped
+#define UBX_MAX_LENGTH 1024             // Anything longer is a corrupt header
+
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_ACK 0x05
+#define UBX_CLASS_CFG 0x06
+#define UBX_NAV_PVT 0x07
+#define UBX_ACK_NAK 0x00
+#define UBX_ACK_ACK 0x01
+#define UBX_CFG_PRT 0x00
+#define UBX_CFG_MSG 0x01
+#define UBX_CFG_RATE 0x08
+
+#define UBX_NAV_PVT_LENGTH 92
+#define UBX_CFG_PRT_LENGTH 20
+#define UBX_CFG_MSG_LENGTH 3
+#define UBX_CFG_RATE_LENGTH 6
+
+enum UbxMessage : uint8_t {
+    UBX_NONE = 0,                       // Frame not complete yet
+    UBX_FIX = 1,                        // NAV-PVT applied to the fix
+    UBX_ACK = 2,                        // getAckClass()/getAckId() acknowledged
+    UBX_NAK = 3,                        // ... rejected
+    UBX_OTHER = 4                       // Valid frame the firmware does not use
+};
+
+class UbxParser {
+public:
+    // Feeds one received byte
+    UbxMessage encode(uint8_t byte);
+
+    const GpsFix& getFix() const { return fix; }
+    uint8_t getAckClass() const { return ackClass; }
+    uint8_t getAckId() const { return ackId; }
+
+    uint32_t getFrames() const { return frames; }
+    uint32_t getChecksumErrors() const { return checksumErrors; }
+
+private:
+    enum State : uint8_t {
+        UBX_WAIT_SYNC_1, UBX_WAIT_SYNC_2, UBX_READ_CLASS, UBX_READ_ID,
+        UBX_READ_LENGTH_1, UBX_READ_LENGTH_2, UBX_READ_PAYLOAD, UBX_READ_CK_A, UBX_READ_CK_B
+    };
+
+    State state = UBX_WAIT_SYNC_1;
+    uint8_t msgClass = 0;
+    uint8_t msgId = 0;
+    uint16_t length = 0;
+    uint16_t received = 0;
+    uint8_t ckA = 0;
+    uint8_t ckB = 0;
+    uint32_t started = 0;               // halMillis() at the first sync byte
+    uint8_t payload[UBX_MAX_PAYLOAD];
+    GpsFix fix;
+
+    uint8_t ackClass = 0;
+    uint8_t ackId = 0;
+    uint32_t frames = 0;
+    uint32_t checksumErrors = 0;
+
+    void checksumByte(uint8_t byte);
+    UbxMessage finish();
+    void applyPvt();
+};
+
+// Complete frame around a payload; out needs len + UBX_FRAME_OVERHEAD bytes
+size_t ubxFrame(uint8_t msgClass, uint8_t msgId, const uint8_t* payload, uint16_t len, uint8_t* out);
+
+// Configuration payloads
+void ubxCfgMsg(uint8_t* payload, uint8_t msgClass, uint8_t msgId, uint8_t rate);  // Current port
+void ubxCfgRate(uint8_t* payload, uint16_t measureMs);
+void ubxCfgPrtUart(uint8_t* payload, uint32_t baud, bool nmeaOut);  // UART1, 8N1, UBX+NMEA in
+
+#endif // UBX_PARSER_H
@@ -11,6 +11,7 @@
 #include "config/pins.h"
 #include "config/patterns.h"
 #include "config/settings.h"
+#include "config/pattern_loader.h"
 
 // Hardware modules
 #include "hardware/led_controller.h"
@@ -20,17 +21,32 @@
 #include "hardware/rtc_manager.h"
 #include "hardware/sd_logger.h"
 #include "hardware/data_manager.h"  // Database for detection tracking
+#include "hardware/data_exporter.h"
+#include "hardware/packet_capture.h"
+#include "location/camera_index.h"
 
 // Detection modules
 #include "detection/detection_state.h"
+#include "detection/detection_pipeline.h"
+#include "hal/esp32_hal.h"
 #include "detection/wifi_detector.h"
 #include "detection/ble_detector.h"
 
+// Diagnostics
+#include "system/stats_reporter.h"
+#include "system/boot_profiler.h"
+
 // ============================================================================
 // GLOBAL STATE
 // ============================================================================
 
 static unsigned long lastDisplayUpdate = 0;
+static TaskHandle_t bleTaskHandle = NULL;
+static char serialCommand[32];
+static uint8_t serialCommandLength = 0;
+static SdFileReader cameraFile;         // /cameras.idx, read by cameraIndex
+static TaskHandle_t setupTaskHandle = NULL;     // Notified when the radios are up
+static bool bootReported = false;
 
 // ============================================================================
 // DUAL-CORE TASK FUNCTIONS
@@ -44,31 +60,154 @@ void bleTask(void* parameter) {
     }
 }
 
+// Brings up WiFi and BLE on Core 0 while setup() initializes the rest, then
+// hands the BLE loop to bleTask and exits
+void radioTask(void* parameter) {
+    {
+        BootPhase phase("wifi");
+        wifiDetector.begin();
+    }
+    {
+        BootPhase phase("ble");
+        bleDetector.begin();
+    }
+    
+    // Create BLE scanning task on Core 0 (WiFi runs on Core 1)
+    xTaskCreatePinnedToCore(
+        bleTask,           // Task function
+        "BLE_Scanner",     // Task name
+        8192,              // Stack size (bytes)
+        NULL,              // Parameters
+        1,                 // Priority
+        &bleTaskHandle,    // Task handle
+        0                  // Core 0
+    );
+    bootProfiler.markScanning();
+    
+    xTaskNotifyGive(setupTaskHandle);
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// KNOWN CAMERAS
+// ============================================================================
+
+// Looks up the current fix in the SD camera index (about once per second)
+void checkKnownCameras(const GpsFix& gps) {
+    static unsigned long lastCheck = 0;
+    if (!cameraIndex.isLoaded() || !gps.valid || millis() - lastCheck < 1000) return;
+    lastCheck = millis();
+    
+    CameraFix fix;
+    fix.lat = toMicrodegrees(gps.latitude);
+    fix.lon = toMicrodegrees(gps.longitude);
+    fix.hasCourse = gps.hasCourse;
+    fix.course = gps.course;
+    fix.speedKmh = gps.speedKmh;
+    
+    CameraAlert alert;
+    if (!cameraIndex.update(fix, &alert)) return;
+    
+    printf("[Cameras] Known %s camera ahead: %u m, bearing %u\n",
+           cameraKindName(alert.camera.kind), alert.distance, alert.bearing);
+    printf("{\"type\":\"camera_ahead\",\"kind\":\"%s\",\"distance_m\":%u,\"bearing\":%u,"
+           "\"latitude\":%.6f,\"longitude\":%.6f}\n",
+           cameraKindName(alert.camera.kind), alert.distance, alert.bearing,
+           fromMicrodegrees(alert.camera.lat), fromMicrodegrees(alert.camera.lon));
+    
+    HardwareConfig& hw = settingsManager.getHardware();
+    if (hw.enable_buzzer || hw.enable_leds) {
+        buzzer.cameraAheadAlert();
+    }
+}
+
+// ============================================================================
+// SERIAL COMMANDS
+// ============================================================================
+
+// Starts a background export; progress shows on the OLED and LEDs
+void startExport(bool changedOnly) {
+    if (!settingsManager.getHardware().enable_sd_card || !sdLogger.isInitialized()) {
+        printf("[Export] SD card not available\n");
+        return;
+    }
+    if (!dataManager.isLoaded()) {
+        printf("[Export] Database still loading\n");
+        return;
+    }
+    if (!dataExporter.start(changedOnly)) {
+        printf("[Export] Export already running\n");
+        return;
+    }
+    if (settingsManager.getHardware().enable_leds) {
+        LED.flash(LEDController::COLOR_PURPLE, 3, 200);
+    }
+}
+
+// Line-based console commands: "stats", "boot", "export", "export changes"
+void handleSerialCommands() {
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+        if (c != '\n' && c != '\r') {
+            if (serialCommandLength < sizeof(serialCommand) - 1) {
+                serialCommand[serialCommandLength++] = c;
+            }
+            continue;
+        }
+        if (serialCommandLength == 0) continue;
+        
+        serialCommand[serialCommandLength] = '\0';
+        serialCommandLength = 0;
+        if (strcmp(serialCommand, "stats") == 0) {
+            statsReporter.print();
+        } else if (strcmp(serialCommand, "boot") == 0) {
+            bootProfiler.print();
+        } else if (strcmp(serialCommand, "export") == 0) {
+            startExport(false);
+        } else if (strcmp(serialCommand, "export changes") == 0) {
+            startExport(true);
+        } else {
+            printf("Unknown command: %s\n", serialCommand);
+        }
+    }
+}
+
 // ============================================================================
 // SETUP & LOOP
 // ============================================================================
 
 void setup() {
     Serial.begin(115200);
-    delay(1000);
     
     printf("Starting Flock You Enhanced Detection System v2.0...\n");
     printf("ESP32-WROOM-32 DevKit V4\n\n");
     
-    // Try to initialize SD card first (needed for config)
-    printf("Initializing SD card...\n");
-    SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
-    bool sdAvailable = SD.begin(SD_CS);
+    // One mount of the SD card for every user (needed for config)
+    bool sdAvailable;
+    {
+        BootPhase phase("sd_mount");
+        SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
+        sdAvailable = SD.begin(SD_CS, SPI, SD_SPI_FREQUENCY, "/sd", SD_MAX_OPEN_FILES);
+    }
     
-    if (sdAvailable) {
-        printf("SD card initialized\n");
-        
-        // Load configuration from SD card
-        settingsManager.loadFromSD();
-        settingsManager.printSettings();
-    } else {
-        printf("SD card not found - using default settings\n");
-        settingsManager.loadDefaults();
+    {
+        BootPhase phase("settings");
+        if (sdAvailable) {
+            printf("SD card initialized\n");
+            
+            // Load configuration from SD card
+            settingsManager.loadFromSD();
+            settingsManager.printSettings();
+        } else {
+            printf("SD card not found - using default settings\n");
+            settingsManager.loadDefaults();
+        }
+    }
+    
+    // Build detection matchers (built-in patterns plus /patterns.txt)
+    {
+        BootPhase phase("patterns");
+        patternLoader.begin(sdAvailable);
     }
     
     // Get hardware configuration
@@ -77,8 +216,9 @@ void setup() {
     // Setup BOOT button for export function
     pinMode(0, INPUT_PULLUP);
     
-    // Initialize hardware based on config
+    // Alert outputs first: the radios may report a detection as soon as they start
     if (hw.enable_leds) {
+        BootPhase phase("leds");
         LED.begin();
         LED.setMode(hw.led_mode);
         LED.setBrightness(hw.led_brightness);
@@ -90,6 +230,7 @@ void setup() {
     }
     
     if (hw.enable_buzzer) {
+        BootPhase phase("buzzer");
         buzzer.setType(hw.buzzer_is_passive ? BUZZER_PASSIVE : BUZZER_ACTIVE);
         buzzer.begin();
         printf("Buzzer initialized (%s)\n", hw.buzzer_is_passive ? "PASSIVE/PWM" : "ACTIVE");
@@ -97,21 +238,9 @@ void setup() {
         printf("Buzzer disabled in config\n");
     }
     
-    if (hw.enable_oled) {
-        if (display.begin()) {
-            display.showBootScreen();
-        }
-    } else {
-        printf("OLED display disabled in config\n");
-    }
-    
-    if (hw.enable_gps) {
-        gpsManager.begin();
-    } else {
-        printf("GPS disabled in config\n");
-    }
-    
+    // Log file names use the RTC date
     if (hw.enable_rtc) {
+        BootPhase phase("rtc");
         rtcManager.begin();
         if (rtcManager.isValid()) {
             printf("RTC time: %s\n", rtcManager.getDateTimeString().c_str());
@@ -121,40 +250,82 @@ void setup() {
     }
     
     if (hw.enable_sd_card && sdAvailable) {
-        sdLogger.begin();
+        {
+            BootPhase phase("sd_logger");
+            sdLogger.begin();
+        }
+        
+        if (settingsManager.getSettings().log.capture_packets) {
+            BootPhase phase("capture");
+            packetCapture.begin();
+        }
         
-        // Initialize data manager (loads database from SD card)
+        // Loads the database in the background; detections made meanwhile
+        // are buffered and applied once it is in memory
         dataManager.init();
     } else if (!hw.enable_sd_card) {
         printf("SD card logging disabled in config\n");
     }
     
-    // Boot sequence (LED + buzzer + display)
-    if (hw.enable_buzzer || hw.enable_leds) {
-        buzzer.bootSequence();
-    }
+    // Initialize detection systems
+    PipelineConfig pipelineConfig;
+    pipelineConfig.cooldown = settingsManager.getSettings().scan.detection_cooldown;
+    pipelineConfig.binaryEvents = settingsManager.getSettings().log.binary_events;
+    detectionPipeline.begin(esp32HalContext(), pipelineConfig);
     
+    // WiFi and BLE come up on Core 0 while the rest initializes here
     printf("\nInitializing wireless systems...\n");
+    setupTaskHandle = xTaskGetCurrentTaskHandle();
+    xTaskCreatePinnedToCore(radioTask, "Radio_Init", 6144, NULL, 1, NULL, 0);
     
-    // Initialize detection systems
-    wifiDetector.begin();
-    bleDetector.begin();
+    if (hw.enable_oled) {
+        BootPhase phase("oled");
+        if (display.begin(settingsManager.getSettings().display.brightness,
+                          hw.enable_rtc ? OLED_I2C_CLOCK_RTC : OLED_I2C_CLOCK)) {
+            display.showBootScreen();
+        }
+    } else {
+        printf("OLED display disabled in config\n");
+    }
     
-    // Create BLE scanning task on Core 0 (WiFi runs on Core 1)
-    xTaskCreatePinnedToCore(
-        bleTask,           // Task function
-        "BLE_Scanner",     // Task name
-        8192,              // Stack size (bytes)
-        NULL,              // Parameters
-        1,                 // Priority
-        NULL,              // Task handle
-        0                  // Core 0
-    );
-    printf("BLE scanner task created on Core 0\n");
+    if (hw.enable_gps) {
+        BootPhase phase("gps");
+        gpsManager.begin(hw.gps_ubx, hw.gps_rate);
+    } else {
+        printf("GPS disabled in config\n");
+    }
     
-    if (hw.enable_sd_card) {
-        printf("Loaded %d known devices from database\n", dataManager.getTotalDevices());
+    // Known camera positions built by the host tool (optional)
+    CameraAlertConfig cameraConfig;
+    cameraConfig.alertDistance = settingsManager.getSettings().scan.camera_alert_distance;
+    if (hw.enable_sd_card && sdLogger.isInitialized() && hw.enable_gps && cameraConfig.alertDistance > 0) {
+        BootPhase phase("camera_index");
+        if (cameraFile.open(CAMERA_INDEX_FILE)) {
+            cameraIndex.begin(&cameraFile, cameraConfig);
+        } else {
+            printf("[Cameras] No %s on SD card - known camera alerts off\n", CAMERA_INDEX_FILE);
+        }
     }
+    
+    // Boot sequence (LED + buzzer), played by the sequencer without blocking
+    if (hw.enable_buzzer || hw.enable_leds) {
+        buzzer.bootSequence();
+    }
+    
+    // Wait for the radio task (WiFi, BLE and their tasks are up)
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    printf("BLE scanner task created on Core 0\n");
+    
+    // Stack high-water marks for the stats report
+    statsReporter.begin(settingsManager.getSettings().log.stats_interval);
+    statsReporter.watchTask(bleTaskHandle);
+    statsReporter.watchTask(wifiDetector.getProcessTask());
+    statsReporter.watchTask(wifiDetector.getHopTask());
+    statsReporter.watchTask(LED.getRenderTask());
+    statsReporter.watchTask(display.getRenderTask());
+    statsReporter.watchTask(gpsManager.getTask());
+    statsReporter.watchTask(packetCapture.getWriterTask());
+    
     printf("\n========================================\n");
     printf("System ready - hunting for Flock Safety devices...\n");
     printf("Dual-core mode: WiFi on Core 1, BLE on Core 0\n");
@@ -166,50 +337,62 @@ void setup() {
 void loop() {
     HardwareConfig& hw = settingsManager.getHardware();
     
-    // Update GPS data
+    // Boot report once the database load has finished too
+    if (!bootReported && bootProfiler.isComplete()) {
+        bootProfiler.print();
+        bootReported = true;
+    }
+    
+    // Latest fix from the GPS task (one copy for this pass)
+    GpsFix gps;
     if (hw.enable_gps) {
-        gpsManager.update();
+        gpsManager.getFix(&gps);
         
         // Sync RTC from GPS once per hour if both are enabled
-        if (hw.enable_rtc && gpsManager.isValid()) {
+        if (hw.enable_rtc && gps.valid && gps.hasTime) {
             static unsigned long lastRTCSync = 0;
             if (millis() - lastRTCSync > 3600000) {  // 1 hour
-                rtcManager.syncFromGPS(
-                    gpsManager.getYear(),
-                    gpsManager.getMonth(),
-                    gpsManager.getDay(),
-                    gpsManager.getHour(),
-                    gpsManager.getMinute(),
-                    gpsManager.getSecond()
-                );
+                rtcManager.syncFromGPS(gps.year, gps.month, gps.day, gps.hour, gps.minute, gps.second);
                 lastRTCSync = millis();
             }
         }
+        
+        // Known camera positions near the current fix
+        checkKnownCameras(gps);
+    } else {
+        gps.status = "Disabled";
     }
     
-    // Handle WiFi channel hopping (runs on Core 1)
-    wifiDetector.hopChannel();
+    // Store detections that were waiting for the fix after their capture
+    detectionPipeline.resolvePending();
     
+    // WiFi channel hopping runs on its own task (Core 1)
     // BLE scanning now runs on Core 0 in separate task
     
-    // Update OLED display periodically
-    if (hw.enable_oled && millis() - lastDisplayUpdate > 1000) {
+    // Update OLED display periodically (export progress while one runs)
+    bool exporting = dataExporter.isRunning();
+    if (hw.enable_oled && exporting && millis() - lastDisplayUpdate > 500) {
+        display.showProgress("EXPORTING", dataExporter.getProgress(), dataExporter.getDevices());
+        lastDisplayUpdate = millis();
+    } else if (hw.enable_oled && millis() - lastDisplayUpdate > 1000) {
         display.update(
             detectionState.deviceInRange,
             detectionState.totalDetectionCount,
             detectionState.wifiDetectionCount,
             detectionState.bleDetectionCount,
-            hw.enable_gps ? gpsManager.isValid() : false,
-            hw.enable_gps ? gpsManager.latitude() : 0.0,
-            hw.enable_gps ? gpsManager.longitude() : 0.0,
-            hw.enable_gps ? gpsManager.getStatus().c_str() : "Disabled",
+            gps.valid,
+            gps.latitude,
+            gps.longitude,
+            gps.status,
             hw.enable_sd_card ? sdLogger.isInitialized() : false
         );
         lastDisplayUpdate = millis();
     }
     
     // Update LEDs based on mode
-    if (hw.enable_leds && !detectionState.deviceInRange) {
+    if (hw.enable_leds && exporting) {
+        LED.showProgress(dataExporter.getProgress(), LEDController::COLOR_PURPLE);
+    } else if (hw.enable_leds && !detectionState.deviceInRange) {
         switch (hw.led_mode) {
             case LED_MODE_UNIFIED:
                 LED.scanningEffect();  // Green breathing (legacy mode)
@@ -219,7 +402,7 @@ void loop() {
                     true,  // systemOK
                     detectionState.wifiDetectionCount > 0,
                     detectionState.bleDetectionCount > 0,
-                    hw.enable_gps ? gpsManager.isValid() : false,
+                    gps.valid,
                     hw.enable_sd_card ? sdLogger.isInitialized() : false
                 );
                 break;
@@ -237,7 +420,7 @@ void loop() {
                     true,  // power
                     detectionState.wifiDetectionCount > 0,  // wifi
                     detectionState.bleDetectionCount > 0,   // ble
-                    hw.enable_gps ? gpsManager.isValid() : false,  // gps
+                    gps.valid,  // gps
                     hw.enable_sd_card ? sdLogger.isInitialized() : false,  // sd
                     !detectionState.deviceInRange,  // scanning
                     detectionState.deviceInRange    // detection
@@ -259,12 +442,27 @@ void loop() {
         printf("Device out of range - stopping heartbeat\n");
         detectionState.resetOutOfRange();
         
-        // Flush database when device goes out of range
+        // Flush database and buffered log rows when device goes out of range
         if (hw.enable_sd_card) {
             dataManager.flush();
+            sdLogger.flush();
         }
     }
     
+    // Write buffered log rows if nothing has been logged for a while; journal
+    // changed devices and compact the database in the background when due
+    if (hw.enable_sd_card) {
+        sdLogger.autoFlush();
+        dataManager.autoFlush();
+    }
+    
+    // Serial console and periodic stats line
+    handleSerialCommands();
+    statsReporter.update();
+    
+    // NimBLE host task is known once the first advert arrives
+    statsReporter.watchTask(bleDetector.getHostTask());
+    
     // Check for BOOT button press to export data
     if (hw.enable_sd_card) {
         static unsigned long bootButtonPress = 0;
@@ -278,18 +476,25 @@ void loop() {
             unsigned long pressDuration = millis() - bootButtonPress;
             bootButtonHeld = false;
             
-            if (pressDuration > 2000) {  // Held for 2+ seconds
-                printf("\n=== EXPORTING DATA ===\n");
-                if (hw.enable_leds) {
-                    LED.flash(LEDController::COLOR_PURPLE, 3, 200);
-                }
-                dataManager.exportSummary();
-                printf("Export complete! Files: /export_map.geojson, /export_data.csv\n\n");
-                if (hw.enable_leds) {
-                    LED.flash(LEDController::COLOR_GREEN, 2, 100);
-                }
+            if (pressDuration > 5000) {         // 5+ seconds: changes since last export
+                startExport(true);
+            } else if (pressDuration > 2000) {  // 2+ seconds: everything
+                startExport(false);
+            }
+        }
+        
+        // Report the end of a background export
+        static ExportState lastExportState = EXPORT_IDLE;
+        ExportState exportState = dataExporter.getState();
+        if (exportState != lastExportState && exportState != EXPORT_RUNNING && lastExportState == EXPORT_RUNNING) {
+            if (exportState == EXPORT_DONE && dataExporter.getMapFile()[0]) {
+                printf("Export complete! Files: %s, %s\n\n", dataExporter.getMapFile(), dataExporter.getCsvFile());
+            }
+            if (hw.enable_leds) {
+                LED.flash(exportState == EXPORT_DONE ? LEDController::COLOR_GREEN : LEDController::COLOR_RED, 2, 100);
             }
         }
+        lastExportState = exportState;
     }
         
     delay(100);
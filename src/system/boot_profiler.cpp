@@ -0,0 +1,69 @@
+#include "boot_profiler.h"
+#include <esp_timer.h>
+
+BootProfiler bootProfiler;
+
+static uint32_t nowMicros() {
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    return now ? now : 1;               // 0 means "still running"
+}
+
+int8_t BootProfiler::begin(const char* name) {
+    uint8_t slot = count.fetch_add(1);
+    if (slot >= BOOT_MAX_PHASES) {
+        count.store(BOOT_MAX_PHASES);
+        return BOOT_NO_PHASE;
+    }
+    phases[slot].name = name;
+    phases[slot].start = nowMicros();
+    return (int8_t)slot;
+}
+
+void BootProfiler::end(int8_t phase) {
+    if (phase < 0 || phase >= BOOT_MAX_PHASES) return;
+    phases[phase].end = nowMicros();
+}
+
+void BootProfiler::markScanning() {
+    scanning = nowMicros();
+}
+
+bool BootProfiler::isComplete() {
+    uint8_t n = count.load();
+    if (n > BOOT_MAX_PHASES) n = BOOT_MAX_PHASES;
+    for (uint8_t i = 0; i < n; i++) {
+        if (phases[i].end == 0) return false;
+    }
+    return true;
+}
+
+void BootProfiler::print() {
+    uint8_t n = count.load();
+    if (n > BOOT_MAX_PHASES) n = BOOT_MAX_PHASES;
+
+    uint32_t done = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (phases[i].end > done) done = phases[i].end;
+    }
+
+    printf("[Boot] Scanning after %.0f ms, boot work done after %.0f ms\n",
+           scanning / 1000.0, done / 1000.0);
+    printf("{\"type\":\"boot\",\"scanning_ms\":%.1f,\"done_ms\":%.1f,\"phases\":{",
+           scanning / 1000.0, done / 1000.0);
+    for (uint8_t i = 0; i < n; i++) {
+        const Phase& p = phases[i];
+        if (p.end) {
+            printf("%s\"%s\":[%.1f,%.1f]", i ? "," : "", p.name, p.start / 1000.0,
+                   (p.end - p.start) / 1000.0);
+        } else {
+            printf("%s\"%s\":[%.1f,null]", i ? "," : "", p.name, p.start / 1000.0);
+        }
+    }
+    printf("}}\n");
+}
+
+BootPhase::BootPhase(const char* name) : id(bootProfiler.begin(name)) {}
+
+BootPhase::~BootPhase() {
+    bootProfiler.end(id);
+}
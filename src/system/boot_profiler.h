@@ -0,0 +1,61 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// ============================================================================
+// BOOT PROFILER
+// ============================================================================
+//
+// Start and length of each boot phase, timed with esp_timer (microseconds
+// since the application started). Phases overlap: setup() initializes the
+// peripherals while the radio task brings up WiFi and BLE and the database
+// loads in the background, so any task may record one. A slot is claimed
+// atomically in begin(); only its owner writes it afterwards.
+//
+// Once every phase has ended the main loop prints one JSON line (again on
+// the "boot" console command):
+//
+//   {"type":"boot","scanning_ms":..,"done_ms":..,"phases":{"sd_mount":[start_ms,ms],..}}
+//
+// scanning_ms is when both radios were up; done_ms when the last phase
+// (usually the database load) ended.
+
+#define BOOT_MAX_PHASES 24
+#define BOOT_NO_PHASE -1
+
+class BootProfiler {
+public:
+    int8_t begin(const char* name);    // BOOT_NO_PHASE if all slots are taken
+    void end(int8_t phase);
+    void markScanning();
+
+    bool isComplete();                  // Every phase begun has ended
+    void print();
+
+private:
+    struct Phase {
+        const char* name;
+        uint32_t start;                 // us
+        volatile uint32_t end;          // us, 0 while running
+    };
+
+    Phase phases[BOOT_MAX_PHASES];
+    std::atomic<uint8_t> count{0};
+    volatile uint32_t scanning = 0;
+};
+
+// Times the enclosing scope: { BootPhase phase("oled"); display.begin(...); }
+class BootPhase {
+public:
+    explicit BootPhase(const char* name);
+    ~BootPhase();
+
+private:
+    int8_t id;
+};
+
+extern BootProfiler bootProfiler;
+
+#endif // BOOT_PROFILER_H
@@ -0,0 +1,123 @@
+#include "metrics.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+static Metric* metricList = nullptr;   // Constant-initialized, safe before static constructors
+
+Metric::Metric(const char* name, MetricKind kind) : name(name), kind(kind), next(metricList) {
+    metricList = this;
+}
+
+Metric* Metric::first() {
+    return metricList;
+}
+
+// ============================================================================
+// HISTOGRAM
+// ============================================================================
+
+static int bucketFor(uint32_t cycles) {
+    if (cycles == 0) return 0;
+    int bucket = 32 - __builtin_clz(cycles);
+    return bucket < METRIC_HISTOGRAM_BUCKETS ? bucket : METRIC_HISTOGRAM_BUCKETS - 1;
+}
+
+void MetricHistogram::record(uint32_t cycles) {
+    buckets[bucketFor(cycles)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t seen = maxCycles.load(std::memory_order_relaxed);
+    while (cycles > seen && !maxCycles.compare_exchange_weak(seen, cycles, std::memory_order_relaxed)) {
+    }
+}
+
+uint32_t MetricHistogram::percentile(double p) const {
+    uint32_t total = getCount();
+    if (total == 0) return 0;
+
+    uint32_t rank = (uint32_t)(p * total);
+    if (rank >= total) rank = total - 1;
+    uint32_t seen = 0;
+    for (int i = 0; i < METRIC_HISTOGRAM_BUCKETS; i++) {
+        seen += getBucket(i);
+        if (seen > rank) {
+            // The top bucket is open-ended; no edge is above the largest sample
+            uint32_t edge = i == METRIC_HISTOGRAM_BUCKETS - 1 ? UINT32_MAX : (uint32_t)((1ull << i) - 1);
+            return edge < getMax() ? edge : getMax();
+        }
+    }
+    return getMax();
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+struct JsonOut {
+    char* out;
+    size_t size;
+    size_t len;
+    bool overflow;
+};
+
+static void append(JsonOut& j, const char* format, ...) {
+    if (j.overflow) return;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(j.out + j.len, j.size - j.len, format, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= j.size - j.len) {
+        j.overflow = true;
+        return;
+    }
+    j.len += n;
+}
+
+static uint32_t cyclesToNs(uint64_t cycles) {
+    uint64_t ns = cycles * 1000 / halCyclesPerMicro();
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+}
+
+static void appendSection(JsonOut& j, MetricKind kind, const char* label) {
+    append(j, "\"%s\":{", label);
+    bool firstEntry = true;
+
+    for (Metric* m = Metric::first(); m; m = m->getNext()) {
+        if (m->getKind() != kind) continue;
+        append(j, "%s\"%s\":", firstEntry ? "" : ",", m->getName());
+        firstEntry = false;
+
+        if (kind == METRIC_COUNTER) {
+            append(j, "%u", (unsigned)static_cast<MetricCounter*>(m)->get());
+        } else if (kind == METRIC_GAUGE) {
+            append(j, "%d", (int)static_cast<MetricGauge*>(m)->get());
+        } else {
+            const MetricHistogram* h = static_cast<MetricHistogram*>(m);
+            append(j, "{\"n\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u,\"hist\":[",
+                   (unsigned)h->getCount(), (unsigned)cyclesToNs(h->percentile(0.50)),
+                   (unsigned)cyclesToNs(h->percentile(0.90)), (unsigned)cyclesToNs(h->percentile(0.99)),
+                   (unsigned)cyclesToNs(h->getMax()));
+
+            // Buckets up to the last non-empty one
+            int last = -1;
+            for (int i = 0; i < METRIC_HISTOGRAM_BUCKETS; i++) {
+                if (h->getBucket(i)) last = i;
+            }
+            for (int i = 0; i <= last; i++) {
+                append(j, "%s%u", i ? "," : "", (unsigned)h->getBucket(i));
+            }
+            append(j, "]}");
+        }
+    }
+    append(j, "}");
+}
+
+size_t metricsFormatJson(char* out, size_t size) {
+    JsonOut j = {out, size, 0, false};
+    appendSection(j, METRIC_COUNTER, "counters");
+    append(j, ",");
+    appendSection(j, METRIC_GAUGE, "gauges");
+    append(j, ",");
+    appendSection(j, METRIC_HISTOGRAM, "latency");
+    return j.overflow ? 0 : j.len;
+}
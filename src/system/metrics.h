@@ -0,0 +1,111 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "hal/hal.h"
+
+// ============================================================================
+// METRICS REGISTRY
+// ============================================================================
+//
+// Counters, gauges and latency histograms that modules declare as statics
+// next to the code they measure:
+//
+//   static MetricHistogram sniffLatency("wifi.sniff");
+//   ...
+//   MetricTimer timer(sniffLatency);
+//
+// Each metric links itself into a global list from its constructor (static
+// initialization, before setup()), so the registry needs no allocation and
+// no central table. Updates are relaxed atomics and safe from any task or
+// core; a report may mix values from slightly different moments.
+//
+// Histograms count samples in log2 buckets of halCycles(): bucket i holds
+// [2^(i-1), 2^i) cycles (bucket 0: zero) and the last one everything above.
+// At 240 MHz that covers a few ns to several seconds in 32 words.
+//
+// Plain C++ (no Arduino/ESP-IDF dependencies) so it can be built on a host.
+
+#define METRIC_HISTOGRAM_BUCKETS 32
+
+enum MetricKind : uint8_t {
+    METRIC_COUNTER = 0,
+    METRIC_GAUGE = 1,
+    METRIC_HISTOGRAM = 2
+};
+
+class Metric {
+public:
+    Metric(const char* name, MetricKind kind);
+
+    const char* getName() const { return name; }
+    MetricKind getKind() const { return kind; }
+    Metric* getNext() const { return next; }
+
+    static Metric* first();
+
+private:
+    const char* name;
+    MetricKind kind;
+    Metric* next;
+};
+
+// Monotonic event count
+class MetricCounter : public Metric {
+public:
+    explicit MetricCounter(const char* name) : Metric(name, METRIC_COUNTER) {}
+    void add(uint32_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint32_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> value{0};
+};
+
+// Last value set (queue depth, table size, ...)
+class MetricGauge : public Metric {
+public:
+    explicit MetricGauge(const char* name) : Metric(name, METRIC_GAUGE) {}
+    void set(int32_t v) { value.store(v, std::memory_order_relaxed); }
+    int32_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int32_t> value{0};
+};
+
+class MetricHistogram : public Metric {
+public:
+    explicit MetricHistogram(const char* name) : Metric(name, METRIC_HISTOGRAM) {}
+    void record(uint32_t cycles);
+
+    uint32_t getCount() const { return count.load(std::memory_order_relaxed); }
+    uint32_t getBucket(int i) const { return buckets[i].load(std::memory_order_relaxed); }
+    uint32_t getMax() const { return maxCycles.load(std::memory_order_relaxed); }
+
+    // Upper edge (cycles) of the bucket holding the p-th sample, 0 if empty
+    uint32_t percentile(double p) const;
+
+private:
+    std::atomic<uint32_t> buckets[METRIC_HISTOGRAM_BUCKETS] = {};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> maxCycles{0};
+};
+
+// Records the cycles between construction and destruction
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& histogram) : histogram(histogram), start(halCycles()) {}
+    ~MetricTimer() { histogram.record(halCycles() - start); }
+
+private:
+    MetricHistogram& histogram;
+    uint32_t start;
+};
+
+// Appends "counters":{...},"gauges":{...},"latency":{...} (no braces around
+// the whole) to out. Latencies are in ns. Returns the length written, or 0
+// if out is too small.
+size_t metricsFormatJson(char* out, size_t size);
+
+#endif // METRICS_H
@@ -0,0 +1,66 @@
+#include "stats_reporter.h"
+#include "metrics.h"
+#include "detection/detection_pipeline.h"
+#include "detection/wifi_detector.h"
+#include "hardware/packet_capture.h"
+
+StatsReporter statsReporter;
+
+void StatsReporter::begin(uint32_t intervalMs) {
+    interval = intervalMs;
+    lastReport = millis();
+    watchTask(xTaskGetCurrentTaskHandle());  // setup() runs in the loop task
+}
+
+void StatsReporter::watchTask(TaskHandle_t task) {
+    if (!task || taskCount >= STATS_MAX_TASKS) return;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (tasks[i] == task) return;
+    }
+    tasks[taskCount++] = task;
+}
+
+void StatsReporter::update() {
+    if (interval == 0 || millis() - lastReport < interval) return;
+    print();
+}
+
+void StatsReporter::print() {
+    lastReport = millis();
+    size_t size = sizeof(buffer) - 2;
+    int len = snprintf(buffer, size,
+                       "{\"type\":\"stats\",\"uptime_ms\":%lu,"
+                       "\"heap\":{\"free\":%u,\"min_free\":%u,\"largest_block\":%u},\"stacks\":{",
+                       millis(), (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(),
+                       (unsigned)ESP.getMaxAllocHeap());
+
+    for (uint8_t i = 0; i < taskCount && len < (int)size; i++) {
+        len += snprintf(buffer + len, size - len, "%s\"%s\":%u", i ? "," : "",
+                        pcTaskGetTaskName(tasks[i]),
+                        (unsigned)uxTaskGetStackHighWaterMark(tasks[i]));
+    }
+
+    const PipelineStats& wifi = detectionPipeline.getWiFiStats();
+    const PipelineStats& ble = detectionPipeline.getBleStats();
+    if (len < (int)size) {
+        len += snprintf(buffer + len, size - len,
+                        "},\"dropped\":{\"wifi_queue\":%u,\"capture\":%u,\"events\":%u},"
+                        "\"pipeline\":{\"wifi\":{\"packets\":%u,\"matches\":%u,\"emitted\":%u,\"suppressed\":%u},"
+                        "\"ble\":{\"packets\":%u,\"matches\":%u,\"emitted\":%u,\"suppressed\":%u}},",
+                        (unsigned)wifiDetector.getFramesDropped(), (unsigned)packetCapture.getDropped(),
+                        (unsigned)detectionPipeline.getEventOverflows(),
+                        (unsigned)wifi.packets, (unsigned)wifi.matches, (unsigned)wifi.emitted,
+                        (unsigned)wifi.suppressed, (unsigned)ble.packets, (unsigned)ble.matches,
+                        (unsigned)ble.emitted, (unsigned)ble.suppressed);
+    }
+
+    size_t metrics = len < (int)size ? metricsFormatJson(buffer + len, size - len) : 0;
+    if (metrics == 0) {
+        printf("[Stats] Report does not fit in %u bytes\n", (unsigned)sizeof(buffer));
+        return;
+    }
+    len += metrics;
+    buffer[len++] = '}';
+    buffer[len++] = '\n';
+    Serial.write((const uint8_t*)buffer, len);
+}
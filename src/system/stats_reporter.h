@@ -0,0 +1,44 @@
+#ifndef STATS_REPORTER_H
+#define STATS_REPORTER_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// STATS REPORTER
+// ============================================================================
+//
+// Prints one JSON line on Serial with where time and memory go:
+//
+//   {"type":"stats","uptime_ms":..,"heap":{..},"stacks":{..},"dropped":{..},
+//    "pipeline":{..},"counters":{..},"gauges":{..},"latency":{..}}
+//
+// heap: free / low-water mark / largest block (bytes). stacks: unused stack
+// (bytes) of each watched task at its high-water mark. dropped: WiFi frame
+// queue overflows, capture records and oversized events. counters, gauges
+// and latency (ns, log2 histograms) come from the metrics registry.
+//
+// Sent when "stats" is typed on the serial console, and every
+// log.stats_interval ms if that is non-zero. The line has no
+// detection_method, so the api/ dashboard does not treat it as a detection.
+
+#define STATS_MAX_TASKS 8
+#define STATS_BUFFER_SIZE 4096
+
+class StatsReporter {
+public:
+    void begin(uint32_t intervalMs);
+    void watchTask(TaskHandle_t task);  // Ignores null handles
+    void update();                      // Main loop - periodic report
+    void print();
+
+private:
+    TaskHandle_t tasks[STATS_MAX_TASKS];
+    uint8_t taskCount = 0;
+    uint32_t interval = 0;
+    unsigned long lastReport = 0;
+    char buffer[STATS_BUFFER_SIZE];
+};
+
+extern StatsReporter statsReporter;
+
+#endif // STATS_REPORTER_H